@@ -33,6 +33,16 @@ enum ApplyInit {
 	INIT_A_NONE
 };
 
+/// Methods of carrying out the triangular solves that apply ILU-type preconditioners
+enum ApplyType {
+	/// Asynchronous sweeps, whose number is set by the preconditioner
+	APPLY_ASYNC,
+	/// Exact solves in which each row waits only for the rows it depends on \sa SyncFreeSchedule
+	APPLY_SYNCFREE,
+	/// Products with incomplete sparse approximate inverses of the factors \sa ILUISAI
+	APPLY_ISAI
+};
+
 /// Converts a string into an initialization type enum. \ref INIT_F_NONE is default.
 inline FactInit getFactInitFromString(const std::string itype) {
 	if(itype == "init_zero")
@@ -59,6 +69,18 @@ inline ApplyInit getApplyInitFromString(const std::string itype) {
 		throw std::invalid_argument("Apply initialization not recongnized!");
 }
 
+/// Converts a string into a triangular solve type enum
+inline ApplyType getApplyTypeFromString(const std::string atype) {
+	if(atype == "async")
+		return APPLY_ASYNC;
+	else if(atype == "syncfree")
+		return APPLY_SYNCFREE;
+	else if(atype == "isai")
+		return APPLY_ISAI;
+	else
+		throw std::invalid_argument("Apply type not recognized!");
+}
+
 }
 
 #endif
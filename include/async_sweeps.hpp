@@ -0,0 +1,221 @@
+/** \file async_sweeps.hpp
+ * \brief Execution of asynchronous sweep procedures within a single parallel region
+ * \author Aditya Kashi
+ *
+ * Applying an asynchronous preconditioner usually involves a few element-wise vector operations
+ * (initialization, copies, scaling) interleaved with a forward and a backward set of asynchronous
+ * sweeps. Opening a parallel region for each of these steps costs a fork and a join each time,
+ * which dominates the cost of an application for small subdomains. Here, all the steps of one
+ * application are carried out by the same team of threads, separated only by barriers where a
+ * step needs the complete result of the previous one.
+ *
+ * The sweeps can optionally be block-asynchronous: the rows are divided into tiles small enough
+ * for their part of the matrix to stay in cache, and a thread that picks up a tile sweeps over it
+ * several times, reading the values of other tiles as they happen to be, before moving on. The
+ * matrix is then read from memory once for several local sweeps.
+ */
+
+#ifndef BLASTED_ASYNC_SWEEPS_H
+#define BLASTED_ASYNC_SWEEPS_H
+
+#include <algorithm>
+#include <cstddef>
+#include "numa_schedule.hpp"
+
+namespace blasted {
+
+/// Division of the rows into tiles for block-asynchronous sweeps \sa AsyncSweepEngine
+template <typename index>
+struct SweepTiling
+{
+	index tilerows = 0;      ///< Number of (block-)rows in a tile; 0 means no tiling
+	int innersweeps = 1;     ///< Number of sweeps over a tile each time a thread picks it up
+};
+
+/// Computes the number of rows in a tile whose data fits in a given amount of cache
+/** The estimate counts, for an average row, the non-zero blocks and column indices of the
+ * matrix, the row pointers and the entries of two vectors.
+ * \param mat The matrix to sweep over
+ * \param bs Block size
+ * \param nvalarrays Number of arrays of values in the pattern of the matrix read by each row, eg.,
+ *   2 for the ILU factorization, which reads the matrix and the factors
+ * \param cachebytes Size of the cache to fit the tile in
+ */
+template <typename scalar, typename index>
+index cache_tile_rows(const CRawBSRMatrix<scalar,index>& mat, const int bs, const int nvalarrays,
+                      const size_t cachebytes)
+{
+	if(mat.nbrows <= 0)
+		return 1;
+	const double nnzbperrow = static_cast<double>(mat.browptr[mat.nbrows])/mat.nbrows;
+	const double rowbytes = nnzbperrow*(nvalarrays*bs*bs*sizeof(scalar) + sizeof(index))
+		+ 2*sizeof(index) + 2*bs*sizeof(scalar);
+	return std::max(static_cast<index>(cachebytes/rowbytes), static_cast<index>(1));
+}
+
+/// Runs the steps of an asynchronous preconditioning or relaxation procedure in one parallel region
+/** Typical usage, inside a const member function of a preconditioner:
+ * \code
+ * const AsyncSweepEngine<index> eng(mat.nbrows, thread_chunk_size, sched);
+ * eng.run(true, [&]() {
+ *     eng.rows([&](const index start, const index end) { ... initialize ... });
+ *     eng.sync();
+ *     eng.forward(napplysweeps, [&](const index irow) { ... forward kernel ... });
+ *     eng.sync();
+ *     eng.backward(napplysweeps, [&](const index irow) { ... backward kernel ... });
+ * });
+ * \endcode
+ * All the functions other than \ref run must be called by all threads of the team, ie., from the
+ * callable passed to \ref run. None of them synchronizes threads on its own; \ref sync is to be
+ * called between steps that depend on each other.
+ *
+ * The sweep functions may also be called from any parallel region (or serially) on their own.
+ */
+template <typename index>
+class AsyncSweepEngine
+{
+public:
+	/// Sets up the schedule of an operation
+	/** \param nrows Number of (block-)rows that are swept
+	 * \param chunksize Number of rows assigned to a thread at a time in dynamically scheduled sweeps
+	 * \param sched Partition of the rows among NUMA domains; if not null and active, it is used
+	 *   both for the element-wise steps and for the sweeps. If it is used, \ref sync must be called
+	 *   before every sweep step.
+	 * \param tiling Tiles for block-asynchronous sweeps; not used along with a NUMA schedule.
+	 *   Tiles are made smaller if needed so that every thread gets at least one.
+	 */
+	AsyncSweepEngine(const index nrows, const int chunksize,
+	                 const DomainSchedule<index> *const sched = nullptr,
+	                 const SweepTiling<index> tiling = SweepTiling<index>())
+		: n{nrows}, chunk{chunksize}, dsched{sched && sched->active() ? sched : nullptr},
+		  tiles{tiling}
+	{ }
+
+	/// Executes all the steps in a single parallel region
+	/** \param usethreads If false, the steps are carried out by one thread, in which case the sweeps
+	 *   are ordinary (sequential) forward and backward substitutions.
+	 * \param steps Callable, taking no arguments, that performs all the steps
+	 */
+	template <typename Steps>
+	void run(const bool usethreads, Steps&& steps) const
+	{
+#pragma omp parallel default(shared) if(usethreads)
+		steps();
+	}
+
+	/// Synchronizes the threads; all previous steps are complete on return
+	void sync() const
+	{
+		if(dsched)
+			dsched->reset();
+		else {
+#pragma omp barrier
+		}
+	}
+
+	/// Calls f(start,end) with a static share of the rows for each thread
+	/** The shares are the same in every call, so that element-wise steps operating on the same
+	 * rows need not be separated by \ref sync.
+	 */
+	template <typename F>
+	void rows(F&& f) const
+	{
+		if(dsched)
+			dsched->for_my_rows(f);
+		else {
+			int nthreads = 1, tid = 0;
+#ifdef _OPENMP
+			nthreads = omp_get_num_threads();
+			tid = omp_get_thread_num();
+#endif
+			f(static_cast<index>(static_cast<long>(n)*tid/nthreads),
+			  static_cast<index>(static_cast<long>(n)*(tid+1)/nthreads));
+		}
+	}
+
+	/// Performs nsweeps asynchronous sweeps over the rows in increasing order
+	/** There is no synchronization between the sweeps. With tiling, each sweep visits every tile
+	 * once and carries out the inner sweeps over it.
+	 * \param body Callable taking the row index
+	 */
+	template <typename F>
+	void forward(const int nsweeps, F&& body) const
+	{
+		if(dsched)
+			dsched->forward(nsweeps, body);
+		else if(tiles.tilerows > 0) {
+			const index tsize = tile_size();
+			const index ntiles = (n + tsize - 1)/tsize;
+			for(int isweep = 0; isweep < nsweeps; isweep++)
+			{
+#pragma omp for schedule(dynamic, 1) nowait
+				for(index itile = 0; itile < ntiles; itile++)
+				{
+					const index end = std::min(n, (itile+1)*tsize);
+					for(int inner = 0; inner < tiles.innersweeps; inner++)
+						for(index irow = itile*tsize; irow < end; irow++)
+							body(irow);
+				}
+			}
+		}
+		else
+			for(int isweep = 0; isweep < nsweeps; isweep++)
+			{
+#pragma omp for schedule(dynamic, chunk) nowait
+				for(index irow = 0; irow < n; irow++)
+					body(irow);
+			}
+	}
+
+	/// Performs nsweeps asynchronous sweeps over the rows in decreasing order \sa forward
+	template <typename F>
+	void backward(const int nsweeps, F&& body) const
+	{
+		if(dsched)
+			dsched->backward(nsweeps, body);
+		else if(tiles.tilerows > 0) {
+			const index tsize = tile_size();
+			const index ntiles = (n + tsize - 1)/tsize;
+			for(int isweep = 0; isweep < nsweeps; isweep++)
+			{
+#pragma omp for schedule(dynamic, 1) nowait
+				for(index itile = ntiles-1; itile >= 0; itile--)
+				{
+					const index start = itile*tsize;
+					const index end = std::min(n, start+tsize);
+					for(int inner = 0; inner < tiles.innersweeps; inner++)
+						for(index irow = end-1; irow >= start; irow--)
+							body(irow);
+				}
+			}
+		}
+		else
+			for(int isweep = 0; isweep < nsweeps; isweep++)
+			{
+#pragma omp for schedule(dynamic, chunk) nowait
+				for(index irow = n-1; irow >= 0; irow--)
+					body(irow);
+			}
+	}
+
+protected:
+	const index n;                              ///< Number of rows
+	const int chunk;                            ///< Chunk size for dynamic scheduling
+	const DomainSchedule<index> *const dsched;  ///< NUMA domain schedule, if any
+	const SweepTiling<index> tiles;             ///< Tiles for block-asynchronous sweeps, if any
+
+	/// Number of rows in a tile, such that each thread of the team gets at least one tile
+	index tile_size() const
+	{
+		int nthreads = 1;
+#ifdef _OPENMP
+		nthreads = omp_get_num_threads();
+#endif
+		const index perthread = (n + nthreads - 1)/nthreads;
+		return std::max(std::min(tiles.tilerows, perthread), static_cast<index>(1));
+	}
+};
+
+}
+
+#endif
@@ -42,8 +42,32 @@ struct Blasted_node
 
 	int nbuildsweeps;           ///< Number of async build sweeps
 	int napplysweeps;           ///< Number of async apply sweeps
+	double buildtol;            ///< Relative tolerance for adaptive async build sweeps; 0 if unused
+	int filllevel;              ///< Level of fill for ILU(k)
+	double ilutfillfactor;      ///< Row fill budget of ParILUT relative to the matrix
+	double refactortol;         ///< Relative row change for incremental block ILU; negative if unused
+	int refactorlevels;         ///< Levels of dependent rows refactorized incrementally
+	bool syncfreefactor;        ///< Compute exact ILU(0) factors without barriers instead of sweeping
+	int tilecachekb;            ///< Cache size in KiB for tiles of block-async sweeps; 0 if unused
+	int tileinnersweeps;        ///< Local sweeps over a tile each time it is visited
+	int colordistance;          ///< Distance of the coloring for multicolor preconditioners
+	bool balancedcolors;        ///< Balance the sizes of the colors for multicolor preconditioners
+	bool incompletesai;         ///< Compute incomplete SAIs for SAI-type preconditioners
+	int chebeigiters;           ///< Power iterations estimating the largest eigenvalue for Chebyshev
+	double chebeigratio;        ///< Ratio of the lower to the upper end of the Chebyshev interval
 	char factinittype[BLASTED_OPT_STRLEN];    ///< Type of initialization for asynchronous factorization
 	char applyinittype[BLASTED_OPT_STRLEN];   ///< Type of initialization for asynchronous application
+	char applytype[BLASTED_OPT_STRLEN];       ///< Method of triangular solves for ILU application
+	char reordering[BLASTED_OPT_STRLEN];      ///< Symmetric reordering of the block-rows, if any
+
+	int sellchunkheight;        ///< SELL-C-sigma chunk height for scalar matrices; 0 for CSR
+	int sellsortscope;          ///< SELL-C-sigma sorting scope
+	bool compressedcolind;      ///< Use 16-bit compressed column indices in async sweeps
+	bool floatfactors;          ///< Store factors and inverted diagonal blocks in single precision
+	bool floatmatrix;           ///< Also keep a single-precision copy of the matrix for SGS sweeps
+	int numadomains;            ///< Number of NUMA domains to distribute preconditioner data over
+	bool numacopymatrix;        ///< Copy the local matrix into NUMA-local storage
+	void *localmat;             ///< The NUMA-local copy of the local matrix, if any
 
 	bool compute_precinfo;      ///< Set true to request computation of extra info to aid analysis
 	void *infolist;             ///< Optional preconditioner information
@@ -59,6 +83,11 @@ struct Blasted_node
 	double factorwalltime;    ///< Wall-clock time for factorization
 	double applycputime;      ///< CPU time taken for application of the preconditioner
 	double applywalltime;     ///< Wall-clock time for application
+	/// Wall-clock time for computing structural data such as ILU positions or level sets;
+	///  this is included in \ref factorwalltime
+	double structwalltime;
+	/// Total number of async build sweeps used over all computations of this preconditioner
+	long buildsweeps;
 
 	struct Blasted_node *next;  ///< Link to next Blasted context
 };
@@ -81,6 +110,7 @@ typedef struct
 	double factorwalltime; ///< Walltime taken by factorizations by all BLASTed instances in this list
 	double applycputime;   ///< CPU time taken by applications of all BLASTed instances in this list
 	double applywalltime;  ///< Walltime taken by applications of all BLASTed instances in this list
+	double structwalltime; ///< Walltime taken for structural setup by all instances in this list
 
 } Blasted_data_list;
 
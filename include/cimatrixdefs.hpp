@@ -0,0 +1,81 @@
+/** \file cimatrixdefs.hpp
+ * \brief Compressed (16-bit) column-index storage for sparse-row matrices
+ * \author Aditya Kashi
+ */
+
+#ifndef BLASTED_CIMATRIXDEFS_H
+#define BLASTED_CIMATRIXDEFS_H
+
+#include <cstdint>
+#include "srmatrixdefs.hpp"
+
+namespace blasted {
+
+/// Type of the compressed column offsets
+typedef std::int16_t ci_offset_t;
+
+/// Offset value marking an entry whose column index is stored in full in the escape array
+constexpr ci_offset_t CI_ESCAPE = std::numeric_limits<ci_offset_t>::min();
+
+/// Compressed block-column indices of a sparse-row matrix
+/** For each stored (block) non-zero jj in (block-)row irow, the column index is stored as the 16-bit
+ * offset bcolind[jj] - irow. This halves the index bytes streamed per sweep compared to 32-bit
+ * indices. Entries whose column is too far from the diagonal for a 16-bit offset are marked with
+ * \ref CI_ESCAPE; their full column indices are stored, in order, in \ref escapes.
+ *
+ * Kernels decode a range of a row by keeping a cursor into \ref escapes. For the ranges needed by
+ * triangular sweeps, the cursor can start at \ref escptr (start of the row) or \ref escdiagptr
+ * (just after the diagonal); the diagonal entry itself never needs an escape.
+ *
+ * The values and all other arrays (row pointers, diagonal locations) are those of the original
+ * matrix, and the compressed indices are valid for any matrix with the same non-zero structure,
+ * such as the ILU(0) factors.
+ */
+template <typename index>
+struct CompressedColumnIndex
+{
+	static_assert(std::numeric_limits<index>::is_integer, "Integer index type required!");
+	static_assert(std::numeric_limits<index>::is_signed, "Signed index type required!");
+
+	ArrayView<ci_offset_t> offsets;  ///< Column offset from the row, or \ref CI_ESCAPE, of each entry
+	ArrayView<index> escapes;        ///< Full column indices of escaped entries
+	ArrayView<index> escptr;         ///< Start of the escapes of each row in \ref escapes (nbrows+1)
+	ArrayView<index> escdiagptr;     ///< First escape of each row lying after the diagonal entry
+	index nbrows;                    ///< Number of (block-)rows
+
+	/// Sets an empty index
+	CompressedColumnIndex() : nbrows{0}
+	{ }
+};
+
+/// An immutable non-owning view of a \ref CompressedColumnIndex, for use in kernels
+template <typename index>
+struct CRawCompressedColumnIndex
+{
+	const ci_offset_t *offsets;      ///< Column offset from the row, or \ref CI_ESCAPE
+	const index *escapes;            ///< Full column indices of escaped entries
+	const index *escptr;             ///< Start of the escapes of each row
+	const index *escdiagptr;         ///< First escape of each row lying after the diagonal entry
+	index nbrows;                    ///< Number of (block-)rows
+
+	/// Sets an empty index
+	CRawCompressedColumnIndex()
+		: offsets{nullptr}, escapes{nullptr}, escptr{nullptr}, escdiagptr{nullptr}, nbrows{0}
+	{ }
+};
+
+/// Wraps the arrays of a compressed column index in a raw view
+template <typename index>
+CRawCompressedColumnIndex<index> createRawView(const CompressedColumnIndex<index>& cind);
+
+/// Computes the compressed column indices of a sparse-row matrix
+/** \param[in] mat The (block-)sparse-row matrix; diagonal locations must be available
+ * \param[out] cind The compressed index; any previous storage is freed
+ */
+template <typename scalar, typename index>
+void compress_column_indices(const CRawBSRMatrix<scalar,index>& mat,
+                             CompressedColumnIndex<index>& cind);
+
+}
+
+#endif
@@ -51,6 +51,38 @@ struct ILUPositions
 template <typename scalar, typename index>
 ILUPositions<index> compute_ILU_positions_CSR_CSR(const CRawBSRMatrix<scalar,index> *const mat);
 
+/// Computes the positions needed for the ILU factors into existing storage, without any output
+/** Meant for patterns that change often, such as those of threshold ILU factors; the storage of
+ * the lists is reused when it is large enough.
+ */
+template <typename scalar, typename index>
+void compute_ILU_positions_CSR_CSR(const CRawBSRMatrix<scalar,index> *const mat,
+                                   ILUPositions<index>& pos);
+
+/// Non-zero structure of incomplete LU factors with a given level of fill (ILU(k))
+/** The pattern contains that of the original matrix. The column indices in each row are sorted.
+ */
+template <typename index>
+struct ILUkPattern
+{
+	std::vector<index> browptr;     ///< Pointers to the beginning of each (block-)row
+	std::vector<index> bcolind;     ///< (Block-)column indices of the non-zeros
+	std::vector<index> diagind;     ///< Positions of the diagonal entries
+	/// Position in \ref bcolind of each stored non-zero of the original matrix
+	std::vector<index> origpos;
+};
+
+/// Computes the symbolic ILU(k) factorization of a matrix by levels of fill
+/** An entry (i,j) is in the pattern if its level of fill is at most fill_level, the level of an
+ * entry of the original matrix being 0 and that of a fill-in created during elimination of row
+ * k being \f$ lev_{ik} + lev_{kj} + 1 \f$. Rows are processed in order, since each row depends
+ * on the patterns of the upper factor in previous rows. The column indices in each row of the
+ * input matrix must be sorted, and all diagonal entries must be present.
+ */
+template <typename scalar, typename index>
+ILUkPattern<index> compute_ILUk_pattern(const CRawBSRMatrix<scalar,index> *const mat,
+                                        const int fill_level);
+
 }
 
 #endif
@@ -11,13 +11,43 @@
 
 namespace blasted {
 
-/// Divides the unknowns in a system into contiguous and ordered levels
-/** \param mat The original matrix. It is assumed that column indices in each row are ordered.
- * \return A list containing, for each level, the starting (block)row index for that level. There is one
- * extra entry in the end for convenience - this is always one past the total number of (block-) rows.
+/// A partition of the (block-)rows into levels, each of which can be processed in parallel
+/** The rows of level l are rows[levelptr[l]] to rows[levelptr[l+1]-1], in increasing order. Rows in
+ * a level depend only on rows in previous levels.
+ */
+template <typename index>
+struct LevelSets
+{
+	std::vector<index> levelptr;    ///< Start of each level in \ref rows, and the number of rows
+	std::vector<index> rows;        ///< Row indices, level by level
+
+	/// Number of levels
+	index numLevels() const { return static_cast<index>(levelptr.size())-1; }
+};
+
+/// Level sets for a forward and a backward substitution sweep over a matrix
+template <typename index>
+struct LevelSchedule
+{
+	/// Levels for a forward sweep; row i depends on rows j < i that it is coupled to
+	LevelSets<index> forward;
+	/// Levels for a backward sweep; row i depends on rows j > i that it is coupled to
+	LevelSets<index> backward;
+};
+
+/// Computes forward and backward level sets from the dependency depth of each (block-)row
+/** The pattern need not be symmetric. Each level is found in parallel from the previous one by
+ * decrementing the dependency counts of the rows depending on it.
+ *
+ * \param mat The original matrix
+ * \param inplace If false, row i depends only on the rows j it reads (non-zero (i,j)), which is
+ *   enough for substitutions that write into a vector different from the ones they read.
+ *   If true, the dependencies are symmetrized so that a sweep updating the solution in place reads
+ *   old values of the rows not yet reached by the sweep, as in the sequential Gauss-Seidel sweep.
  */
 template <typename scalar, typename index>
-std::vector<index> computeLevels(const CRawBSRMatrix<scalar,index> *const mat);
+LevelSchedule<index> computeLevels(const CRawBSRMatrix<scalar,index> *const mat,
+                                   const bool inplace = false);
 
 }
 
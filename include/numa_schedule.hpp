@@ -0,0 +1,275 @@
+/** \file numa_schedule.hpp
+ * \brief Partitioning of rows among NUMA domains, first-touch initialization and loop scheduling
+ * \author Aditya Kashi
+ *
+ * Memory pages are placed on the NUMA domain (socket) of the thread that first writes to them. The
+ * (block-)rows of a matrix are split into contiguous ranges, one per domain, with roughly equal
+ * numbers of non-zeros. Arrays associated with rows are first written by threads of the domain
+ * owning those rows, and loops over rows are scheduled statically across domains and dynamically
+ * within each domain. Each thread thus mostly reads memory attached to its own socket.
+ *
+ * Threads are assigned to domains by thread number: with T threads and D domains, thread t belongs
+ * to domain floor(tD/T). This matches the thread placement obtained with OMP_PLACES=sockets and
+ * OMP_PROC_BIND=close or spread. If there are fewer threads than domains, each thread takes care of
+ * several domains.
+ */
+
+#ifndef BLASTED_NUMA_SCHEDULE_H
+#define BLASTED_NUMA_SCHEDULE_H
+
+#include <vector>
+#include <algorithm>
+#include "srmatrixdefs.hpp"
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace blasted {
+
+/// Rows partitioned among NUMA domains, with loops scheduled statically across the domains and
+/// dynamically within each domain
+/** An inactive schedule (the default, or with fewer than two domains) should not be used for loops;
+ * callers are expected to fall back to ordinary OpenMP loops in that case.
+ */
+template <typename index>
+class DomainSchedule
+{
+public:
+	/// Sets an inactive schedule
+	DomainSchedule() : ndom{1}, chunk{1}
+	{ }
+
+	/// Partitions the rows of a matrix among NUMA domains
+	/** \param mat The matrix whose (block-)rows are to be partitioned
+	 * \param ndomains Number of NUMA domains; the schedule is inactive if this is less than 2
+	 * \param chunksize Number of rows assigned to a thread at a time within a domain
+	 */
+	template <typename scalar>
+	void setup(const CRawBSRMatrix<scalar,index>& mat, const int ndomains, const int chunksize)
+	{
+		ndom = std::max(1, std::min(ndomains, static_cast<int>(mat.nbrows)));
+		chunk = std::max(1, chunksize);
+		domptr.resize(ndom+1);
+
+		// balance the number of non-zeros
+		const index nnz = mat.browptr[mat.nbrows];
+		domptr[0] = 0;
+		for(int d = 1; d < ndom; d++) {
+			const index target = static_cast<index>(static_cast<long>(nnz)*d/ndom);
+			domptr[d] = std::lower_bound(mat.browptr, mat.browptr+mat.nbrows, target) - mat.browptr;
+		}
+		domptr[ndom] = mat.nbrows;
+
+		counters.assign(ndom*cstride, 0);
+	}
+
+	/// Whether rows are distributed over more than one domain
+	bool active() const { return ndom > 1; }
+
+	/// Number of domains
+	int numDomains() const { return ndom; }
+
+	/// First row of a domain; domainStart(numDomains()) is the number of rows
+	index domainStart(const int d) const { return domptr[d]; }
+
+	/// Initializes an array having rowsize entries per row, from the threads owning the rows
+	/** To be called outside of any parallel region.
+	 */
+	template <typename T>
+	void first_touch(T *const arr, const int rowsize, const T value) const
+	{
+#pragma omp parallel default(shared)
+		for_my_rows([arr,rowsize,value](const index start, const index end) {
+			for(index i = start*rowsize; i < end*rowsize; i++)
+				arr[i] = value;
+		});
+	}
+
+	/// Copies (or zeros) an array with a variable number of entries per row, from the threads owning
+	/// the rows
+	/** To be called outside of any parallel region.
+	 * \param rowptr Row pointers, such that the entries of row i are rowptr[i] to rowptr[i+1]-1
+	 * \param entrysize Number of values in one entry (eg. bs*bs for the blocks of a BSR matrix)
+	 * \param src Array to copy from, or null if dst is to be zeroed
+	 * \param dst Array to write
+	 */
+	template <typename T>
+	void first_touch_entries(const index *const rowptr, const int entrysize, const T *const src,
+	                         T *const dst) const
+	{
+#pragma omp parallel default(shared)
+		for_my_rows([rowptr,entrysize,src,dst](const index start, const index end) {
+			for(index i = rowptr[start]*entrysize; i < rowptr[end]*entrysize; i++)
+				dst[i] = src ? src[i] : T(0);
+		});
+	}
+
+	/// Resets the work counters of all domains
+	/** To be called by all threads of a parallel region (or outside of one) before every loop. It
+	 * synchronizes the threads, so all previous loops are complete on return.
+	 */
+	void reset() const
+	{
+#pragma omp barrier
+#pragma omp single
+		for(int d = 0; d < ndom; d++)
+			counters[d*cstride] = 0;
+	}
+
+	/// Executes nsweeps asynchronous forward sweeps over the rows
+	/** To be called by all threads of a parallel region after \ref reset. Chunks of rows of a domain
+	 * are handed out to threads of that domain in order, sweep after sweep, without synchronization
+	 * between sweeps.
+	 * \param body Callable taking the row index
+	 */
+	template <typename Body>
+	void forward(const int nsweeps, Body&& body) const
+	{
+		for_my_domains([this,nsweeps,&body](const int d) {
+			const index start = domptr[d];
+			const index nchunks = (domptr[d+1]-start + chunk-1)/chunk;
+			const index ntasks = nchunks*nsweeps;
+			for(index task = next_task(d); task < ntasks; task = next_task(d))
+			{
+				const index rstart = start + (task % nchunks)*chunk;
+				const index rend = std::min(rstart+chunk, domptr[d+1]);
+				for(index irow = rstart; irow < rend; irow++)
+					body(irow);
+			}
+		});
+	}
+
+	/// Executes nsweeps asynchronous backward sweeps over the rows \sa forward
+	template <typename Body>
+	void backward(const int nsweeps, Body&& body) const
+	{
+		for_my_domains([this,nsweeps,&body](const int d) {
+			const index start = domptr[d];
+			const index nchunks = (domptr[d+1]-start + chunk-1)/chunk;
+			const index ntasks = nchunks*nsweeps;
+			for(index task = next_task(d); task < ntasks; task = next_task(d))
+			{
+				const index rstart = start + (nchunks-1 - task % nchunks)*chunk;
+				const index rend = std::min(rstart+chunk, domptr[d+1]);
+				for(index irow = rend-1; irow >= rstart; irow--)
+					body(irow);
+			}
+		}, true);
+	}
+
+	/// Calls f(start,end) with the static share of rows of the calling thread in each of its domains
+	/** To be called by all threads of a parallel region; there is no synchronization. The rows
+	 * handed to a thread are the ones it initializes in \ref first_touch.
+	 */
+	template <typename F>
+	void for_my_rows(F&& f) const
+	{
+		int nthreads, tid;
+		thread_info(nthreads, tid);
+		for_my_domains([&](const int d) {
+			int rank = 0, count = 1;
+			if(nthreads >= ndom) {
+				// threads t such that floor(t ndom / nthreads) = d
+				const int tfirst = static_cast<int>((static_cast<long>(d)*nthreads + ndom-1)/ndom);
+				const int tlast = static_cast<int>((static_cast<long>(d+1)*nthreads + ndom-1)/ndom);
+				rank = tid - tfirst;
+				count = tlast - tfirst;
+			}
+			const index nrows = domptr[d+1]-domptr[d];
+			f(domptr[d] + static_cast<index>(static_cast<long>(nrows)*rank/count),
+			  domptr[d] + static_cast<index>(static_cast<long>(nrows)*(rank+1)/count));
+		});
+	}
+
+protected:
+	int ndom;                            ///< Number of domains
+	int chunk;                           ///< Number of rows in a dynamically assigned chunk
+	std::vector<index> domptr;           ///< First row of each domain, and the number of rows
+	/// Next task of each domain, one per cache line
+	mutable std::vector<index> counters;
+
+	/// Distance between counters of successive domains, so that they are on separate cache lines
+	static constexpr int cstride = CACHE_LINE_LEN/sizeof(index);
+
+	/// Number of threads in the current team and the number of the calling thread
+	static void thread_info(int& nthreads, int& tid)
+	{
+#ifdef _OPENMP
+		nthreads = omp_get_num_threads();
+		tid = omp_get_thread_num();
+#else
+		nthreads = 1;
+		tid = 0;
+#endif
+	}
+
+	/// Claims the next task of a domain
+	index next_task(const int d) const
+	{
+		index task;
+#pragma omp atomic capture
+		task = counters[d*cstride]++;
+		return task;
+	}
+
+	/// Calls f(d) for each domain d handled by the calling thread
+	/** \param reverse Whether to go through the domains in decreasing order, if the thread handles
+	 *   more than one domain
+	 */
+	template <typename F>
+	void for_my_domains(F&& f, const bool reverse = false) const
+	{
+		int nthreads, tid;
+		thread_info(nthreads, tid);
+		if(nthreads >= ndom)
+			f(static_cast<int>(static_cast<long>(tid)*ndom/nthreads));
+		else if(!reverse)
+			for(int d = tid; d < ndom; d += nthreads)
+				f(d);
+		else
+			for(int d = tid + (ndom-1-tid)/nthreads*nthreads; d >= 0; d -= nthreads)
+				f(d);
+	}
+};
+
+/// Copies a sparse-row matrix into storage first touched by the threads owning the rows
+/** This is meant for matrices whose arrays are owned by some other library, and were most likely
+ * allocated and written by a single thread.
+ * \param[in] mat The matrix to copy
+ * \param[in] bs Block size of the matrix
+ * \param[in] sched The partition of the rows of mat among NUMA domains
+ * \param[out] copy The copy; any previous storage is released
+ */
+template <typename scalar, typename index>
+void copy_matrix_to_domains(const CRawBSRMatrix<scalar,index>& mat, const int bs,
+                            const DomainSchedule<index>& sched,
+                            SRMatrixStorage<scalar,index>& copy)
+{
+	const index nnzb = mat.browptr[mat.nbrows];
+	copy.nbrows = mat.nbrows;
+	copy.nnzb = nnzb;
+	copy.nbstored = nnzb;
+	copy.browptr.resize(mat.nbrows+1);
+	copy.bcolind.resize(nnzb);
+	copy.vals.resize(nnzb*bs*bs);
+	copy.diagind.resize(mat.nbrows);
+
+	index *const brptr = &copy.browptr[0];
+	index *const dind = &copy.diagind[0];
+	sched.first_touch(brptr, 1, index(0));
+	sched.first_touch(dind, 1, index(0));
+	for(index i = 0; i < mat.nbrows; i++) {
+		brptr[i] = mat.browptr[i];
+		dind[i] = mat.diagind[i];
+	}
+	brptr[mat.nbrows] = nnzb;
+
+	sched.first_touch_entries(brptr, 1, mat.bcolind, &copy.bcolind[0]);
+	sched.first_touch_entries(brptr, bs*bs, mat.vals, &copy.vals[0]);
+	copy.browendptr.wrap(brptr+1, mat.nbrows);
+}
+
+}
+
+#endif
@@ -40,6 +40,18 @@ struct PrecInfo
 	const double& lower_min_diag_dom() const { return f_info[4]; }
 	/// Average diagonal dominance in lower factor, if any
 	const double& lower_avg_diag_dom() const  { return f_info[5]; }
+
+	/// Wall-clock time (seconds) spent in this setup computing structural data, such as the
+	///  positions needed by ILU factorization or level sets; this is always measured
+	double structure_walltime = 0;
+
+	/// Number of sweeps used to build the preconditioner, for those built by asynchronous sweeps;
+	///  this is always recorded
+	int build_sweeps = 0;
+
+	/// Number of (block-)rows whose factors were recomputed, for preconditioners that support
+	///  incremental refactorization; all rows unless only some were refactorized
+	int refactored_rows = 0;
 };
 
 /// Information about a preconditioner over a sequence of linear solves
@@ -30,6 +30,10 @@ public:
 	 */
 	void apply(const scalar *const b, scalar *const __restrict x) const;
 
+	/// Applies the preconditioner to one vector at a time \sa Preconditioner::apply_multi
+	void apply_multi(const int nvecs, const scalar *const x, scalar *const __restrict y) const
+	{ Preconditioner<scalar,index>::apply_multi(nvecs, x, y); }
+
 	/// Does nothing but throw an exception
 	void apply_relax(const scalar *const x, scalar *const __restrict y) const;
 
@@ -63,6 +67,10 @@ public:
 	 */
 	void apply(const scalar *const b, scalar *const __restrict x) const;
 
+	/// Applies the preconditioner to one vector at a time \sa Preconditioner::apply_multi
+	void apply_multi(const int nvecs, const scalar *const x, scalar *const __restrict y) const
+	{ Preconditioner<scalar,index>::apply_multi(nvecs, x, y); }
+
 	/// Does nothing but throw an exception
 	void apply_relax(const scalar *const x, scalar *const __restrict y) const;
 
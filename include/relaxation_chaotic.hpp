@@ -29,6 +29,10 @@ public:
 	/// Async. forward block-Gauss-Seidel preconditioner
 	void apply(const scalar *const b, scalar *const __restrict x) const;
 
+	/// Applies the preconditioner to one vector at a time \sa Preconditioner::apply_multi
+	void apply_multi(const int nvecs, const scalar *const x, scalar *const __restrict y) const
+	{ Preconditioner<scalar,index>::apply_multi(nvecs, x, y); }
+
 	/// Carry out chaotic block relaxation
 	/** For this solver, tolerance checking is never done irrespective of
 	 * \ref Precontitioner::setApplyParams.
@@ -70,6 +74,10 @@ public:
 	/// Async. forward Gauss-Seidel preconditioner
 	void apply(const scalar *const b, scalar *const __restrict x) const;
 
+	/// Applies the preconditioner to one vector at a time \sa Preconditioner::apply_multi
+	void apply_multi(const int nvecs, const scalar *const x, scalar *const __restrict y) const
+	{ Preconditioner<scalar,index>::apply_multi(nvecs, x, y); }
+
 	/// Carry out chaotic relaxation
 	/** For this solver, tolerance checking is never done irrespective of
 	 * \ref Precontitioner::setApplyParams.
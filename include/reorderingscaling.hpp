@@ -20,8 +20,11 @@
 #ifndef BLASTED_REORDERING_SCALING_H
 #define BLASTED_REORDERING_SCALING_H
 
+#include <string>
 #include <vector>
+#include <stdexcept>
 #include "srmatrixdefs.hpp"
+#include "levelschedule.hpp"
 
 namespace blasted {
 
@@ -132,6 +135,143 @@ protected:
 	std::vector<scalar> colscale;
 };
 
+/// Symmetric orderings of the (block-)rows that are computed natively from the block pattern
+enum GraphOrdering {
+	NATURAL_ORDERING,            ///< The original ordering
+	RCM_ORDERING,                ///< Reverse Cuthill-McKee \sa computeRCMOrdering
+	ND_ORDERING                  ///< Nested dissection \sa computeNestedDissectionOrdering
+};
+
+/// Converts a string into a graph ordering enum
+inline GraphOrdering getGraphOrderingFromString(const std::string ordering) {
+	if(ordering == "natural" || ordering == "none")
+		return NATURAL_ORDERING;
+	else if(ordering == "rcm")
+		return RCM_ORDERING;
+	else if(ordering == "nd")
+		return ND_ORDERING;
+	else
+		throw std::invalid_argument("Graph ordering not recognized!");
+}
+
+/// Computes the reverse Cuthill-McKee ordering of the (block-)rows of a matrix
+/** As for colorings, rows are coupled if there is a non-zero (block) in either of the positions
+ * (i,j) and (j,i). Each connected component is numbered breadth-first from a pseudo-peripheral row,
+ * the unnumbered neighbors of a row being taken in increasing order of degree, and the resulting
+ * order is reversed. This reduces the bandwidth and profile of the matrix, so that rows close in
+ * the ordering touch nearby parts of the vectors.
+ * \return The permutation: row i of the reordered matrix is row ord[i] of the original matrix
+ */
+template <typename scalar, typename index>
+std::vector<index> computeRCMOrdering(const CRawBSRMatrix<scalar,index>& mat);
+
+/// Computes a nested dissection ordering of the (block-)rows of a matrix
+/** The graph is recursively bisected by a level of a breadth-first level structure rooted at a
+ * pseudo-peripheral row, choosing the level that splits the rows most evenly. The two halves are
+ * numbered first, each recursively, followed by the separator. Disconnected parts are dissected
+ * separately. Subgraphs of at most \p leaf_size rows are not dissected further but numbered in
+ * their original relative order. The result keeps most couplings within small, contiguous sets of
+ * rows.
+ * \param mat The matrix whose block pattern is ordered
+ * \param leaf_size Size of subgraphs below which dissection stops
+ * \return The permutation: row i of the reordered matrix is row ord[i] of the original matrix
+ */
+template <typename scalar, typename index>
+std::vector<index> computeNestedDissectionOrdering(const CRawBSRMatrix<scalar,index>& mat,
+                                                   const index leaf_size);
+
+/// Builds the pattern of a matrix symmetrically reordered by a permutation of its (block-)rows
+/** Within a row, the non-zeros remain sorted by column. The diagonal block is located in each row.
+ * \param[in] ord The new ordering: row i of the reordered matrix is row ord[i] of the original
+ * \param[out] rmat The reordered matrix, whose values are allocated but not set
+ * \param[out] origloc For each non-zero (block) of the reordered matrix, its location in the
+ *   original matrix
+ */
+template <typename scalar, typename index>
+void getReorderedPattern(const CRawBSRMatrix<scalar,index>& mat, const int bs,
+                         const std::vector<index>& ord, SRMatrixStorage<scalar,index>& rmat,
+                         std::vector<index>& origloc);
+
+/// Reverse Cuthill-McKee symmetric reordering \sa computeRCMOrdering
+template <typename scalar, typename index, int bs>
+class RCMReordering : public Reordering<scalar,index,bs>
+{
+public:
+	RCMReordering();
+
+	/// Computes the ordering from the block pattern of the matrix
+	void compute(const CRawBSRMatrix<scalar,index>& mat);
+};
+
+/// Nested dissection symmetric reordering \sa computeNestedDissectionOrdering
+template <typename scalar, typename index, int bs>
+class NestedDissectionReordering : public Reordering<scalar,index,bs>
+{
+public:
+	/// \param leaf_size Size of subgraphs below which dissection stops
+	NestedDissectionReordering(const index leaf_size);
+
+	/// Computes the ordering from the block pattern of the matrix
+	void compute(const CRawBSRMatrix<scalar,index>& mat);
+
+protected:
+	const index leafsize;            ///< Size of subgraphs below which dissection stops
+};
+
+/// Computes a greedy coloring of the (block-)rows of a matrix
+/** Rows are coupled if there is a non-zero (block) in either of the positions (i,j) and (j,i), so
+ * the pattern need not be symmetric. The rows are visited in their natural order and each is given
+ * a color not used by any row coupled to it, so the result depends only on the non-zero pattern.
+ * Since no two rows of the same color are coupled, all rows of a color can be processed in
+ * parallel by sweeps that go through the colors one after another.
+ *
+ * \param mat The matrix whose block pattern is colored
+ * \param distance 1 to give different colors to coupled rows, 2 to also give different colors to
+ *   rows coupled to a common row
+ * \param balanced If false, each row gets the lowest admissible color. If true, each row gets the
+ *   admissible color used by the fewest rows so far, so that the colors have similar sizes; a new
+ *   color is opened only when no existing color is admissible.
+ * \return The rows of each color, as level sets \sa LevelSets
+ */
+template <typename scalar, typename index>
+LevelSets<index> computeColoring(const CRawBSRMatrix<scalar,index>& mat, const int distance,
+                                 const bool balanced);
+
+/// Symmetric reordering that numbers the (block-)rows color by color \sa computeColoring
+/** Within each color, rows keep their relative order. In the reordered matrix, the rows of color
+ * c are rows colorPointers()[c] to colorPointers()[c+1]-1, and the diagonal block of every color
+ * is block-diagonal.
+ */
+template <typename scalar, typename index, int bs>
+class MulticolorReordering : public Reordering<scalar,index,bs>
+{
+public:
+	/** \param distance Distance of the coloring, 1 or 2
+	 * \param balanced Whether to balance the sizes of the colors
+	 */
+	MulticolorReordering(const int distance, const bool balanced);
+
+	/// Colours the rows of the matrix and sets the ordering
+	void compute(const CRawBSRMatrix<scalar,index>& mat);
+
+	/// Sets the ordering from a coloring computed earlier
+	void setColoring(const LevelSets<index>& colors);
+
+	/// Start of each color in the reordered matrix, and the number of rows
+	const std::vector<index>& colorPointers() const { return colorptr; }
+
+	/// Number of colors
+	index numColors() const { return static_cast<index>(colorptr.size())-1; }
+
+protected:
+	using Reordering<scalar,index,bs>::rp;
+	using Reordering<scalar,index,bs>::cp;
+
+	const int dist;                  ///< Coloring distance
+	const bool balance;              ///< Whether color sizes are balanced
+	std::vector<index> colorptr;     ///< Start of each color in the reordered matrix
+};
+
 #ifdef HAVE_MC64
 
 class MC64 : public ReorderingScaling<double,int,1>
@@ -0,0 +1,118 @@
+/** \file sellmatrixdefs.hpp
+ * \brief Sliced ELLPACK (SELL-C-sigma) storage for scalar sparse matrices
+ * \author Aditya Kashi
+ */
+
+#ifndef BLASTED_SELLMATRIXDEFS_H
+#define BLASTED_SELLMATRIXDEFS_H
+
+#include <algorithm>
+#include "srmatrixdefs.hpp"
+
+namespace blasted {
+
+/// Which part of a sparse-row matrix is to be stored in a SELL-C-sigma matrix
+enum SELLPart {
+	SELL_FULL,              ///< All the non-zeros
+	SELL_STRICT_LOWER,      ///< Non-zeros to the left of the diagonal only
+	SELL_STRICT_UPPER       ///< Non-zeros to the right of the diagonal only
+};
+
+/// Sliced ELLPACK storage of a scalar square sparse matrix \cite sell:kreutzer_sellcsigma
+/** Rows are grouped into chunks of C consecutive rows, and each chunk is padded to the length of its
+ * longest row. Within a chunk, entries are stored column-wise - the j-th entries of all C rows of
+ * the chunk are contiguous. This lets SIMD kernels work on C rows at once with unit-stride loads of
+ * the values and column indices.
+ *
+ * Before chunking, the rows inside each window of sigma consecutive rows are sorted by decreasing
+ * length, to reduce the padding. Rows never move out of their window, so the locality of the
+ * original ordering is mostly retained. The sorted row positions are mapped to original row indices
+ * by \ref rowperm; the column indices are not permuted, so vectors are always in the original
+ * ordering.
+ *
+ * Padding entries have a value of zero. Their column index is that of the row they pad, or zero for
+ * the lanes of the last chunk that do not correspond to any row.
+ */
+template <typename scalar, typename index>
+struct SELLMatrixStorage
+{
+	static_assert(std::numeric_limits<index>::is_integer, "Integer index type required!");
+	static_assert(std::numeric_limits<index>::is_signed, "Signed index type required!");
+
+	ArrayView<index> chunkptr;    ///< Start of each chunk in \ref colind and \ref vals (nchunks+1)
+	ArrayView<index> chunklen;    ///< Padded row length of each chunk
+	ArrayView<index> colind;      ///< Column indices, stored column-wise within each chunk
+	ArrayView<scalar> vals;       ///< Non-zero values, stored column-wise within each chunk
+	/// Location in the source CSR values array of each entry of \ref vals; -1 for padding
+	ArrayView<index> srcpos;
+	/// Original row index of each sorted row position; -1 for lanes past the last row
+	ArrayView<index> rowperm;
+	index nrows;                  ///< Number of rows of the matrix
+	index nchunks;                ///< Number of chunks
+	int C;                        ///< Chunk height
+	int sigma;                    ///< Sorting scope
+	SELLPart part;                ///< The part of the original matrix that is stored
+
+	/// Sets an empty matrix
+	SELLMatrixStorage()
+		: nrows{0}, nchunks{0}, C{0}, sigma{0}, part{SELL_FULL}
+	{ }
+
+	/// Number of valid rows in a chunk (less than C only for the last chunk)
+	int chunk_rows(const index ichunk) const {
+		return static_cast<int>(std::min(static_cast<index>(C), nrows - ichunk*C));
+	}
+};
+
+/// An immutable non-owning view of a \ref SELLMatrixStorage, for use in kernels
+template <typename scalar, typename index>
+struct CRawSELLMatrix
+{
+	const index *chunkptr;        ///< Start of each chunk in \ref colind and \ref vals
+	const index *chunklen;        ///< Padded row length of each chunk
+	const index *colind;          ///< Column indices, stored column-wise within each chunk
+	const scalar *vals;           ///< Non-zero values, stored column-wise within each chunk
+	const index *rowperm;         ///< Original row index of each sorted row position
+	index nrows;                  ///< Number of rows of the matrix
+	index nchunks;                ///< Number of chunks
+	int C;                        ///< Chunk height
+
+	/// Sets an empty matrix
+	CRawSELLMatrix()
+		: chunkptr{nullptr}, chunklen{nullptr}, colind{nullptr}, vals{nullptr}, rowperm{nullptr},
+		  nrows{0}, nchunks{0}, C{0}
+	{ }
+
+	/// Number of valid rows in a chunk (less than C only for the last chunk)
+	int chunk_rows(const index ichunk) const {
+		return static_cast<int>(std::min(static_cast<index>(C), nrows - ichunk*C));
+	}
+};
+
+/// Wraps the arrays of a SELL matrix in a raw view
+template <typename scalar, typename index>
+CRawSELLMatrix<scalar,index> createRawView(const SELLMatrixStorage<scalar,index>& smat);
+
+/// Converts (part of) a CSR matrix into SELL-C-sigma storage
+/** \param[in] mat The scalar sparse-row matrix; column indices in each row must be sorted if a
+ *   strictly triangular part is requested, and diagonal locations must be available
+ * \param[in] C The chunk height - usually the SIMD width for the scalar type
+ * \param[in] sigma The sorting scope; it must be a multiple of C. A value of 0 or 1 disables sorting.
+ * \param[in] part The part of the matrix to convert
+ * \param[out] smat The SELL matrix; any previous storage is freed
+ *
+ * Throws std::invalid_argument if C or sigma is invalid.
+ */
+template <typename scalar, typename index>
+void convert_SR_to_SELL(const CRawBSRMatrix<scalar,index>& mat, const int C, const int sigma,
+                        const SELLPart part, SELLMatrixStorage<scalar,index>& smat);
+
+/// Re-gathers the values of a SELL matrix from a CSR matrix with the same non-zero structure
+/** Useful when the numerical values of the source matrix change but its structure does not.
+ */
+template <typename scalar, typename index>
+void update_SELL_values(const CRawBSRMatrix<scalar,index>& mat, SELLMatrixStorage<scalar,index>& smat);
+
+}
+
+#endif
@@ -12,6 +12,7 @@
 #include "solvertypes.h"
 #include "async_initialization_decl.hpp"
 #include "solverops_base.hpp"
+#include "reorderingscaling.hpp"
 
 namespace blasted {
 
@@ -36,6 +37,22 @@ const std::string cscbgsstr = "cscbgs";
 const std::string levelsgsstr = "level_sgs";
 /// Asynchronous factorized ILU0 with level-scheduled application
 const std::string asynclevelilustr = "async_level_ilu0";
+/// ILU(k) with asynchronous factorization and application
+const std::string ilukstr = "iluk";
+/// ILU(k) with asynchronous factorization and level-scheduled application
+const std::string asynclevelilukstr = "async_level_iluk";
+/// Threshold ILU with a dynamically chosen pattern (scalar only)
+const std::string parilutstr = "parilut";
+/// Multicolor SGS
+const std::string mcsgsstr = "mc_sgs";
+/// Exact ILU(0) of the multicolor-reordered matrix
+const std::string mcilu0str = "mc_ilu0";
+/// Left sparse approximate inverse with the pattern of the matrix
+const std::string saistr = "sai";
+/// SGS applied through sparse approximate inverses of its triangular factors
+const std::string sgssaistr = "sgs_sai";
+/// Jacobi-scaled Chebyshev iteration
+const std::string chebyshevstr = "chebyshev";
 /** @} */
 
 /// Basic settings needed for most iterations
@@ -48,6 +65,33 @@ struct SolverSettings {
 	 */
 	bool relax;
 	int thread_chunk_size;                ///< Number of work-items (iterations) in each thread chunk
+	/// Chunk height for storing scalar (bs = 1) matrices in SELL-C-sigma format - 4 or 8
+	/** Any other value means that the CSR matrix is used directly. Only used for Jacobi and SGS,
+	 * and cannot be combined with \ref float_factors, \ref compressed_colind, sweep tiling or
+	 * \ref numa_domains; the factory throws std::invalid_argument for such combinations.
+	 */
+	int sell_chunk_height = 0;
+	/// Sorting scope (sigma) of SELL-C-sigma storage; a multiple of \ref sell_chunk_height, or 1
+	int sell_sort_scope = 1;
+	/// Use 16-bit compressed column indices in the sweeps of asynchronous SGS and ILU(0)
+	/** Reduces the index bytes streamed per sweep; see \ref CompressedColumnIndex.
+	 */
+	bool compressed_colind = false;
+	/// Store the data read when applying Jacobi, SGS and ILU(0) in single precision
+	/** The inverted diagonal blocks and ILU factors are copied to float after each computation;
+	 * arithmetic is still done in double precision. Relaxation is not affected.
+	 */
+	bool float_factors = false;
+	/// When \ref float_factors is set, also read the matrix from a single-precision copy in SGS
+	bool float_matrix = false;
+	/// Number of NUMA domains (sockets) over which to distribute preconditioner data and sweeps
+	/** Values less than 2 disable NUMA-aware placement; see \ref DomainSchedule.
+	 */
+	int numa_domains = 1;
+	/// Symmetric reordering of the block-rows under which the preconditioner is built and applied
+	/** Available for every preconditioner type \sa ReorderedPreconditioner
+	 */
+	GraphOrdering reordering = NATURAL_ORDERING;
 
 	/// Default destructor
 	virtual ~SolverSettings() = default;
@@ -61,6 +105,48 @@ struct AsyncSolverSettings : public SolverSettings {
 	FactInit fact_inittype;               ///< Initialization type for asynchronous factorization
 	ApplyInit apply_inittype;             ///< Initialization type for asynchronous triangular solves
 	bool compute_precinfo;                ///< Set to true if extra information is needed
+	/// Relative reduction of the estimated ILU remainder at which build sweeps stop
+	/** Zero (the default) means exactly \ref nbuildsweeps asynchronous sweeps are carried out;
+	 * otherwise \ref nbuildsweeps is the maximum. \sa AsyncILU0_SRPreconditioner::setBuildTolerance
+	 */
+	double build_tol = 0;
+	/// Level of fill for ILU(k) preconditioners
+	int fill_level = 1;
+	/// Maximum number of non-zeros in a row of ParILUT factors, relative to that row of the matrix
+	/** The number of add-drop steps is given by \ref nbuildsweeps.
+	 */
+	double ilut_fill_factor = 2;
+	/// Relative change of a block-row's values above which block ILU(0) refactorizes it
+	/** Negative (the default) means every compute refactorizes all rows. The factory throws
+	 * std::invalid_argument if this is non-negative for a scalar (bs = 1) matrix.
+	 * \sa AsyncBlockILU0_SRPreconditioner::setIncrementalRefactorization
+	 */
+	double refactor_row_tol = -1;
+	/// Levels of rows depending on changed rows that are refactorized along with them; negative for all
+	int refactor_dep_levels = 1;
+	/// Whether ILU(0)-type preconditioners compute exact factors by a synchronization-free pass
+	/** \sa AsyncILU0_SRPreconditioner::setSyncFreeFactorization */
+	bool syncfree_factor = false;
+	/// How ILU(0)-type preconditioners carry out their triangular solves
+	/** \sa AsyncILU0_SRPreconditioner::setApplyType */
+	ApplyType apply_type = APPLY_ASYNC;
+	/// Cache size in bytes for block-asynchronous sweeps over tiles of rows; 0 disables tiling
+	/** Used by SGS preconditioning and relaxation and by the ILU(0)-type build sweeps.
+	 * \sa AsyncSGS_SRPreconditioner::setSweepTiling
+	 */
+	size_t tile_cache_bytes = 0;
+	/// Number of local sweeps over a tile each time it is visited
+	int tile_inner_sweeps = 2;
+	/// Distance of the coloring used by multicolor preconditioners, 1 or 2 \sa computeColoring
+	int color_distance = 1;
+	/// Whether multicolor preconditioners balance the sizes of the colors
+	bool balanced_colors = false;
+	/// Whether SAI-type preconditioners compute incomplete SAIs instead of least-squares SAIs
+	bool incomplete_sai = false;
+	/// Number of power iterations estimating the largest eigenvalue for Chebyshev iterations
+	int cheb_eig_iters = 10;
+	/// Ratio of the lower end of the Chebyshev interval to the estimated upper end
+	double cheb_eig_ratio = 0.3;
 };
 
 template <typename scalar, typename index>
@@ -105,6 +191,12 @@ private:
 	SRPreconditioner<scalar,index> *
 	create_srpreconditioner_of_type(SRMatrixStorage<const scalar, const index>&& prec_matrix,
 	                                const AsyncSolverSettings& opts) const;
+
+	/// Creates scalar preconditioners that use SELL-C-sigma storage with chunk height C
+	template <int C>
+	SRPreconditioner<scalar,index> *
+	create_sell_preconditioner(SRMatrixStorage<const scalar, const index>&& prec_matrix,
+	                           const AsyncSolverSettings& opts) const;
 };
 
 }
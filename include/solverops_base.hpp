@@ -11,6 +11,7 @@
 #include "linearoperator.hpp"
 #include "srmatrixdefs.hpp"
 #include "preconditioner_diagnostics.hpp"
+#include "numa_schedule.hpp"
 
 namespace blasted {
 
@@ -48,6 +49,14 @@ public:
 	/// To apply the preconditioner
 	virtual void apply(const scalar *const x, scalar *const __restrict y) const = 0;
 
+	/// To apply the preconditioner to several vectors at once
+	/** The multivectors are stored row-interleaved: entry v of row i is at position i*nvecs+v.
+	 * This default implementation applies the preconditioner to one vector at a time. Subclasses
+	 * override it to process all the vectors with each pass over the matrix.
+	 * \param nvecs Number of vectors
+	 */
+	virtual void apply_multi(const int nvecs, const scalar *const x, scalar *const __restrict y) const;
+
 	/// To apply relaxation
 	virtual void apply_relax(const scalar *const x, scalar *const __restrict y) const = 0;
 
@@ -70,11 +79,23 @@ class SRPreconditioner : public Preconditioner<scalar,index>
 public:
 	SRPreconditioner(SRMatrixStorage<const scalar, const index>&& matrix);
 
+	/// Distribute the data of the preconditioner over NUMA domains \sa DomainSchedule
+	/** Arrays allocated by the preconditioner are then first touched by the threads of the domain
+	 * owning the corresponding rows, and supporting operators schedule their sweeps statically
+	 * across domains and dynamically within them. Must be called before the first \ref compute.
+	 * \param ndomains Number of NUMA domains (usually sockets); less than 2 disables this
+	 * \param chunksize Number of rows assigned to a thread at a time within a domain
+	 */
+	void setNUMADomains(const int ndomains, const int chunksize)
+	{ numasched.setup(mat, ndomains, chunksize); }
+
 protected:
 	/// Matrix view
 	SRMatrixStorage<const scalar, const index> pmat;
 	/// Matrix wrapper
 	CRawBSRMatrix<scalar,index> mat;
+	/// Partition of the rows among NUMA domains; inactive by default
+	DomainSchedule<index> numasched;
 };
 
 /// Identity operator as preconditioner
@@ -96,6 +117,9 @@ public:
 	/// Does nothing but copy the input argument into the output argument
 	void apply(const scalar *const x, scalar *const __restrict y) const;
 
+	/// Does nothing but copy the input multivector into the output multivector
+	void apply_multi(const int nvecs, const scalar *const x, scalar *const __restrict y) const;
+
 	/// Does nothing
 	void apply_relax(const scalar *const x, scalar *const __restrict y) const;
 
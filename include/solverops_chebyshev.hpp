@@ -0,0 +1,94 @@
+/** \file
+ * \brief Chebyshev polynomial preconditioning and relaxation
+ * \author Aditya Kashi
+ */
+
+#ifndef BLASTED_SOLVEROPS_CHEBYSHEV_H
+#define BLASTED_SOLVEROPS_CHEBYSHEV_H
+
+#include <type_traits>
+#include "solverops_jacobi.hpp"
+
+namespace blasted {
+
+/// Selects the (point-block) Jacobi operator for the block size
+/** The type is \ref BJacobiSRPreconditioner, or \ref JacobiSRPreconditioner for a block size of 1.
+ */
+template <typename scalar, typename index, int bs, StorageOptions stor>
+struct PointBlockJacobi {
+	typedef typename std::conditional<bs == 1, JacobiSRPreconditioner<scalar,index>,
+	                                  BJacobiSRPreconditioner<scalar,index,bs,stor>>::type type;
+};
+
+/// Point-block Jacobi-scaled Chebyshev iteration as preconditioner or relaxation
+/** The Chebyshev polynomial of D^{-1} A, D being the diagonal (blocks) of A, is built for an interval
+ * [lmin, lmax] assumed to contain the eigenvalues of D^{-1} A. The upper bound is estimated by
+ * power iterations each time the operator is computed; the lower bound is a fixed fraction of it.
+ * The iterations need only sparse matrix-vector products, Jacobi scaling and vector updates, so
+ * they have no triangular dependencies and their application does not depend on the order in
+ * which the rows are processed.
+ *
+ * As a preconditioner, a fixed number of Chebyshev steps (the degree of the polynomial) are
+ * applied starting from zero; as relaxation, the number of steps is given by the apply parameters,
+ * starting from the input vector.
+ */
+template <typename scalar, typename index, int bs, StorageOptions stor>
+class ChebyshevSRPreconditioner : public PointBlockJacobi<scalar,index,bs,stor>::type
+{
+public:
+	/** \param degree Number of Chebyshev steps when used as preconditioner
+	 * \param eig_iters Number of power iterations for estimating the largest eigenvalue
+	 * \param eig_ratio Ratio of the lower bound of the interval to the upper one; in (0,1)
+	 */
+	ChebyshevSRPreconditioner(SRMatrixStorage<const scalar, const index>&& matrix, const int degree,
+	                          const int eig_iters, const scalar eig_ratio);
+
+	~ChebyshevSRPreconditioner();
+
+	bool relaxationAvailable() const { return true; }
+
+	/// Inverts the diagonal (blocks) and estimates the bounds of the spectrum of D^{-1} A
+	PrecInfo compute();
+
+	/// Applies the Chebyshev polynomial of D^{-1} A to r
+	void apply(const scalar *const r, scalar *const __restrict z) const;
+
+	/// Applies the preconditioner to one vector at a time \sa Preconditioner::apply_multi
+	void apply_multi(const int nvecs, const scalar *const x, scalar *const __restrict y) const
+	{ Preconditioner<scalar,index>::apply_multi(nvecs, x, y); }
+
+	/// Carries out Chebyshev iterations, as many as the max iterations in the apply parameters
+	void apply_relax(const scalar *const b, scalar *const __restrict x) const;
+
+	/// Returns the estimated largest eigenvalue of D^{-1} A, with the safety factor applied
+	scalar maxEigenvalueBound() const { return lmax; }
+
+	/// Returns the lower end of the interval of the Chebyshev polynomial
+	scalar minEigenvalueBound() const { return lmin; }
+
+protected:
+	using Jacobi = typename PointBlockJacobi<scalar,index,bs,stor>::type;
+	using SRPreconditioner<scalar,index>::mat;
+	using Preconditioner<scalar,index>::solveparams;
+
+	const int chebdegree;           ///< Number of Chebyshev steps for preconditioning
+	const int eigiters;             ///< Number of power iterations for the eigenvalue estimate
+	const scalar eigratio;          ///< Ratio of the lower bound of the spectrum to the upper one
+
+	scalar lmin;                    ///< Lower end of the interval of the polynomial
+	scalar lmax;                    ///< Upper end of the interval of the polynomial
+
+	/// Work vectors: residual, scaled residual and update, each of the length of the operator
+	scalar *work;
+
+	/// Carries out Chebyshev steps for A x = b
+	/** \param zeroguess If true, x is taken to be zero on input and is not read
+	 * \param ctol Whether to check the norm of the updates for convergence, as in relaxation
+	 */
+	void iterate(const scalar *const b, scalar *const __restrict x, const int nsteps,
+	             const bool zeroguess, const bool ctol) const;
+};
+
+}
+
+#endif
@@ -10,9 +10,16 @@
 #include "reorderingscaling.hpp"
 #include "async_initialization_decl.hpp"
 #include "ilu_pattern.hpp"
+#include "structural_cache.hpp"
+#include "cimatrixdefs.hpp"
+#include "syncfree_schedule.hpp"
+#include "async_sweeps.hpp"
 
 namespace blasted {
 
+template <typename scalar, typename index, int bs, StorageOptions stor>
+class ILUISAI;
+
 /// Asynchronous block-ILU(0) preconditioner for sparse-row matrices
 /** Finds \f$ \tilde{L} \f$ and \f$ \tilde{U} \f$ such that
  * \f[ \tilde{L} \tilde{U} = A \f]
@@ -35,16 +42,80 @@ public:
 	 * \param apply_inittype Type of initialization to use for application
 	 * \param threadedfactor If false, the preconditioner is computed sequentially
 	 * \param threadedapply If false, the preconditioner is applied sequentially
+	 * \param compressed_colind Whether the application should use 16-bit compressed column indices
+	 *   \sa CompressedColumnIndex
 	 */
 	AsyncBlockILU0_SRPreconditioner(SRMatrixStorage<const scalar, const index>&& matrix,
 	                                const int nbuildsweeps, const int napplysweeps,
 	                                const bool use_scaling, const int thread_chunk_size,
 	                                const FactInit fact_inittype, const ApplyInit apply_inittype,
 	                                const bool threadedfactor=true, const bool threadedapply=true,
-	                                const bool compute_remainder = false);
+	                                const bool compute_remainder = false,
+	                                const bool compressed_colind = false);
 
 	~AsyncBlockILU0_SRPreconditioner();
 
+	/// Sets a tolerance for stopping the build sweeps adaptively
+	/** If positive, the sweeps are synchronized and stop once the ILU remainder, estimated during
+	 * each sweep, is reduced by this factor relative to the first sweep; the number of build sweeps
+	 * then only caps the number of sweeps. The sweeps used are reported in \ref PrecInfo.
+	 * If zero (the default), the fixed number of build sweeps is carried out asynchronously.
+	 */
+	void setBuildTolerance(const scalar tol) { buildtol = tol; }
+
+	/// Enables recomputing only the factors of block-rows affected by changes in the matrix values
+	/** After the first computation, \ref compute compares the values of the matrix with those last
+	 * factorized, and carries out the build sweeps only over the block-rows that changed
+	 * significantly and the rows depending on them \sa block_ilu0_changed_rows. These sweeps start
+	 * from the previous factors. The number of refactorized rows is reported in \ref PrecInfo;
+	 * if the remainder is to be computed, it is computed over the whole matrix before and after
+	 * the refactorization, along with the diagonal dominance of the factors.
+	 * \param rowtol Relative change in the values of a block-row above which it is refactorized;
+	 *   negative (the default) disables incremental refactorization
+	 * \param deplevels Number of levels of dependent block-rows to refactorize along with them;
+	 *   negative to refactorize all rows depending on them, directly or indirectly
+	 *
+	 * With a finite number of levels this is an approximation: rows depending on a changed row
+	 * more indirectly keep factors computed from the old values, and since their own values did
+	 * not change they are not refactorized later either. The error can thus accumulate over
+	 * many computes; a negative number of levels avoids it, at the cost of more rows.
+	 */
+	void setIncrementalRefactorization(const scalar rowtol, const int deplevels)
+	{
+		refactortol = rowtol;
+		refactorlevels = deplevels;
+	}
+
+	/// Selects synchronization-free exact factorization instead of the asynchronous sweeps
+	/** Each block-row is factorized once, as soon as the rows in the columns of its lower
+	 * triangular part are done, so the exact block-ILU(0) factors are computed in parallel without
+	 * barriers. The number of build sweeps and the build tolerance are then unused. With
+	 * incremental refactorization, the refactorized rows are factorized in the same way.
+	 */
+	void setSyncFreeFactorization(const bool syncfree) { syncfreefactor = syncfree; }
+
+	/// Selects how the triangular solves are carried out when applying the preconditioner
+	/** With \ref APPLY_SYNCFREE, the solves are exact and each block-row waits only for the rows
+	 * it depends on; the number of apply sweeps and the apply initialization are then unused.
+	 * Application to several vectors at once uses the same exact solves.
+	 * With \ref APPLY_ISAI, incomplete sparse approximate inverses of the factors are computed
+	 * after factorization, and are applied instead of the triangular solves \sa ILUISAI
+	 */
+	void setApplyType(const ApplyType type) { applytype = type; }
+
+	/// Enables block-asynchronous build sweeps over cache-sized tiles of block-rows \sa AsyncSweepEngine
+	/** The number of build sweeps then counts passes over all the tiles, each of which carries out
+	 * the inner sweeps. Not used for adaptive build sweeps \sa setBuildTolerance
+	 * \param cachebytes Amount of cache the data of a tile should fit in; 0 (the default) disables
+	 *   tiling
+	 * \param innersweeps Number of local sweeps over a tile each time it is visited
+	 */
+	void setSweepTiling(const size_t cachebytes, const int innersweeps)
+	{
+		tilecachebytes = cachebytes;
+		tiling.innersweeps = innersweeps;
+	}
+
 	/// Returns the number of rows of the operator
 	index dim() const { return mat.nbrows*bs; }
 
@@ -59,17 +130,22 @@ public:
 	/// Applies a block LU factorization L U z = r
 	void apply(const scalar *const x, scalar *const __restrict y) const;
 
+	/// Applies the block LU factorization to several row-interleaved vectors at once
+	void apply_multi(const int nvecs, const scalar *const x, scalar *const __restrict y) const;
+
 	/// Does nothing but throw an exception
 	void apply_relax(const scalar *const x, scalar *const __restrict y) const;
 
 protected:
 	using SRPreconditioner<scalar,index>::mat;
+	using SRPreconditioner<scalar,index>::numasched;
 
 	using Blk = Block_t<scalar,bs,stor>;
 	using Seg = Segment_t<scalar,bs>;
 
-	/// Precomputed positions in \ref iluvals to help with factorization
-	ILUPositions<index> plist;
+	/// Precomputed positions in \ref iluvals to help with factorization, shared among instances
+	///  having the same sparsity pattern
+	std::shared_ptr<const ILUPositions<index>> plist;
 
 	/// Storage for L and U factors
 	/** Use \ref bcolind and \ref browptr to access the storage,
@@ -83,16 +159,42 @@ protected:
 	/// Temporary storage for result of application of L
 	scalar *ytemp;
 
+	/// Temporary storage for the application of L to several vectors, grown on demand
+	mutable scalar *ymulti = nullptr;
+	mutable int nymultivecs = 0;                 ///< Number of vectors \ref ymulti can hold
+
 	const bool usescaling;                       ///< Whether to scale the matrix before ILU
 	const bool threadedfactor;         ///< True for thread-parallel ILU0 factorization
 	const bool threadedapply;          ///< True for thread-parallel LU application
 	const int nbuildsweeps;
 	const int napplysweeps;
+	scalar buildtol = 0;                         ///< Tolerance for adaptive build \sa setBuildTolerance
 	const int thread_chunk_size;
 	const FactInit factinittype;
 	const ApplyInit applyinittype;
 	const bool compute_remainder;
 
+	const bool usecompressedind;                 ///< Whether to use compressed column indices
+	CompressedColumnIndex<index> cind;           ///< Compressed column indices of \ref mat
+	CRawCompressedColumnIndex<index> rcind;      ///< View of \ref cind
+
+	/// Relative change of block-rows to refactorize \sa setIncrementalRefactorization
+	scalar refactortol = -1;
+	int refactorlevels = 1;                      ///< Levels of dependent rows to refactorize
+	/// (Scaled) values of the matrix at the last factorization of each block-row
+	scalar *snapshot = nullptr;
+	/// Inverses of the diagonal blocks of U, for incremental refactorization
+	scalar *pivinvs = nullptr;
+
+	bool syncfreefactor = false;                 ///< \sa setSyncFreeFactorization
+	ApplyType applytype = APPLY_ASYNC;           ///< \sa setApplyType
+	/// Row completion flags for sync-free factorization and application
+	std::unique_ptr<SyncFreeSchedule<index>> sfsched;
+	/// Approximate inverses of the factors for \ref APPLY_ISAI
+	std::unique_ptr<ILUISAI<scalar,index,bs,stor>> isai;
+	size_t tilecachebytes = 0;                   ///< Cache size for tiles \sa setSweepTiling
+	SweepTiling<index> tiling;                   ///< Tiles of the build sweeps, set up in compute
+
 	void setup_storage();
 };
 
@@ -109,16 +211,56 @@ public:
 	 * \param apply_inittype Type of initialization to use for application
 	 * \param threadedfactor If false, the preconditioner is computed sequentially
 	 * \param threadedapply If false, the preconditioner is applied sequentially
+	 * \param compressed_colind Whether the application should use 16-bit compressed column indices
+	 *   \sa CompressedColumnIndex
 	 */
 	AsyncILU0_SRPreconditioner(SRMatrixStorage<const scalar, const index>&& matrix,
 	                           const int nbuildsweeps, const int napplysweeps,
 	                           const bool use_scaling, const int thread_chunk_size,
 	                           const FactInit fact_inittype, const ApplyInit apply_inittype,
 	                           const bool compute_preconditioner_info,
-	                           const bool threadedfactor=true, const bool threadedapply=true);
+	                           const bool threadedfactor=true, const bool threadedapply=true,
+	                           const bool compressed_colind = false);
 
 	virtual ~AsyncILU0_SRPreconditioner();
 
+	/// Sets a tolerance for stopping the build sweeps adaptively
+	/** If positive, the sweeps are synchronized and stop once the ILU remainder, estimated during
+	 * each sweep, is reduced by this factor relative to the first sweep; the number of build sweeps
+	 * then only caps the number of sweeps. The sweeps used are reported in \ref PrecInfo.
+	 * If zero (the default), the fixed number of build sweeps is carried out asynchronously.
+	 */
+	void setBuildTolerance(const scalar tol) { buildtol = tol; }
+
+	/// Selects synchronization-free exact factorization instead of the asynchronous sweeps
+	/** Each row is factorized once, as soon as the rows in the columns of its lower triangular
+	 * part are done, so the exact ILU(0) factors are computed in parallel without barriers.
+	 * The number of build sweeps and the build tolerance are then unused.
+	 */
+	void setSyncFreeFactorization(const bool syncfree) { syncfreefactor = syncfree; }
+
+	/// Selects how the triangular solves are carried out when applying the preconditioner
+	/** With \ref APPLY_SYNCFREE, the solves are exact and each row waits only for the rows it
+	 * depends on; the number of apply sweeps and the apply initialization are then unused.
+	 * Application to several vectors at once uses the same exact solves.
+	 * With \ref APPLY_ISAI, incomplete sparse approximate inverses of the factors are computed
+	 * after factorization, and are applied instead of the triangular solves \sa ILUISAI
+	 */
+	void setApplyType(const ApplyType type) { applytype = type; }
+
+	/// Enables block-asynchronous build sweeps over cache-sized tiles of rows \sa AsyncSweepEngine
+	/** The number of build sweeps then counts passes over all the tiles, each of which carries out
+	 * the inner sweeps. Not used for adaptive build sweeps \sa setBuildTolerance
+	 * \param cachebytes Amount of cache the data of a tile should fit in; 0 (the default) disables
+	 *   tiling
+	 * \param innersweeps Number of local sweeps over a tile each time it is visited
+	 */
+	void setSweepTiling(const size_t cachebytes, const int innersweeps)
+	{
+		tilecachebytes = cachebytes;
+		tiling.innersweeps = innersweeps;
+	}
+
 	/// Returns the number of rows
 	index dim() const { return mat.nbrows; }
 
@@ -130,14 +272,19 @@ public:
 	/// To apply the preconditioner
 	void apply(const scalar *const x, scalar *const __restrict y) const;
 
+	/// To apply the preconditioner to several row-interleaved vectors at once
+	void apply_multi(const int nvecs, const scalar *const x, scalar *const __restrict y) const;
+
 	/// Does nothing but throw an exception
 	void apply_relax(const scalar *const x, scalar *const __restrict y) const;
 
 protected:
 	using SRPreconditioner<scalar,index>::mat;
+	using SRPreconditioner<scalar,index>::numasched;
 
-	/// Precomputed positions in \ref iluvals to help with factorization
-	ILUPositions<index> plist;
+	/// Precomputed positions in \ref iluvals to help with factorization, shared among instances
+	///  having the same sparsity pattern
+	std::shared_ptr<const ILUPositions<index>> plist;
 
 	/// Storage for L and U factors
 	scalar *iluvals;
@@ -148,11 +295,16 @@ protected:
 	/// Temporary storage for result of application of L
 	scalar *ytemp;
 
+	/// Temporary storage for the application of L to several vectors, grown on demand
+	mutable scalar *ymulti = nullptr;
+	mutable int nymultivecs = 0;                 ///< Number of vectors \ref ymulti can hold
+
 	const bool usescaling;                       ///< Whether to scale the matrix before ILU
 	const bool threadedfactor;                   ///< True for thread-parallel ILU0 factorization
 	const bool threadedapply;                    ///< True for thread-parallel LU application
 	const int nbuildsweeps;                      ///< Number of async sweeps for building ILU factors
 	const int napplysweeps;                      ///< Number of async sweeps for applying ILU factors
+	scalar buildtol = 0;                         ///< Tolerance for adaptive build \sa setBuildTolerance
 
 	/// Number of work-items in each dynamic job assigned to a thread
 	const int thread_chunk_size;
@@ -161,6 +313,19 @@ protected:
 	const ApplyInit applyinittype;
 	const bool compute_precinfo;                 ///< Whether to compute expensive quantities for analysis
 
+	bool syncfreefactor = false;                 ///< \sa setSyncFreeFactorization
+	ApplyType applytype = APPLY_ASYNC;           ///< \sa setApplyType
+	/// Row completion flags for sync-free factorization and application
+	std::unique_ptr<SyncFreeSchedule<index>> sfsched;
+	/// Approximate inverses of the factors for \ref APPLY_ISAI
+	std::unique_ptr<ILUISAI<scalar,index,1,ColMajor>> isai;
+	size_t tilecachebytes = 0;                   ///< Cache size for tiles \sa setSweepTiling
+	SweepTiling<index> tiling;                   ///< Tiles of the build sweeps, set up in compute
+
+	const bool usecompressedind;                 ///< Whether to use compressed column indices
+	CompressedColumnIndex<index> cind;           ///< Compressed column indices of \ref mat
+	CRawCompressedColumnIndex<index> rcind;      ///< View of \ref cind
+
 	/// Allocates memory for storing LU factors and initializes it, as well as temporary data
 	/** \param scaling Set to true to allocate storage for the scaling vector that's applied to
 	 * the matrix A before computing the ILU factors.
@@ -196,6 +361,10 @@ public:
 	/// Apply the preconditioner and apply ordering and scaling to the output
 	void apply(const scalar *const x, scalar *const __restrict y) const;
 
+	/// Applies the preconditioner to one vector at a time \sa Preconditioner::apply_multi
+	void apply_multi(const int nvecs, const scalar *const x, scalar *const __restrict y) const
+	{ Preconditioner<scalar,index>::apply_multi(nvecs, x, y); }
+
 	/// Does nothing but throw an exception
 	void apply_relax(const scalar *const x, scalar *const __restrict y) const;
 
@@ -209,6 +378,7 @@ protected:
 	using AsyncILU0_SRPreconditioner<scalar,index>::threadedfactor;
 	using AsyncILU0_SRPreconditioner<scalar,index>::threadedapply;
 	using AsyncILU0_SRPreconditioner<scalar,index>::nbuildsweeps;
+	using AsyncILU0_SRPreconditioner<scalar,index>::buildtol;
 	using AsyncILU0_SRPreconditioner<scalar,index>::napplysweeps;
 	using AsyncILU0_SRPreconditioner<scalar,index>::thread_chunk_size;
 	using AsyncILU0_SRPreconditioner<scalar,index>::factinittype;
@@ -222,6 +392,58 @@ protected:
 	ReorderingScaling<scalar,index,1> *const reord;
 };
 
+/// Asynchronous scalar threshold ILU whose pattern is chosen dynamically \cite ilu:parilut
+/** Every time the preconditioner is computed, the pattern of the factors starts from that of the
+ * matrix and is updated by alternately adding the largest entries of the ILU remainder and
+ * dropping the smallest entries of the factors outside the pattern of the matrix, with
+ * asynchronous fixed-point sweeps in between. The number of non-zeros in each row of the factors
+ * is limited to a multiple of that in the corresponding row of the matrix.
+ * The factors are applied like ILU(0) factors.
+ */
+template <typename scalar, typename index>
+class AsyncILUT_SRPreconditioner : public AsyncILU0_SRPreconditioner<scalar,index>
+{
+public:
+	/** \see AsyncILU0_SRPreconditioner
+	 * \param nsteps Number of add-sweep-drop-sweep steps for building the factors
+	 * \param fill_factor Maximum number of non-zeros in each row of the factors, relative to the
+	 *   number of non-zeros in that row of the matrix
+	 */
+	AsyncILUT_SRPreconditioner(SRMatrixStorage<const scalar, const index>&& matrix,
+	                           const int nsteps, const int napplysweeps,
+	                           const bool use_scaling, const int thread_chunk_size,
+	                           const FactInit fact_inittype, const ApplyInit apply_inittype,
+	                           const scalar fill_factor, const bool compute_preconditioner_info,
+	                           const bool threadedfactor=true, const bool threadedapply=true);
+
+	/// Computes the pattern and the values of the factors
+	PrecInfo compute();
+
+protected:
+	using SRPreconditioner<scalar,index>::mat;
+	using SRPreconditioner<scalar,index>::pmat;
+	using AsyncILU0_SRPreconditioner<scalar,index>::iluvals;
+	using AsyncILU0_SRPreconditioner<scalar,index>::scale;
+	using AsyncILU0_SRPreconditioner<scalar,index>::threadedfactor;
+	using AsyncILU0_SRPreconditioner<scalar,index>::nbuildsweeps;
+	using AsyncILU0_SRPreconditioner<scalar,index>::thread_chunk_size;
+	using AsyncILU0_SRPreconditioner<scalar,index>::factinittype;
+	using AsyncILU0_SRPreconditioner<scalar,index>::compute_precinfo;
+	using AsyncILU0_SRPreconditioner<scalar,index>::applytype;
+	using AsyncILU0_SRPreconditioner<scalar,index>::sfsched;
+	using AsyncILU0_SRPreconditioner<scalar,index>::isai;
+	using AsyncILU0_SRPreconditioner<scalar,index>::setup_storage;
+
+	/// Maximum number of non-zeros in a row of the factors relative to that in the matrix
+	const scalar fillfactor;
+
+	/// Pattern of the current factors, with values of the (scaled) matrix; viewed by \ref mat
+	SRMatrixStorage<scalar,index> ilutmat;
+
+	/// Number of entries \ref iluvals can hold; it is reallocated only when the factors outgrow it
+	index iluvalscapacity = 0;
+};
+
 #ifdef HAVE_MC64
 
 /// EXPERIMENTAL - 
@@ -257,6 +479,7 @@ protected:
 	using AsyncILU0_SRPreconditioner<scalar,index>::threadedfactor;
 	using AsyncILU0_SRPreconditioner<scalar,index>::threadedapply;
 	using AsyncILU0_SRPreconditioner<scalar,index>::nbuildsweeps;
+	using AsyncILU0_SRPreconditioner<scalar,index>::buildtol;
 	using AsyncILU0_SRPreconditioner<scalar,index>::napplysweeps;
 	using AsyncILU0_SRPreconditioner<scalar,index>::thread_chunk_size;
 	using AsyncILU0_SRPreconditioner<scalar,index>::factinittype;
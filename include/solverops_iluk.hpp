@@ -0,0 +1,63 @@
+/** \file
+ * \brief Incomplete LU factorizations with levels of fill, computed by asynchronous iterations
+ * \author Aditya Kashi
+ */
+
+#ifndef BLASTED_SOLVEROPS_ILUK_H
+#define BLASTED_SOLVEROPS_ILUK_H
+
+#include <memory>
+#include "solverops_ilu0.hpp"
+#include "solverops_levels_ilu0.hpp"
+
+namespace blasted {
+
+/// ILU(k) preconditioner computed by an ILU(0)-type preconditioner on the pattern of ILU(k)
+/** The Chow-Patel fixed-point iteration, and the asynchronous or level-scheduled triangular
+ * solves, work on any pattern containing that of the matrix. The first \ref compute determines
+ * the pattern of the ILU(k) factors \sa compute_ILUk_pattern, after which the preconditioner
+ * ILU0 carries out all the operations on a copy of the matrix extended by zeros to that pattern.
+ * The values are copied into the extended matrix every time the preconditioner is computed.
+ *
+ * \tparam bs Block size; 1 for scalar ILU0 types
+ * \tparam ILU0 The ILU(0) preconditioner to extend, such as AsyncILU0_SRPreconditioner or
+ *   Async_Level_BlockILU0
+ */
+template <typename scalar, typename index, int bs, typename ILU0>
+class LevelOfFillILU : public ILU0
+{
+public:
+	/// Sets up the preconditioner
+	/** \param matrix The matrix to compute the preconditioner from
+	 * \param fill_level Level of fill k
+	 * \param args Other arguments of the constructor of ILU0
+	 */
+	template <typename... Args>
+	LevelOfFillILU(SRMatrixStorage<const scalar, const index>&& matrix, const int fill_level,
+	               Args&&... args)
+		: ILU0(std::move(matrix), std::forward<Args>(args)...), filllevel{fill_level},
+		  extvals{nullptr}
+	{ }
+
+	~LevelOfFillILU();
+
+	/// Computes the factorization. The first invocation also computes the ILU(k) pattern.
+	PrecInfo compute();
+
+protected:
+	using SRPreconditioner<scalar,index>::mat;
+	using SRPreconditioner<scalar,index>::pmat;
+
+	/// Level of fill
+	const int filllevel;
+
+	/// Pattern of the factors, shared among instances having the same pattern and level of fill
+	std::shared_ptr<const ILUkPattern<index>> pattern;
+
+	/// Values of the matrix on the extended pattern, viewed by \ref mat after the first compute
+	scalar *extvals;
+};
+
+}
+
+#endif
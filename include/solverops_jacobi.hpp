@@ -6,6 +6,7 @@
 #ifndef BLASTED_SOLVEROPS_JACOBI_H
 #define BLASTED_SOLVEROPS_JACOBI_H
 
+#include <memory>
 #include "solverops_base.hpp"
 
 namespace blasted {
@@ -33,6 +34,9 @@ public:
 	/// To apply the preconditioner
 	void apply(const scalar *const x, scalar *const __restrict y) const;
 
+	/// To apply the preconditioner to several row-interleaved vectors at once
+	void apply_multi(const int nvecs, const scalar *const x, scalar *const __restrict y) const;
+
 	/// Carry out a relaxation solve
 	void apply_relax(const scalar *const x, scalar *const __restrict y) const;
 
@@ -40,6 +44,7 @@ protected:
 	
 	using SRPreconditioner<scalar,index>::pmat;
 	using SRPreconditioner<scalar,index>::mat;
+	using SRPreconditioner<scalar,index>::numasched;
 	using Preconditioner<scalar,index>::solveparams;
 	using Blk = Block_t<scalar,bs,stopt>;
 	using Seg = Segment_t<scalar,bs>;
@@ -47,6 +52,9 @@ protected:
 	/// Storage for factored or inverted diagonal blocks
 	scalar *dblocks;
 	//aligned_vector<scalar> dblocks;
+
+	/// Owner of \ref dblocks, shared with other instances wrapping the same matrix
+	std::shared_ptr<scalar> dblockstore;
 };
 
 /// Scalar Jacobi operator for sparse-row matrices
@@ -72,16 +80,23 @@ public:
 	/// To apply the preconditioner
 	void apply(const scalar *const x, scalar *const __restrict y) const;
 
+	/// To apply the preconditioner to several row-interleaved vectors at once
+	void apply_multi(const int nvecs, const scalar *const x, scalar *const __restrict y) const;
+
 	/// Carry out a relaxation solve
 	void apply_relax(const scalar *const x, scalar *const __restrict y) const;
 
 protected:
 	
 	using SRPreconditioner<scalar,index>::mat;
+	using SRPreconditioner<scalar,index>::numasched;
 	using Preconditioner<scalar,index>::solveparams;
 	
-	/// Storage for factored or inverted diagonal blocks
+	/// Storage for inverted diagonal entries
 	scalar *dblocks;
+
+	/// Owner of \ref dblocks, shared with other instances wrapping the same matrix
+	std::shared_ptr<scalar> dblockstore;
 };
 	
 }
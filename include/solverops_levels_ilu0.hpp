@@ -7,6 +7,7 @@
 #define BLASTED_LEVEL_ILU0_H
 
 #include "solverops_ilu0.hpp"
+#include "levelschedule.hpp"
 
 namespace blasted {
 
@@ -27,6 +28,10 @@ public:
 	/// Applies a block LU factorization L U z = r
 	void apply(const scalar *const x, scalar *const __restrict y) const;
 
+	/// Applies the preconditioner to one vector at a time \sa Preconditioner::apply_multi
+	void apply_multi(const int nvecs, const scalar *const x, scalar *const __restrict y) const
+	{ Preconditioner<scalar,index>::apply_multi(nvecs, x, y); }
+
 	/// Does nothing but throw an exception
 	void apply_relax(const scalar *const x, scalar *const __restrict y) const;
 
@@ -45,7 +50,8 @@ protected:
 	using Blk = Block_t<scalar,bs,stor>;
 	using Seg = Segment_t<scalar,bs>;
 
-	std::vector<index> levels;
+	/// Level sets for the triangular solves, shared among instances having the same sparsity pattern
+	std::shared_ptr<const LevelSchedule<index>> levels;
 };
 
 template <typename scalar, typename index>
@@ -65,6 +71,10 @@ public:
 	/// Applies a block LU factorization L U z = r
 	void apply(const scalar *const x, scalar *const __restrict y) const;
 
+	/// Applies the preconditioner to one vector at a time \sa Preconditioner::apply_multi
+	void apply_multi(const int nvecs, const scalar *const x, scalar *const __restrict y) const
+	{ Preconditioner<scalar,index>::apply_multi(nvecs, x, y); }
+
 	/// Does nothing but throw an exception
 	void apply_relax(const scalar *const x, scalar *const __restrict y) const;
 
@@ -80,7 +90,8 @@ protected:
 	using AsyncILU0_SRPreconditioner<scalar,index>::thread_chunk_size;
 	using AsyncILU0_SRPreconditioner<scalar,index>::threadedfactor;
 
-	std::vector<index> levels;
+	/// Level sets for the triangular solves, shared among instances having the same sparsity pattern
+	std::shared_ptr<const LevelSchedule<index>> levels;
 };
 
 }
@@ -8,6 +8,7 @@
 #define BLASTED_SOLVEROPS_LEVELS_SGS_H
 
 #include "solverops_jacobi.hpp"
+#include "levelschedule.hpp"
 
 namespace blasted {
 
@@ -27,6 +28,10 @@ public:
 	/// To apply the preconditioner
 	void apply(const scalar *const r, scalar *const __restrict z) const;
 
+	/// Applies the preconditioner to one vector at a time \sa Preconditioner::apply_multi
+	void apply_multi(const int nvecs, const scalar *const x, scalar *const __restrict y) const
+	{ Preconditioner<scalar,index>::apply_multi(nvecs, x, y); }
+
 	/// Carry out a relaxation solve
 	void apply_relax(const scalar *const x, scalar *const __restrict y) const;
 
@@ -42,8 +47,12 @@ protected:
 	/// Temporary storage for the result of the forward Gauss-Seidel sweep
 	scalar *ytemp;
 
-	/// Independent levels
-	std::vector<index> levels;
+	/// Level sets for the preconditioning sweeps, shared among instances having the same
+	///  sparsity pattern
+	std::shared_ptr<const LevelSchedule<index>> levels;
+
+	/// Level sets for relaxation sweeps, which update the solution vector in place
+	std::shared_ptr<const LevelSchedule<index>> relaxlevels;
 };
 
 /// Level-scheduled parallel symmetric Gauss-Seidel iteration
@@ -62,6 +71,10 @@ public:
 	/// To apply the preconditioner
 	void apply(const scalar *const r, scalar *const __restrict z) const;
 
+	/// Applies the preconditioner to one vector at a time \sa Preconditioner::apply_multi
+	void apply_multi(const int nvecs, const scalar *const x, scalar *const __restrict y) const
+	{ Preconditioner<scalar,index>::apply_multi(nvecs, x, y); }
+
 	/// Carry out a relaxation solve
 	void apply_relax(const scalar *const x, scalar *const __restrict y) const;
 
@@ -74,8 +87,12 @@ protected:
 	/// Temporary storage for the result of the forward Gauss-Seidel sweep
 	scalar *ytemp;
 
-	/// Independent levels
-	std::vector<index> levels;
+	/// Level sets for the preconditioning sweeps, shared among instances having the same
+	///  sparsity pattern
+	std::shared_ptr<const LevelSchedule<index>> levels;
+
+	/// Level sets for relaxation sweeps, which update the solution vector in place
+	std::shared_ptr<const LevelSchedule<index>> relaxlevels;
 };
 
 }
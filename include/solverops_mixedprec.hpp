@@ -0,0 +1,257 @@
+/** \file solverops_mixedprec.hpp
+ * \brief Preconditioners that store their factors and matrix copies in a lower precision
+ * \author Aditya Kashi
+ *
+ * The operators here are computed exactly as their full-precision counterparts. After each
+ * computation, the data read by the preconditioning operation (inverted diagonal blocks, ILU
+ * factors and, optionally, the matrix itself) is copied into arrays of the storage type lscalar,
+ * usually float. The preconditioning operation then streams these lower-precision arrays, while all
+ * arithmetic and accumulation is done in the working precision scalar. Relaxation and the
+ * asynchronous factorization keep using the full-precision data.
+ */
+
+#ifndef BLASTED_SOLVEROPS_MIXEDPREC_H
+#define BLASTED_SOLVEROPS_MIXEDPREC_H
+
+#include "solverops_sgs.hpp"
+#include "solverops_ilu0.hpp"
+
+namespace blasted {
+
+/// Block-Jacobi operator whose inverted diagonal blocks are applied from lower-precision storage
+template <typename scalar, typename lscalar, typename index, int bs, StorageOptions stor>
+class MixedPrecBJacobiPreconditioner : public BJacobiSRPreconditioner<scalar,index,bs,stor>
+{
+public:
+	MixedPrecBJacobiPreconditioner(SRMatrixStorage<const scalar, const index>&& matrix);
+
+	~MixedPrecBJacobiPreconditioner();
+
+	/// Compute the inverted diagonal blocks and their lower-precision copy
+	PrecInfo compute();
+
+	/// To apply the preconditioner
+	void apply(const scalar *const x, scalar *const __restrict y) const;
+
+	/// Applies the preconditioner to one vector at a time \sa Preconditioner::apply_multi
+	void apply_multi(const int nvecs, const scalar *const x, scalar *const __restrict y) const
+	{ Preconditioner<scalar,index>::apply_multi(nvecs, x, y); }
+
+protected:
+	using SRPreconditioner<scalar,index>::mat;
+	using SRPreconditioner<scalar,index>::numasched;
+	using BJacobiSRPreconditioner<scalar,index,bs,stor>::dblocks;
+
+	lscalar *ldblocks;                        ///< Lower-precision copy of the inverted diagonal blocks
+};
+
+/// Scalar Jacobi operator whose inverted diagonal is applied from lower-precision storage
+template <typename scalar, typename lscalar, typename index>
+class MixedPrecJacobiPreconditioner : public JacobiSRPreconditioner<scalar,index>
+{
+public:
+	MixedPrecJacobiPreconditioner(SRMatrixStorage<const scalar, const index>&& matrix);
+
+	~MixedPrecJacobiPreconditioner();
+
+	/// Compute the inverted diagonal and its lower-precision copy
+	PrecInfo compute();
+
+	/// To apply the preconditioner
+	void apply(const scalar *const x, scalar *const __restrict y) const;
+
+	/// Applies the preconditioner to one vector at a time \sa Preconditioner::apply_multi
+	void apply_multi(const int nvecs, const scalar *const x, scalar *const __restrict y) const
+	{ Preconditioner<scalar,index>::apply_multi(nvecs, x, y); }
+
+protected:
+	using SRPreconditioner<scalar,index>::mat;
+	using SRPreconditioner<scalar,index>::numasched;
+	using JacobiSRPreconditioner<scalar,index>::dblocks;
+
+	lscalar *ldblocks;                        ///< Lower-precision copy of the inverted diagonal
+};
+
+/// Asynchronous block-SGS operator applied with lower-precision diagonal blocks and, optionally,
+/// a lower-precision copy of the matrix
+template <typename scalar, typename lscalar, typename index, int bs, StorageOptions stor>
+class MixedPrecAsyncBlockSGSPreconditioner
+	: public AsyncBlockSGS_SRPreconditioner<scalar,index,bs,stor>
+{
+public:
+	/// Create the preconditioner \sa AsyncBlockSGS_SRPreconditioner
+	/** \param lowprec_matrix Whether the sweeps should also read the matrix from a lower-precision
+	 *   copy; if false, only the inverted diagonal blocks are stored in lower precision
+	 */
+	MixedPrecAsyncBlockSGSPreconditioner(SRMatrixStorage<const scalar, const index>&& matrix,
+	                                     const int napplysweeps, const ApplyInit apply_inittype,
+	                                     const int threadchunksize, const bool lowprec_matrix);
+
+	~MixedPrecAsyncBlockSGSPreconditioner();
+
+	/// Compute the preconditioner and the lower-precision copies
+	PrecInfo compute();
+
+	/// To apply the preconditioner
+	void apply(const scalar *const x, scalar *const __restrict y) const;
+
+	/// Applies the preconditioner to one vector at a time \sa Preconditioner::apply_multi
+	void apply_multi(const int nvecs, const scalar *const x, scalar *const __restrict y) const
+	{ Preconditioner<scalar,index>::apply_multi(nvecs, x, y); }
+
+protected:
+	using SRPreconditioner<scalar,index>::mat;
+	using SRPreconditioner<scalar,index>::numasched;
+	using BJacobiSRPreconditioner<scalar,index,bs,stor>::dblocks;
+	using AsyncBlockSGS_SRPreconditioner<scalar,index,bs,stor>::ytemp;
+	using AsyncBlockSGS_SRPreconditioner<scalar,index,bs,stor>::napplysweeps;
+	using AsyncBlockSGS_SRPreconditioner<scalar,index,bs,stor>::ainit;
+	using AsyncBlockSGS_SRPreconditioner<scalar,index,bs,stor>::thread_chunk_size;
+
+	const bool lowprecmatrix;                 ///< Whether to keep a lower-precision matrix copy
+	lscalar *ldblocks;                        ///< Lower-precision copy of the inverted diagonal blocks
+	lscalar *lvals;                           ///< Lower-precision copy of the matrix values, or null
+
+	/// Applies the two sweeps using matrix values of type vscalar
+	template <typename vscalar>
+	void apply_sweeps(const vscalar *const vals, const scalar *const x, scalar *const __restrict y)
+		const;
+};
+
+/// Asynchronous scalar SGS operator applied with a lower-precision diagonal and, optionally,
+/// a lower-precision copy of the matrix
+template <typename scalar, typename lscalar, typename index>
+class MixedPrecAsyncSGSPreconditioner : public AsyncSGS_SRPreconditioner<scalar,index>
+{
+public:
+	/// Create the preconditioner \sa AsyncSGS_SRPreconditioner
+	/** \param lowprec_matrix Whether the sweeps should also read the matrix from a lower-precision
+	 *   copy; if false, only the inverted diagonal is stored in lower precision
+	 */
+	MixedPrecAsyncSGSPreconditioner(SRMatrixStorage<const scalar, const index>&& matrix,
+	                                const int napplysweeps, const ApplyInit apply_inittype,
+	                                const int threadchunksize, const bool lowprec_matrix);
+
+	~MixedPrecAsyncSGSPreconditioner();
+
+	/// Compute the preconditioner and the lower-precision copies
+	PrecInfo compute();
+
+	/// To apply the preconditioner
+	void apply(const scalar *const x, scalar *const __restrict y) const;
+
+	/// Applies the preconditioner to one vector at a time \sa Preconditioner::apply_multi
+	void apply_multi(const int nvecs, const scalar *const x, scalar *const __restrict y) const
+	{ Preconditioner<scalar,index>::apply_multi(nvecs, x, y); }
+
+protected:
+	using SRPreconditioner<scalar,index>::mat;
+	using SRPreconditioner<scalar,index>::numasched;
+	using JacobiSRPreconditioner<scalar,index>::dblocks;
+	using AsyncSGS_SRPreconditioner<scalar,index>::ytemp;
+	using AsyncSGS_SRPreconditioner<scalar,index>::napplysweeps;
+	using AsyncSGS_SRPreconditioner<scalar,index>::ainit;
+	using AsyncSGS_SRPreconditioner<scalar,index>::thread_chunk_size;
+
+	const bool lowprecmatrix;                 ///< Whether to keep a lower-precision matrix copy
+	lscalar *ldblocks;                        ///< Lower-precision copy of the inverted diagonal
+	lscalar *lvals;                           ///< Lower-precision copy of the matrix values, or null
+
+	/// Applies the two sweeps using matrix values of type vscalar
+	template <typename vscalar>
+	void apply_sweeps(const vscalar *const vals, const scalar *const x, scalar *const __restrict y)
+		const;
+};
+
+/// Asynchronous block-ILU(0) preconditioner applied from lower-precision factors
+/** The factorization is carried out in the working precision. The working-precision factors are
+ * kept only if the factorization is initialized with \ref INIT_F_NONE, so that it can continue from
+ * the previous factors during a subsequent computation; otherwise they are freed after conversion.
+ */
+template <typename scalar, typename lscalar, typename index, int bs, StorageOptions stor>
+class MixedPrecAsyncBlockILU0Preconditioner
+	: public AsyncBlockILU0_SRPreconditioner<scalar,index,bs,stor>
+{
+public:
+	/// \sa AsyncBlockILU0_SRPreconditioner
+	MixedPrecAsyncBlockILU0Preconditioner(SRMatrixStorage<const scalar, const index>&& matrix,
+	                                      const int nbuildsweeps, const int napplysweeps,
+	                                      const bool use_scaling, const int thread_chunk_size,
+	                                      const FactInit fact_inittype,
+	                                      const ApplyInit apply_inittype,
+	                                      const bool threadedfactor=true,
+	                                      const bool threadedapply=true,
+	                                      const bool compute_remainder = false);
+
+	~MixedPrecAsyncBlockILU0Preconditioner();
+
+	/// Compute the factors and their lower-precision copy
+	PrecInfo compute();
+
+	/// Applies the lower-precision block LU factors
+	void apply(const scalar *const x, scalar *const __restrict y) const;
+
+	/// Applies the preconditioner to one vector at a time \sa Preconditioner::apply_multi
+	void apply_multi(const int nvecs, const scalar *const x, scalar *const __restrict y) const
+	{ Preconditioner<scalar,index>::apply_multi(nvecs, x, y); }
+
+protected:
+	using SRPreconditioner<scalar,index>::mat;
+	using SRPreconditioner<scalar,index>::numasched;
+	using AsyncBlockILU0_SRPreconditioner<scalar,index,bs,stor>::iluvals;
+	using AsyncBlockILU0_SRPreconditioner<scalar,index,bs,stor>::factinittype;
+	using AsyncBlockILU0_SRPreconditioner<scalar,index,bs,stor>::scale;
+	using AsyncBlockILU0_SRPreconditioner<scalar,index,bs,stor>::ytemp;
+	using AsyncBlockILU0_SRPreconditioner<scalar,index,bs,stor>::threadedapply;
+	using AsyncBlockILU0_SRPreconditioner<scalar,index,bs,stor>::napplysweeps;
+	using AsyncBlockILU0_SRPreconditioner<scalar,index,bs,stor>::thread_chunk_size;
+	using AsyncBlockILU0_SRPreconditioner<scalar,index,bs,stor>::applyinittype;
+
+	lscalar *liluvals;                        ///< Lower-precision copy of the LU factors
+};
+
+/// Asynchronous scalar ILU(0) preconditioner applied from lower-precision factors
+/** \sa MixedPrecAsyncBlockILU0Preconditioner
+ */
+template <typename scalar, typename lscalar, typename index>
+class MixedPrecAsyncILU0Preconditioner : public AsyncILU0_SRPreconditioner<scalar,index>
+{
+public:
+	/// \sa AsyncILU0_SRPreconditioner
+	MixedPrecAsyncILU0Preconditioner(SRMatrixStorage<const scalar, const index>&& matrix,
+	                                 const int nbuildsweeps, const int napplysweeps,
+	                                 const bool use_scaling, const int thread_chunk_size,
+	                                 const FactInit fact_inittype, const ApplyInit apply_inittype,
+	                                 const bool compute_preconditioner_info,
+	                                 const bool threadedfactor=true, const bool threadedapply=true);
+
+	~MixedPrecAsyncILU0Preconditioner();
+
+	/// Compute the factors and their lower-precision copy
+	PrecInfo compute();
+
+	/// Applies the lower-precision LU factors
+	void apply(const scalar *const x, scalar *const __restrict y) const;
+
+	/// Applies the preconditioner to one vector at a time \sa Preconditioner::apply_multi
+	void apply_multi(const int nvecs, const scalar *const x, scalar *const __restrict y) const
+	{ Preconditioner<scalar,index>::apply_multi(nvecs, x, y); }
+
+protected:
+	using SRPreconditioner<scalar,index>::mat;
+	using SRPreconditioner<scalar,index>::numasched;
+	using AsyncILU0_SRPreconditioner<scalar,index>::iluvals;
+	using AsyncILU0_SRPreconditioner<scalar,index>::factinittype;
+	using AsyncILU0_SRPreconditioner<scalar,index>::scale;
+	using AsyncILU0_SRPreconditioner<scalar,index>::ytemp;
+	using AsyncILU0_SRPreconditioner<scalar,index>::threadedapply;
+	using AsyncILU0_SRPreconditioner<scalar,index>::napplysweeps;
+	using AsyncILU0_SRPreconditioner<scalar,index>::thread_chunk_size;
+	using AsyncILU0_SRPreconditioner<scalar,index>::applyinittype;
+
+	lscalar *liluvals;                        ///< Lower-precision copy of the LU factors
+};
+
+}
+
+#endif
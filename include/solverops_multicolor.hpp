@@ -0,0 +1,243 @@
+/** \file
+ * \brief Multicolor Gauss-Seidel and ILU(0) iterations
+ * \author Aditya Kashi
+ *
+ * The (block-)rows are colored such that no two rows of the same color are coupled
+ * \sa computeColoring. Sweeps then go through the colors one after another, processing all rows of
+ * a color in parallel. The results are those of the sequential algorithms applied in the color
+ * order, so they do not depend on the number of threads. Since coloring typically needs far fewer
+ * colors than there are levels in the natural ordering, fewer barriers are needed than with level
+ * scheduling, at the cost of the ordering being different.
+ */
+
+#ifndef BLASTED_SOLVEROPS_MULTICOLOR_H
+#define BLASTED_SOLVEROPS_MULTICOLOR_H
+
+#include "solverops_jacobi.hpp"
+#include "levelschedule.hpp"
+#include "ilu_pattern.hpp"
+
+namespace blasted {
+
+/// Multicolor parallel block symmetric Gauss-Seidel iteration
+/** The forward sweep goes through the colors in increasing order and the backward sweep in
+ * decreasing order, updating the solution in place.
+ */
+template <typename scalar, typename index, int bs, StorageOptions stor>
+class Multicolor_BSGS : public BJacobiSRPreconditioner<scalar,index,bs,stor>
+{
+public:
+	/** \param color_distance Distance of the coloring, 1 or 2 \sa computeColoring
+	 * \param balanced_colors Whether to balance the sizes of the colors
+	 */
+	Multicolor_BSGS(SRMatrixStorage<const scalar, const index>&& matrix,
+	                const int color_distance, const bool balanced_colors);
+
+	bool relaxationAvailable() const { return true; }
+
+	/// Compute the preconditioner. The first invocation also colors the rows.
+	PrecInfo compute();
+
+	/// To apply the preconditioner
+	void apply(const scalar *const r, scalar *const __restrict z) const;
+
+	/// Applies the preconditioner to one vector at a time \sa Preconditioner::apply_multi
+	void apply_multi(const int nvecs, const scalar *const x, scalar *const __restrict y) const
+	{ Preconditioner<scalar,index>::apply_multi(nvecs, x, y); }
+
+	/// Carry out a relaxation solve
+	void apply_relax(const scalar *const x, scalar *const __restrict y) const;
+
+protected:
+	using Preconditioner<scalar,index>::solveparams;
+	using SRPreconditioner<scalar,index>::mat;
+	using BJacobiSRPreconditioner<scalar,index,bs,stor>::dblocks;
+
+	using Blk = Block_t<scalar,bs,stor>;
+	using Seg = Segment_t<scalar,bs>;
+
+	const int colordist;             ///< Distance of the coloring
+	const bool balancedcolors;       ///< Whether the sizes of the colors are balanced
+
+	/// Rows of each color, shared among instances having the same sparsity pattern
+	std::shared_ptr<const LevelSets<index>> colors;
+
+	/// Carries out symmetric sweeps starting from the current solution
+	void sweeps(const Seg *const b, Seg *const x, const int nsweeps) const;
+};
+
+/// Multicolor parallel symmetric Gauss-Seidel iteration
+template <typename scalar, typename index>
+class Multicolor_SGS : public JacobiSRPreconditioner<scalar,index>
+{
+public:
+	/** \param color_distance Distance of the coloring, 1 or 2 \sa computeColoring
+	 * \param balanced_colors Whether to balance the sizes of the colors
+	 */
+	Multicolor_SGS(SRMatrixStorage<const scalar, const index>&& matrix,
+	               const int color_distance, const bool balanced_colors);
+
+	bool relaxationAvailable() const { return true; }
+
+	/// Compute the preconditioner. The first invocation also colors the rows.
+	PrecInfo compute();
+
+	/// To apply the preconditioner
+	void apply(const scalar *const r, scalar *const __restrict z) const;
+
+	/// Applies the preconditioner to one vector at a time \sa Preconditioner::apply_multi
+	void apply_multi(const int nvecs, const scalar *const x, scalar *const __restrict y) const
+	{ Preconditioner<scalar,index>::apply_multi(nvecs, x, y); }
+
+	/// Carry out a relaxation solve
+	void apply_relax(const scalar *const x, scalar *const __restrict y) const;
+
+protected:
+	using Preconditioner<scalar,index>::solveparams;
+	using SRPreconditioner<scalar,index>::mat;
+	using JacobiSRPreconditioner<scalar,index>::dblocks;
+
+	const int colordist;             ///< Distance of the coloring
+	const bool balancedcolors;       ///< Whether the sizes of the colors are balanced
+
+	/// Rows of each color, shared among instances having the same sparsity pattern
+	std::shared_ptr<const LevelSets<index>> colors;
+
+	/// Carries out symmetric sweeps starting from the current solution
+	void sweeps(const scalar *const b, scalar *const x, const int nsweeps) const;
+};
+
+/// Exact block-ILU(0) of the matrix reordered color by color
+/** The matrix is symmetrically permuted so that the rows of each color are contiguous
+ * \sa MulticolorReordering. Since the rows of a color are not coupled to each other, the block-rows
+ * of a color depend only on rows of previous colors, both in the factorization and in the
+ * forward substitution; similarly for the backward substitution. So all rows of a color are
+ * factorized or solved for in parallel, with a barrier between colors. The input and output
+ * vectors are in the original ordering.
+ */
+template <typename scalar, typename index, int bs, StorageOptions stor>
+class Multicolor_BILU0 : public SRPreconditioner<scalar,index>
+{
+public:
+	/** \param color_distance Distance of the coloring, 1 or 2 \sa computeColoring
+	 * \param balanced_colors Whether to balance the sizes of the colors
+	 */
+	Multicolor_BILU0(SRMatrixStorage<const scalar, const index>&& matrix,
+	                 const int color_distance, const bool balanced_colors);
+
+	~Multicolor_BILU0();
+
+	/// Returns the number of rows of the operator
+	index dim() const { return mat.nbrows*bs; }
+
+	bool relaxationAvailable() const { return false; }
+
+	/// Computes the factors. The first invocation also colors and permutes the pattern.
+	PrecInfo compute();
+
+	/// Applies the block LU factorization L U z = r in the reordered space
+	void apply(const scalar *const r, scalar *const __restrict z) const;
+
+	/// Applies the preconditioner to one vector at a time \sa Preconditioner::apply_multi
+	void apply_multi(const int nvecs, const scalar *const x, scalar *const __restrict y) const
+	{ Preconditioner<scalar,index>::apply_multi(nvecs, x, y); }
+
+	/// Does nothing but throw an exception
+	void apply_relax(const scalar *const x, scalar *const __restrict y) const;
+
+protected:
+	using SRPreconditioner<scalar,index>::mat;
+
+	using Blk = Block_t<scalar,bs,stor>;
+	using Seg = Segment_t<scalar,bs>;
+
+	const int colordist;             ///< Distance of the coloring
+	const bool balancedcolors;       ///< Whether the sizes of the colors are balanced
+
+	/// Rows of each color in the original ordering, shared among instances with the same pattern
+	std::shared_ptr<const LevelSets<index>> colors;
+
+	/// The matrix reordered color by color
+	SRMatrixStorage<scalar,index> rmat;
+
+	/// For each non-zero block of \ref rmat, its location in the original matrix
+	std::vector<index> origloc;
+
+	/// Storage for the L and U factors, in the pattern of \ref rmat
+	scalar *iluvals;
+
+	/// Precomputed positions in the factors for the factorization, shared among instances having
+	///  the same sparsity pattern
+	std::shared_ptr<const ILUPositions<index>> plist;
+
+	/// Inverses of the diagonal blocks of U, computed along with them
+	Blk *pivinv;
+
+	/// Temporary storage for the result of the forward solve
+	scalar *ytemp;
+	/// Temporary storage for the solution in the reordered space
+	scalar *ztemp;
+};
+
+/// Exact scalar ILU(0) of the matrix reordered color by color \sa Multicolor_BILU0
+template <typename scalar, typename index>
+class Multicolor_ILU0 : public SRPreconditioner<scalar,index>
+{
+public:
+	/** \param color_distance Distance of the coloring, 1 or 2 \sa computeColoring
+	 * \param balanced_colors Whether to balance the sizes of the colors
+	 */
+	Multicolor_ILU0(SRMatrixStorage<const scalar, const index>&& matrix,
+	                const int color_distance, const bool balanced_colors);
+
+	~Multicolor_ILU0();
+
+	/// Returns the number of rows of the operator
+	index dim() const { return mat.nbrows; }
+
+	bool relaxationAvailable() const { return false; }
+
+	/// Computes the factors. The first invocation also colors and permutes the pattern.
+	PrecInfo compute();
+
+	/// Applies the LU factorization L U z = r in the reordered space
+	void apply(const scalar *const r, scalar *const __restrict z) const;
+
+	/// Applies the preconditioner to one vector at a time \sa Preconditioner::apply_multi
+	void apply_multi(const int nvecs, const scalar *const x, scalar *const __restrict y) const
+	{ Preconditioner<scalar,index>::apply_multi(nvecs, x, y); }
+
+	/// Does nothing but throw an exception
+	void apply_relax(const scalar *const x, scalar *const __restrict y) const;
+
+protected:
+	using SRPreconditioner<scalar,index>::mat;
+
+	const int colordist;             ///< Distance of the coloring
+	const bool balancedcolors;       ///< Whether the sizes of the colors are balanced
+
+	/// Rows of each color in the original ordering, shared among instances with the same pattern
+	std::shared_ptr<const LevelSets<index>> colors;
+
+	/// The matrix reordered color by color
+	SRMatrixStorage<scalar,index> rmat;
+
+	/// For each non-zero of \ref rmat, its location in the original matrix
+	std::vector<index> origloc;
+
+	/// Storage for the L and U factors, in the pattern of \ref rmat
+	scalar *iluvals;
+
+	/// Precomputed positions in the factors for the factorization, shared among instances having
+	///  the same sparsity pattern
+	std::shared_ptr<const ILUPositions<index>> plist;
+
+	/// Temporary storage for the result of the forward solve
+	scalar *ytemp;
+	/// Temporary storage for the solution in the reordered space
+	scalar *ztemp;
+};
+
+}
+
+#endif
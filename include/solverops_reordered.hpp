@@ -0,0 +1,102 @@
+/** \file
+ * \brief Preconditioning and relaxation in a bandwidth-reducing ordering of the matrix
+ * \author Aditya Kashi
+ *
+ * Matrices from unstructured meshes often come in orderings in which coupled (block-)rows are far
+ * apart. Symmetrically reordering the matrix improves the cache reuse of all sweeps over it and,
+ * for asynchronous iterations, lets information travel along the ordering faster.
+ */
+
+#ifndef BLASTED_SOLVEROPS_REORDERED_H
+#define BLASTED_SOLVEROPS_REORDERED_H
+
+#include <functional>
+#include <memory>
+#include "solverops_base.hpp"
+#include "reorderingscaling.hpp"
+
+namespace blasted {
+
+/// Applies any preconditioner or relaxation to a symmetrically reordered copy of the matrix
+/** The ordering is computed from the block pattern, and the reordered pattern is built, only once
+ * per sparsity pattern; the ordering is shared among instances having the same pattern. Each
+ * \ref compute copies the values into the reordered matrix and recomputes the wrapped operator.
+ * The input and output vectors are in the original ordering; they are permuted on the way in and
+ * out by parallel passes that gather or scatter whole block-rows, the input and the initial
+ * output being gathered together.
+ */
+template <typename scalar, typename index>
+class ReorderedPreconditioner : public SRPreconditioner<scalar,index>
+{
+public:
+	/// Creates the wrapped operator from a view of the reordered matrix
+	using InnerCreator = std::function<SRPreconditioner<scalar,index>*
+	                                   (SRMatrixStorage<const scalar,const index>&&)>;
+
+	/// Reorders the pattern of the matrix and creates the wrapped operator
+	/** \param block_size Size of the dense blocks of the matrix
+	 * \param ordering The ordering to use; must not be NATURAL_ORDERING
+	 * \param create_inner Called once, from this constructor, to create the wrapped operator
+	 */
+	ReorderedPreconditioner(SRMatrixStorage<const scalar,const index>&& matrix, const int block_size,
+	                        const GraphOrdering ordering, const InnerCreator& create_inner);
+
+	~ReorderedPreconditioner();
+
+	/// Returns the number of rows of the operator
+	index dim() const { return mat.nbrows*bs; }
+
+	/// Relaxation is available if it is available from the wrapped operator
+	bool relaxationAvailable() const { return inner->relaxationAvailable(); }
+
+	/// Copies the values into the reordered matrix and computes the wrapped operator
+	PrecInfo compute();
+
+	/// Applies the wrapped preconditioner in the reordered space
+	void apply(const scalar *const r, scalar *const __restrict z) const;
+
+	/// Applies the wrapped preconditioner to all vectors at once in the reordered space
+	void apply_multi(const int nvecs, const scalar *const x, scalar *const __restrict y) const;
+
+	/// Carries out the wrapped relaxation in the reordered space
+	void apply_relax(const scalar *const b, scalar *const __restrict x) const;
+
+	/// The ordering: block-row i of the reordered matrix is block-row ordering()[i] of the original
+	const std::vector<index>& ordering() const { return *ord; }
+
+protected:
+	using Preconditioner<scalar,index>::solveparams;
+	using SRPreconditioner<scalar,index>::mat;
+
+	const int bs;                        ///< Block size
+
+	/// The new ordering, shared among instances having the same sparsity pattern
+	std::shared_ptr<const std::vector<index>> ord;
+
+	/// The reordered matrix
+	SRMatrixStorage<scalar,index> rmat;
+
+	/// For each non-zero block of \ref rmat, its location in the original matrix
+	std::vector<index> origloc;
+
+	/// The operator applied to the reordered matrix
+	std::unique_ptr<SRPreconditioner<scalar,index>> inner;
+
+	/// Wall-clock time spent on structure in the constructor, reported by the first \ref compute
+	double structtime;
+
+	/// Temporary storage for the input vector in the reordered space
+	scalar *rtemp;
+	/// Temporary storage for the output vector in the reordered space
+	scalar *ztemp;
+
+	/// Temporary storage for the input multivector in the reordered space, grown on demand
+	mutable scalar *rmulti = nullptr;
+	/// Temporary storage for the output multivector in the reordered space, grown on demand
+	mutable scalar *zmulti = nullptr;
+	mutable int nmultivecs = 0;          ///< Number of vectors \ref rmulti and \ref zmulti can hold
+};
+
+}
+
+#endif
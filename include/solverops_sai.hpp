@@ -1,21 +1,26 @@
 /** \file
  * \brief Sparse approximate inverse preconditioner
+ * \author Aditya Kashi
  */
 
 #ifndef BLASTED_SOLVEROPS_SAI_H
 #define BLASTED_SOLVEROPS_SAI_H
 
+#include <memory>
 #include "solverops_base.hpp"
 
 namespace blasted {
 
-/// Data needed for SAI computations
-template <typename scalar, typename index>
-struct LeftSAIImpl;
+template <typename index>
+struct LeftSAIPattern;
 
 /// A block SAI(1) preconditioner
 /** Left sparse approximate inverse with static sparsity pattern corresponding to the sparsity
- * pattern of the original matrix.
+ * pattern of the original matrix. The approximate inverse is stored in its own compact sparse-row
+ * matrix, so that application is a single parallel sparse matrix-vector product.
+ *
+ * The assembly pattern of the least-squares problems depends only on the pattern of the matrix
+ * and is shared among instances having the same pattern \sa StructuralCache
  */
 template <typename scalar, typename index, int bs, StorageOptions stor>
 class LeftSAIPreconditioner : public SRPreconditioner<scalar,index>
@@ -23,22 +28,44 @@ class LeftSAIPreconditioner : public SRPreconditioner<scalar,index>
 	static_assert(bs > 0, "Block size must be positive!");
 	static_assert(stor == RowMajor || stor == ColMajor, "Invalid storage option!");
 public:
-	LeftSAIPreconditioner(SRMatrixStorage<const scalar, const index>&& matrix);
+	/** \param full_sai Set to true for a least-squares SAI, false for an incomplete SAI
+	 * \param thread_chunk_size Number of (block-)rows given to a thread at a time when computing
+	 */
+	LeftSAIPreconditioner(SRMatrixStorage<const scalar, const index>&& matrix, const bool full_sai,
+	                      const int thread_chunk_size);
+
+	/// Returns the number of rows of the operator
+	index dim() const { return mat.nbrows*bs; }
 
 	bool relaxationAvailable() const { return false; }
 
 	/// Compute the approximate inverse
+	/** The pattern is set up the first time; the sparsity pattern of the matrix is assumed not to
+	 * change after that.
+	 */
 	PrecInfo compute();
 
 	/// To apply the preconditioner
 	void apply(const scalar *const x, scalar *const __restrict y) const;
 
+	/// Applies the approximate inverse to several row-interleaved vectors at once
+	void apply_multi(const int nvecs, const scalar *const x, scalar *const __restrict y) const;
+
 	/// To apply relaxation - not available; throws an exception
 	void apply_relax(const scalar *const x, scalar *const __restrict y) const;
 
 protected:
-	/// SAI preprocessing data
-	LeftSAIImpl<scalar,index> impl;
+	using SRPreconditioner<scalar,index>::mat;
+	using SRPreconditioner<scalar,index>::pmat;
+
+	const bool fullsai;                     ///< Whether to compute a SAI or an incomplete SAI
+	const int threadchunksize;              ///< Number of rows given to a thread at a time
+
+	/// Pattern of the least-squares problems, shared among instances having the same pattern
+	std::shared_ptr<const LeftSAIPattern<index>> saipatt;
+
+	/// The sparse approximate inverse
+	SRMatrixStorage<scalar,index> sai;
 };
 
 }
@@ -0,0 +1,118 @@
+/** \file solverops_sell.hpp
+ * \brief Scalar Jacobi and asynchronous SGS operations using SELL-C-sigma storage
+ * \author Aditya Kashi
+ */
+
+#ifndef BLASTED_SOLVEROPS_SELL_H
+#define BLASTED_SOLVEROPS_SELL_H
+
+#include "solverops_sgs.hpp"
+#include "sellmatrixdefs.hpp"
+
+namespace blasted {
+
+/// Scalar Jacobi operator whose relaxation works on a SELL-C-sigma copy of the matrix
+/** The preconditioning operation is the same as for \ref JacobiSRPreconditioner; the relaxation
+ * computes the residual of C rows at a time.
+ * \tparam C Chunk height of the SELL-C-sigma storage, usually the SIMD width for the scalar type
+ */
+template <typename scalar, typename index, int C>
+class SELLJacobiPreconditioner : public JacobiSRPreconditioner<scalar,index>
+{
+public:
+	/// Create the Jacobi operator
+	/** \param sort_scope Sorting scope (sigma) of the SELL-C-sigma storage, a multiple of C
+	 */
+	SELLJacobiPreconditioner(SRMatrixStorage<const scalar, const index>&& matrix,
+	                         const int sort_scope);
+
+	/// Compute the inverse diagonal and the SELL copy of the matrix
+	PrecInfo compute();
+
+	/// Carry out a relaxation solve
+	void apply_relax(const scalar *const x, scalar *const __restrict y) const;
+
+protected:
+	using Preconditioner<scalar,index>::solveparams;
+	using SRPreconditioner<scalar,index>::mat;
+	using JacobiSRPreconditioner<scalar,index>::dblocks;
+
+	const int sigma;                          ///< Sorting scope
+
+	SELLMatrixStorage<scalar,index> smat;     ///< The full matrix in SELL-C-sigma storage
+	CRawSELLMatrix<scalar,index> rsmat;       ///< View of \ref smat
+};
+
+/// Asynchronous scalar SGS operator whose sweeps work on SELL-C-sigma copies of the matrix
+/** The strictly lower and strictly upper triangular parts are stored separately. Rows belonging to
+ * the same chunk are updated together (Jacobi-wise), while the chunks are processed asynchronously
+ * like the rows of \ref AsyncSGS_SRPreconditioner.
+ * \tparam C Chunk height of the SELL-C-sigma storage, usually the SIMD width for the scalar type
+ */
+template <typename scalar, typename index, int C>
+class AsyncSGS_SELLPreconditioner : public AsyncSGS_SRPreconditioner<scalar,index>
+{
+public:
+	/// Create asynchronous scalar SGS preconditioner
+	/** \param napplysweeps Number of asynchronous application sweeps (ignored for relaxation)
+	 * \param apply_inittype Type of initialization to use for temporary and output vectors
+	 *   (ignored for relaxation)
+	 * \param threadchunksize Number of rows assigned to a thread at a time
+	 * \param sort_scope Sorting scope (sigma) of the SELL-C-sigma storage, a multiple of C
+	 * \param relaxation Whether the operator is to be used for relaxation; only then is a SELL copy
+	 *   of the full matrix set up by \ref compute
+	 */
+	AsyncSGS_SELLPreconditioner(SRMatrixStorage<const scalar, const index>&& matrix,
+	                            const int napplysweeps, const ApplyInit apply_inittype,
+	                            const int threadchunksize, const int sort_scope,
+	                            const bool relaxation = false);
+
+	/// Relaxation is available only if requested on construction
+	bool relaxationAvailable() const { return relaxation; }
+
+	/// Compute the inverse diagonal and the SELL copies of the triangular parts of the matrix
+	/** The SELL copy of the full matrix is also computed if relaxation was requested.
+	 */
+	PrecInfo compute();
+
+	/// To apply the preconditioner
+	void apply(const scalar *const x, scalar *const __restrict y) const;
+
+	/// Applies the preconditioner to one vector at a time \sa Preconditioner::apply_multi
+	void apply_multi(const int nvecs, const scalar *const x, scalar *const __restrict y) const
+	{ Preconditioner<scalar,index>::apply_multi(nvecs, x, y); }
+
+	/// Carry out a relaxation solve
+	/** Throws std::runtime_error if relaxation was not requested on construction.
+	 */
+	void apply_relax(const scalar *const x, scalar *const __restrict y) const;
+
+protected:
+	using Preconditioner<scalar,index>::solveparams;
+	using SRPreconditioner<scalar,index>::mat;
+	using JacobiSRPreconditioner<scalar,index>::dblocks;
+	using AsyncSGS_SRPreconditioner<scalar,index>::ytemp;
+	using AsyncSGS_SRPreconditioner<scalar,index>::napplysweeps;
+	using AsyncSGS_SRPreconditioner<scalar,index>::ainit;
+	using AsyncSGS_SRPreconditioner<scalar,index>::thread_chunk_size;
+
+	const int sigma;                          ///< Sorting scope
+
+	SELLMatrixStorage<scalar,index> lmat;     ///< Strictly lower triangular part
+	SELLMatrixStorage<scalar,index> umat;     ///< Strictly upper triangular part
+	CRawSELLMatrix<scalar,index> rlmat;       ///< View of \ref lmat
+	CRawSELLMatrix<scalar,index> rumat;       ///< View of \ref umat
+
+	const bool relaxation;                    ///< Whether relaxation is to be available
+
+	/// The full matrix, for relaxation; only set up if \ref relaxation is true
+	SELLMatrixStorage<scalar,index> fmat;
+	CRawSELLMatrix<scalar,index> rfmat;       ///< View of \ref fmat
+
+	/// Number of chunks assigned to a thread at a time
+	int chunks_per_task() const { return std::max(1, thread_chunk_size/C); }
+};
+
+}
+
+#endif
@@ -9,6 +9,8 @@
 #include "async_initialization_decl.hpp"
 #include "solverops_jacobi.hpp"
 #include "scmatrixdefs.hpp"
+#include "cimatrixdefs.hpp"
+#include "async_sweeps.hpp"
 
 namespace blasted {
 
@@ -31,13 +33,28 @@ public:
 	 * \param apply_inittype Type of initialization to use for temporary and output vectors
 	 *   (ignored for relaxation)
 	 * \param threadchunksize Number of iterations assigned to a thread at a time
+	 * \param compressed_colind Whether the sweeps should use 16-bit compressed column indices
+	 *   \sa CompressedColumnIndex
 	 */
 	AsyncBlockSGS_SRPreconditioner(SRMatrixStorage<const scalar, const index>&& matrix,
 	                               const int napplysweeps, const ApplyInit apply_inittype,
-	                               const int threadchunksize);
+	                               const int threadchunksize, const bool compressed_colind = false);
 
 	~AsyncBlockSGS_SRPreconditioner();
 
+	/// Enables block-asynchronous sweeps over cache-sized tiles of block-rows \sa AsyncSweepEngine
+	/** Applies to both preconditioning and relaxation. The number of apply sweeps (or relaxation
+	 * iterations) then counts passes over all the tiles, each of which carries out the inner sweeps.
+	 * \param cachebytes Amount of cache the matrix data of a tile should fit in; 0 (the default)
+	 *   disables tiling
+	 * \param innersweeps Number of local sweeps over a tile each time it is visited
+	 */
+	void setSweepTiling(const size_t cachebytes, const int innersweeps)
+	{
+		tilecachebytes = cachebytes;
+		tiling.innersweeps = innersweeps;
+	}
+
 	/// Returns the number of rows of the operator
 	index dim() const { return mat.nbrows*bs; }
 
@@ -49,12 +66,18 @@ public:
 	/// To apply the preconditioner
 	void apply(const scalar *const x, scalar *const __restrict y) const;
 
+	/// To apply the preconditioner to several row-interleaved vectors at once
+	/** The result of the forward sweep always starts from zero.
+	 */
+	void apply_multi(const int nvecs, const scalar *const x, scalar *const __restrict y) const;
+
 	/// Carry out a relaxation solve
 	void apply_relax(const scalar *const x, scalar *const __restrict y) const;
 
 protected:
 	using Preconditioner<scalar,index>::solveparams;
 	using SRPreconditioner<scalar,index>::mat;
+	using SRPreconditioner<scalar,index>::numasched;
 	using BJacobiSRPreconditioner<scalar,index,bs,stor>::dblocks;
 
 	using Blk = Block_t<scalar,bs,stor>;
@@ -63,9 +86,20 @@ protected:
 	/// Temporary storage for the result of the forward Gauss-Seidel sweep
 	mutable scalar *ytemp;
 
+	/// Temporary storage for the forward sweeps on several vectors, grown on demand
+	mutable scalar *ymulti = nullptr;
+	mutable int nymultivecs = 0;                     ///< Number of vectors \ref ymulti can hold
+
 	const int napplysweeps;
 	const ApplyInit ainit;
 	const int thread_chunk_size;
+
+	size_t tilecachebytes = 0;                       ///< Cache size for tiles \sa setSweepTiling
+	SweepTiling<index> tiling;                       ///< Tiles of the sweeps, set up in compute
+
+	const bool usecompressedind;                     ///< Whether to use compressed column indices
+	CompressedColumnIndex<index> cind;               ///< Compressed column indices of \ref mat
+	CRawCompressedColumnIndex<index> rcind;          ///< View of \ref cind
 };
 
 /// Asynchronous scalar SGS operator for sparse-row matrices
@@ -78,13 +112,28 @@ public:
 	 * \param apply_inittype Type of initialization to use for temporary and output vectors
 	 *   (ignored for relaxation)
 	 * \param threadchunksize Number of iterations assigned to a thread at a time
+	 * \param compressed_colind Whether the sweeps should use 16-bit compressed column indices
+	 *   \sa CompressedColumnIndex
 	 */
 	AsyncSGS_SRPreconditioner(SRMatrixStorage<const scalar, const index>&& matrix,
 	                          const int napplysweeps, const ApplyInit apply_inittype,
-	                          const int threadchunksize);
+	                          const int threadchunksize, const bool compressed_colind = false);
 
 	~AsyncSGS_SRPreconditioner();
 
+	/// Enables block-asynchronous sweeps over cache-sized tiles of rows \sa AsyncSweepEngine
+	/** Applies to both preconditioning and relaxation. The number of apply sweeps (or relaxation
+	 * iterations) then counts passes over all the tiles, each of which carries out the inner sweeps.
+	 * \param cachebytes Amount of cache the matrix data of a tile should fit in; 0 (the default)
+	 *   disables tiling
+	 * \param innersweeps Number of local sweeps over a tile each time it is visited
+	 */
+	void setSweepTiling(const size_t cachebytes, const int innersweeps)
+	{
+		tilecachebytes = cachebytes;
+		tiling.innersweeps = innersweeps;
+	}
+
 	/// Returns the number of rows
 	index dim() const { return mat.nbrows; }
 
@@ -96,20 +145,37 @@ public:
 	/// To apply the preconditioner
 	void apply(const scalar *const x, scalar *const __restrict y) const;
 
+	/// To apply the preconditioner to several row-interleaved vectors at once
+	/** The result of the forward sweep always starts from zero.
+	 */
+	void apply_multi(const int nvecs, const scalar *const x, scalar *const __restrict y) const;
+
 	/// Carry out a relaxation solve
 	void apply_relax(const scalar *const x, scalar *const __restrict y) const;
 
 protected:
 	using Preconditioner<scalar,index>::solveparams;
 	using SRPreconditioner<scalar,index>::mat;
+	using SRPreconditioner<scalar,index>::numasched;
 	using JacobiSRPreconditioner<scalar,index>::dblocks;
 	
 	/// Temporary storage for the result of the forward Gauss-Seidel sweep
 	mutable scalar *ytemp;
 
+	/// Temporary storage for the forward sweeps on several vectors, grown on demand
+	mutable scalar *ymulti = nullptr;
+	mutable int nymultivecs = 0;                     ///< Number of vectors \ref ymulti can hold
+
 	const int napplysweeps;
 	const ApplyInit ainit;
 	const int thread_chunk_size;
+
+	size_t tilecachebytes = 0;                       ///< Cache size for tiles \sa setSweepTiling
+	SweepTiling<index> tiling;                       ///< Tiles of the sweeps, set up in compute
+
+	const bool usecompressedind;                     ///< Whether to use compressed column indices
+	CompressedColumnIndex<index> cind;               ///< Compressed column indices of \ref mat
+	CRawCompressedColumnIndex<index> rcind;          ///< View of \ref cind
 };
 
 /// Backward Gauss-Seidel preconditioner applied column-wise
@@ -135,6 +201,10 @@ public:
 	PrecInfo compute();
 	void apply(const scalar *const x, scalar *const __restrict y) const;
 
+	/// Applies the preconditioner to one vector at a time \sa Preconditioner::apply_multi
+	void apply_multi(const int nvecs, const scalar *const x, scalar *const __restrict y) const
+	{ Preconditioner<scalar,index>::apply_multi(nvecs, x, y); }
+
 	/// Does nothing but throw an exception
 	void apply_relax(const scalar *const x, scalar *const __restrict y) const;
 
@@ -6,16 +6,25 @@
 #ifndef BLASTED_SGS_SAI_H
 #define BLASTED_SGS_SAI_H
 
+#include <memory>
 #include "solverops_base.hpp"
-#include "sai.hpp"
 
 namespace blasted {
 
+template <typename index>
+struct TriangularSAIPattern;
+
 /// Block SGS preconditioner applied by (incomplete) sparse approximate inverse
-/** The sparsity pattern of the approximate inverse is the same as the original matrix.
+/** The SGS preconditioner is \f$ M = (D+L) D^{-1} (D+U) \f$. The inverses of the triangular
+ * factors D+L and D+U are replaced by approximate inverses having their sparsity patterns.
  * We use the left approximate inverse as it is easy to implement for CSR-stored matrices. That is,
- * we compute \f$ \min_{m_k} \lVert m_k^T A - e_k^T \rVert_2 = \min_{m_k} \lVert A^T m_k - e_k \rVert_2 \f$
- * for each column k of the approximate inverse M.
+ * we compute \f$ \min_{m_k} \lVert m_k^T T - e_k^T \rVert_2 = \min_{m_k} \lVert T^T m_k - e_k \rVert_2 \f$
+ * for each row k of the approximate inverse of a triangular factor T.
+ *
+ * The approximate inverses are stored in their own compact sparse-row matrices, and the diagonal
+ * (blocks) D is folded into the columns of that of D+U, so that application is exactly two
+ * parallel sparse matrix-vector products. The assembly patterns are shared among instances having
+ * the same pattern \sa StructuralCache
  */
 template <typename scalar, typename index, int bs, StorageOptions stopt>
 class BSGS_SAI : public SRPreconditioner<scalar,index>
@@ -24,7 +33,11 @@ class BSGS_SAI : public SRPreconditioner<scalar,index>
 	static_assert(stopt == RowMajor || stopt == ColMajor, "Invalid storage option!");
 
 public:
-	BSGS_SAI(const bool full_spai);
+	/** \param full_sai Set to true for least-squares SAIs, false for incomplete SAIs
+	 * \param thread_chunk_size Number of (block-)rows given to a thread at a time when computing
+	 */
+	BSGS_SAI(SRMatrixStorage<const scalar, const index>&& matrix, const bool full_sai,
+	         const int thread_chunk_size);
 
 	~BSGS_SAI();
 
@@ -32,53 +45,40 @@ public:
 	index dim() const { return mat.nbrows*bs; }
 
 	bool relaxationAvailable() const { return false; }
-	
+
 	/// Compute the preconditioner
-	void compute();
+	/** The patterns are set up the first time; the sparsity pattern of the matrix is assumed not to
+	 * change after that.
+	 */
+	PrecInfo compute();
 
 	/// To apply the preconditioner
 	void apply(const scalar *const x, scalar *const __restrict y) const;
 
-	/// Carry out a relaxation solve
+	/// Applies the preconditioner to several row-interleaved vectors at once
+	void apply_multi(const int nvecs, const scalar *const x, scalar *const __restrict y) const;
+
+	/// Relaxation is not available; throws an exception
 	void apply_relax(const scalar *const x, scalar *const __restrict y) const;
 
 protected:
-	
-	using Blk = Block_t<scalar,bs,stopt>;
-	using Seg = Segment_t<scalar,bs>;
 	using SRPreconditioner<scalar,index>::mat;
-	using Preconditioner<scalar,index>::solveparams;
 
-	const bool fullsai;
+	const bool fullsai;                     ///< Whether to compute SAIs or incomplete SAIs
+	const int threadchunksize;              ///< Number of rows given to a thread at a time
 
-	LeftSAIPattern<index> saipattern;
+	/// Patterns of the least-squares problems, shared among instances having the same pattern
+	std::shared_ptr<const TriangularSAIPattern<index>> saipatt;
 
-	RawBSRMatrix<scalar,index> saiL;
-	RawBSRMatrix<scalar,index> saiU;
+	SRMatrixStorage<scalar,index> saiL;     ///< Approximate inverse of D+L
+	SRMatrixStorage<scalar,index> saiU;     ///< Approximate inverse of D+U, times D
 
-	using LMatrix = Matrix<scalar,Dynamic,Dynamic,ColMajor>;
+	/// Temporary storage for the result of application of the approximate inverse of D+L
+	scalar *ytemp;
 
-	/// Sets up data structures the first time
-	/** Computes sizes of lower and upper approximate inverses and allocates storage.
-	 * Also calls \ref compute_pattern
-	 */
-	void initialize();
-
-	/// Computes the pattern of each local least-squares problem
-	void compute_pattern();
-
-	__attribute__((always_inline))
-	void compute_SAI_lower(const index col);
-	__attribute__((always_inline))
-	void compute_SAI_upper(const index col);
-	// __attribute__((always_inline))
-	// LMatrix compute_LHS_SAI_upper(const index col) const;
-	// __attribute__((always_inline))
-	// LMatrix compute_LHS_SAI_lower(const index col) const;
-	// __attribute__((always_inline))
-	// LMatrix compute_LHS_incompSAI_upper(const index col) const;
-	// __attribute__((always_inline))
-	// LMatrix compute_LHS_incompSAI_lower(const index col) const;
+	/// Temporary storage like \ref ytemp for several vectors at once, grown on demand
+	mutable scalar *ymulti = nullptr;
+	mutable int nymultivecs = 0;            ///< Number of vectors \ref ymulti can hold
 };
 
 }
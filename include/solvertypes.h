@@ -19,6 +19,14 @@ extern "C" {
 	              BLASTED_CSC_BGS,
 	              BLASTED_LEVEL_SGS,
 	              BLASTED_ASYNC_LEVEL_ILU0,
+	              BLASTED_ILUK,
+	              BLASTED_ASYNC_LEVEL_ILUK,
+	              BLASTED_PARILUT,
+	              BLASTED_MC_SGS,
+	              BLASTED_MC_ILU0,
+	              BLASTED_SAI,
+	              BLASTED_SGS_SAI,
+	              BLASTED_CHEBYSHEV,
 	              BLASTED_NO_PREC,
 	              BLASTED_EXTERNAL
 	} BlastedSolverType;
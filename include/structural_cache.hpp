@@ -0,0 +1,155 @@
+/** \file structural_cache.hpp
+ * \brief Process-wide cache of data derived from the sparsity pattern of matrices
+ * \author Aditya Kashi
+ *
+ * Preconditioners often need auxiliary structures that depend only on the non-zero pattern of the
+ * matrix, such as the positions needed for ILU factorization or level schedules. When several
+ * preconditioner instances are created for matrices having the same pattern (for example, one per
+ * block of a field-split, or one per stage of a multi-stage solver), these are shared through this
+ * cache instead of being recomputed and stored by each instance. Patterns are identified by a
+ * fingerprint computed from the row pointers, column indices and block size.
+ *
+ * Entries are held weakly: a structure lives as long as some preconditioner uses it.
+ */
+
+#ifndef BLASTED_STRUCTURAL_CACHE_H
+#define BLASTED_STRUCTURAL_CACHE_H
+
+#include <cstdint>
+#include <string>
+#include <memory>
+#include <new>
+#include <map>
+#include <mutex>
+#include <tuple>
+#include <typeindex>
+#include <boost/align/aligned_alloc.hpp>
+#include "srmatrixdefs.hpp"
+
+namespace blasted {
+
+/// Identifies the non-zero structure of a sparse-row matrix
+/** Two independent 64-bit hashes of the pattern are used, so accidental collisions are not a
+ * practical concern.
+ */
+struct PatternFingerprint
+{
+	std::uint64_t hash1;      ///< FNV-1a hash of the pattern
+	std::uint64_t hash2;      ///< Multiplicative hash of the pattern with a different mixing
+	long nbrows;              ///< Number of (block-)rows
+	long nnzb;                ///< Number of stored (block-)non-zeros
+	int bs;                   ///< Block size
+
+	bool operator<(const PatternFingerprint& o) const {
+		return std::tie(hash1,hash2,nbrows,nnzb,bs) < std::tie(o.hash1,o.hash2,o.nbrows,o.nnzb,o.bs);
+	}
+	bool operator==(const PatternFingerprint& o) const {
+		return hash1 == o.hash1 && hash2 == o.hash2 && nbrows == o.nbrows && nnzb == o.nnzb
+			&& bs == o.bs;
+	}
+};
+
+/// Computes the fingerprint of the non-zero pattern of a matrix
+template <typename scalar, typename index>
+PatternFingerprint pattern_fingerprint(const CRawBSRMatrix<scalar,index>& mat, const int bs)
+{
+	PatternFingerprint fp;
+	fp.nbrows = mat.nbrows;
+	fp.nnzb = mat.browptr[mat.nbrows];
+	fp.bs = bs;
+
+	std::uint64_t h1 = 14695981039346656037ULL, h2 = static_cast<std::uint64_t>(bs);
+	const auto mix = [&h1,&h2](const std::uint64_t v) {
+		h1 = (h1 ^ v) * 1099511628211ULL;
+		std::uint64_t z = h2 + v + 0x9e3779b97f4a7c15ULL;
+		z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+		z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+		h2 = z ^ (z >> 31);
+	};
+	for(index i = 0; i <= mat.nbrows; i++)
+		mix(static_cast<std::uint64_t>(mat.browptr[i]));
+	for(index j = 0; j < mat.browptr[mat.nbrows]; j++)
+		mix(static_cast<std::uint64_t>(mat.bcolind[j]));
+
+	fp.hash1 = h1;
+	fp.hash2 = h2;
+	return fp;
+}
+
+/// Cache of read-only structures computed from sparsity patterns, and of buffers tied to operators
+/** Use \ref structural_cache to access the process-wide instance. All member functions are
+ * thread-safe; builders are run without holding the lock, so two threads asking for the same
+ * missing entry at the same time may both build it, but only one copy is retained.
+ */
+class StructuralCache
+{
+public:
+	/// Returns the structure of type T and kind 'kind' for a pattern, building it if needed
+	/** \param kind Name distinguishing different structures of the same type
+	 * \param fp Fingerprint of the pattern
+	 * \param build Callable, taking no arguments, that returns the structure as a T
+	 */
+	template <typename T, typename Builder>
+	std::shared_ptr<const T> structure(const std::string& kind, const PatternFingerprint& fp,
+	                                   Builder&& build)
+	{
+		const Key key{std::type_index(typeid(T)), kind, fp, nullptr};
+		if(std::shared_ptr<void> p = find(key))
+			return std::static_pointer_cast<const T>(p);
+
+		const std::shared_ptr<void> newp = std::make_shared<T>(build());
+		return std::static_pointer_cast<const T>(insert(key, newp));
+	}
+
+	/// Returns an aligned array of n entries of type T associated with one operator
+	/** The operator is identified by its pattern and the address of its values. The contents of the
+	 * array are left to the users; it is meant for data such as inverted diagonal blocks that all
+	 * instances wrapping the same operator compute identically.
+	 * \param tag A type distinguishing different layouts of the same data (eg. the block type)
+	 * \param[out] created True if the array was newly allocated, false if it was already in use
+	 */
+	template <typename tag, typename T>
+	std::shared_ptr<T> operator_buffer(const std::string& kind, const PatternFingerprint& fp,
+	                                   const void *const vals, const size_t n, bool& created)
+	{
+		const Key key{std::type_index(typeid(tag)), kind, fp, vals};
+		if(std::shared_ptr<void> p = find(key)) {
+			created = false;
+			return std::static_pointer_cast<T>(p);
+		}
+
+		const std::shared_ptr<T> newp(
+			static_cast<T*>(boost::alignment::aligned_alloc(CACHE_LINE_LEN, n*sizeof(T))),
+			[](T *const ptr) { boost::alignment::aligned_free(ptr); });
+		if(!newp)
+			throw std::bad_alloc();
+		const std::shared_ptr<void> p = insert(key, newp);
+		created = (p == newp);
+		return std::static_pointer_cast<T>(p);
+	}
+
+	/// Number of entries currently alive
+	size_t size() const;
+
+protected:
+	/// Type of the entry, kind, pattern and optionally the address of the operator's values
+	typedef std::tuple<std::type_index, std::string, PatternFingerprint, const void*> Key;
+
+	mutable std::mutex mtx;
+	std::map<Key, std::weak_ptr<void>> entries;
+
+	/// Returns the live entry for a key, or null
+	std::shared_ptr<void> find(const Key& key);
+
+	/// Inserts an entry unless a live one already exists, and returns the live one
+	/** Expired entries are purged.
+	 */
+	std::shared_ptr<void> insert(const Key& key, const std::shared_ptr<void>& p);
+};
+
+/// The process-wide structural cache
+StructuralCache& structural_cache();
+
+}
+
+#endif
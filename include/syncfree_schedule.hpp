@@ -0,0 +1,133 @@
+/** \file syncfree_schedule.hpp
+ * \brief Synchronization-free processing of rows in dependency order
+ * \author Aditya Kashi
+ *
+ * Triangular operations such as the ILU factorization and triangular solves process each row using
+ * results of some previous (or, for the upper factor, subsequent) rows. Instead of grouping rows
+ * into levels separated by barriers, each row here waits only for the rows it actually depends on,
+ * by spinning on per-row completion counters. Rows are handed to threads in order, which the
+ * monotonic schedule modifier guarantees, so a row's dependencies have always been handed out
+ * before it, and processing cannot deadlock.
+ */
+
+#ifndef BLASTED_SYNCFREE_SCHEDULE_H
+#define BLASTED_SYNCFREE_SCHEDULE_H
+
+#include <atomic>
+#include <memory>
+#include <vector>
+#include "srmatrixdefs.hpp"
+
+namespace blasted {
+
+/// Processes the rows of a triangular operation, each as soon as its dependencies are complete
+/** The dependencies of a row are given by the column indices of a matrix: for a forward operation,
+ * those of the strictly lower triangular part, and for a backward operation, those of the strictly
+ * upper triangular part. Completion is recorded by setting a row's counter to the number of the
+ * current operation, so the counters never need to be reset.
+ *
+ * The functions \ref forward and \ref backward must be called by all threads of a team (or outside
+ * any parallel region, in which case they are ordinary sequential loops). Only one operation may
+ * use a schedule at a time.
+ */
+template <typename index>
+class SyncFreeSchedule
+{
+public:
+	/// Sets up completion counters for a number of rows
+	/** \param nrows Number of (block-)rows
+	 * \param chunksize Number of consecutive rows handed to a thread at a time
+	 */
+	SyncFreeSchedule(const index nrows, const int chunksize)
+		: n{nrows}, chunk{chunksize}, done{new std::atomic<int>[nrows]}, epoch{0}
+	{
+		for(index i = 0; i < n; i++)
+			done[i].store(0, std::memory_order_relaxed);
+	}
+
+	/// Calls body(irow) for all rows in increasing order of dependency
+	/** A row is processed after all rows in the columns of its strictly lower triangular part.
+	 * All rows are complete on return.
+	 */
+	template <typename scalar, typename F>
+	void forward(const CRawBSRMatrix<scalar,index>& mat, F&& body) const
+	{
+		const int target = next_epoch();
+#pragma omp for schedule(monotonic:dynamic, chunk)
+		for(index irow = 0; irow < n; irow++)
+		{
+			for(index j = mat.browptr[irow]; j < mat.diagind[irow]; j++)
+				wait_for(mat.bcolind[j], target);
+			body(irow);
+			done[irow].store(target, std::memory_order_release);
+		}
+	}
+
+	/// Calls body(irow) for some rows in increasing order of dependency
+	/** Only dependencies on rows that are processed here are waited for; other rows are taken to be
+	 * complete already.
+	 * \param rows The rows to process, in increasing order
+	 * \param active Flags for all rows, non-zero for those in rows
+	 */
+	template <typename scalar, typename F>
+	void forward(const CRawBSRMatrix<scalar,index>& mat, const std::vector<index>& rows,
+	             const std::vector<char>& active, F&& body) const
+	{
+		const int target = next_epoch();
+		const index nrows = static_cast<index>(rows.size());
+#pragma omp for schedule(monotonic:dynamic, chunk)
+		for(index i = 0; i < nrows; i++)
+		{
+			const index irow = rows[i];
+			for(index j = mat.browptr[irow]; j < mat.diagind[irow]; j++)
+				if(active[mat.bcolind[j]])
+					wait_for(mat.bcolind[j], target);
+			body(irow);
+			done[irow].store(target, std::memory_order_release);
+		}
+	}
+
+	/// Calls body(irow) for all rows in decreasing order of dependency
+	/** A row is processed after all rows in the columns of its strictly upper triangular part.
+	 * All rows are complete on return.
+	 */
+	template <typename scalar, typename F>
+	void backward(const CRawBSRMatrix<scalar,index>& mat, F&& body) const
+	{
+		const int target = next_epoch();
+#pragma omp for schedule(monotonic:dynamic, chunk)
+		for(index i = 0; i < n; i++)
+		{
+			const index irow = n-1-i;
+			for(index j = mat.diagind[irow]+1; j < mat.browptr[irow+1]; j++)
+				wait_for(mat.bcolind[j], target);
+			body(irow);
+			done[irow].store(target, std::memory_order_release);
+		}
+	}
+
+protected:
+	const index n;                             ///< Number of rows
+	const int chunk;                           ///< Number of rows handed to a thread at a time
+	std::unique_ptr<std::atomic<int>[]> done;  ///< Number of the last operation completing each row
+	mutable int epoch;                         ///< Number of the current operation
+
+	/// Starts a new operation; called by all threads
+	int next_epoch() const
+	{
+#pragma omp single
+		epoch++;
+		return epoch;
+	}
+
+	/// Spins until a row is complete in the current operation
+	void wait_for(const index row, const int target) const
+	{
+		while(done[row].load(std::memory_order_acquire) < target)
+			;
+	}
+};
+
+}
+
+#endif
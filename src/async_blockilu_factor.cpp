@@ -38,17 +38,29 @@ static void fact_init_sgs(const CRawBSRMatrix<scalar,index> *const mat, const sc
                           scalar *const __restrict iluvals);
 
 /// Carry out the nonlinear asynchronous iterations to compute the ILU factors
+/** \param buildtol If positive, the sweeps are synchronized and stop once the ILU remainder,
+ *   estimated during each sweep, falls below this fraction of its value in the first sweep.
+ * \param tiling Tiles for block-asynchronous sweeps, used only for a fixed number of sweeps
+ * \param[in,out] pivinv Inverses of the diagonal blocks of U, initially those of the initial factors;
+ *   updated whenever a diagonal block is
+ * \return The number of sweeps carried out
+ */
 template <typename scalar, typename index, int bs, StorageOptions stor, bool usescaling>
-void async_bilu0_sweeps(const CRawBSRMatrix<scalar,index> *const mat, const ILUPositions<index>& plist,
-                        const scalar *const scale, const int nbuildsweeps, const int thread_chunk_size,
-                        const bool usethreads, scalar *const __restrict iluvals);
+int async_bilu0_sweeps(const CRawBSRMatrix<scalar,index> *const mat, const ILUPositions<index>& plist,
+                       const scalar *const scale, const int nbuildsweeps, const scalar buildtol,
+                       const int thread_chunk_size, const bool usethreads,
+                       const SweepTiling<index>& tiling,
+                       scalar *const __restrict iluvals, Block_t<scalar,bs,stor> *const pivinv);
 
 template <typename scalar, typename index, int bs, StorageOptions stor>
 PrecInfo block_ilu0_factorize(const CRawBSRMatrix<scalar,index> *const mat,
                               const ILUPositions<index>& plist,
-                              const int nbuildsweeps, const int thread_chunk_size, const bool usethreads,
+                              const int nbuildsweeps, const scalar buildtol,
+                              const int thread_chunk_size, const bool usethreads,
                               const FactInit init_type, const bool compute_info,
-                              scalar *const __restrict iluvals, scalar *const __restrict scale)
+                              scalar *const __restrict iluvals, scalar *const __restrict scale,
+                              const SyncFreeSchedule<index> *const syncfree,
+                              const SweepTiling<index> tiling)
 {
 	//using NABlk = Block_t<scalar,bs,static_cast<StorageOptions>(stor|Eigen::DontAlign)>;
 
@@ -112,12 +124,33 @@ PrecInfo block_ilu0_factorize(const CRawBSRMatrix<scalar,index> *const mat,
 	 * it should usually be okay as we are only comparing equality later.
 	 */
 
-	if(scale)
-		async_bilu0_sweeps<scalar,index,bs,stor,true>(mat, plist, scale, nbuildsweeps,
-		                                              thread_chunk_size, usethreads, iluvals);
+	// inverses of the pivot blocks, updated along with them during the sweeps
+	Eigen::aligned_allocator<Blk> alloc;
+	Blk *const pivinv = alloc.allocate(mat->nbrows);
+#pragma omp parallel for default(shared)
+	for(index irow = 0; irow < mat->nbrows; irow++)
+		kernels::block_invert<scalar,bs,stor>(ilu[mat->diagind[irow]], pivinv[irow]);
+
+	if(syncfree) {
+#pragma omp parallel default(shared) if(usethreads)
+		syncfree->forward(*mat, [&](const index irow) {
+			if(scale)
+				async_block_ilu0_factorize<scalar,index,bs,stor,true>(mat, mvals, plist, scale, irow,
+				                                                      ilu, pivinv);
+			else
+				async_block_ilu0_factorize<scalar,index,bs,stor,false>(mat, mvals, plist, scale, irow,
+				                                                       ilu, pivinv);
+		});
+		pinfo.build_sweeps = 1;
+	}
+	else if(scale)
+		pinfo.build_sweeps = async_bilu0_sweeps<scalar,index,bs,stor,true>
+			(mat, plist, scale, nbuildsweeps, buildtol, thread_chunk_size, usethreads, tiling,
+			 iluvals, pivinv);
 	else
-		async_bilu0_sweeps<scalar,index,bs,stor,false>(mat, plist, scale, nbuildsweeps,
-		                                               thread_chunk_size, usethreads, iluvals);
+		pinfo.build_sweeps = async_bilu0_sweeps<scalar,index,bs,stor,false>
+			(mat, plist, scale, nbuildsweeps, buildtol, thread_chunk_size, usethreads, tiling,
+			 iluvals, pivinv);
 
 	if(compute_info)
 	{
@@ -140,69 +173,417 @@ PrecInfo block_ilu0_factorize(const CRawBSRMatrix<scalar,index> *const mat,
 		pinfo.upper_min_diag_dom() = arr[3];
 	}
 
-	// invert diagonal blocks
+	// store the inverted diagonal blocks
 #pragma omp parallel for default(shared)
 	for(index irow = 0; irow < mat->nbrows; irow++)
-		ilu[mat->diagind[irow]] = ilu[mat->diagind[irow]].inverse().eval();
+		ilu[mat->diagind[irow]] = pivinv[irow];
 
+	alloc.deallocate(pivinv, mat->nbrows);
 	return pinfo;
 }
 
 template PrecInfo
 block_ilu0_factorize<double,int,4,ColMajor> (const CRawBSRMatrix<double,int> *const mat,
                                              const ILUPositions<int>& plist,
-                                             const int nbuildsweeps, const int thread_chunk_size,
+                                             const int nbuildsweeps, const double buildtol,
+                                             const int thread_chunk_size,
                                              const bool usethreads, const FactInit inittype,
                                              const bool compute_residuals,
                                              double *const __restrict iluvals,
-                                             double *const __restrict scale);
+                                             double *const __restrict scale,
+                                             const SyncFreeSchedule<int> *const syncfree,
+                                             const SweepTiling<int> tiling);
 template PrecInfo
 block_ilu0_factorize<double,int,5,ColMajor> (const CRawBSRMatrix<double,int> *const mat,
                                              const ILUPositions<int>& plist,
-                                             const int nbuildsweeps, const int thread_chunk_size,
+                                             const int nbuildsweeps, const double buildtol,
+                                             const int thread_chunk_size,
                                              const bool usethreads, const FactInit inittype,
                                              const bool compute_residuals,
                                              double *const __restrict iluvals,
-                                             double *const __restrict scale);
+                                             double *const __restrict scale,
+                                             const SyncFreeSchedule<int> *const syncfree,
+                                             const SweepTiling<int> tiling);
 template PrecInfo
 block_ilu0_factorize<double,int,4,RowMajor> (const CRawBSRMatrix<double,int> *const mat,
                                              const ILUPositions<int>& plist,
-                                             const int nbuildsweeps, const int thread_chunk_size,
+                                             const int nbuildsweeps, const double buildtol,
+                                             const int thread_chunk_size,
                                              const bool usethreads, const FactInit inittype,
                                              const bool compute_residuals,
                                              double *const __restrict iluvals,
-                                             double *const __restrict scale);
+                                             double *const __restrict scale,
+                                             const SyncFreeSchedule<int> *const syncfree,
+                                             const SweepTiling<int> tiling);
 
 #ifdef BUILD_BLOCK_SIZE
 
 template PrecInfo block_ilu0_factorize<double,int,BUILD_BLOCK_SIZE,ColMajor>
 
 (const CRawBSRMatrix<double,int> *const mat, const ILUPositions<int>& plist,
- const int nbuildsweeps, const int thread_chunk_size, const bool usethreads, const FactInit inittype,
- const bool compute_residuals, double *const __restrict iluvals, double *const __restrict scale);
+ const int nbuildsweeps, const double buildtol, const int thread_chunk_size, const bool usethreads,
+ const FactInit inittype,
+ const bool compute_residuals, double *const __restrict iluvals, double *const __restrict scale,
+ const SyncFreeSchedule<int> *const syncfree, const SweepTiling<int> tiling);
 
 #endif
 
 template <typename scalar, typename index, int bs, StorageOptions stor, bool usescaling>
-void async_bilu0_sweeps(const CRawBSRMatrix<scalar,index> *const mat, const ILUPositions<index>& plist,
-                        const scalar *const scale, const int nbuildsweeps, const int thread_chunk_size,
-                        const bool usethreads,
-                        scalar *const __restrict iluvals)
+int async_bilu0_sweeps(const CRawBSRMatrix<scalar,index> *const mat, const ILUPositions<index>& plist,
+                       const scalar *const scale, const int nbuildsweeps, const scalar buildtol,
+                       const int thread_chunk_size, const bool usethreads,
+                       const SweepTiling<index>& tiling,
+                       scalar *const __restrict iluvals, Block_t<scalar,bs,stor> *const pivinv)
 {
 	using Blk = Block_t<scalar,bs,stor>;
 	const Blk *mvals = reinterpret_cast<const Blk*>(mat->vals);
 	Blk *ilu = reinterpret_cast<Blk*>(iluvals);
 
+	if(buildtol <= 0)
+	{
+		const AsyncSweepEngine<index> eng(mat->nbrows, thread_chunk_size, nullptr, tiling);
+#pragma omp parallel default(shared) if(usethreads)
+		eng.forward(nbuildsweeps, [&](const index irow) {
+			async_block_ilu0_factorize<scalar,index,bs,stor,usescaling>(mat, mvals, plist, scale,
+			                                                            irow, ilu, pivinv);
+		});
+		return nbuildsweeps;
+	}
+
+	// Same as the scalar case: the remainder estimate is fused into the sweep
+	scalar resnorm = 0, initresnorm = 0;
+	int nsweeps = 0;
+	bool converged = false;
+
 #pragma omp parallel default(shared) if(usethreads)
 	for(int isweep = 0; isweep < nbuildsweeps; isweep++)
 	{
-#pragma omp for schedule(dynamic, thread_chunk_size) nowait
+#pragma omp for schedule(dynamic, thread_chunk_size) reduction(+:resnorm)
 		for(index irow = 0; irow < mat->nbrows; irow++)
-			async_block_ilu0_factorize<scalar,index,bs,stor,usescaling>(mat, mvals, plist, scale,
-			                                                            irow, ilu);
+			resnorm += async_block_ilu0_factorize<scalar,index,bs,stor,usescaling,true>
+				(mat, mvals, plist, scale, irow, ilu, pivinv);
+
+#pragma omp single
+		{
+			if(isweep == 0)
+				initresnorm = resnorm;
+			nsweeps = isweep+1;
+			converged = resnorm <= buildtol*initresnorm;
+			resnorm = 0;
+		}
+
+		if(converged)
+			break;
+	}
+
+	return nsweeps;
+}
+
+template <typename scalar, typename index, int bs, StorageOptions stor>
+void block_ilu0_save_state(const CRawBSRMatrix<scalar,index> *const mat, const scalar *const scale,
+                           const scalar *const iluvals,
+                           scalar *const __restrict snapshot, scalar *const __restrict pivinvs)
+{
+	using Blk = Block_t<scalar,bs,stor>;
+	const Blk *const mvals = reinterpret_cast<const Blk*>(mat->vals);
+	const Blk *const ilu = reinterpret_cast<const Blk*>(iluvals);
+	Blk *const snap = reinterpret_cast<Blk*>(snapshot);
+	Blk *const pivinv = reinterpret_cast<Blk*>(pivinvs);
+
+#pragma omp parallel for default(shared)
+	for(index irow = 0; irow < mat->nbrows; irow++)
+	{
+		for(index jj = mat->browptr[irow]; jj < mat->browptr[irow+1]; jj++) {
+			snap[jj] = mvals[jj];
+			if(scale)
+				scaleBlock<scalar,index,bs,stor>(scale, irow, mat->bcolind[jj], snap[jj]);
+		}
+		pivinv[irow] = ilu[mat->diagind[irow]];
 	}
 }
 
+template <typename scalar, typename index, int bs, StorageOptions stor>
+std::vector<index> block_ilu0_changed_rows(const CRawBSRMatrix<scalar,index> *const mat,
+                                           const scalar *const scale,
+                                           const scalar rowtol, const int deplevels,
+                                           scalar *const __restrict snapshot,
+                                           std::vector<char>& active)
+{
+	using Blk = Block_t<scalar,bs,stor>;
+	const Blk *const mvals = reinterpret_cast<const Blk*>(mat->vals);
+	Blk *const snap = reinterpret_cast<Blk*>(snapshot);
+
+	active.assign(mat->nbrows, 0);
+
+#pragma omp parallel for default(shared)
+	for(index irow = 0; irow < mat->nbrows; irow++)
+	{
+		scalar change = 0, oldnorm = 0;
+		for(index jj = mat->browptr[irow]; jj < mat->browptr[irow+1]; jj++) {
+			Blk newblk = mvals[jj];
+			if(scale)
+				scaleBlock<scalar,index,bs,stor>(scale, irow, mat->bcolind[jj], newblk);
+			change += (newblk - snap[jj]).cwiseAbs().sum();
+			oldnorm += snap[jj].cwiseAbs().sum();
+		}
+		active[irow] = change > rowtol*oldnorm;
+	}
+
+	// Rows depending on marked rows through their lower triangular part
+	if(deplevels < 0)
+	{
+		// the columns of the lower part precede the row, so one ordered pass gives the closure
+		for(index irow = 0; irow < mat->nbrows; irow++)
+			if(!active[irow])
+				for(index jj = mat->browptr[irow]; jj < mat->diagind[irow]; jj++)
+					if(active[mat->bcolind[jj]]) {
+						active[irow] = 1;
+						break;
+					}
+	}
+	else
+	{
+		std::vector<char> prev;
+		for(int ilev = 0; ilev < deplevels; ilev++)
+		{
+			prev = active;
+			bool added = false;
+#pragma omp parallel for default(shared) reduction(||:added)
+			for(index irow = 0; irow < mat->nbrows; irow++)
+			{
+				if(prev[irow])
+					continue;
+				for(index jj = mat->browptr[irow]; jj < mat->diagind[irow]; jj++)
+					if(prev[mat->bcolind[jj]]) {
+						active[irow] = 1;
+						added = true;
+						break;
+					}
+			}
+			if(!added)
+				break;
+		}
+	}
+
+	// compact the marked rows in parallel
+	std::vector<index> rowpos(mat->nbrows+1, 0);
+#pragma omp parallel for simd default(shared)
+	for(index irow = 0; irow < mat->nbrows; irow++)
+		rowpos[irow+1] = active[irow];
+	internal::inclusive_scan(rowpos);
+
+	std::vector<index> rows(rowpos[mat->nbrows]);
+#pragma omp parallel for default(shared)
+	for(index irow = 0; irow < mat->nbrows; irow++)
+		if(active[irow])
+			rows[rowpos[irow]] = irow;
+
+#pragma omp parallel for default(shared)
+	for(size_t i = 0; i < rows.size(); i++)
+	{
+		const index irow = rows[i];
+		for(index jj = mat->browptr[irow]; jj < mat->browptr[irow+1]; jj++) {
+			snap[jj] = mvals[jj];
+			if(scale)
+				scaleBlock<scalar,index,bs,stor>(scale, irow, mat->bcolind[jj], snap[jj]);
+		}
+	}
+
+	return rows;
+}
+
+template <typename scalar, typename index, int bs, StorageOptions stor>
+void block_ilu0_refactorize(const CRawBSRMatrix<scalar,index> *const mat,
+                            const ILUPositions<index>& plist,
+                            const std::vector<index>& rows, const std::vector<char>& active,
+                            const int nbuildsweeps, const int thread_chunk_size,
+                            const bool usethreads, const scalar *const scale,
+                            scalar *const __restrict iluvals, scalar *const __restrict pivinvs,
+                            const SyncFreeSchedule<index> *const syncfree)
+{
+	using Blk = Block_t<scalar,bs,stor>;
+	const Blk *const mvals = reinterpret_cast<const Blk*>(mat->vals);
+	Blk *const ilu = reinterpret_cast<Blk*>(iluvals);
+	Blk *const pivinv = reinterpret_cast<Blk*>(pivinvs);
+	const index nrows = static_cast<index>(rows.size());
+
+	// The sweeps read only the cached pivot inverses of other rows, never the diagonal blocks of
+	//  the factors, so the diagonal blocks of the rows being refactorized can temporarily hold
+	//  U while those of other rows keep their inverses.
+	if(syncfree) {
+#pragma omp parallel default(shared) if(usethreads)
+		syncfree->forward(*mat, rows, active, [&](const index irow) {
+			if(scale)
+				async_block_ilu0_factorize<scalar,index,bs,stor,true>(mat, mvals, plist, scale, irow,
+				                                                      ilu, pivinv);
+			else
+				async_block_ilu0_factorize<scalar,index,bs,stor,false>(mat, mvals, plist, scale, irow,
+				                                                       ilu, pivinv);
+		});
+	}
+	else
+#pragma omp parallel default(shared) if(usethreads)
+	for(int isweep = 0; isweep < nbuildsweeps; isweep++)
+	{
+		if(scale) {
+#pragma omp for schedule(dynamic, thread_chunk_size) nowait
+			for(index i = 0; i < nrows; i++)
+				async_block_ilu0_factorize<scalar,index,bs,stor,true>(mat, mvals, plist, scale,
+				                                                      rows[i], ilu, pivinv);
+		}
+		else {
+#pragma omp for schedule(dynamic, thread_chunk_size) nowait
+			for(index i = 0; i < nrows; i++)
+				async_block_ilu0_factorize<scalar,index,bs,stor,false>(mat, mvals, plist, scale,
+				                                                       rows[i], ilu, pivinv);
+		}
+	}
+
+#pragma omp parallel for default(shared)
+	for(index i = 0; i < nrows; i++)
+		ilu[mat->diagind[rows[i]]] = pivinv[rows[i]];
+}
+
+template <typename scalar, typename index, int bs, StorageOptions stor>
+scalar block_ilu0_inverted_remainder(const CRawBSRMatrix<scalar,index> *const mat,
+                                     const ILUPositions<index>& plist, const scalar *const scale,
+                                     const scalar *const iluvals, const int thread_chunk_size,
+                                     PrecInfo *const ddinfo)
+{
+	using Blk = Block_t<scalar,bs,stor>;
+	const Blk *const ilu = reinterpret_cast<const Blk*>(iluvals);
+	const index nnzb = mat->browptr[mat->nbrows];
+
+	Eigen::aligned_allocator<Blk> alloc;
+	Blk *const fact = alloc.allocate(nnzb);
+#pragma omp parallel for default(shared)
+	for(index irow = 0; irow < mat->nbrows; irow++)
+		for(index jj = mat->browptr[irow]; jj < mat->browptr[irow+1]; jj++) {
+			if(jj == mat->diagind[irow])
+				kernels::block_invert<scalar,bs,stor>(ilu[jj], fact[jj]);
+			else
+				fact[jj] = ilu[jj];
+		}
+
+	const scalar *const factvals = reinterpret_cast<const scalar*>(fact);
+	const scalar remainder = scale ?
+		block_ilu0_nonlinear_res<scalar,index,bs,stor,true>(mat, plist, scale, factvals,
+		                                                    thread_chunk_size) :
+		block_ilu0_nonlinear_res<scalar,index,bs,stor,false>(mat, plist, scale, factvals,
+		                                                     thread_chunk_size);
+
+	if(ddinfo) {
+		const std::array<scalar,4> arr = diagonal_dominance<scalar,index,bs,stor>
+			(SRMatrixStorage<const scalar,const index>(mat->browptr, mat->bcolind, factvals,
+			                                           mat->diagind, mat->browendptr, mat->nbrows,
+			                                           mat->nnzb, mat->nbstored, bs));
+		ddinfo->lower_avg_diag_dom() = arr[0];
+		ddinfo->lower_min_diag_dom() = arr[1];
+		ddinfo->upper_avg_diag_dom() = arr[2];
+		ddinfo->upper_min_diag_dom() = arr[3];
+	}
+
+	alloc.deallocate(fact, nnzb);
+	return remainder;
+}
+
+template void
+block_ilu0_save_state<double,int,4,ColMajor>(const CRawBSRMatrix<double,int> *const mat,
+	const double *const scale, const double *const iluvals,
+	double *const __restrict snapshot, double *const __restrict pivinvs);
+template std::vector<int>
+block_ilu0_changed_rows<double,int,4,ColMajor>(const CRawBSRMatrix<double,int> *const mat,
+	const double *const scale, const double rowtol, const int deplevels,
+	double *const __restrict snapshot, std::vector<char>& active);
+template void
+block_ilu0_refactorize<double,int,4,ColMajor>(const CRawBSRMatrix<double,int> *const mat,
+	const ILUPositions<int>& plist, const std::vector<int>& rows, const std::vector<char>& active,
+	const int nbuildsweeps, const int thread_chunk_size, const bool usethreads,
+	const double *const scale, double *const __restrict iluvals, double *const __restrict pivinvs,
+	const SyncFreeSchedule<int> *const syncfree);
+template double
+block_ilu0_inverted_remainder<double,int,4,ColMajor>(const CRawBSRMatrix<double,int> *const mat,
+	const ILUPositions<int>& plist, const double *const scale, const double *const iluvals,
+	const int thread_chunk_size, PrecInfo *const ddinfo);
+
+template void
+block_ilu0_save_state<double,int,5,ColMajor>(const CRawBSRMatrix<double,int> *const mat,
+	const double *const scale, const double *const iluvals,
+	double *const __restrict snapshot, double *const __restrict pivinvs);
+template std::vector<int>
+block_ilu0_changed_rows<double,int,5,ColMajor>(const CRawBSRMatrix<double,int> *const mat,
+	const double *const scale, const double rowtol, const int deplevels,
+	double *const __restrict snapshot, std::vector<char>& active);
+template void
+block_ilu0_refactorize<double,int,5,ColMajor>(const CRawBSRMatrix<double,int> *const mat,
+	const ILUPositions<int>& plist, const std::vector<int>& rows, const std::vector<char>& active,
+	const int nbuildsweeps, const int thread_chunk_size, const bool usethreads,
+	const double *const scale, double *const __restrict iluvals, double *const __restrict pivinvs,
+	const SyncFreeSchedule<int> *const syncfree);
+template double
+block_ilu0_inverted_remainder<double,int,5,ColMajor>(const CRawBSRMatrix<double,int> *const mat,
+	const ILUPositions<int>& plist, const double *const scale, const double *const iluvals,
+	const int thread_chunk_size, PrecInfo *const ddinfo);
+
+template void
+block_ilu0_save_state<double,int,4,RowMajor>(const CRawBSRMatrix<double,int> *const mat,
+	const double *const scale, const double *const iluvals,
+	double *const __restrict snapshot, double *const __restrict pivinvs);
+template std::vector<int>
+block_ilu0_changed_rows<double,int,4,RowMajor>(const CRawBSRMatrix<double,int> *const mat,
+	const double *const scale, const double rowtol, const int deplevels,
+	double *const __restrict snapshot, std::vector<char>& active);
+template void
+block_ilu0_refactorize<double,int,4,RowMajor>(const CRawBSRMatrix<double,int> *const mat,
+	const ILUPositions<int>& plist, const std::vector<int>& rows, const std::vector<char>& active,
+	const int nbuildsweeps, const int thread_chunk_size, const bool usethreads,
+	const double *const scale, double *const __restrict iluvals, double *const __restrict pivinvs,
+	const SyncFreeSchedule<int> *const syncfree);
+template double
+block_ilu0_inverted_remainder<double,int,4,RowMajor>(const CRawBSRMatrix<double,int> *const mat,
+	const ILUPositions<int>& plist, const double *const scale, const double *const iluvals,
+	const int thread_chunk_size, PrecInfo *const ddinfo);
+
+#ifdef BUILD_BLOCK_SIZE
+template void
+block_ilu0_save_state<double,int,BUILD_BLOCK_SIZE,ColMajor>(const CRawBSRMatrix<double,int> *const mat,
+	const double *const scale, const double *const iluvals,
+	double *const __restrict snapshot, double *const __restrict pivinvs);
+template std::vector<int>
+block_ilu0_changed_rows<double,int,BUILD_BLOCK_SIZE,ColMajor>(const CRawBSRMatrix<double,int> *const mat,
+	const double *const scale, const double rowtol, const int deplevels,
+	double *const __restrict snapshot, std::vector<char>& active);
+template void
+block_ilu0_refactorize<double,int,BUILD_BLOCK_SIZE,ColMajor>(const CRawBSRMatrix<double,int> *const mat,
+	const ILUPositions<int>& plist, const std::vector<int>& rows, const std::vector<char>& active,
+	const int nbuildsweeps, const int thread_chunk_size, const bool usethreads,
+	const double *const scale, double *const __restrict iluvals, double *const __restrict pivinvs,
+	const SyncFreeSchedule<int> *const syncfree);
+template double
+block_ilu0_inverted_remainder<double,int,BUILD_BLOCK_SIZE,ColMajor>(const CRawBSRMatrix<double,int> *const mat,
+	const ILUPositions<int>& plist, const double *const scale, const double *const iluvals,
+	const int thread_chunk_size, PrecInfo *const ddinfo);
+
+template void
+block_ilu0_save_state<double,int,BUILD_BLOCK_SIZE,RowMajor>(const CRawBSRMatrix<double,int> *const mat,
+	const double *const scale, const double *const iluvals,
+	double *const __restrict snapshot, double *const __restrict pivinvs);
+template std::vector<int>
+block_ilu0_changed_rows<double,int,BUILD_BLOCK_SIZE,RowMajor>(const CRawBSRMatrix<double,int> *const mat,
+	const double *const scale, const double rowtol, const int deplevels,
+	double *const __restrict snapshot, std::vector<char>& active);
+template void
+block_ilu0_refactorize<double,int,BUILD_BLOCK_SIZE,RowMajor>(const CRawBSRMatrix<double,int> *const mat,
+	const ILUPositions<int>& plist, const std::vector<int>& rows, const std::vector<char>& active,
+	const int nbuildsweeps, const int thread_chunk_size, const bool usethreads,
+	const double *const scale, double *const __restrict iluvals, double *const __restrict pivinvs,
+	const SyncFreeSchedule<int> *const syncfree);
+template double
+block_ilu0_inverted_remainder<double,int,BUILD_BLOCK_SIZE,RowMajor>(const CRawBSRMatrix<double,int> *const mat,
+	const ILUPositions<int>& plist, const double *const scale, const double *const iluvals,
+	const int thread_chunk_size, PrecInfo *const ddinfo);
+#endif
+
 template <typename scalar, typename index, int bs, StorageOptions stor> static
 void fact_init_sgs(const CRawBSRMatrix<scalar,index> *const mat, const scalar *const scale,
                    scalar *const __restrict iluvals)
@@ -224,7 +605,7 @@ void fact_init_sgs(const CRawBSRMatrix<scalar,index> *const mat, const scalar *c
 		{
 			Block_t<scalar,bs,stor> tempblk = mvals[mat->diagind[i]];
 			scaleBlock<scalar,index,bs,stor>(scale, i, i, tempblk);
-			dblks[i].noalias() = tempblk.inverse();
+			kernels::block_invert<scalar,bs,stor>(tempblk, dblks[i]);
 
 			for(index j = mat->browptr[i]; j < mat->browptr[i+1]; j++)
 			{
@@ -236,7 +617,7 @@ void fact_init_sgs(const CRawBSRMatrix<scalar,index> *const mat, const scalar *c
 #pragma omp parallel for default (shared)
 		for(index i = 0; i < mat->nbrows; i++)
 		{
-			dblks[i].noalias() = mvals[mat->diagind[i]].inverse();
+			kernels::block_invert<scalar,bs,stor>(mvals[mat->diagind[i]], dblks[i]);
 
 			for(index j = mat->browptr[i]; j < mat->browptr[i+1]; j++)
 				ilu[j] = mvals[j];
@@ -6,10 +6,13 @@
 #ifndef BLASTED_ASYNC_BLOCKILU_FACTOR_H
 #define BLASTED_ASYNC_BLOCKILU_FACTOR_H
 
+#include <vector>
 #include "srmatrixdefs.hpp"
 #include "async_initialization_decl.hpp"
 #include "ilu_pattern.hpp"
 #include "preconditioner_diagnostics.hpp"
+#include "syncfree_schedule.hpp"
+#include "async_sweeps.hpp"
 
 namespace blasted {
 
@@ -20,7 +23,10 @@ namespace blasted {
  *
  * \param[in] mat The BSR matrix
  * \param[in] plist Lists of positions in the LU matrix required for the ILU computation
- * \param[in] nbuildsweeps Number of asynchronous sweeps to use for parallel builds
+ * \param[in] nbuildsweeps Number of asynchronous sweeps to use for parallel builds; the maximum
+ *   number if buildtol is positive
+ * \param[in] buildtol If positive, sweeps stop once the ILU remainder, estimated during each sweep,
+ *   is reduced by this factor relative to the first sweep. The sweeps are then synchronized.
  * \param[in] thread_chunk_size The number of work-items to assign to thread-contexts in one batch
  *   for dynamically scheduled threads - should not be too small or too large
  * \param[in] usethreads Whether to use asynchronous threaded (true) or serial (false) factorization
@@ -30,15 +36,105 @@ namespace blasted {
  * \param[out] iluvals The ILU factorization non-zeros, accessed using the block-row pointers,
  *   block-column indices and diagonal pointers of the original BSR matrix
  * \param[out] scale Entries that are used to symmetrically scale the original matrix before factorization
+ * \param[in] syncfree If not null, the exact block-ILU(0) factors are computed in one pass instead,
+ *   each block-row waiting only for the rows it depends on; the number of sweeps and tolerance
+ *   are unused.
+ * \param[in] tiling Tiles for block-asynchronous sweeps \sa AsyncSweepEngine; only used when the
+ *   number of sweeps is fixed, ie., buildtol is not positive
  * \return ILU remainder
  */
 template <typename scalar, typename index, int bs, StorageOptions stor>
 PrecInfo block_ilu0_factorize(const CRawBSRMatrix<scalar,index> *const mat,
                               const ILUPositions<index>& plist,
-                              const int nbuildsweeps, const int thread_chunk_size, const bool usethreads,
+                              const int nbuildsweeps, const scalar buildtol,
+                              const int thread_chunk_size, const bool usethreads,
                               const FactInit init_type,
                               const bool compute_remainder,
-                              scalar *const __restrict iluvals, scalar *const __restrict scale);
+                              scalar *const __restrict iluvals, scalar *const __restrict scale,
+                              const SyncFreeSchedule<index> *const syncfree = nullptr,
+                              const SweepTiling<index> tiling = SweepTiling<index>());
+
+/// Saves the state needed to later refactorize only some block-rows \sa block_ilu0_refactorize
+/** \param[in] mat The matrix that was just factorized
+ * \param[in] scale The symmetric scaling used in the factorization, or null
+ * \param[in] iluvals The ILU factors, with inverted diagonal blocks
+ * \param[out] snapshot Pre-allocated storage for the (scaled) values of the matrix
+ * \param[out] pivinvs Pre-allocated storage for the inverses of the diagonal blocks of U
+ */
+template <typename scalar, typename index, int bs, StorageOptions stor>
+void block_ilu0_save_state(const CRawBSRMatrix<scalar,index> *const mat, const scalar *const scale,
+                           const scalar *const iluvals,
+                           scalar *const __restrict snapshot, scalar *const __restrict pivinvs);
+
+/// Marks the block-rows whose factors need to be recomputed after the values of the matrix change
+/** A block-row is marked if the 1-norm of the change of its (scaled) values since they were last
+ * factorized exceeds rowtol times the 1-norm of those old values. The ILU factors of a row
+ * depend on the factors of the rows corresponding to the columns of its lower triangular part,
+ * so rows depending on marked rows are marked as well, for the given number of levels or, if
+ * that is negative, all of them. The snapshot is updated for all marked rows.
+ *
+ * With a finite number of levels, the rows depending on a changed row only more indirectly keep
+ * factors computed from its old values. Since their own values did not change, they are not
+ * marked by later calls either, so this approximation persists until a full factorization.
+ *
+ * \param[in] mat The matrix with the new values
+ * \param[in] scale Symmetric scaling of the new matrix, or null
+ * \param[in] rowtol Relative change above which a row is marked; zero marks any change
+ * \param[in] deplevels Number of levels of dependent rows to mark; negative to mark all rows
+ *   depending on marked rows, directly or indirectly
+ * \param[in,out] snapshot The (scaled) values of the matrix that were last factorized
+ * \param[out] active Flags for each block-row, set to 1 for marked rows
+ * \return The marked block-rows in increasing order
+ */
+template <typename scalar, typename index, int bs, StorageOptions stor>
+std::vector<index> block_ilu0_changed_rows(const CRawBSRMatrix<scalar,index> *const mat,
+                                           const scalar *const scale,
+                                           const scalar rowtol, const int deplevels,
+                                           scalar *const __restrict snapshot,
+                                           std::vector<char>& active);
+
+/// Recomputes the block-ILU0 factors of some block-rows by asynchronous sweeps over those rows
+/** The sweeps are warm-started from the previous factors, and factors of other rows are used as
+ * they are. The cost is thus proportional to the number of rows to refactorize. If a sync-free
+ * schedule is given, the rows are instead factorized once each in dependency order, which gives
+ * the exact factors of those rows given the factors of the other rows.
+ * \param[in] mat The matrix
+ * \param[in] plist Positions needed for the ILU computation
+ * \param[in] rows The block-rows to refactorize, in increasing order
+ * \param[in] active Flags marking the block-rows in rows
+ * \param[in] nbuildsweeps Number of asynchronous sweeps over the rows
+ * \param[in] thread_chunk_size The batch size of allocation of work-items to threads
+ * \param[in] usethreads Whether to use asynchronous threaded (true) or serial (false) sweeps
+ * \param[in] scale Symmetric scaling of the matrix, or null
+ * \param[in,out] iluvals The ILU factors, with inverted diagonal blocks
+ * \param[in,out] pivinvs Inverses of the diagonal blocks of U \sa block_ilu0_save_state
+ * \param[in] syncfree If not null, the schedule for a synchronization-free factorization of the
+ *   rows; the number of build sweeps is then unused
+ */
+template <typename scalar, typename index, int bs, StorageOptions stor>
+void block_ilu0_refactorize(const CRawBSRMatrix<scalar,index> *const mat,
+                            const ILUPositions<index>& plist,
+                            const std::vector<index>& rows, const std::vector<char>& active,
+                            const int nbuildsweeps, const int thread_chunk_size,
+                            const bool usethreads, const scalar *const scale,
+                            scalar *const __restrict iluvals, scalar *const __restrict pivinvs,
+                            const SyncFreeSchedule<index> *const syncfree = nullptr);
+
+/// Computes the ILU remainder, as \ref block_ilu0_nonlinear_res does, of factors whose diagonal
+///  blocks are stored inverted
+/** The diagonal blocks are inverted back in a temporary copy of the factors.
+ * \param[in] mat The matrix A
+ * \param[in] plist Positions needed for the ILU computation
+ * \param[in] scale Symmetric scaling of the matrix, or null
+ * \param[in] iluvals The ILU factors, with inverted diagonal blocks
+ * \param[in] thread_chunk_size The batch size of allocation of work-items to threads
+ * \param[out] ddinfo If not null, the diagonal dominance of the factors is stored in it
+ */
+template <typename scalar, typename index, int bs, StorageOptions stor>
+scalar block_ilu0_inverted_remainder(const CRawBSRMatrix<scalar,index> *const mat,
+                                     const ILUPositions<index>& plist, const scalar *const scale,
+                                     const scalar *const iluvals, const int thread_chunk_size,
+                                     PrecInfo *const ddinfo);
 
 /// Computes the vector 1-norm of the ILU remainder A - LU restricted to the sparsity pattern of A
 /** \param[in] mat The matrix A
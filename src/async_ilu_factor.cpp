@@ -25,20 +25,52 @@ static void fact_init_original(const CRawBSRMatrix<scalar,index> *const mat,
                                const scalar *const scale,
                                scalar *const __restrict iluvals);
 
+/// Carries out the asynchronous sweeps that compute the ILU factors
+/** \param buildtol If positive, the sweeps are synchronized and stop once the ILU remainder,
+ *   estimated during each sweep, falls below this fraction of its value in the first sweep;
+ *   nbuildsweeps is then the maximum number of sweeps. Otherwise, exactly nbuildsweeps
+ *   asynchronous sweeps are carried out.
+ * \param tiling Tiles for block-asynchronous sweeps, used only for a fixed number of sweeps
+ * \return The number of sweeps carried out
+ */
 template <typename scalar, typename index, bool scalerow, bool scalecol>
-static void executeILU0Factorization(const CRawBSRMatrix<scalar,index> *const mat,
-                                     const ILUPositions<index>& plist,
-                                     const int nbuildsweeps, const int thread_chunk_size,
-                                     const bool usethreads,
-                                     const scalar *const rowscale, const scalar *const colscale,
-                                     scalar *const __restrict iluvals);
+static int executeILU0Factorization(const CRawBSRMatrix<scalar,index> *const mat,
+                                    const ILUPositions<index>& plist,
+                                    const int nbuildsweeps, const scalar buildtol,
+                                    const int thread_chunk_size, const bool usethreads,
+                                    const SweepTiling<index>& tiling,
+                                    const scalar *const rowscale, const scalar *const colscale,
+                                    scalar *const __restrict iluvals);
+
+/// Computes the exact ILU factors in one pass, each row waiting only for the rows it depends on
+/** \return The number of passes, ie., 1
+ */
+template <typename scalar, typename index, bool scalerow, bool scalecol>
+static int executeSyncFreeILU0Factorization(const CRawBSRMatrix<scalar,index> *const mat,
+                                            const ILUPositions<index>& plist,
+                                            const SyncFreeSchedule<index>& sched,
+                                            const bool usethreads,
+                                            const scalar *const rowscale,
+                                            const scalar *const colscale,
+                                            scalar *const __restrict iluvals)
+{
+#pragma omp parallel default(shared) if(usethreads)
+	sched.forward(*mat, [&](const index irow) {
+		async_ilu0_factorize_kernel<scalar,index,scalerow,scalecol>(mat, plist, irow, rowscale,
+		                                                            colscale, iluvals);
+	});
+	return 1;
+}
 
 template <typename scalar, typename index>
 PrecInfo scalar_ilu0_factorize(const CRawBSRMatrix<scalar,index> *const mat,
                                const ILUPositions<index>& plist,
-                               const int nbuildsweeps, const int thread_chunk_size, const bool usethreads,
+                               const int nbuildsweeps, const scalar buildtol,
+                               const int thread_chunk_size, const bool usethreads,
                                const FactInit factinittype, const bool compute_info,
-                               scalar *const __restrict iluvals, scalar *const __restrict scale)
+                               scalar *const __restrict iluvals, scalar *const __restrict scale,
+                               const SyncFreeSchedule<index> *const syncfree,
+                               const SweepTiling<index> tiling)
 {
 	if(scale)
 		// get the diagonal scaling matrix
@@ -70,12 +102,22 @@ PrecInfo scalar_ilu0_factorize(const CRawBSRMatrix<scalar,index> *const mat,
 			                                                    scale, scale, iluvals);
 	}
 
-	if(scale)
-		executeILU0Factorization<scalar,index,true,true>(mat, plist, nbuildsweeps, thread_chunk_size,
-		                                                 usethreads, scale, scale, iluvals);
+	if(syncfree) {
+		if(scale)
+			pinfo.build_sweeps = executeSyncFreeILU0Factorization<scalar,index,true,true>
+				(mat, plist, *syncfree, usethreads, scale, scale, iluvals);
+		else
+			pinfo.build_sweeps = executeSyncFreeILU0Factorization<scalar,index,false,false>
+				(mat, plist, *syncfree, usethreads, scale, scale, iluvals);
+	}
+	else if(scale)
+		pinfo.build_sweeps = executeILU0Factorization<scalar,index,true,true>
+			(mat, plist, nbuildsweeps, buildtol, thread_chunk_size, usethreads, tiling, scale, scale,
+			 iluvals);
 	else
-		executeILU0Factorization<scalar,index,false,false>(mat, plist, nbuildsweeps, thread_chunk_size,
-		                                                   usethreads, scale, scale, iluvals);
+		pinfo.build_sweeps = executeILU0Factorization<scalar,index,false,false>
+			(mat, plist, nbuildsweeps, buildtol, thread_chunk_size, usethreads, tiling, scale, scale,
+			 iluvals);
 
 	if(compute_info)
 	{
@@ -100,9 +142,12 @@ PrecInfo scalar_ilu0_factorize(const CRawBSRMatrix<scalar,index> *const mat,
 template PrecInfo
 scalar_ilu0_factorize<double,int>(const CRawBSRMatrix<double,int> *const mat,
                                   const ILUPositions<int>& plist,
-                                  const int nbuildsweeps, const int thread_chunk_size,
+                                  const int nbuildsweeps, const double buildtol,
+                                  const int thread_chunk_size,
                                   const bool usethreads, const FactInit finit, const bool compute_info,
-                                  double *const __restrict iluvals, double *const __restrict scale);
+                                  double *const __restrict iluvals, double *const __restrict scale,
+                                  const SyncFreeSchedule<int> *const syncfree,
+                                  const SweepTiling<int> tiling);
 
 /* We set L' to (I+LD^(-1)) and U' to (D+U) so that L'U' = (D+L)D^(-1)(D+U).
  */
@@ -151,29 +196,60 @@ void fact_init_original(const CRawBSRMatrix<scalar,index> *const mat,
 }
 
 template <typename scalar, typename index, bool scalerow, bool scalecol>
-void executeILU0Factorization(const CRawBSRMatrix<scalar,index> *const mat,
-                                     const ILUPositions<index>& plist,
-                                     const int nbuildsweeps, const int thread_chunk_size,
-                                     const bool usethreads,
-                                     const scalar *const rowscale, const scalar *const colscale,
-                                     scalar *const __restrict iluvals)
+int executeILU0Factorization(const CRawBSRMatrix<scalar,index> *const mat,
+                             const ILUPositions<index>& plist,
+                             const int nbuildsweeps, const scalar buildtol,
+                             const int thread_chunk_size, const bool usethreads,
+                             const SweepTiling<index>& tiling,
+                             const scalar *const rowscale, const scalar *const colscale,
+                             scalar *const __restrict iluvals)
 {
 	if(scalerow)
 		assert(rowscale);
 
+	if(buildtol <= 0)
+	{
+		const AsyncSweepEngine<index> eng(mat->nbrows, thread_chunk_size, nullptr, tiling);
+#pragma omp parallel default(shared) if(usethreads)
+		eng.forward(nbuildsweeps, [&](const index irow) {
+			async_ilu0_factorize_kernel<scalar,index,scalerow,scalecol>(mat, plist, irow,
+			                                                            rowscale, colscale, iluvals);
+		});
+		return nbuildsweeps;
+	}
+
+	/* The remainder is accumulated while sweeping, using whatever factor values each row sees, so
+	 * it costs little more than the sweep itself. The barrier implied by the reduction is the only
+	 * synchronization added.
+	 */
+	scalar resnorm = 0, initresnorm = 0;
+	int nsweeps = 0;
+	bool converged = false;
+
 #pragma omp parallel default(shared) if(usethreads)
+	for(int isweep = 0; isweep < nbuildsweeps; isweep++)
 	{
-		for(int isweep = 0; isweep < nbuildsweeps; isweep++)
+#pragma omp for schedule(dynamic, thread_chunk_size) reduction(+:resnorm)
+		for(index irow = 0; irow < mat->nbrows; irow++)
 		{
-#pragma omp for schedule(dynamic, thread_chunk_size) nowait
-			for(index irow = 0; irow < mat->nbrows; irow++)
-			{
-				async_ilu0_factorize_kernel<scalar,index,scalerow,scalecol>(mat, plist, irow,
-				                                                            rowscale, colscale,
-				                                                            iluvals);
-			}
+			resnorm += async_ilu0_factorize_kernel<scalar,index,scalerow,scalecol,true>
+				(mat, plist, irow, rowscale, colscale, iluvals);
 		}
+
+#pragma omp single
+		{
+			if(isweep == 0)
+				initresnorm = resnorm;
+			nsweeps = isweep+1;
+			converged = resnorm <= buildtol*initresnorm;
+			resnorm = 0;
+		}
+
+		if(converged)
+			break;
 	}
+
+	return nsweeps;
 }
 
 template <typename scalar, typename index, bool needscalerow, bool needscalecol>
@@ -263,8 +339,10 @@ void scalar_ilu0_factorize_noscale(const CRawBSRMatrix<scalar,index> *const mat,
 	}
 
 	// compute L and U
-	executeILU0Factorization<scalar,index,false,false>(mat, plist, nbuildsweeps, thread_chunk_size,
-	                                                   usethreads, nullptr, nullptr, iluvals);
+	executeILU0Factorization<scalar,index,false,false>(mat, plist, nbuildsweeps, scalar(0),
+	                                                   thread_chunk_size, usethreads,
+	                                                   SweepTiling<index>(), nullptr, nullptr,
+	                                                   iluvals);
 }
 
 template
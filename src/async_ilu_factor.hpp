@@ -11,6 +11,8 @@
 #include "reorderingscaling.hpp"
 #include "async_initialization_decl.hpp"
 #include "preconditioner_diagnostics.hpp"
+#include "syncfree_schedule.hpp"
+#include "async_sweeps.hpp"
 
 namespace blasted {
 
@@ -18,20 +20,30 @@ namespace blasted {
 ///  Scales the matrix symmetrically so that diagonal entries become 1.
 /** \param[in] mat The preconditioner as a CSR matrix
  * \param[in] plist Lists of positions in the LU matrix required for the ILU computation
- * \param[in] nbuildweeps The number of asynch sweeps to use for a parallel build
+ * \param[in] nbuildweeps The number of asynch sweeps to use for a parallel build; the maximum
+ *   number if buildtol is positive
+ * \param[in] buildtol If positive, sweeps stop once the ILU remainder, estimated during each sweep,
+ *   is reduced by this factor relative to the first sweep. The sweeps are then synchronized.
  * \param[in] thread_chunk_size The batch size of allocation of work-items to threads
  * \param[in] usethreads Whether to use asynchronous threaded (true) or serial (false) factorization
  * \param[in] factinittype Method to use for initializing the ILU factor matrix
  * \param[in] compute_info Whether to compute extra information such as diagonal dominance of factors
  * \param[in,out] iluvals A pre-allocated array for storage of the ILU0 factorization
  * \param[in,out] scale A pre-allocated array for storage of diagonal scaling factors
+ * \param[in] syncfree If not null, the exact ILU(0) factors are computed in one pass instead, each
+ *   row waiting only for the rows it depends on; the number of sweeps and tolerance are unused.
+ * \param[in] tiling Tiles for block-asynchronous sweeps \sa AsyncSweepEngine; only used when the
+ *   number of sweeps is fixed, ie., buildtol is not positive
  */
 template <typename scalar, typename index>
 PrecInfo scalar_ilu0_factorize(const CRawBSRMatrix<scalar,index> *const mat,
                                const ILUPositions<index>& plist,
-                               const int nbuildsweeps, const int thread_chunk_size, const bool usethreads,
+                               const int nbuildsweeps, const scalar buildtol,
+                               const int thread_chunk_size, const bool usethreads,
                                const FactInit factinittype, const bool compute_info,
-                               scalar *const __restrict iluvals, scalar *const __restrict scale);
+                               scalar *const __restrict iluvals, scalar *const __restrict scale,
+                               const SyncFreeSchedule<index> *const syncfree = nullptr,
+                               const SweepTiling<index> tiling = SweepTiling<index>());
 
 /// Computes the vector 1-norm of the ILU0 remainder A - LU
 /** Note that A is assumed to be RVC, where V are the actual matrix values stored and R and C are the
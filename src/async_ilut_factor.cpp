@@ -0,0 +1,374 @@
+/** \file
+ * \brief Implementation of the threshold-based ILU factorization with dynamic pattern
+ * \author Aditya Kashi
+ */
+
+#include <vector>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <stdexcept>
+#include <new>
+#include <boost/align/aligned_alloc.hpp>
+#include "async_ilut_factor.hpp"
+#include "async_ilu_factor.hpp"
+#include "ilu_pattern.hpp"
+#include "kernels/kernels_ilu0_factorize.hpp"
+#include "helper_algorithms.hpp"
+
+namespace blasted {
+
+using boost::alignment::aligned_alloc;
+using boost::alignment::aligned_free;
+
+/// Working storage of the threshold ILU factorization
+template <typename scalar, typename index>
+struct ILUTWork
+{
+	std::vector<index> browptr;     ///< Pointers to the beginning of rows of the current pattern
+	std::vector<index> bcolind;     ///< Column indices of the current pattern
+	std::vector<index> diagind;     ///< Positions of the diagonal entries
+	std::vector<scalar> avals;      ///< Values of the (scaled) matrix in the pattern
+	std::vector<scalar> fvals;      ///< Values of the factors
+	std::vector<char> ina;          ///< Whether each entry is in the pattern of A
+
+	index nrows() const { return static_cast<index>(browptr.size())-1; }
+
+	/// The pattern as a matrix whose values are \ref avals
+	CRawBSRMatrix<scalar,index> view() const {
+		return CRawBSRMatrix<scalar,index>(&browptr[0], &bcolind[0], &avals[0], &diagind[0],
+		                                   &browptr[1], nrows(), browptr.back(), browptr.back());
+	}
+};
+
+/// An entry of a row of the pattern being assembled
+template <typename scalar, typename index>
+struct ILUTEntry
+{
+	index col;
+	scalar aval;
+	scalar fval;
+	char ina;
+};
+
+/// Replaces the pattern and values of the working storage with new rows
+template <typename scalar, typename index>
+static void assemble_rows(const std::vector<std::vector<ILUTEntry<scalar,index>>>& rows,
+                          ILUTWork<scalar,index>& w)
+{
+	const index n = static_cast<index>(rows.size());
+	w.browptr.assign(n+1, 0);
+#pragma omp parallel for simd default(shared)
+	for(index irow = 0; irow < n; irow++)
+		w.browptr[irow+1] = static_cast<index>(rows[irow].size());
+	internal::inclusive_scan(w.browptr);
+
+	const index nnz = w.browptr[n];
+	w.bcolind.resize(nnz);
+	w.avals.resize(nnz);
+	w.fvals.resize(nnz);
+	w.ina.resize(nnz);
+	w.diagind.resize(n);
+
+#pragma omp parallel for default(shared)
+	for(index irow = 0; irow < n; irow++)
+	{
+		index j = w.browptr[irow];
+		for(const ILUTEntry<scalar,index>& e : rows[irow]) {
+			w.bcolind[j] = e.col;
+			w.avals[j] = e.aval;
+			w.fvals[j] = e.fval;
+			w.ina[j] = e.ina;
+			if(e.col == irow)
+				w.diagind[irow] = j;
+			j++;
+		}
+	}
+}
+
+/// Adds to each row the largest non-zeros of the remainder A - LU outside the current pattern
+/** The new entries are initialized such that the remainder vanishes at their locations, given the
+ * other entries of the factors. The products contributing to the remainder of a row are gathered
+ * from the upper parts of the rows of its L-part and merged by sorting them by column, so the
+ * work and storage for a row depend only on the lengths of the rows involved.
+ * \param maxfill Maximum number of entries outside the pattern of A allowed in each row
+ */
+template <typename scalar, typename index>
+static void add_candidates(const std::vector<index>& maxfill, const int thread_chunk_size,
+                           ILUTWork<scalar,index>& w)
+{
+	const index n = w.nrows();
+	std::vector<std::vector<ILUTEntry<scalar,index>>> rows(n);
+
+#pragma omp parallel default(shared)
+	{
+		// products l_ik u_kj contributing to the current row, and the resulting candidates
+		std::vector<std::pair<index,scalar>> prods;
+		std::vector<std::pair<scalar,index>> cands;
+
+#pragma omp for schedule(dynamic, thread_chunk_size)
+		for(index irow = 0; irow < n; irow++)
+		{
+			// A is zero outside the pattern, so the remainder there is -sum_k l_ik u_kj
+			prods.clear();
+			for(index k = w.browptr[irow]; k < w.diagind[irow]; k++)
+			{
+				const scalar lik = w.fvals[k];
+				const index krow = w.bcolind[k];
+				for(index kk = w.diagind[krow]; kk < w.browptr[krow+1]; kk++)
+					prods.push_back(std::make_pair(w.bcolind[kk], -lik*w.fvals[kk]));
+			}
+			std::sort(prods.begin(), prods.end());
+
+			// sum the products of each column outside the pattern, which is also sorted
+			cands.clear();
+			index jpat = w.browptr[irow];
+			for(size_t ip = 0; ip < prods.size(); )
+			{
+				const index col = prods[ip].first;
+				scalar rem = 0;
+				for( ; ip < prods.size() && prods[ip].first == col; ip++)
+					rem += prods[ip].second;
+
+				while(jpat < w.browptr[irow+1] && w.bcolind[jpat] < col)
+					jpat++;
+				if(jpat < w.browptr[irow+1] && w.bcolind[jpat] == col)
+					continue;
+
+				const scalar val = col < irow ? rem/w.fvals[w.diagind[col]] : rem;
+				if(val != scalar(0))
+					cands.push_back(std::make_pair(val, col));
+			}
+
+			const size_t nkeep = std::min(cands.size(), static_cast<size_t>(maxfill[irow]));
+			if(nkeep < cands.size()) {
+				std::nth_element(cands.begin(), cands.begin()+nkeep, cands.end(),
+				                 [](const std::pair<scalar,index>& a, const std::pair<scalar,index>& b) {
+				                 	return std::abs(a.first) > std::abs(b.first);
+				                 });
+				cands.resize(nkeep);
+				std::sort(cands.begin(), cands.end(),
+				          [](const std::pair<scalar,index>& a, const std::pair<scalar,index>& b) {
+				          	return a.second < b.second;
+				          });
+			}
+
+			// merge the candidates into the row
+			std::vector<ILUTEntry<scalar,index>>& row = rows[irow];
+			row.reserve(w.browptr[irow+1]-w.browptr[irow] + nkeep);
+			index j = w.browptr[irow];
+			auto it = cands.begin();
+			while(j < w.browptr[irow+1] || it != cands.end())
+			{
+				if(it == cands.end() || (j < w.browptr[irow+1] && w.bcolind[j] < it->second)) {
+					row.push_back({w.bcolind[j], w.avals[j], w.fvals[j], w.ina[j]});
+					j++;
+				}
+				else {
+					row.push_back({it->second, scalar(0), it->first, 0});
+					++it;
+				}
+			}
+		}
+	}
+
+	assemble_rows(rows, w);
+}
+
+/// Drops the smallest entries outside the pattern of A, keeping at most maxfill[i] in row i
+template <typename scalar, typename index>
+static void drop_entries(const std::vector<index>& maxfill, const int thread_chunk_size,
+                         ILUTWork<scalar,index>& w)
+{
+	const index n = w.nrows();
+	std::vector<std::vector<ILUTEntry<scalar,index>>> rows(n);
+
+#pragma omp parallel default(shared)
+	{
+		std::vector<std::pair<scalar,index>> fills;
+		std::vector<char> keep;
+
+#pragma omp for schedule(dynamic, thread_chunk_size)
+		for(index irow = 0; irow < n; irow++)
+		{
+			const index start = w.browptr[irow], end = w.browptr[irow+1];
+			keep.assign(end-start, 1);
+
+			fills.clear();
+			for(index j = start; j < end; j++)
+				if(!w.ina[j])
+					fills.push_back(std::make_pair(std::abs(w.fvals[j]), j));
+
+			if(fills.size() > static_cast<size_t>(maxfill[irow]))
+			{
+				std::nth_element(fills.begin(), fills.begin()+maxfill[irow], fills.end(),
+				                 [](const std::pair<scalar,index>& a, const std::pair<scalar,index>& b) {
+				                 	return a.first > b.first;
+				                 });
+				for(size_t i = maxfill[irow]; i < fills.size(); i++)
+					keep[fills[i].second-start] = 0;
+			}
+
+			std::vector<ILUTEntry<scalar,index>>& row = rows[irow];
+			for(index j = start; j < end; j++)
+				if(keep[j-start])
+					row.push_back({w.bcolind[j], w.avals[j], w.fvals[j], w.ina[j]});
+		}
+	}
+
+	assemble_rows(rows, w);
+}
+
+/// Carries out one asynchronous sweep of the ILU fixed-point iteration on the current pattern
+template <typename scalar, typename index>
+static void ilut_sweep(const ILUPositions<index>& plist, const int thread_chunk_size,
+                       const bool usethreads, ILUTWork<scalar,index>& w)
+{
+	const CRawBSRMatrix<scalar,index> m = w.view();
+	scalar *const fvals = &w.fvals[0];
+
+#pragma omp parallel for default(shared) schedule(dynamic, thread_chunk_size) if(usethreads)
+	for(index irow = 0; irow < m.nbrows; irow++)
+		async_ilu0_factorize_kernel<scalar,index,false,false>(&m, plist, irow, nullptr, nullptr,
+		                                                      fvals);
+}
+
+template <typename scalar, typename index>
+PrecInfo scalar_parilut_factorize(const CRawBSRMatrix<scalar,index> *const mat, const int nsteps,
+                                  const scalar fillfactor, const int thread_chunk_size,
+                                  const bool usethreads, const FactInit factinittype,
+                                  const bool compute_info,
+                                  SRMatrixStorage<scalar,index>& lu, scalar *&luvals,
+                                  index& luvalscapacity, scalar *const __restrict scale)
+{
+	if(nsteps < 1)
+		throw std::invalid_argument("ParILUT: At least one step is needed!");
+
+	const index n = mat->nbrows;
+	ILUTWork<scalar,index> w;
+	w.browptr.assign(mat->browptr, mat->browptr+n+1);
+	w.bcolind.assign(mat->bcolind, mat->bcolind+mat->browptr[n]);
+	w.diagind.assign(mat->diagind, mat->diagind+n);
+	w.avals.resize(mat->browptr[n]);
+	w.fvals.resize(mat->browptr[n]);
+	w.ina.assign(mat->browptr[n], 1);
+
+	if(scale)
+		getScalingVector<scalar,index,1>(mat, scale);
+
+	std::vector<index> maxfill(n);
+
+#pragma omp parallel for default(shared)
+	for(index irow = 0; irow < n; irow++)
+	{
+		const index rowlen = mat->browptr[irow+1]-mat->browptr[irow];
+		maxfill[irow] = std::max(static_cast<index>(fillfactor*rowlen) - rowlen, index(0));
+
+		for(index j = mat->browptr[irow]; j < mat->browptr[irow+1]; j++)
+			w.avals[j] = scale ? scale[irow]*mat->vals[j]*scale[mat->bcolind[j]] : mat->vals[j];
+	}
+
+	// initial factors in the pattern of A, after which the pattern of L is used only through A
+	w.fvals = w.avals;
+	if(factinittype == INIT_F_SGS)
+	{
+		std::vector<scalar>& fv = w.fvals;
+#pragma omp parallel for default(shared)
+		for(index irow = 0; irow < n; irow++)
+			for(index j = w.browptr[irow]; j < w.diagind[irow]; j++)
+				fv[j] /= w.avals[w.diagind[w.bcolind[j]]];
+	}
+
+	PrecInfo pinfo;
+	double structtime = 0;
+	const auto tick = []() { return std::chrono::steady_clock::now(); };
+	const auto since = [](const std::chrono::steady_clock::time_point t) {
+		return std::chrono::duration<double>(std::chrono::steady_clock::now()-t).count();
+	};
+
+	ILUPositions<index> plist;
+
+	if(compute_info) {
+		const auto t = tick();
+		const CRawBSRMatrix<scalar,index> m = w.view();
+		compute_ILU_positions_CSR_CSR(&m, plist);
+		structtime += since(t);
+		pinfo.prec_rem_initial_norm() = scalar_ilu0_nonlinear_res<scalar,index,false,false>
+			(&m, plist, thread_chunk_size, nullptr, nullptr, &w.fvals[0]);
+	}
+
+	for(int istep = 0; istep < nsteps; istep++)
+	{
+		auto t = tick();
+		add_candidates(maxfill, thread_chunk_size, w);
+		{
+			const CRawBSRMatrix<scalar,index> m = w.view();
+			compute_ILU_positions_CSR_CSR(&m, plist);
+		}
+		structtime += since(t);
+
+		ilut_sweep(plist, thread_chunk_size, usethreads, w);
+
+		t = tick();
+		drop_entries(maxfill, thread_chunk_size, w);
+		{
+			const CRawBSRMatrix<scalar,index> m = w.view();
+			compute_ILU_positions_CSR_CSR(&m, plist);
+		}
+		structtime += since(t);
+
+		ilut_sweep(plist, thread_chunk_size, usethreads, w);
+	}
+
+	pinfo.build_sweeps = 2*nsteps;
+	pinfo.structure_walltime = structtime;
+
+	if(compute_info) {
+		const CRawBSRMatrix<scalar,index> m = w.view();
+		pinfo.prec_remainder_norm() = scalar_ilu0_nonlinear_res<scalar,index,false,false>
+			(&m, plist, thread_chunk_size, nullptr, nullptr, &w.fvals[0]);
+	}
+
+	// copy out, reallocating only storage that is too small
+	const index nnz = w.browptr[n];
+	if(lu.browptr.size() != n+1) {
+		lu.browptr.resize(n+1);
+		lu.diagind.resize(n);
+	}
+	if(lu.bcolind.size() < nnz) {
+		lu.bcolind.resize(nnz);
+		lu.vals.resize(nnz);
+	}
+	if(luvalscapacity < nnz) {
+		aligned_free(luvals);
+		luvalscapacity = 0;
+		luvals = (scalar*)aligned_alloc(CACHE_LINE_LEN, nnz*sizeof(scalar));
+		if(!luvals)
+			throw std::bad_alloc();
+		luvalscapacity = nnz;
+	}
+
+	std::copy(w.browptr.begin(), w.browptr.end(), &lu.browptr[0]);
+	std::copy(w.diagind.begin(), w.diagind.end(), &lu.diagind[0]);
+#pragma omp parallel for simd default(shared)
+	for(index j = 0; j < nnz; j++) {
+		lu.bcolind[j] = w.bcolind[j];
+		lu.vals[j] = w.avals[j];
+		luvals[j] = w.fvals[j];
+	}
+	lu.browendptr.wrap(&lu.browptr[1], n);
+	lu.nbrows = n;
+	lu.nnzb = lu.nbstored = nnz;
+
+	return pinfo;
+}
+
+template PrecInfo
+scalar_parilut_factorize(const CRawBSRMatrix<double,int> *const mat, const int nsteps,
+                         const double fillfactor, const int thread_chunk_size,
+                         const bool usethreads, const FactInit factinittype,
+                         const bool compute_info,
+                         SRMatrixStorage<double,int>& lu, double *&luvals,
+                         int& luvalscapacity, double *const __restrict scale);
+
+}
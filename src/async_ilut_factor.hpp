@@ -0,0 +1,55 @@
+/** \file
+ * \brief Threshold-based incomplete LU factorization with a dynamically chosen pattern, computed by
+ *  asynchronous fixed-point sweeps
+ * \author Aditya Kashi
+ */
+
+#ifndef BLASTED_ASYNC_ILUT_FACTOR_H
+#define BLASTED_ASYNC_ILUT_FACTOR_H
+
+#include "srmatrixdefs.hpp"
+#include "async_initialization_decl.hpp"
+#include "preconditioner_diagnostics.hpp"
+
+namespace blasted {
+
+/// Computes a threshold ILU factorization whose pattern is chosen while sweeping \cite ilu:parilut
+/** Starting from the pattern of A, each step
+ *  - adds to the pattern the locations outside it where the remainder A - LU is non-zero, at most
+ *    as many in each row as allowed by the row's fill budget, picking the largest remainders;
+ *  - carries out an asynchronous sweep of the ILU fixed-point iteration on the enlarged pattern;
+ *  - drops the smallest entries that are not in the pattern of A, such that the number of
+ *    non-zeros in each row of the factors is within the row's budget;
+ *  - carries out another asynchronous sweep on the reduced pattern.
+ * Every operation is parallel over rows. The sweeps use the same kernel and positions as the
+ * asynchronous ILU(0) factorization \sa async_ilu0_factorize_kernel. The factors are stored like
+ * ILU(0) factors: the unit lower triangular factor without its diagonal and the upper triangular
+ * factor, both in the pattern of the output matrix.
+ *
+ * \param[in] mat The matrix as a CSR matrix, with sorted column indices
+ * \param[in] nsteps Number of add-sweep-drop-sweep steps
+ * \param[in] fillfactor Budget of non-zeros for each row of the factors, relative to the number
+ *   of non-zeros in that row of A; at least the pattern of A is kept
+ * \param[in] thread_chunk_size The batch size of allocation of work-items to threads
+ * \param[in] usethreads Whether to use asynchronous threaded (true) or serial (false) factorization
+ * \param[in] factinittype Method to use for initializing the ILU factors in the pattern of A
+ * \param[in] compute_info Whether to compute the remainder of the final factors
+ * \param[in,out] lu The pattern of the factors; its values are those of the (scaled) matrix
+ *   extended by zeros. Its arrays are reallocated only if they are too small.
+ * \param[in,out] luvals The values of the factors, in the pattern of lu; storage allocated by
+ *   aligned_alloc that is reallocated if its capacity is less than the number of non-zeros
+ * \param[in,out] luvalscapacity Number of entries that luvals can hold
+ * \param[in,out] scale If not null, pre-allocated storage for the symmetric scaling of the matrix
+ *   applied before factorization
+ */
+template <typename scalar, typename index>
+PrecInfo scalar_parilut_factorize(const CRawBSRMatrix<scalar,index> *const mat, const int nsteps,
+                                  const scalar fillfactor, const int thread_chunk_size,
+                                  const bool usethreads, const FactInit factinittype,
+                                  const bool compute_info,
+                                  SRMatrixStorage<scalar,index>& lu, scalar *&luvals,
+                                  index& luvalscapacity, scalar *const __restrict scale);
+
+}
+
+#endif
@@ -18,6 +18,10 @@
  */
 
 #include "matvecs.hpp"
+#include "../kernels/kernels_sell.hpp"
+#include "../kernels/kernels_blockops.hpp"
+#include "../kernels/kernels_multivec.hpp"
+#include "../kernels/kernels_compressed.hpp"
 
 namespace blasted {
 
@@ -35,15 +39,61 @@ void BLAS_BSR<mscalar,mindex,bs,stor>
 #pragma omp parallel for default(shared)
 	for(index irow = 0; irow < mat.nbrows; irow++)
 	{
-		y[irow] = Vector<scalar>::Zero(bs);
+		Seg prod = Seg::Zero();
 
 		// loop over non-zero blocks of this block-row
 		for(index jj = mat.browptr[irow]; jj < mat.browptr[irow+1]; jj++)
 		{
 			// multiply the blocks with corresponding sub-vectors
 			const index jcol = mat.bcolind[jj];
-			y[irow].noalias() += data[jj] * x[jcol];
+			kernels::block_gemv_add<scalar,bs,stor>(data[jj], x[jcol], prod);
 		}
+
+		y[irow] = prod;
+	}
+}
+
+template <typename mscalar, typename mindex, int bs, StorageOptions stor>
+void BLAS_BSR<mscalar,mindex,bs,stor>
+::matrix_apply_multi(const SRMatrixStorage<mscalar,mindex>&& mat, const int nvecs,
+                     const scalar *const xx, scalar *const __restrict yy)
+{
+	using Blk = Block_t<scalar,bs,stor>;
+	const Blk *data = reinterpret_cast<const Blk*>(&mat.vals[0]);
+
+#pragma omp parallel for default(shared)
+	for(index irow = 0; irow < mat.nbrows; irow++)
+	{
+		scalar *const yblk = yy + irow*bs*nvecs;
+		for(int i = 0; i < bs*nvecs; i++)
+			yblk[i] = 0;
+
+		kernels::block_row_product_multi<scalar,index,bs,stor>(data, &mat.bcolind[0],
+		                                                       mat.browptr[irow], mat.browptr[irow+1],
+		                                                       nvecs, xx, yblk);
+	}
+}
+
+template <typename mscalar, typename mindex, int bs, StorageOptions stor>
+void BLAS_BSR<mscalar,mindex,bs,stor>
+::matrix_apply_ci(const SRMatrixStorage<mscalar,mindex>&& mat,
+                  const CRawCompressedColumnIndex<index>& cind,
+                  const scalar *const xx, scalar *const __restrict yy)
+{
+	using Blk = Block_t<scalar,bs,stor>;
+	using Seg = Segment_t<scalar,bs>;
+	const Blk *data = reinterpret_cast<const Blk*>(&mat.vals[0]);
+	const Seg *x = reinterpret_cast<const Seg*>(xx);
+	Seg *y = reinterpret_cast<Seg*>(yy);
+
+#pragma omp parallel for default(shared)
+	for(index irow = 0; irow < mat.nbrows; irow++)
+	{
+		Seg prod = Seg::Zero();
+		kernels::block_row_product_ci<scalar,index,bs,stor>(data, cind, irow, mat.browptr[irow],
+		                                                    mat.browptr[irow+1], cind.escptr[irow],
+		                                                    x, prod);
+		y[irow] = prod;
 	}
 }
 
@@ -63,14 +113,16 @@ void BLAS_BSR<mscalar,mindex,bs,stor>
 #pragma omp parallel for default(shared)
 	for(index irow = 0; irow < mat.nbrows; irow++)
 	{
-		z[irow] = b * y[irow];
+		Seg prod = Seg::Zero();
 
 		// loop over non-zero blocks of this block-row
 		for(index jj = mat.browptr[irow]; jj < mat.browptr[irow+1]; jj++)
 		{
 			const index jcol = mat.bcolind[jj];
-			z[irow].noalias() += a * data[jj] * x[jcol];
+			kernels::block_gemv_add<scalar,bs,stor>(data[jj], x[jcol], prod);
 		}
+
+		z[irow] = b * y[irow] + a * prod;
 	}
 }
 
@@ -90,6 +142,38 @@ void BLAS_CSR<mscalar,mindex>::matrix_apply(const SRMatrixStorage<mscalar,mindex
 	}
 }
 
+template <typename mscalar, typename mindex>
+void BLAS_CSR<mscalar,mindex>::matrix_apply_multi(const SRMatrixStorage<mscalar,mindex>&& mat,
+                                                  const int nvecs,
+                                                  const scalar *const xx, scalar *const __restrict yy)
+{
+#pragma omp parallel for default(shared)
+	for(index irow = 0; irow < mat.nbrows; irow++)
+	{
+		scalar *const yrow = yy + irow*nvecs;
+		for(int v = 0; v < nvecs; v++)
+			yrow[v] = 0;
+
+		kernels::scalar_row_product_multi<scalar,index>(&mat.vals[0], &mat.bcolind[0],
+		                                                mat.browptr[irow], mat.browptr[irow+1],
+		                                                nvecs, xx, yrow);
+	}
+}
+
+template <typename mscalar, typename mindex>
+void BLAS_CSR<mscalar,mindex>::matrix_apply_ci(const SRMatrixStorage<mscalar,mindex>&& mat,
+                                               const CRawCompressedColumnIndex<index>& cind,
+                                               const scalar *const xx, scalar *const __restrict yy)
+{
+#pragma omp parallel for default(shared)
+	for(index irow = 0; irow < mat.nbrows; irow++)
+	{
+		yy[irow] = kernels::scalar_row_product_ci<scalar,index>(&mat.vals[0], cind, irow,
+		                                                        mat.browptr[irow], mat.browptr[irow+1],
+		                                                        cind.escptr[irow], xx);
+	}
+}
+
 template <typename mscalar, typename mindex>
 void BLAS_CSR<mscalar,mindex>::gemv3(const SRMatrixStorage<mscalar,mindex>&& mat,
                                      const scalar a, const scalar *const __restrict xx, 
@@ -107,6 +191,47 @@ void BLAS_CSR<mscalar,mindex>::gemv3(const SRMatrixStorage<mscalar,mindex>&& mat
 	}
 }
 
+template <typename scalar, typename index, int C>
+void BLAS_SELL<scalar,index,C>::matrix_apply(const CRawSELLMatrix<scalar,index>& mat,
+                                             const scalar *const xx, scalar *const __restrict yy)
+{
+	assert(mat.C == C);
+
+#pragma omp parallel for default(shared)
+	for(index ic = 0; ic < mat.nchunks; ic++)
+	{
+		alignas(CACHE_LINE_LEN) scalar prod[C];
+		kernels::sell_chunk_product<scalar,index,C>(mat.vals + mat.chunkptr[ic],
+		                                            mat.colind + mat.chunkptr[ic],
+		                                            mat.chunklen[ic], xx, prod);
+
+		const index *const rows = mat.rowperm + ic*C;
+		for(int i = 0; i < mat.chunk_rows(ic); i++)
+			yy[rows[i]] = prod[i];
+	}
+}
+
+template <typename scalar, typename index, int C>
+void BLAS_SELL<scalar,index,C>::gemv3(const CRawSELLMatrix<scalar,index>& mat,
+                                      const scalar a, const scalar *const __restrict xx,
+                                      const scalar b, const scalar *const yy, scalar *const zz)
+{
+	assert(mat.C == C);
+
+#pragma omp parallel for default(shared)
+	for(index ic = 0; ic < mat.nchunks; ic++)
+	{
+		alignas(CACHE_LINE_LEN) scalar prod[C];
+		kernels::sell_chunk_product<scalar,index,C>(mat.vals + mat.chunkptr[ic],
+		                                            mat.colind + mat.chunkptr[ic],
+		                                            mat.chunklen[ic], xx, prod);
+
+		const index *const rows = mat.rowperm + ic*C;
+		for(int i = 0; i < mat.chunk_rows(ic); i++)
+			zz[rows[i]] = a*prod[i] + b*yy[rows[i]];
+	}
+}
+
 template <typename scalar, typename index, int bs, StorageOptions stor>
 void bcsc_gemv3(const CRawBSCMatrix<scalar,index> *const mat,
                 const scalar a, const scalar *const __restrict xx, 
@@ -161,9 +286,19 @@ template struct BLAS_BSR<const double,const int,3,RowMajor>;
 template struct BLAS_BSR<const double,const int,4,RowMajor>;
 template struct BLAS_BSR<const double,const int,7,RowMajor>;
 
+#ifdef BUILD_BLOCK_SIZE
+template struct BLAS_BSR<double,int,BUILD_BLOCK_SIZE,ColMajor>;
+template struct BLAS_BSR<double,int,BUILD_BLOCK_SIZE,RowMajor>;
+template struct BLAS_BSR<const double,const int,BUILD_BLOCK_SIZE,ColMajor>;
+template struct BLAS_BSR<const double,const int,BUILD_BLOCK_SIZE,RowMajor>;
+#endif
+
 template struct BLAS_CSR<double,int>;
 template struct BLAS_CSR<const double,const int>;
 
+template struct BLAS_SELL<double,int,4>;
+template struct BLAS_SELL<double,int,8>;
+
 // BSC matrix
 
 template
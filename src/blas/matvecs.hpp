@@ -9,6 +9,8 @@
 #include <Eigen/Core>
 #include "srmatrixdefs.hpp"
 #include "scmatrixdefs.hpp"
+#include "sellmatrixdefs.hpp"
+#include "cimatrixdefs.hpp"
 
 namespace blasted {
 
@@ -24,6 +26,20 @@ struct BLAS_BSR {
 	static void matrix_apply(const SRMatrixStorage<mscalar,mindex>&& mat,
 	                         const scalar *const xx, scalar *const __restrict yy);
 
+	/// Product of a BSR matrix with several vectors at once
+	/** The multivectors are stored row-interleaved: entry v of row i is at position i*nvecs+v.
+	 * \param nvecs Number of vectors
+	 */
+	static void matrix_apply_multi(const SRMatrixStorage<mscalar,mindex>&& mat, const int nvecs,
+	                               const scalar *const xx, scalar *const __restrict yy);
+
+	/// Matrix-vector product for BSR matrices using compressed column indices
+	/** \param cind Compressed column indices of mat \sa CompressedColumnIndex
+	 */
+	static void matrix_apply_ci(const SRMatrixStorage<mscalar,mindex>&& mat,
+	                            const CRawCompressedColumnIndex<index>& cind,
+	                            const scalar *const xx, scalar *const __restrict yy);
+
 	/// Computes z := a Ax + by for  scalars a and b and vectors x and y
 	/**
 	 * \param[in] mat The BSR matrix
@@ -46,6 +62,20 @@ struct BLAS_CSR {
 	static void matrix_apply(const SRMatrixStorage<mscalar,mindex>&& mat,
 	                         const scalar *const xx, scalar *const __restrict yy);
 
+	/// Product of a CSR matrix with several vectors at once
+	/** The multivectors are stored row-interleaved: entry v of row i is at position i*nvecs+v.
+	 * \param nvecs Number of vectors
+	 */
+	static void matrix_apply_multi(const SRMatrixStorage<mscalar,mindex>&& mat, const int nvecs,
+	                               const scalar *const xx, scalar *const __restrict yy);
+
+	/// Matrix-vector product for CSR matrices using compressed column indices
+	/** \param cind Compressed column indices of mat \sa CompressedColumnIndex
+	 */
+	static void matrix_apply_ci(const SRMatrixStorage<mscalar,mindex>&& mat,
+	                            const CRawCompressedColumnIndex<index>& cind,
+	                            const scalar *const xx, scalar *const __restrict yy);
+
 	/// Computes z := a Ax + by for  scalars a and b and vectors x and y
 	/**
 	 * \param[in] mat The CSR matrix
@@ -56,6 +86,38 @@ struct BLAS_CSR {
 	                  const scalar b, const scalar *const yy, scalar *const zz);
 };
 
+/// Selects the BLAS-2 operations for sparse-row matrices of the given block size
+/** The type is \ref BLAS_BSR, or \ref BLAS_CSR for a block size of 1.
+ */
+template <typename mscalar, typename mindex, int bs, StorageOptions stor>
+struct BLAS_SR {
+	typedef BLAS_BSR<mscalar,mindex,bs,stor> type;
+};
+
+template <typename mscalar, typename mindex, StorageOptions stor>
+struct BLAS_SR<mscalar,mindex,1,stor> {
+	typedef BLAS_CSR<mscalar,mindex> type;
+};
+
+/// BLAS-2 operations for scalar SELL-C-sigma matrices
+/** The chunk height C of the matrix must match the template parameter.
+ */
+template <typename scalar, typename index, int C>
+struct BLAS_SELL {
+	/// Matrix-vector product for SELL-C-sigma matrices
+	static void matrix_apply(const CRawSELLMatrix<scalar,index>& mat,
+	                         const scalar *const xx, scalar *const __restrict yy);
+
+	/// Computes z := a Ax + by for  scalars a and b and vectors x and y
+	/**
+	 * \param[in] mat The SELL-C-sigma matrix
+	 * \warning xx must not alias zz.
+	 */
+	static void gemv3(const CRawSELLMatrix<scalar,index>& mat,
+	                  const scalar a, const scalar *const __restrict xx,
+	                  const scalar b, const scalar *const yy, scalar *const zz);
+};
+
 /// GeMV for block compressed sparse column matrix
 /** Computes z := a Ax + by for  scalars a and b and vectors x and y
  */
@@ -38,6 +38,37 @@ static int get_int_petscoptions(const char *const option_tag)
 	return val;
 }
 
+/// Reads an optional int option from the PETSc options database
+static int get_optional_int_petscoptions(const char *const option_tag, const int default_value)
+{
+	PetscBool set = PETSC_FALSE;
+	PetscInt val = default_value;
+	int ierr = PetscOptionsGetInt(NULL, NULL, option_tag, &val, &set);
+	if(ierr) {
+		throw std::runtime_error("Petsc could not get optional int option!");
+	}
+	if(!set) {
+		printf(" BLASTed: %s not set; using default value of %d\n", option_tag, default_value);
+	}
+	return val;
+}
+
+/// Reads an optional real option from the PETSc options database
+static PetscReal get_optional_real_petscoptions(const char *const option_tag,
+                                                const PetscReal default_value)
+{
+	PetscBool set = PETSC_FALSE;
+	PetscReal val = default_value;
+	int ierr = PetscOptionsGetReal(NULL, NULL, option_tag, &val, &set);
+	if(ierr) {
+		throw std::runtime_error("Petsc could not get optional real option!");
+	}
+	if(!set) {
+		printf(" BLASTed: %s not set; using default value of %g\n", option_tag, default_value);
+	}
+	return val;
+}
+
 /// Reads an optional bool option from the PETSc options database
 static int get_optional_bool_petscoptions(const char *const option_tag, const bool default_value)
 {
@@ -98,7 +129,9 @@ static PetscErrorCode setupDataFromOptions(PC pc)
 
 	PetscInt sweeps[2];
 
-	if(ptype != BLASTED_JACOBI && ptype != BLASTED_LEVEL_SGS && ptype != BLASTED_NO_PREC)
+	if(ptype != BLASTED_JACOBI && ptype != BLASTED_LEVEL_SGS && ptype != BLASTED_MC_SGS
+	   && ptype != BLASTED_MC_ILU0 && ptype != BLASTED_SAI && ptype != BLASTED_SGS_SAI
+	   && ptype != BLASTED_NO_PREC)
 	{
 		// Params for async iterations
 
@@ -112,17 +145,42 @@ static PetscErrorCode setupDataFromOptions(PC pc)
 			abort();
 		}
 
-		if(ptype == BLASTED_ILU0 || ptype == BLASTED_SAPILU0 || ptype == BLASTED_ASYNC_LEVEL_ILU0)
+		if(ptype == BLASTED_ILU0 || ptype == BLASTED_SAPILU0 || ptype == BLASTED_ASYNC_LEVEL_ILU0
+		   || ptype == BLASTED_ILUK || ptype == BLASTED_ASYNC_LEVEL_ILUK || ptype == BLASTED_PARILUT)
 		{
 			ctx->scale = get_bool_petscoptions("-blasted_use_symmetric_scaling");
 			get_string_petscoptions("-blasted_async_fact_init_type", ctx->factinittype);
+			ctx->buildtol = get_optional_real_petscoptions("-blasted_async_build_tol", 0);
+			if(ptype == BLASTED_ILUK || ptype == BLASTED_ASYNC_LEVEL_ILUK)
+				ctx->filllevel = get_optional_int_petscoptions("-blasted_ilu_fill_level", 1);
+			if(ptype == BLASTED_ILU0 || ptype == BLASTED_SAPILU0 || ptype == BLASTED_ILUK) {
+				ctx->refactortol = get_optional_real_petscoptions("-blasted_refactor_row_tol", -1);
+				ctx->refactorlevels = get_optional_int_petscoptions("-blasted_refactor_dep_levels", 1);
+				ctx->syncfreefactor = get_optional_bool_petscoptions("-blasted_syncfree_factor", false);
+			}
+			if(ptype == BLASTED_ILU0 || ptype == BLASTED_SAPILU0 || ptype == BLASTED_ILUK
+			   || ptype == BLASTED_PARILUT) {
+				PetscBool set = PETSC_FALSE;
+				PetscOptionsGetString(NULL, NULL, "-blasted_ilu_apply_type", ctx->applytype,
+				                      BLASTED_OPT_STRLEN, &set);
+				if(!set)
+					strcpy(ctx->applytype, "async");
+			}
+			if(ptype == BLASTED_PARILUT)
+				ctx->ilutfillfactor = get_optional_real_petscoptions("-blasted_ilut_fill_factor", 2);
 		}
 		else {
 			ctx->scale = false;
 			strcpy(ctx->factinittype, "NA");
+			ctx->buildtol = 0;
 		}
 		get_string_petscoptions("-blasted_async_apply_init_type", ctx->applyinittype);
 		ctx->threadchunksize = get_int_petscoptions("-blasted_thread_chunk_size");
+		if(ptype == BLASTED_SGS || ptype == BLASTED_ILU0 || ptype == BLASTED_SAPILU0
+		   || ptype == BLASTED_ILUK) {
+			ctx->tilecachekb = get_optional_int_petscoptions("-blasted_sweep_tile_kb", 0);
+			ctx->tileinnersweeps = get_optional_int_petscoptions("-blasted_sweep_tile_inner_sweeps", 2);
+		}
 #ifdef DEBUG
 		printf("BLASTed: setupDataFromOptions:\n");
 		printf(" fact init type = %s, apply init type = %s", ctx->factinittype, ctx->applyinittype);
@@ -134,9 +192,40 @@ static PetscErrorCode setupDataFromOptions(PC pc)
 		sweeps[1] = 1;
 	}
 
+	if(ptype == BLASTED_MC_SGS || ptype == BLASTED_MC_ILU0) {
+		ctx->colordistance = get_optional_int_petscoptions("-blasted_color_distance", 1);
+		ctx->balancedcolors = get_optional_bool_petscoptions("-blasted_balanced_colors", false);
+	}
+
+	if(ptype == BLASTED_SAI || ptype == BLASTED_SGS_SAI) {
+		ctx->incompletesai = get_optional_bool_petscoptions("-blasted_sai_incomplete", false);
+		ctx->threadchunksize = get_optional_int_petscoptions("-blasted_thread_chunk_size", 16);
+	}
+
+	if(ptype == BLASTED_CHEBYSHEV) {
+		ctx->chebeigiters = get_optional_int_petscoptions("-blasted_chebyshev_eig_iters", 10);
+		ctx->chebeigratio = get_optional_real_petscoptions("-blasted_chebyshev_eig_ratio", 0.3);
+	}
+
+	{
+		PetscBool set = PETSC_FALSE;
+		PetscOptionsGetString(NULL, NULL, "-blasted_reordering", ctx->reordering,
+		                      BLASTED_OPT_STRLEN, &set);
+		if(!set)
+			strcpy(ctx->reordering, "natural");
+	}
+
 	ctx->compute_precinfo =
 		get_optional_bool_petscoptions("-blasted_compute_preconditioner_info", false);
 
+	ctx->sellchunkheight = get_optional_int_petscoptions("-blasted_sell_chunk_height", 0);
+	ctx->sellsortscope = get_optional_int_petscoptions("-blasted_sell_sort_scope", 1);
+	ctx->compressedcolind = get_optional_bool_petscoptions("-blasted_compressed_colind", false);
+	ctx->floatfactors = get_optional_bool_petscoptions("-blasted_float_factors", false);
+	ctx->floatmatrix = get_optional_bool_petscoptions("-blasted_float_matrix", false);
+	ctx->numadomains = get_optional_int_petscoptions("-blasted_numa_domains", 1);
+	ctx->numacopymatrix = get_optional_bool_petscoptions("-blasted_numa_copy_matrix", false);
+
 #ifdef DEBUG
 	printf("BLASTed: setupDataFromOptions: Setting up preconditioner with\n");
 	printf(" ptype = %d and sweeps = %d,%d.\n", ptype, sweeps[0], sweeps[1]);
@@ -148,7 +237,8 @@ static PetscErrorCode setupDataFromOptions(PC pc)
 	ctx->napplysweeps = sweeps[1];
 	ctx->first_setup_done = true;
 	ctx->cputime = ctx->walltime = ctx->factorcputime = ctx->factorwalltime =
-		ctx->applycputime = ctx->applywalltime = 0;
+		ctx->applycputime = ctx->applywalltime = ctx->structwalltime = 0;
+	ctx->buildsweeps = 0;
 
 	const std::string pcname = std::string("Blasted-") + ctx->prectypestr;
 
@@ -209,15 +299,39 @@ PetscErrorCode createNewPreconditioner(PC pc)
 	settings.napplysweeps = ctx->napplysweeps;
 	settings.thread_chunk_size = ctx->threadchunksize;
 	settings.compute_precinfo = ctx->compute_precinfo;
+	settings.sell_chunk_height = ctx->sellchunkheight;
+	settings.sell_sort_scope = ctx->sellsortscope;
+	settings.compressed_colind = ctx->compressedcolind;
+	settings.float_factors = ctx->floatfactors;
+	settings.float_matrix = ctx->floatmatrix;
+	settings.numa_domains = ctx->numadomains;
+	settings.build_tol = ctx->buildtol;
+	settings.fill_level = ctx->filllevel;
+	settings.ilut_fill_factor = ctx->ilutfillfactor;
+	settings.refactor_row_tol = ctx->refactortol;
+	settings.refactor_dep_levels = ctx->refactorlevels;
+	settings.syncfree_factor = ctx->syncfreefactor;
+	settings.tile_cache_bytes = static_cast<size_t>(ctx->tilecachekb)*1024;
+	settings.tile_inner_sweeps = ctx->tileinnersweeps;
+	settings.color_distance = ctx->colordistance;
+	settings.balanced_colors = ctx->balancedcolors;
+	settings.incomplete_sai = ctx->incompletesai;
+	settings.cheb_eig_iters = ctx->chebeigiters;
+	settings.cheb_eig_ratio = ctx->chebeigratio;
+	settings.reordering = getGraphOrderingFromString(ctx->reordering);
 	if(settings.prectype != BLASTED_JACOBI && settings.prectype != BLASTED_LEVEL_SGS
+	   && settings.prectype != BLASTED_MC_SGS && settings.prectype != BLASTED_MC_ILU0
+	   && settings.prectype != BLASTED_SAI && settings.prectype != BLASTED_SGS_SAI
 	   && settings.prectype != BLASTED_NO_PREC)
 	{
 		if(settings.prectype == BLASTED_ILU0 || settings.prectype == BLASTED_SAPILU0 ||
-		   settings.prectype == BLASTED_ASYNC_LEVEL_ILU0)
+		   settings.prectype == BLASTED_ASYNC_LEVEL_ILU0 || settings.prectype == BLASTED_ILUK ||
+		   settings.prectype == BLASTED_ASYNC_LEVEL_ILUK || settings.prectype == BLASTED_PARILUT)
 			settings.fact_inittype = getFactInitFromString(ctx->factinittype);
 		else
 			settings.fact_inittype = INIT_F_NONE;
 		settings.apply_inittype = getApplyInitFromString(ctx->applyinittype);
+		settings.apply_type = getApplyTypeFromString(ctx->applytype);
 	}
 
 	settings.relax = false;
@@ -229,7 +343,33 @@ PetscErrorCode createNewPreconditioner(PC pc)
 	if(ctx->bs <= 0 || ctx->bs > 5 || ctx->bs == 2)
 		SETERRQ1(PETSC_COMM_SELF, PETSC_ERR_SUP, "BLASTed: Block size %d is not supported!", ctx->bs);
 
-	if(ctx->bs == 1) {
+	// delete any old NUMA-local copy of the matrix
+	SRMatrixStorage<PetscReal,PetscInt> *localmat
+		= static_cast<SRMatrixStorage<PetscReal,PetscInt>*>(ctx->localmat);
+	delete localmat;
+	ctx->localmat = NULL;
+
+	if(ctx->numacopymatrix && ctx->numadomains > 1) {
+		// PETSc's arrays were most likely written by one thread; copy them into storage spread over
+		// the NUMA domains in the same way as the preconditioner's data
+		CRawBSRMatrix<PetscReal,PetscInt> amat;
+		amat.nbrows = localrows/ctx->bs;
+		amat.browptr = ctx->bs == 1 ? Adiag->i : Abdiag->i;
+		amat.bcolind = ctx->bs == 1 ? Adiag->j : Abdiag->j;
+		amat.vals = ctx->bs == 1 ? Adiag->a : Abdiag->a;
+		amat.diagind = ctx->bs == 1 ? Adiag->diag : Abdiag->diag;
+		amat.browendptr = amat.browptr+1;
+		amat.nnzb = amat.nbstored = amat.browptr[amat.nbrows];
+
+		DomainSchedule<PetscInt> sched;
+		sched.setup(amat, ctx->numadomains, 1);
+		localmat = new SRMatrixStorage<PetscReal,PetscInt>;
+		copy_matrix_to_domains(amat, ctx->bs, sched, *localmat);
+		ctx->localmat = static_cast<void*>(localmat);
+
+		precop = factory->create_preconditioner(share_with_const(*localmat, ctx->bs), settings);
+	}
+	else if(ctx->bs == 1) {
 		precop = factory->create_preconditioner(SRMatrixStorage<const PetscReal,const PetscInt>
 		                                        (Adiag->i, Adiag->j, Adiag->a, Adiag->diag,
 		                                         Adiag->i+1, localrows,
@@ -266,7 +406,25 @@ PetscErrorCode updatePreconditioner(PC pc)
 	BlastedPreconditioner *const precop = reinterpret_cast<BlastedPreconditioner*>(ctx->bprec);
 	PrecInfoList *const pilist = static_cast<PrecInfoList*>(ctx->infolist);
 
+	if(ctx->localmat) {
+		// refresh the NUMA-local copy of the matrix with the current values
+		SRMatrixStorage<PetscReal,PetscInt> *const localmat
+			= static_cast<SRMatrixStorage<PetscReal,PetscInt>*>(ctx->localmat);
+		Mat A;
+		ierr = PCGetOperators(pc, NULL, &A); CHKERRQ(ierr);
+		const PetscReal *const avals = ctx->bs == 1 ? ((const Mat_SeqAIJ*)A->data)->a
+			: ((const Mat_SeqBAIJ*)A->data)->a;
+
+		const CRawBSRMatrix<PetscReal,PetscInt> lmat
+			= createRawView(share_with_const(*localmat, ctx->bs));
+		DomainSchedule<PetscInt> sched;
+		sched.setup(lmat, ctx->numadomains, 1);
+		sched.first_touch_entries(lmat.browptr, ctx->bs*ctx->bs, avals, &localmat->vals[0]);
+	}
+
 	PrecInfo pinfo = precop->compute();
+	ctx->structwalltime += pinfo.structure_walltime;
+	ctx->buildsweeps += pinfo.build_sweeps;
 
 	if(ctx->compute_precinfo)
 		pilist->infolist.push_back(pinfo);
@@ -282,7 +440,7 @@ Blasted_data_list newBlastedDataList()
 	b.ctxlist = NULL;
 	b.bfactory = NULL;
 	b.size = 0;
-	b.factorcputime = b.factorwalltime = b.applycputime = b.applywalltime = 0.0;
+	b.factorcputime = b.factorwalltime = b.applycputime = b.applywalltime = b.structwalltime = 0.0;
 	b._defaultfactory = 0;
 	return b;
 }
@@ -319,8 +477,32 @@ Blasted_data newBlastedDataContext()
 	ctx.bprec = NULL;
 	ctx.infolist = NULL;
 	ctx.first_setup_done = false;
+	ctx.sellchunkheight = 0;
+	ctx.sellsortscope = 1;
+	ctx.compressedcolind = false;
+	ctx.floatfactors = false;
+	ctx.floatmatrix = false;
+	ctx.numadomains = 1;
+	ctx.numacopymatrix = false;
+	ctx.buildtol = 0;
+	ctx.filllevel = 1;
+	ctx.ilutfillfactor = 2;
+	ctx.refactortol = -1;
+	ctx.refactorlevels = 1;
+	ctx.syncfreefactor = false;
+	strcpy(ctx.applytype, "async");
+	ctx.tilecachekb = 0;
+	ctx.tileinnersweeps = 2;
+	ctx.colordistance = 1;
+	ctx.balancedcolors = false;
+	ctx.incompletesai = false;
+	ctx.chebeigiters = 10;
+	ctx.chebeigratio = 0.3;
+	strcpy(ctx.reordering, "natural");
+	ctx.buildsweeps = 0;
+	ctx.localmat = NULL;
 	ctx.cputime = ctx.walltime = ctx.factorcputime = ctx.factorwalltime
-		= ctx.applycputime = ctx.applywalltime = 0.0;
+		= ctx.applycputime = ctx.applywalltime = ctx.structwalltime = 0.0;
 	ctx.next = NULL;
 	return ctx;
 }
@@ -344,6 +526,8 @@ PetscErrorCode cleanup_blasted(PC pc)
 	ierr = PCShellGetContext(pc, (void**)&ctx); CHKERRQ(ierr);
 	BlastedPreconditioner* prec = reinterpret_cast<BlastedPreconditioner*>(ctx->bprec);
 	delete prec;
+	delete static_cast<SRMatrixStorage<PetscReal,PetscInt>*>(ctx->localmat);
+	ctx->localmat = NULL;
 
 	return ierr;
 }
@@ -658,6 +842,9 @@ PetscErrorCode setup_localpreconditioner_blasted(KSP ksp, Blasted_data *const bc
 
 	// set a relaxation application only for supported preconditioners
 	if(bctx->prectype != BLASTED_ILU0 &&
+	   bctx->prectype != BLASTED_ILUK &&
+	   bctx->prectype != BLASTED_PARILUT &&
+	   bctx->prectype != BLASTED_MC_ILU0 &&
 	   bctx->prectype != BLASTED_CSC_BGS &&
 	   bctx->prectype != BLASTED_NO_PREC)
 	{
@@ -671,6 +858,7 @@ PetscErrorCode setup_localpreconditioner_blasted(KSP ksp, Blasted_data *const bc
 void computeTotalTimes(Blasted_data_list *const bctv)
 {
 	bctv->factorcputime = bctv->factorwalltime = bctv->applycputime = bctv->applywalltime = 0.0;
+	bctv->structwalltime = 0.0;
 
 	Blasted_data *node = bctv->ctxlist;
 	while(node != NULL){
@@ -678,6 +866,7 @@ void computeTotalTimes(Blasted_data_list *const bctv)
 		bctv->applywalltime += node->applywalltime;
 		bctv->factorcputime += node->factorcputime;
 		bctv->applycputime += node->applycputime;
+		bctv->structwalltime += node->structwalltime;
 		node = node->next;
 	}
 }
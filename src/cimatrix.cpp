@@ -0,0 +1,109 @@
+/** \file
+ * \brief Compression of the column indices of sparse-row matrices to 16-bit offsets
+ * \author Aditya Kashi
+ *
+ * This file is part of BLASTed.
+ *   BLASTed is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   BLASTed is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with BLASTed.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "cimatrixdefs.hpp"
+
+namespace blasted {
+
+/// Whether the column of an entry in the given row must be stored as an escape
+template <typename index>
+static inline bool needs_escape(const index irow, const index col)
+{
+	const index off = col - irow;
+	return off <= static_cast<index>(CI_ESCAPE) || off > std::numeric_limits<ci_offset_t>::max();
+}
+
+template <typename scalar, typename index>
+void compress_column_indices(const CRawBSRMatrix<scalar,index>& mat,
+                             CompressedColumnIndex<index>& cind)
+{
+	const index N = mat.nbrows;
+	cind.nbrows = N;
+	cind.offsets.resize(mat.browptr[N]);
+	cind.escptr.resize(N+1);
+	cind.escdiagptr.resize(N);
+
+	// count escapes in each row
+
+	cind.escptr[0] = 0;
+#pragma omp parallel for default(shared)
+	for(index irow = 0; irow < N; irow++)
+	{
+		index nesc = 0;
+		for(index jj = mat.browptr[irow]; jj < mat.browptr[irow+1]; jj++)
+			if(needs_escape(irow, mat.bcolind[jj]))
+				nesc++;
+		cind.escptr[irow+1] = nesc;
+	}
+
+	for(index irow = 0; irow < N; irow++)
+		cind.escptr[irow+1] += cind.escptr[irow];
+
+	cind.escapes.resize(cind.escptr[N]);
+
+	// fill
+
+#pragma omp parallel for default(shared)
+	for(index irow = 0; irow < N; irow++)
+	{
+		index e = cind.escptr[irow];
+		for(index jj = mat.browptr[irow]; jj < mat.browptr[irow+1]; jj++)
+		{
+			if(jj == mat.diagind[irow]+1)
+				cind.escdiagptr[irow] = e;
+
+			const index col = mat.bcolind[jj];
+			if(needs_escape(irow, col)) {
+				cind.offsets[jj] = CI_ESCAPE;
+				cind.escapes[e++] = col;
+			}
+			else
+				cind.offsets[jj] = static_cast<ci_offset_t>(col - irow);
+		}
+
+		if(mat.diagind[irow]+1 >= mat.browptr[irow+1])
+			cind.escdiagptr[irow] = e;
+	}
+}
+
+template void compress_column_indices(const CRawBSRMatrix<double,int>& mat,
+                                      CompressedColumnIndex<int>& cind);
+
+/// Address of the first entry of an array, or null if it is empty
+template <typename T>
+static inline const T *first_or_null(const ArrayView<T>& arr)
+{
+	return arr.size() > 0 ? &arr[0] : nullptr;
+}
+
+template <typename index>
+CRawCompressedColumnIndex<index> createRawView(const CompressedColumnIndex<index>& cind)
+{
+	CRawCompressedColumnIndex<index> rind;
+	rind.offsets = first_or_null(cind.offsets);
+	rind.escapes = first_or_null(cind.escapes);
+	rind.escptr = first_or_null(cind.escptr);
+	rind.escdiagptr = first_or_null(cind.escdiagptr);
+	rind.nbrows = cind.nbrows;
+	return rind;
+}
+
+template CRawCompressedColumnIndex<int> createRawView(const CompressedColumnIndex<int>& cind);
+
+}
@@ -22,6 +22,10 @@
 #include "blasted_config.hpp"
 #include "helper_algorithms.hpp"
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 namespace blasted {
 namespace internal {
 
@@ -65,12 +69,58 @@ template void sortBlockInnerDimension<double,int,5>(const int N,
 template void sortBlockInnerDimension<double,int,7>(const int N,
                                                     int *const colind, double *const vals);
 
+/// Scans a random-access container of indices in place
+/** For long vectors, each thread scans a contiguous part, after which the sums of the preceding
+ * parts are added in a second parallel pass.
+ */
+template <typename Vec>
+static void inclusive_scan_inplace(Vec& v)
+{
+	using index = typename Vec::value_type;
+	const size_t n = v.size();
+#ifdef _OPENMP
+	const int maxthreads = omp_get_max_threads();
+#else
+	const int maxthreads = 1;
+#endif
+
+	if(maxthreads == 1 || n < static_cast<size_t>(maxthreads)*4096) {
+		// serial
+		for(size_t i = 1; i < n; i++)
+			v[i] += v[i-1];
+		return;
+	}
+
+	std::vector<index> partsum(maxthreads+1, 0);
+
+#pragma omp parallel default(shared)
+	{
+		int nthreads = 1, tid = 0;
+#ifdef _OPENMP
+		nthreads = omp_get_num_threads();
+		tid = omp_get_thread_num();
+#endif
+		const size_t start = n*tid/nthreads, end = n*(tid+1)/nthreads;
+
+		for(size_t i = start+1; i < end; i++)
+			v[i] += v[i-1];
+		partsum[tid+1] = end > start ? v[end-1] : 0;
+
+#pragma omp barrier
+#pragma omp single
+		for(int t = 1; t <= nthreads; t++)
+			partsum[t] += partsum[t-1];
+
+		const index offset = partsum[tid];
+		for(size_t i = start; i < end; i++)
+			v[i] += offset;
+	}
+}
+
 template <typename index>
 void inclusive_scan(std::vector<index>& v)
 {
-	// serial
-	for(size_t i = 1; i < v.size(); i++)
-		v[i] += v[i-1];
+	inclusive_scan_inplace(v);
 }
 
 template void inclusive_scan(std::vector<int>& v);
@@ -88,9 +138,7 @@ template void inclusive_scan(std::vector<int>& v);
 template <typename index>
 void inclusive_scan(device_vector<index>& v)
 {
-	// serial
-	for(size_t i = 1; i < v.size(); i++)
-		v[i] += v[i-1];
+	inclusive_scan_inplace(v);
 }
 
 template void inclusive_scan(device_vector<int>& v);
@@ -0,0 +1,170 @@
+/** \file
+ * \brief Implementation of ILU application through incomplete sparse approximate inverses
+ * \author Aditya Kashi
+ *
+ * This file is part of BLASTed.
+ *   BLASTed is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   BLASTed is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with BLASTed.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <new>
+#include <Eigen/LU>
+#include <boost/align/aligned_alloc.hpp>
+#include "blas/matvecs.hpp"
+#include "ilu_isai.hpp"
+
+namespace blasted {
+
+using boost::alignment::aligned_alloc;
+using boost::alignment::aligned_free;
+
+template <typename scalar, typename index, int bs, StorageOptions stor>
+ILUISAI<scalar,index,bs,stor>::ILUISAI(const bool inverted_diagonal)
+	: invdiag{inverted_diagonal}, factvals{nullptr}, ytemp{nullptr}
+{ }
+
+template <typename scalar, typename index, int bs, StorageOptions stor>
+ILUISAI<scalar,index,bs,stor>::~ILUISAI()
+{
+	aligned_free(factvals);
+	aligned_free(ytemp);	aligned_free(ymulti);
+}
+
+template <typename scalar, typename index, int bs, StorageOptions stor>
+void ILUISAI<scalar,index,bs,stor>::reset()
+{
+	isaipatt.reset();
+}
+
+template <typename scalar, typename index, int bs, StorageOptions stor>
+void ILUISAI<scalar,index,bs,stor>::setup(const CRawBSRMatrix<scalar,index>& mat)
+{
+	isaipatt = triangular_SAI_patterns(mat, bs, false);
+
+	triangular_part_pattern(mat, bs, true, linv);
+	triangular_part_pattern(mat, bs, false, uinv);
+
+	aligned_free(factvals);
+	aligned_free(ytemp);
+	factvals = (scalar*)aligned_alloc(CACHE_LINE_LEN, mat.browptr[mat.nbrows]*bs*bs*sizeof(scalar));
+	ytemp = (scalar*)aligned_alloc(CACHE_LINE_LEN, mat.nbrows*bs*sizeof(scalar));
+	if(!factvals || !ytemp)
+		throw std::bad_alloc();
+}
+
+/** The factors are copied with a unit diagonal for L, and the ISAI of L is computed from the lower
+ * triangular view of the copy. The diagonal of the copy is then overwritten with that of U, not
+ * inverted, and the ISAI of U is computed from the upper triangular view.
+ */
+template <typename scalar, typename index, int bs, StorageOptions stor>
+void ILUISAI<scalar,index,bs,stor>::compute(const CRawBSRMatrix<scalar,index>& mat,
+                                            const scalar *const iluvals, const scalar *const scale,
+                                            const int thread_chunk_size)
+{
+	using Blk = Block_t<scalar,bs,stor>;
+
+	if(!isaipatt)
+		setup(mat);
+
+	const Blk *const ilu = reinterpret_cast<const Blk*>(iluvals);
+	Blk *const fact = reinterpret_cast<Blk*>(factvals);
+
+#pragma omp parallel for default(shared)
+	for(index irow = 0; irow < mat.nbrows; irow++)
+	{
+		for(index jj = mat.browptr[irow]; jj < mat.browendptr[irow]; jj++)
+			fact[jj] = ilu[jj];
+		fact[mat.diagind[irow]] = Blk::Identity();
+	}
+
+	{
+		SRMatrixStorage<const scalar,const index> fmat(mat.browptr, mat.bcolind, factvals,
+		                                               mat.diagind, mat.browendptr, mat.nbrows,
+		                                               mat.nnzb, mat.nbstored, bs);
+		const SRMatrixStorage<const scalar,const index> lower = getLowerTriangularView(std::move(fmat));
+		compute_SAI<scalar,index,bs,stor>(lower, isaipatt->lower, thread_chunk_size, false, linv);
+	}
+
+#pragma omp parallel for default(shared)
+	for(index irow = 0; irow < mat.nbrows; irow++)
+	{
+		const index d = mat.diagind[irow];
+		if(invdiag)
+			fact[d] = ilu[d].inverse();
+		else
+			fact[d] = ilu[d];
+	}
+
+	{
+		SRMatrixStorage<const scalar,const index> fmat(mat.browptr, mat.bcolind, factvals,
+		                                               mat.diagind, mat.browendptr, mat.nbrows,
+		                                               mat.nnzb, mat.nbstored, bs);
+		const SRMatrixStorage<const scalar,const index> upper = getUpperTriangularView(std::move(fmat));
+		compute_SAI<scalar,index,bs,stor>(upper, isaipatt->upper, thread_chunk_size, false, uinv);
+	}
+
+	if(scale)
+	{
+		Blk *const lb = reinterpret_cast<Blk*>(&linv.vals[0]);
+		Blk *const ub = reinterpret_cast<Blk*>(&uinv.vals[0]);
+
+#pragma omp parallel for default(shared)
+		for(index irow = 0; irow < mat.nbrows; irow++)
+		{
+			for(index jj = linv.browptr[irow]; jj < linv.browptr[irow+1]; jj++)
+				for(int k = 0; k < bs; k++)
+					lb[jj].col(k) *= scale[linv.bcolind[jj]*bs+k];
+
+			for(index jj = uinv.browptr[irow]; jj < uinv.browptr[irow+1]; jj++)
+				for(int k = 0; k < bs; k++)
+					ub[jj].row(k) *= scale[irow*bs+k];
+		}
+	}
+}
+
+template <typename scalar, typename index, int bs, StorageOptions stor>
+void ILUISAI<scalar,index,bs,stor>::apply(const scalar *const r, scalar *const __restrict z) const
+{
+	using SpMV = typename BLAS_SR<const scalar,const index,bs,stor>::type;
+	SpMV::matrix_apply(share_with_const(linv, bs), r, ytemp);
+	SpMV::matrix_apply(share_with_const(uinv, bs), ytemp, z);
+}
+
+template <typename scalar, typename index, int bs, StorageOptions stor>
+void ILUISAI<scalar,index,bs,stor>::apply_multi(const int nvecs, const scalar *const r,
+                                                scalar *const __restrict z) const
+{
+	using SpMV = typename BLAS_SR<const scalar,const index,bs,stor>::type;
+	if(nvecs > nymultivecs) {
+		aligned_free(ymulti);
+		nymultivecs = 0;
+		ymulti = (scalar*)aligned_alloc(CACHE_LINE_LEN, linv.nbrows*bs*nvecs*sizeof(scalar));
+		if(!ymulti)
+			throw std::bad_alloc();
+		nymultivecs = nvecs;
+	}
+	SpMV::matrix_apply_multi(share_with_const(linv, bs), nvecs, r, ymulti);
+	SpMV::matrix_apply_multi(share_with_const(uinv, bs), nvecs, ymulti, z);
+}
+
+template class ILUISAI<double,int,1,ColMajor>;
+template class ILUISAI<double,int,4,ColMajor>;
+template class ILUISAI<double,int,5,ColMajor>;
+template class ILUISAI<double,int,4,RowMajor>;
+
+#ifdef BUILD_BLOCK_SIZE
+template class ILUISAI<double,int,BUILD_BLOCK_SIZE,ColMajor>;
+template class ILUISAI<double,int,BUILD_BLOCK_SIZE,RowMajor>;
+#endif
+
+}
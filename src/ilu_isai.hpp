@@ -0,0 +1,83 @@
+/** \file
+ * \brief Application of ILU factors through incomplete sparse approximate inverses
+ * \author Aditya Kashi
+ *
+ * The triangular solves needed to apply incomplete LU factors are inherently sequential; even
+ * when carried out asynchronously or in a synchronization-free manner, their latency limits the
+ * scaling to many cores. Replacing each factor by an incomplete sparse approximate inverse (ISAI)
+ * \cite isai:anzt turns the application into two sparse matrix-vector products.
+ */
+
+#ifndef BLASTED_ILU_ISAI_H
+#define BLASTED_ILU_ISAI_H
+
+#include <memory>
+#include "srmatrixdefs.hpp"
+#include "sai.hpp"
+
+namespace blasted {
+
+/// Incomplete sparse approximate inverses of the triangular factors of an ILU factorization
+/** The approximate inverses have the patterns of the triangular factors, and are stored in their
+ * own compact sparse-row matrices. The symmetric scaling applied to the matrix before
+ * factorization, if any, is folded into them: the columns of the inverse of L and the rows of the
+ * inverse of U are scaled. Application is thus exactly two sparse matrix-vector products.
+ *
+ * The assembly patterns depend only on the pattern of the matrix and are shared among instances
+ * having the same pattern \sa StructuralCache
+ */
+template <typename scalar, typename index, int bs, StorageOptions stor>
+class ILUISAI
+{
+public:
+	/** \param inverted_diagonal Whether the diagonal (blocks) of the factors are stored inverted
+	 */
+	ILUISAI(const bool inverted_diagonal);
+
+	~ILUISAI();
+
+	/// Computes the approximate inverses of the factors
+	/** The patterns are set up the first time, or if \ref reset has been called since.
+	 * \param mat The matrix whose pattern the ILU factors have
+	 * \param iluvals The ILU factors: the strictly lower part of L, and U; L has a unit diagonal
+	 * \param scale The vector that scaled the matrix symmetrically before factorization, or null
+	 * \param thread_chunk_size Number of rows given to a thread at a time
+	 */
+	void compute(const CRawBSRMatrix<scalar,index>& mat, const scalar *const iluvals,
+	             const scalar *const scale, const int thread_chunk_size);
+
+	/// Marks the patterns as stale, for when the pattern of the factors has changed
+	void reset();
+
+	/// Applies the approximate inverses of U and L in turn
+	void apply(const scalar *const r, scalar *const __restrict z) const;
+
+	/// Applies the approximate inverses to several row-interleaved vectors at once
+	void apply_multi(const int nvecs, const scalar *const r, scalar *const __restrict z) const;
+
+protected:
+	const bool invdiag;                            ///< Whether the stored diagonal is inverted
+
+	/// Patterns of the least-squares problems, shared among instances having the same pattern
+	std::shared_ptr<const TriangularSAIPattern<index>> isaipatt;
+
+	SRMatrixStorage<scalar,index> linv;            ///< Approximate inverse of L
+	SRMatrixStorage<scalar,index> uinv;            ///< Approximate inverse of U
+
+	/// Copy of the factors with a unit diagonal for L or the non-inverted diagonal of U
+	scalar *factvals;
+
+	/// Temporary storage for the result of application of the inverse of L
+	scalar *ytemp;
+
+	/// Temporary storage like \ref ytemp for several vectors at once, grown on demand
+	mutable scalar *ymulti = nullptr;
+	mutable int nymultivecs = 0;                   ///< Number of vectors \ref ymulti can hold
+
+	/// Allocates the storage and sets the patterns of the approximate inverses
+	void setup(const CRawBSRMatrix<scalar,index>& mat);
+};
+
+}
+
+#endif
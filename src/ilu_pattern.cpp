@@ -18,148 +18,207 @@
  */
 
 #include <numeric>
+#include <limits>
+#include <cassert>
 #include <iostream>
+#include <string>
+#include <stdexcept>
 #include "ilu_pattern.hpp"
 #include "helper_algorithms.hpp"
 
 namespace blasted {
 
-/** 
- * \note In the loops, the variable pos is initially set negative.
- * If index is an unsigned type, that might be a problem.
+/// Visits the pairs of positions whose product contributes to the ILU(0) factors in one row
+/** For each entry (irow,k) of the strictly lower part of row irow, the part of row irow after
+ * position k is intersected with the upper part (including the diagonal) of row bcolind[k] by
+ * merging the two sorted lists of column indices. Each common column index gives an entry j of
+ * row irow and an entry ipos of row bcolind[k] such that the product of the factor entries at k
+ * and ipos is needed for computing the entry at j.
+ *
+ * Positions are visited in increasing order of k for each j.
+ * \param visit Callable taking (j, k, ipos)
+ */
+template <typename scalar, typename index, typename Visitor>
+static inline void visit_ILU_positions(const CRawBSRMatrix<scalar,index> *const mat, const index irow,
+                                       Visitor&& visit)
+{
+	const index rowend = mat->browptr[irow+1];
+	for(index k = mat->browptr[irow]; k < rowend && mat->bcolind[k] < irow; k++)
+	{
+		const index krow = mat->bcolind[k];
+		const index krowend = mat->browptr[krow+1];
+		index j = k+1, ipos = mat->diagind[krow];
+		while(j < rowend && ipos < krowend)
+		{
+			if(mat->bcolind[j] < mat->bcolind[ipos])
+				j++;
+			else if(mat->bcolind[j] > mat->bcolind[ipos])
+				ipos++;
+			else {
+				visit(j, k, ipos);
+				j++;
+				ipos++;
+			}
+		}
+	}
+}
+
+/** The number of positions needed by each non-zero is counted, in parallel over rows, by merging
+ * sorted rows. After a scan of the counts, the positions are stored in a second parallel pass.
+ * The column indices in each row must be sorted.
  */
 template <typename scalar, typename index>
-ILUPositions<index> compute_ILU_positions_CSR_CSR(const CRawBSRMatrix<scalar,index> *const mat)
+void compute_ILU_positions_CSR_CSR(const CRawBSRMatrix<scalar,index> *const mat,
+                                   ILUPositions<index>& pos)
 {
 	static_assert(std::numeric_limits<index>::is_signed, "Signed index type required!");
 	static_assert(std::numeric_limits<index>::is_integer, "Integer index type required!");
 
-	ILUPositions<index> pos;
 	const index pattern_size = mat->browptr[mat->nbrows];
 
-	std::vector<size_t> numpos(pattern_size,0);
-	pos.posptr.resize(pattern_size+1);
-	pos.posptr[0] = 0;
+	pos.posptr.assign(pattern_size+1, 0);
 
 	// compute number of indices that need to stored for each nonzero
-	for(index irow = 0; irow < mat->nbrows; irow++) {
-		for(index j = mat->browptr[irow]; j < mat->browptr[irow+1]; j++)
-		{
-			if(irow > mat->bcolind[j])
-			{
-				for(index k = mat->browptr[irow]; 
-				    (k < mat->browptr[irow+1]) && (mat->bcolind[k] < mat->bcolind[j]); 
-				    k++  ) 
-				{
-					index ipos = -1;
-					internal::inner_search(mat->bcolind, mat->diagind[mat->bcolind[k]], 
-					                       mat->browptr[mat->bcolind[k]+1], mat->bcolind[j], &ipos);
-
-					if(ipos > -1)
-						numpos[j]++;
-				}
-			}
-			else
-			{
-				// u_ij
-
-				for(index k = mat->browptr[irow]; 
-				    (k < mat->browptr[irow+1]) && (mat->bcolind[k] < irow); k++) 
-				{
-					index ipos = -1;
-
-					/* search for column index mat->bcolind[j], 
-					 * between the diagonal index of row mat->bcolind[k] 
-					 * and the last index of row mat->bcolind[k]
-					 */
-					internal::inner_search(mat->bcolind, mat->diagind[mat->bcolind[k]], 
-					                       mat->browptr[mat->bcolind[k]+1], mat->bcolind[j], &ipos);
-
-					if(ipos > -1)
-						numpos[j]++;
-				}
-			}
-
-			pos.posptr[j+1] = numpos[j];
-		}
+#pragma omp parallel for default(shared) schedule(dynamic, 256)
+	for(index irow = 0; irow < mat->nbrows; irow++)
+	{
+		visit_ILU_positions(mat, irow, [&pos](const index j, const index, const index) {
+			pos.posptr[j+1]++;
+		});
 	}
 
-	const size_t totallen = std::accumulate(numpos.begin(), numpos.end(), 0);
 	internal::inclusive_scan(pos.posptr);
-
-	assert(static_cast<size_t>(pos.posptr[pattern_size]) == totallen);
-
-	// check for structured grids
-	// for(index irow = 0; irow < mat->nbrows; irow++)
-	// {
-	// 	for(index jj = mat->browptr[irow]; jj < mat->browptr[irow+1]; jj++)
-	// 		if(jj != mat->diagind[irow])
-	// 			assert(pos.posptr[jj+1]-pos.posptr[jj] == 0);
-	// }
+	const index totallen = pos.posptr[pattern_size];
 
 	pos.lowerp.resize(totallen);
 	pos.upperp.resize(totallen);
 
-	for(index irow = 0; irow < mat->nbrows; irow++) {
-		for(index j = mat->browptr[irow]; j < mat->browptr[irow+1]; j++)
+	// next free location for each non-zero
+	std::vector<index> fillpos(pos.posptr.begin(), pos.posptr.end()-1);
+
+#pragma omp parallel for default(shared) schedule(dynamic, 256)
+	for(index irow = 0; irow < mat->nbrows; irow++)
+	{
+		visit_ILU_positions(mat, irow, [&pos,&fillpos](const index j, const index k, const index ipos) {
+			const index loc = fillpos[j]++;
+			pos.lowerp[loc] = k;
+			pos.upperp[loc] = ipos;
+		});
+	}
+
+#ifdef DEBUG
+	for(index j = 0; j < pattern_size; j++)
+		assert(fillpos[j] == pos.posptr[j+1]);
+#endif
+}
+
+template <typename scalar, typename index>
+ILUPositions<index> compute_ILU_positions_CSR_CSR(const CRawBSRMatrix<scalar,index> *const mat)
+{
+	ILUPositions<index> pos;
+	compute_ILU_positions_CSR_CSR(mat, pos);
+	std::cout << "  ILU_positions: Computed required locations in L and U factors." << std::endl;
+	return pos;
+}
+
+template void compute_ILU_positions_CSR_CSR(const CRawBSRMatrix<double,int> *const mat,
+                                            ILUPositions<int>& pos);
+template ILUPositions<int> compute_ILU_positions_CSR_CSR(const CRawBSRMatrix<double,int> *const mat);
+
+/** The current row is kept as a linked list of column indices sorted in increasing order, with the
+ * level of fill of each entry in a dense array. Each entry of the row left of the diagonal, in
+ * increasing order, is eliminated using the upper part of the corresponding previous row of the
+ * result; fill-in is inserted into the list as it is found, right of the entry being eliminated.
+ */
+template <typename scalar, typename index>
+ILUkPattern<index> compute_ILUk_pattern(const CRawBSRMatrix<scalar,index> *const mat,
+                                        const int fill_level)
+{
+	if(fill_level < 0)
+		throw std::invalid_argument("ILUk pattern: Level of fill must be non-negative!");
+
+	const index n = mat->nbrows;
+	ILUkPattern<index> pat;
+	pat.browptr.resize(n+1);
+	pat.diagind.resize(n);
+	pat.origpos.resize(mat->browptr[n]);
+	pat.bcolind.reserve(mat->browptr[n]);
+	std::vector<int> levels;              // level of fill of each entry of the result
+	levels.reserve(mat->browptr[n]);
+
+	// Linked list of columns in the current row; n marks the end. Levels of absent entries are -1.
+	std::vector<index> next(n+1, -1);
+	std::vector<int> rowlev(n, -1);
+
+	pat.browptr[0] = 0;
+	for(index irow = 0; irow < n; irow++)
+	{
+		if(mat->bcolind[mat->diagind[irow]] != irow)
+			throw std::runtime_error("ILUk pattern: Diagonal entry missing in row "
+			                         + std::to_string(irow) + "!");
+
+		index head = n;
+		for(index j = mat->browendptr[irow]-1; j >= mat->browptr[irow]; j--) {
+			const index col = mat->bcolind[j];
+			next[col] = head;
+			head = col;
+			rowlev[col] = 0;
+		}
+
+		for(index k = head; k < irow; k = next[k])
 		{
-			if(irow > mat->bcolind[j])
-			{
-				index offset = 0;
-
-				for(index k = mat->browptr[irow]; 
-				    (k < mat->browptr[irow+1]) && (mat->bcolind[k] < mat->bcolind[j]); 
-				    k++  ) 
-				{
-					index ipos = -1;
-					internal::inner_search(mat->bcolind, mat->diagind[mat->bcolind[k]], 
-					                       mat->browptr[mat->bcolind[k]+1], mat->bcolind[j], &ipos);
-
-					if(ipos != -1)
-					{
-						pos.lowerp[pos.posptr[j]+offset] = k;
-						pos.upperp[pos.posptr[j]+offset] = ipos;
-						offset++;
-					}
-				}
+			const int levk = rowlev[k];
+			if(levk >= fill_level)
+				continue;
 
-				assert(static_cast<size_t>(offset) == numpos[j]);
-			}
-			else
+			index prev = k;
+			for(index kk = pat.diagind[k]+1; kk < pat.browptr[k+1]; kk++)
 			{
-				// u_ij
-
-				index offset = 0;
-
-				for(index k = mat->browptr[irow];
-				    (k < mat->browptr[irow+1]) && (mat->bcolind[k] < irow); k++) 
-				{
-					index ipos = -1;
-
-					/* search for column index mat->bcolind[j], 
-					 * between the diagonal index of row mat->bcolind[k] 
-					 * and the last index of row mat->bcolind[k]
-					 */
-					internal::inner_search(mat->bcolind, mat->diagind[mat->bcolind[k]], 
-					                       mat->browptr[mat->bcolind[k]+1], mat->bcolind[j], &ipos);
-
-					if(ipos != -1)
-					{
-						pos.lowerp[pos.posptr[j]+offset] = k;
-						pos.upperp[pos.posptr[j]+offset] = ipos;
-						offset++;
-					}
+				const int newlev = levk + levels[kk] + 1;
+				if(newlev > fill_level)
+					continue;
+
+				const index col = pat.bcolind[kk];
+				if(rowlev[col] < 0) {
+					// columns in row k are increasing, so the search can resume from the last one
+					while(next[prev] < col)
+						prev = next[prev];
+					next[col] = next[prev];
+					next[prev] = col;
+					rowlev[col] = newlev;
 				}
+				else if(newlev < rowlev[col])
+					rowlev[col] = newlev;
 
-				assert(static_cast<size_t>(offset) == numpos[j]);
+				prev = col;
 			}
 		}
+
+		for(index col = head; col < n; col = next[col])
+		{
+			if(col == irow)
+				pat.diagind[irow] = static_cast<index>(pat.bcolind.size());
+			pat.bcolind.push_back(col);
+			levels.push_back(rowlev[col]);
+			rowlev[col] = -1;
+		}
+		pat.browptr[irow+1] = static_cast<index>(pat.bcolind.size());
+
+		// the original entries appear in the same order in the new row
+		index jpos = pat.browptr[irow];
+		for(index j = mat->browptr[irow]; j < mat->browendptr[irow]; j++) {
+			while(pat.bcolind[jpos] != mat->bcolind[j])
+				jpos++;
+			pat.origpos[j] = jpos;
+		}
 	}
 
-	std::cout << "  ILU_positions: Computed required locations in L and U factors." << std::endl;
-	return pos;
+	std::cout << "  ILUk_pattern: Level " << fill_level << " pattern has " << pat.browptr[n]
+	          << " non-zeros against " << mat->browptr[n] << " in the original matrix." << std::endl;
+	return pat;
 }
 
-template ILUPositions<int> compute_ILU_positions_CSR_CSR(const CRawBSRMatrix<double,int> *const mat);
+template ILUkPattern<int> compute_ILUk_pattern(const CRawBSRMatrix<double,int> *const mat,
+                                               const int fill_level);
 
 }
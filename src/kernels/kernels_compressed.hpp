@@ -0,0 +1,126 @@
+/** \file kernels_compressed.hpp
+ * \brief Row kernels that decode compressed (16-bit) column indices on the fly
+ * \author Aditya Kashi
+ *
+ * See \ref CompressedColumnIndex for the format. Each kernel walks a contiguous range of one row,
+ * with a cursor into the escape array that must point to the first escape of that range.
+ */
+
+#ifndef BLASTED_KERNELS_COMPRESSED_H
+#define BLASTED_KERNELS_COMPRESSED_H
+
+#include "cimatrixdefs.hpp"
+#include "kernels_blockops.hpp"
+
+namespace blasted {
+
+namespace kernels {
+
+/// Decodes the column index of entry jj of row irow
+/** \param[in,out] esc Cursor into the escape array; advanced if the entry is an escape
+ */
+template <typename index> inline
+index ci_column(const CRawCompressedColumnIndex<index>& cind, const index irow, const index jj,
+                index& esc)
+{
+	const ci_offset_t off = cind.offsets[jj];
+	return off != CI_ESCAPE ? irow + off : cind.escapes[esc++];
+}
+
+/// Dot product of a range of a CSR row with a vector
+/** \param vals Non-zero values of the matrix
+ * \param cind Compressed column indices of the matrix
+ * \param irow The row
+ * \param start Index of the first entry of the row to use
+ * \param end One past the index of the last entry to use
+ * \param esc Location of the first escape in the range in the escape array
+ * \param x The vector to multiply
+ */
+template <typename scalar, typename index> inline
+scalar scalar_row_product_ci(const scalar *const __restrict vals,
+                             const CRawCompressedColumnIndex<index>& cind,
+                             const index irow, const index start, const index end, index esc,
+                             const scalar *const __restrict x)
+{
+	scalar inter = 0;
+	for(index jj = start; jj < end; jj++)
+		inter += vals[jj]*x[ci_column(cind, irow, jj, esc)];
+	return inter;
+}
+
+/// Accumulates the product of a range of blocks of a BSR block-row with a vector
+/** \param[in,out] inter The product is added to this
+ * \sa scalar_row_product_ci
+ */
+template <typename scalar, typename index, int bs, StorageOptions stor> inline
+void block_row_product_ci(const Block_t<scalar,bs,stor> *const vals,
+                          const CRawCompressedColumnIndex<index>& cind,
+                          const index irow, const index start, const index end, index esc,
+                          const Segment_t<scalar,bs> *const x, Segment_t<scalar,bs>& inter)
+{
+	for(index jj = start; jj < end; jj++)
+		block_gemv_add<scalar,bs,stor>(vals[jj], x[ci_column(cind, irow, jj, esc)], inter);
+}
+
+/// Forward Gauss-Seidel kernel using compressed column indices \sa scalar_fgs
+template <typename scalar, typename index> inline
+scalar scalar_fgs_ci(const scalar *const __restrict vals, const CRawCompressedColumnIndex<index>& cind,
+                     const index irow, const index rowstart, const index diagind,
+                     const scalar diag_entry_inv, const scalar rhs,
+                     const scalar *const __restrict x)
+{
+	const scalar inter = scalar_row_product_ci(vals, cind, irow, rowstart, diagind,
+	                                           cind.escptr[irow], x);
+	return diag_entry_inv * (rhs - inter);
+}
+
+/// Backward Gauss-Seidel kernel using compressed column indices \sa scalar_bgs
+template <typename scalar, typename index> inline
+scalar scalar_bgs_ci(const scalar *const __restrict vals, const CRawCompressedColumnIndex<index>& cind,
+                     const index irow, const index diagind, const index nextrowstart,
+                     const scalar diag_entry_inv, const scalar rhs,
+                     const scalar *const __restrict x)
+{
+	const scalar inter = scalar_row_product_ci(vals, cind, irow, diagind+1, nextrowstart,
+	                                           cind.escdiagptr[irow], x);
+	return rhs - diag_entry_inv*inter;
+}
+
+/// Forward block Gauss-Seidel kernel using compressed column indices \sa block_fgs
+template <typename scalar, typename index, int bs, StorageOptions stor> inline
+void block_fgs_ci(const Block_t<scalar,bs,stor> *const vals,
+                  const CRawCompressedColumnIndex<index>& cind,
+                  const index irow, const index browstart, const index bdiagind,
+                  const Block_t<scalar,bs,stor>& diaginv, const Segment_t<scalar,bs>& rhs,
+                  Segment_t<scalar,bs> *const x)
+{
+	Segment_t<scalar,bs> inter = Segment_t<scalar,bs>::Zero();
+	block_row_product_ci<scalar,index,bs,stor>(vals, cind, irow, browstart, bdiagind,
+	                                           cind.escptr[irow], x, inter);
+
+	const Segment_t<scalar,bs> res = rhs - inter;
+	block_gemv<scalar,bs,stor>(diaginv, res, x[irow]);
+}
+
+/// Backward block Gauss-Seidel kernel using compressed column indices \sa block_bgs
+template <typename scalar, typename index, int bs, StorageOptions stor> inline
+void block_bgs_ci(const Block_t<scalar,bs,stor> *const vals,
+                  const CRawCompressedColumnIndex<index>& cind,
+                  const index irow, const index bdiagind, const index nextbrowstart,
+                  const Block_t<scalar,bs,stor>& diaginv, const Segment_t<scalar,bs>& rhs,
+                  Segment_t<scalar,bs> *const x)
+{
+	Segment_t<scalar,bs> inter = Segment_t<scalar,bs>::Zero();
+	block_row_product_ci<scalar,index,bs,stor>(vals, cind, irow, bdiagind+1, nextbrowstart,
+	                                           cind.escdiagptr[irow], x, inter);
+
+	Segment_t<scalar,bs> dinter;
+	block_gemv<scalar,bs,stor>(diaginv, inter, dinter);
+	x[irow] = rhs - dinter;
+}
+
+}
+
+}
+
+#endif
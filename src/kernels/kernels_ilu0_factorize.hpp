@@ -6,8 +6,10 @@
 #ifndef BLASTED_KERNELS_ILU0_FACTORIZE_H
 #define BLASTED_KERNELS_ILU0_FACTORIZE_H
 
+#include <cmath>
 #include <Eigen/LU>
 #include "ilu_pattern.hpp"
+#include "kernels_blockops.hpp"
 
 namespace blasted {
 
@@ -15,14 +17,18 @@ namespace blasted {
 /** Depending on template parameters, it can
  * factorize a scaled matrix, though the original matrix is not modified.
  * \param[in] plist Lists of positions in the LU matrix required for the ILU computation
+ * \return If computeres is true, the 1-norm of the ILU remainder A - LU over the row, as estimated
+ *   from the factor values read during the update; otherwise zero.
  */
-template <typename scalar, typename index, bool needscalerow, bool needscalecol> inline
-void async_ilu0_factorize_kernel(const CRawBSRMatrix<scalar,index> *const mat,
-                                 const ILUPositions<index>& plist,
-                                 const index irow,
-                                 const scalar *const rowscale, const scalar *const colscale,
-                                 scalar *const __restrict iluvals)
+template <typename scalar, typename index, bool needscalerow, bool needscalecol,
+          bool computeres = false> inline
+scalar async_ilu0_factorize_kernel(const CRawBSRMatrix<scalar,index> *const mat,
+                                   const ILUPositions<index>& plist,
+                                   const index irow,
+                                   const scalar *const rowscale, const scalar *const colscale,
+                                   scalar *const __restrict iluvals)
 {
+	scalar resnorm = 0;
 	for(index j = mat->browptr[irow]; j < mat->browptr[irow+1]; j++)
 	{
 		scalar sum = mat->vals[j];
@@ -45,11 +51,18 @@ void async_ilu0_factorize_kernel(const CRawBSRMatrix<scalar,index> *const mat,
 		}
 
 		// For lower triangular part, divide by u_jj
-		if(irow > mat->bcolind[j])
-			sum = sum / iluvals[mat->diagind[mat->bcolind[j]]];
+		if(irow > mat->bcolind[j]) {
+			const scalar ujj = iluvals[mat->diagind[mat->bcolind[j]]];
+			if(computeres)
+				resnorm += std::abs(sum - iluvals[j]*ujj);
+			sum = sum / ujj;
+		}
+		else if(computeres)
+			resnorm += std::abs(sum - iluvals[j]);
 
 		iluvals[j] = sum;
 	}
+	return resnorm;
 }
 
 /// Scales a block using a symmetric scaling vector
@@ -68,13 +81,25 @@ inline void scaleBlock(const scalar *const scale, const index blockrow, const in
 			val(i,j) *= scale[blockrow*bs + i] * scale[blockcol*bs + j];
 }
 
-template <typename scalar, typename index, int bs, StorageOptions stor, bool usescaling>
-inline void async_block_ilu0_factorize(const CRawBSRMatrix<scalar,index> *const mat,
+/// Computes one block-row of an asynchronous block-ILU(0) factorization
+/** The Schur complement updates of each block are carried out as one batched sequence of small
+ * matrix products.
+ * \param[in,out] pivinv If not null, inverses of the diagonal blocks of U for each block-row. The
+ *   inverse for this row is updated along with its diagonal block, and those of previous rows are
+ *   used for the lower triangular blocks instead of inverting their pivot blocks every time.
+ * \return If computeres is true, the vector 1-norm of the ILU remainder A - LU over the block-row,
+ *   as estimated from the factor blocks read during the update; otherwise zero.
+ */
+template <typename scalar, typename index, int bs, StorageOptions stor, bool usescaling,
+          bool computeres = false>
+inline scalar async_block_ilu0_factorize(const CRawBSRMatrix<scalar,index> *const mat,
                                        const Block_t<scalar,bs,stor> *const mvals,
                                        const ILUPositions<index>& plist, const scalar *const scale,
                                        const index irow,
-                                       Block_t<scalar,bs,stor> *const __restrict ilu)
+                                       Block_t<scalar,bs,stor> *const __restrict ilu,
+                                       Block_t<scalar,bs,stor> *const __restrict pivinv = nullptr)
 {
+	scalar resnorm = 0;
 	for(index jpos = mat->browptr[irow]; jpos < mat->browptr[irow+1]; jpos++)
 	{
 		const index column = mat->bcolind[jpos];
@@ -83,18 +108,35 @@ inline void async_block_ilu0_factorize(const CRawBSRMatrix<scalar,index> *const
 		if(usescaling)
 			scaleBlock<scalar,index,bs,stor>(scale, irow, column, sum);
 
-		for(index k = plist.posptr[jpos]; k < plist.posptr[jpos+1]; k++)
-			sum.noalias() -= ilu[plist.lowerp[k]]*ilu[plist.upperp[k]];
+		kernels::block_gemm_sub_batch<scalar,bs,stor>(ilu, plist.lowerp.data()+plist.posptr[jpos],
+		                                              ilu, plist.upperp.data()+plist.posptr[jpos],
+		                                              plist.posptr[jpos+1]-plist.posptr[jpos], sum);
 
 		if(irow > column)
 		{
-			ilu[jpos].noalias() = sum * ilu[mat->diagind[column]].inverse();
+			if(computeres) {
+				Block_t<scalar,bs,stor> rem = sum;
+				kernels::block_gemm_sub<scalar,bs,stor>(ilu[jpos], ilu[mat->diagind[column]], rem);
+				resnorm += rem.cwiseAbs().sum();
+			}
+			if(pivinv)
+				kernels::block_gemm<scalar,bs,stor>(sum, pivinv[column], ilu[jpos]);
+			else {
+				Block_t<scalar,bs,stor> diaginv;
+				kernels::block_invert<scalar,bs,stor>(ilu[mat->diagind[column]], diaginv);
+				kernels::block_gemm<scalar,bs,stor>(sum, diaginv, ilu[jpos]);
+			}
 		}
 		else
 		{
+			if(computeres)
+				resnorm += (sum - ilu[jpos]).cwiseAbs().sum();
 			ilu[jpos].noalias() = sum;
+			if(pivinv && column == irow)
+				kernels::block_invert<scalar,bs,stor>(sum, pivinv[irow]);
 		}
 	}
+	return resnorm;
 }
 
 }
@@ -8,6 +8,9 @@
 #define BLASTED_KERNELS_ILU_APPLY_H
 
 #include "srmatrixdefs.hpp"
+#include "kernels_blockops.hpp"
+#include "kernels_multivec.hpp"
+#include "kernels_compressed.hpp"
 
 namespace blasted {
 	
@@ -58,10 +61,10 @@ void block_unit_lower_triangular(const Block_t<scalar,bs,stor> *const vals,
                                  const Segment_t<scalar,bs>& rhs,
                                  const index irow, Segment_t<scalar,bs> *const x)
 {
-	Matrix<scalar,bs,1> inter = Matrix<scalar,bs,1>::Zero();
+	Segment_t<scalar,bs> inter = Segment_t<scalar,bs>::Zero();
 
 	for(index jj = browstart; jj < bdiagind; jj++)
-		inter += vals[jj]*x[bcolind[jj]];
+		kernels::block_gemv_add<scalar,bs,stor>(vals[jj], x[bcolind[jj]], inter);
 
 	x[irow] = rhs - inter;
 }
@@ -83,14 +86,163 @@ void block_upper_triangular(const Block_t<scalar,bs,stor> *const vals,
                             const Segment_t<scalar,bs>& rhs,
                             const int irow, Segment_t<scalar,bs> *const x)
 {
-	Matrix<scalar,bs,1> inter = Matrix<scalar,bs,1>::Zero();
+	Segment_t<scalar,bs> inter = Segment_t<scalar,bs>::Zero();
 	
 	// compute U z
 	for(index jj = bdiagind+1; jj < nextbrowstart; jj++)
-		inter += vals[jj] * x[bcolind[jj]];
+		kernels::block_gemv_add<scalar,bs,stor>(vals[jj], x[bcolind[jj]], inter);
 
 	// compute z = D^(-1) (y - U z) for the irow-th block-segment of z
-	x[irow] = vals[bdiagind] * ( rhs - inter );
+	const Segment_t<scalar,bs> res = rhs - inter;
+	kernels::block_gemv<scalar,bs,stor>(vals[bdiagind], res, x[irow]);
+}
+
+/// Unit lower triangular solve kernel for one row of k row-interleaved vectors
+template <typename scalar, typename index> inline
+void scalar_unit_lower_triangular_multi(const scalar *const __restrict vals,
+                                        const index *const __restrict colind,
+                                        const index irow, const index rowstart, const index diagind,
+                                        const int k, const scalar *const __restrict rhs,
+                                        scalar *const x)
+{
+	for(int v0 = 0; v0 < k; v0 += kernels::MULTIVEC_GROUP)
+	{
+		const int nv = std::min(kernels::MULTIVEC_GROUP, k-v0);
+		scalar inter[kernels::MULTIVEC_GROUP] = {};
+		kernels::scalar_row_product_multi(vals, colind, rowstart, diagind, k, nv, x+v0, inter);
+
+#pragma omp simd
+		for(int v = 0; v < nv; v++)
+			x[irow*k+v0+v] = rhs[irow*k+v0+v] - inter[v];
+	}
+}
+
+/// Upper triangular solve kernel for one row of k row-interleaved vectors
+template <typename scalar, typename index> inline
+void scalar_upper_triangular_multi(const scalar *const __restrict vals,
+                                   const index *const __restrict colind,
+                                   const index irow, const index diagind, const index nextrowstart,
+                                   const scalar diag_entry_inv, const int k,
+                                   const scalar *const __restrict rhs, scalar *const x)
+{
+	for(int v0 = 0; v0 < k; v0 += kernels::MULTIVEC_GROUP)
+	{
+		const int nv = std::min(kernels::MULTIVEC_GROUP, k-v0);
+		scalar inter[kernels::MULTIVEC_GROUP] = {};
+		kernels::scalar_row_product_multi(vals, colind, diagind+1, nextrowstart, k, nv, x+v0, inter);
+
+#pragma omp simd
+		for(int v = 0; v < nv; v++)
+			x[irow*k+v0+v] = diag_entry_inv * (rhs[irow*k+v0+v] - inter[v]);
+	}
+}
+
+/// Block unit lower triangular solve kernel for one block-row of k row-interleaved vectors
+template <typename scalar, typename index, int bs, StorageOptions stor> inline
+void block_unit_lower_triangular_multi(const Block_t<scalar,bs,stor> *const vals,
+                                       const index *const bcolind,
+                                       const index browstart, const index bdiagind,
+                                       const int k, const scalar *const __restrict rhs,
+                                       const index irow, scalar *const x)
+{
+	for(int v0 = 0; v0 < k; v0 += kernels::MULTIVEC_GROUP)
+	{
+		const int nv = std::min(kernels::MULTIVEC_GROUP, k-v0);
+		scalar inter[bs*kernels::MULTIVEC_GROUP] = {};
+		kernels::block_row_product_multi<scalar,index,bs,stor>(vals, bcolind, browstart, bdiagind,
+		                                                       k, nv, x+v0, inter);
+
+		for(int i = 0; i < bs; i++)
+#pragma omp simd
+			for(int v = 0; v < nv; v++)
+				x[(irow*bs+i)*k+v0+v] = rhs[(irow*bs+i)*k+v0+v] - inter[i*nv+v];
+	}
+}
+
+/// Block upper triangular solve kernel for one block-row of k row-interleaved vectors
+/** The diagonal blocks of vals are assumed pre-inverted.
+ */
+template <typename scalar, typename index, int bs, StorageOptions stor> inline
+void block_upper_triangular_multi(const Block_t<scalar,bs,stor> *const vals,
+                                  const index *const bcolind,
+                                  const index bdiagind, const index nextbrowstart,
+                                  const int k, const scalar *const __restrict rhs,
+                                  const index irow, scalar *const x)
+{
+	for(int v0 = 0; v0 < k; v0 += kernels::MULTIVEC_GROUP)
+	{
+		const int nv = std::min(kernels::MULTIVEC_GROUP, k-v0);
+		scalar inter[bs*kernels::MULTIVEC_GROUP] = {};
+		scalar res[bs*kernels::MULTIVEC_GROUP] = {};
+		kernels::block_row_product_multi<scalar,index,bs,stor>(vals, bcolind, bdiagind+1,
+		                                                       nextbrowstart, k, nv, x+v0, inter);
+
+		for(int i = 0; i < bs; i++)
+#pragma omp simd
+			for(int v = 0; v < nv; v++)
+				inter[i*nv+v] = rhs[(irow*bs+i)*k+v0+v] - inter[i*nv+v];
+		kernels::block_panel_gemm_add<scalar,bs,stor>(vals[bdiagind], inter, nv, nv, res, nv);
+
+		for(int i = 0; i < bs; i++)
+			for(int v = 0; v < nv; v++)
+				x[(irow*bs+i)*k+v0+v] = res[i*nv+v];
+	}
+}
+
+/// Unit lower triangular solve using compressed column indices \sa scalar_unit_lower_triangular
+template <typename scalar, typename index> inline
+scalar scalar_unit_lower_triangular_ci(const scalar *const __restrict vals,
+                                       const CRawCompressedColumnIndex<index>& cind,
+                                       const index irow, const index rowstart, const index diagind,
+                                       const scalar rhs, const scalar *const __restrict x)
+{
+	return rhs - kernels::scalar_row_product_ci(vals, cind, irow, rowstart, diagind,
+	                                            cind.escptr[irow], x);
+}
+
+/// Upper triangular solve kernel using compressed column indices \sa scalar_upper_triangular
+template <typename scalar, typename index> inline
+scalar scalar_upper_triangular_ci(const scalar *const __restrict vals,
+                                  const CRawCompressedColumnIndex<index>& cind,
+                                  const index irow, const index diagind, const index nextrowstart,
+                                  const scalar diag_entry_inv, const scalar rhs,
+                                  const scalar *const __restrict x)
+{
+	const scalar inter = kernels::scalar_row_product_ci(vals, cind, irow, diagind+1, nextrowstart,
+	                                                    cind.escdiagptr[irow], x);
+	return diag_entry_inv * (rhs - inter);
+}
+
+/// Block unit lower triangular solve kernel using compressed column indices
+/// \sa block_unit_lower_triangular
+template <typename scalar, typename index, int bs, StorageOptions stor> inline
+void block_unit_lower_triangular_ci(const Block_t<scalar,bs,stor> *const vals,
+                                    const CRawCompressedColumnIndex<index>& cind,
+                                    const index browstart, const index bdiagind,
+                                    const Segment_t<scalar,bs>& rhs,
+                                    const index irow, Segment_t<scalar,bs> *const x)
+{
+	Segment_t<scalar,bs> inter = Segment_t<scalar,bs>::Zero();
+	kernels::block_row_product_ci<scalar,index,bs,stor>(vals, cind, irow, browstart, bdiagind,
+	                                                    cind.escptr[irow], x, inter);
+	x[irow] = rhs - inter;
+}
+
+/// Block upper triangular solve kernel using compressed column indices
+/// \sa block_upper_triangular
+template <typename scalar, typename index, int bs, StorageOptions stor> inline
+void block_upper_triangular_ci(const Block_t<scalar,bs,stor> *const vals,
+                               const CRawCompressedColumnIndex<index>& cind,
+                               const index bdiagind, const index nextbrowstart,
+                               const Segment_t<scalar,bs>& rhs,
+                               const index irow, Segment_t<scalar,bs> *const x)
+{
+	Segment_t<scalar,bs> inter = Segment_t<scalar,bs>::Zero();
+	kernels::block_row_product_ci<scalar,index,bs,stor>(vals, cind, irow, bdiagind+1, nextbrowstart,
+	                                                    cind.escdiagptr[irow], x, inter);
+
+	const Segment_t<scalar,bs> res = rhs - inter;
+	kernels::block_gemv<scalar,bs,stor>(vals[bdiagind], res, x[irow]);
 }
 
 }
@@ -0,0 +1,171 @@
+/** \file kernels_mixedprec.hpp
+ * \brief Kernels for matrices and factors stored in a lower precision than the working precision
+ * \author Aditya Kashi
+ *
+ * Matrix entries and factors of some storage type (eg. float) are read and converted to the
+ * working type scalar, in which all arithmetic and accumulation is done. Vectors are always of the
+ * working type. For the Gauss-Seidel kernels, the matrix entries (vscalar) and the inverted
+ * diagonal entries or blocks (dscalar) may be stored in different precisions.
+ */
+
+#ifndef BLASTED_KERNELS_MIXEDPREC_H
+#define BLASTED_KERNELS_MIXEDPREC_H
+
+#include "srmatrixdefs.hpp"
+#include "kernels_blockops.hpp"
+
+namespace blasted {
+
+namespace kernels {
+
+/// Dot product of a range of a CSR row, with entries stored in any precision, with a vector
+template <typename scalar, typename vscalar, typename index> inline
+scalar scalar_row_product_lp(const vscalar *const __restrict vals,
+                             const index *const __restrict colind,
+                             const index start, const index end,
+                             const scalar *const __restrict x)
+{
+	scalar inter = 0;
+#pragma omp simd reduction(+:inter)
+	for(index jj = start; jj < end; jj++)
+		inter += static_cast<scalar>(vals[jj])*x[colind[jj]];
+	return inter;
+}
+
+/// Accumulates the product of a range of blocks of a BSR block-row, with entries stored in any
+/// precision, with a vector
+/** \param[in,out] inter The product is added to this
+ */
+template <typename scalar, typename vscalar, typename index, int bs, StorageOptions stor> inline
+void block_row_product_lp(const Block_t<vscalar,bs,stor> *const vals,
+                          const index *const __restrict bcolind,
+                          const index start, const index end,
+                          const Segment_t<scalar,bs> *const x, Segment_t<scalar,bs>& inter)
+{
+	for(index jj = start; jj < end; jj++) {
+		const Block_t<scalar,bs,stor> a = vals[jj].template cast<scalar>();
+		block_gemv_add<scalar,bs,stor>(a, x[bcolind[jj]], inter);
+	}
+}
+
+/// y := A x for a block A stored in any precision
+template <typename scalar, typename lscalar, int bs, StorageOptions stor> inline
+void block_gemv_lp(const Block_t<lscalar,bs,stor>& la, const Segment_t<scalar,bs>& x,
+                   Segment_t<scalar,bs>& y)
+{
+	const Block_t<scalar,bs,stor> a = la.template cast<scalar>();
+	block_gemv<scalar,bs,stor>(a, x, y);
+}
+
+/// Forward Gauss-Seidel kernel with low-precision storage \sa scalar_fgs
+template <typename scalar, typename vscalar, typename dscalar, typename index> inline
+scalar scalar_fgs_lp(const vscalar *const __restrict vals, const index *const __restrict colind,
+                     const index rowstart, const index diagind,
+                     const dscalar diag_entry_inv, const scalar rhs,
+                     const scalar *const __restrict x)
+{
+	const scalar inter = scalar_row_product_lp(vals, colind, rowstart, diagind, x);
+	return static_cast<scalar>(diag_entry_inv) * (rhs - inter);
+}
+
+/// Backward Gauss-Seidel kernel with low-precision storage \sa scalar_bgs
+template <typename scalar, typename vscalar, typename dscalar, typename index> inline
+scalar scalar_bgs_lp(const vscalar *const __restrict vals, const index *const __restrict colind,
+                     const index diagind, const index nextrowstart,
+                     const dscalar diag_entry_inv, const scalar rhs,
+                     const scalar *const __restrict x)
+{
+	const scalar inter = scalar_row_product_lp(vals, colind, diagind+1, nextrowstart, x);
+	return rhs - static_cast<scalar>(diag_entry_inv)*inter;
+}
+
+/// Forward block Gauss-Seidel kernel with low-precision storage \sa block_fgs
+template <typename scalar, typename vscalar, typename dscalar, typename index,
+          int bs, StorageOptions stor> inline
+void block_fgs_lp(const Block_t<vscalar,bs,stor> *const vals, const index *const bcolind,
+                  const index irow, const index browstart, const index bdiagind,
+                  const Block_t<dscalar,bs,stor>& diaginv, const Segment_t<scalar,bs>& rhs,
+                  Segment_t<scalar,bs> *const x)
+{
+	Segment_t<scalar,bs> inter = Segment_t<scalar,bs>::Zero();
+	block_row_product_lp<scalar,vscalar,index,bs,stor>(vals, bcolind, browstart, bdiagind, x, inter);
+
+	const Segment_t<scalar,bs> res = rhs - inter;
+	block_gemv_lp<scalar,dscalar,bs,stor>(diaginv, res, x[irow]);
+}
+
+/// Backward block Gauss-Seidel kernel with low-precision storage \sa block_bgs
+template <typename scalar, typename vscalar, typename dscalar, typename index,
+          int bs, StorageOptions stor> inline
+void block_bgs_lp(const Block_t<vscalar,bs,stor> *const vals, const index *const bcolind,
+                  const index irow, const index bdiagind, const index nextbrowstart,
+                  const Block_t<dscalar,bs,stor>& diaginv, const Segment_t<scalar,bs>& rhs,
+                  Segment_t<scalar,bs> *const x)
+{
+	Segment_t<scalar,bs> inter = Segment_t<scalar,bs>::Zero();
+	block_row_product_lp<scalar,vscalar,index,bs,stor>(vals, bcolind, bdiagind+1, nextbrowstart, x,
+	                                                   inter);
+
+	Segment_t<scalar,bs> dinter;
+	block_gemv_lp<scalar,dscalar,bs,stor>(diaginv, inter, dinter);
+	x[irow] = rhs - dinter;
+}
+
+/// Unit lower triangular solve kernel with low-precision factors \sa scalar_unit_lower_triangular
+template <typename scalar, typename lscalar, typename index> inline
+scalar scalar_unit_lower_triangular_lp(const lscalar *const __restrict vals,
+                                       const index *const __restrict colind,
+                                       const index rowstart, const index diagind,
+                                       const scalar rhs, const scalar *const __restrict x)
+{
+	return rhs - scalar_row_product_lp(vals, colind, rowstart, diagind, x);
+}
+
+/// Upper triangular solve kernel with low-precision factors \sa scalar_upper_triangular
+template <typename scalar, typename lscalar, typename index> inline
+scalar scalar_upper_triangular_lp(const lscalar *const __restrict vals,
+                                  const index *const __restrict colind,
+                                  const index diagind, const index nextrowstart,
+                                  const scalar diag_entry_inv, const scalar rhs,
+                                  const scalar *const __restrict x)
+{
+	const scalar inter = scalar_row_product_lp(vals, colind, diagind+1, nextrowstart, x);
+	return diag_entry_inv * (rhs - inter);
+}
+
+/// Block unit lower triangular solve kernel with low-precision factors
+/// \sa block_unit_lower_triangular
+template <typename scalar, typename lscalar, typename index, int bs, StorageOptions stor> inline
+void block_unit_lower_triangular_lp(const Block_t<lscalar,bs,stor> *const vals,
+                                    const index *const bcolind,
+                                    const index browstart, const index bdiagind,
+                                    const Segment_t<scalar,bs>& rhs,
+                                    const index irow, Segment_t<scalar,bs> *const x)
+{
+	Segment_t<scalar,bs> inter = Segment_t<scalar,bs>::Zero();
+	block_row_product_lp<scalar,lscalar,index,bs,stor>(vals, bcolind, browstart, bdiagind, x, inter);
+	x[irow] = rhs - inter;
+}
+
+/// Block upper triangular solve kernel with low-precision factors; the diagonal blocks are
+/// assumed pre-inverted \sa block_upper_triangular
+template <typename scalar, typename lscalar, typename index, int bs, StorageOptions stor> inline
+void block_upper_triangular_lp(const Block_t<lscalar,bs,stor> *const vals,
+                               const index *const bcolind,
+                               const index bdiagind, const index nextbrowstart,
+                               const Segment_t<scalar,bs>& rhs,
+                               const index irow, Segment_t<scalar,bs> *const x)
+{
+	Segment_t<scalar,bs> inter = Segment_t<scalar,bs>::Zero();
+	block_row_product_lp<scalar,lscalar,index,bs,stor>(vals, bcolind, bdiagind+1, nextbrowstart, x,
+	                                                   inter);
+
+	const Segment_t<scalar,bs> res = rhs - inter;
+	block_gemv_lp<scalar,lscalar,bs,stor>(vals[bdiagind], res, x[irow]);
+}
+
+}
+
+}
+
+#endif
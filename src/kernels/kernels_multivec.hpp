@@ -0,0 +1,136 @@
+/** \file kernels_multivec.hpp
+ * \brief Kernels operating on several vectors at once
+ * \author Aditya Kashi
+ *
+ * Multivectors with k columns are stored row-interleaved: entry v of row i is at position i*k+v.
+ * For block matrices, the rows belonging to one block-row thus form a contiguous bs x k row-major
+ * panel. Every matrix entry that is read is applied to all k vectors, and the innermost loops run
+ * over the vectors with unit stride.
+ *
+ * Kernels that need per-row scratch space work on groups of at most \ref MULTIVEC_GROUP vectors at
+ * a time, so that the scratch space lives on the stack. Within a group, the panels of the scratch
+ * space have a row stride equal to the group size, while the multivectors keep their stride k.
+ */
+
+#ifndef BLASTED_KERNELS_MULTIVEC_H
+#define BLASTED_KERNELS_MULTIVEC_H
+
+#include <algorithm>
+#include "srmatrixdefs.hpp"
+
+namespace blasted {
+
+namespace kernels {
+
+/// Maximum number of vectors processed together by kernels that need per-row scratch space
+constexpr int MULTIVEC_GROUP = 8;
+
+/// Accumulates the product of a range of entries of a CSR row with some of k vectors
+/** \param vals Non-zero values of the matrix
+ * \param colind Column indices of the matrix
+ * \param start Index of the first entry of the row to use
+ * \param end One past the index of the last entry to use
+ * \param k Number of vectors in the multivector, ie., its row stride
+ * \param nv Number of vectors to multiply, starting from the first one pointed to by x
+ * \param x The row-interleaved multivector to multiply
+ * \param[in,out] inter The nv products are added to this
+ */
+template <typename scalar, typename index> inline
+void scalar_row_product_multi(const scalar *const __restrict vals,
+                              const index *const __restrict colind,
+                              const index start, const index end, const int k, const int nv,
+                              const scalar *const x, scalar *const __restrict inter)
+{
+	for(index jj = start; jj < end; jj++)
+	{
+		const scalar a = vals[jj];
+		const scalar *const xrow = x + colind[jj]*k;
+#pragma omp simd
+		for(int v = 0; v < nv; v++)
+			inter[v] += a*xrow[v];
+	}
+}
+
+/// Accumulates the product of a range of entries of a CSR row with k vectors
+template <typename scalar, typename index> inline
+void scalar_row_product_multi(const scalar *const __restrict vals,
+                              const index *const __restrict colind,
+                              const index start, const index end, const int k,
+                              const scalar *const x, scalar *const __restrict inter)
+{
+	scalar_row_product_multi(vals, colind, start, end, k, k, x, inter);
+}
+
+/// Y += A X, where X and Y are bs x nv panels with row strides ldx and ldy respectively
+template <typename scalar, int bs, StorageOptions stor> inline
+void block_panel_gemm_add(const Block_t<scalar,bs,stor>& a, const scalar *const __restrict x,
+                          const int ldx, const int nv, scalar *const __restrict y, const int ldy)
+{
+	for(int i = 0; i < bs; i++)
+		for(int j = 0; j < bs; j++)
+		{
+			const scalar aij = a(i,j);
+#pragma omp simd
+			for(int v = 0; v < nv; v++)
+				y[i*ldy+v] += aij*x[j*ldx+v];
+		}
+}
+
+/// Y += A X, where X and Y are bs x k panels
+template <typename scalar, int bs, StorageOptions stor> inline
+void block_panel_gemm_add(const Block_t<scalar,bs,stor>& a, const scalar *const __restrict x,
+                          const int k, scalar *const __restrict y)
+{
+	block_panel_gemm_add<scalar,bs,stor>(a, x, k, k, y, k);
+}
+
+/// Y -= A X, where X and Y are bs x nv panels with row strides ldx and ldy respectively
+template <typename scalar, int bs, StorageOptions stor> inline
+void block_panel_gemm_sub(const Block_t<scalar,bs,stor>& a, const scalar *const __restrict x,
+                          const int ldx, const int nv, scalar *const __restrict y, const int ldy)
+{
+	for(int i = 0; i < bs; i++)
+		for(int j = 0; j < bs; j++)
+		{
+			const scalar aij = a(i,j);
+#pragma omp simd
+			for(int v = 0; v < nv; v++)
+				y[i*ldy+v] -= aij*x[j*ldx+v];
+		}
+}
+
+/// Accumulates the product of a range of blocks of a BSR block-row with some of k vectors
+/** \param vals Non-zero blocks of the matrix
+ * \param bcolind Block-column indices of the matrix
+ * \param start Index of the first block of the row to use
+ * \param end One past the index of the last block to use
+ * \param k Number of vectors in the multivector, ie., its row stride
+ * \param nv Number of vectors to multiply, starting from the first one pointed to by x
+ * \param x The row-interleaved multivector to multiply
+ * \param[in,out] inter The bs x nv panel of products, with row stride nv, is added to this
+ */
+template <typename scalar, typename index, int bs, StorageOptions stor> inline
+void block_row_product_multi(const Block_t<scalar,bs,stor> *const vals,
+                             const index *const __restrict bcolind,
+                             const index start, const index end, const int k, const int nv,
+                             const scalar *const x, scalar *const __restrict inter)
+{
+	for(index jj = start; jj < end; jj++)
+		block_panel_gemm_add<scalar,bs,stor>(vals[jj], x + bcolind[jj]*bs*k, k, nv, inter, nv);
+}
+
+/// Accumulates the product of a range of blocks of a BSR block-row with k vectors
+template <typename scalar, typename index, int bs, StorageOptions stor> inline
+void block_row_product_multi(const Block_t<scalar,bs,stor> *const vals,
+                             const index *const __restrict bcolind,
+                             const index start, const index end, const int k,
+                             const scalar *const x, scalar *const __restrict inter)
+{
+	block_row_product_multi<scalar,index,bs,stor>(vals, bcolind, start, end, k, k, x, inter);
+}
+
+} // end kernels
+
+}
+
+#endif
@@ -7,6 +7,7 @@
 #define BLASTED_KERNELS_RELAXATION_H
 
 #include <Eigen/Core>
+#include "kernels_blockops.hpp"
 
 namespace blasted {
 
@@ -25,15 +26,16 @@ void block_relax_kernel
  Segment_t<scalar,bs>& y
  )
 {
-	Matrix<scalar,bs,1> inter = Matrix<scalar,bs,1>::Zero();
+	Segment_t<scalar,bs> inter = Segment_t<scalar,bs>::Zero();
 
 	for(index jj = browstart; jj < bdiagind; jj++)
-	  inter += vals[jj]*xL[bcolind[jj]];
+	  kernels::block_gemv_add<scalar,bs,stor>(vals[jj], xL[bcolind[jj]], inter);
 
 	for(index jj = bdiagind+1; jj < nextbrowstart; jj++)
-	  inter += vals[jj]*xU[bcolind[jj]];
+	  kernels::block_gemv_add<scalar,bs,stor>(vals[jj], xU[bcolind[jj]], inter);
 
-	y.noalias() = diaginv * (rhs - inter);
+	const Segment_t<scalar,bs> res = rhs - inter;
+	kernels::block_gemv<scalar,bs,stor>(diaginv, res, y);
 }
 
 /// Relax one row
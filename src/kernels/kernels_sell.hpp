@@ -0,0 +1,113 @@
+/** \file kernels_sell.hpp
+ * \brief Kernels operating on chunks of SELL-C-sigma matrices
+ * \author Aditya Kashi
+ *
+ * All kernels here process the C rows of one chunk together, so that the innermost loops run across
+ * rows with unit stride and map onto SIMD lanes.
+ */
+
+#ifndef BLASTED_KERNELS_SELL_H
+#define BLASTED_KERNELS_SELL_H
+
+#include "sellmatrixdefs.hpp"
+
+namespace blasted {
+
+namespace kernels {
+
+/// Computes the product of one chunk of a SELL-C-sigma matrix with a vector
+/** \param vals Values of the chunk
+ * \param colind Column indices of the chunk
+ * \param len Padded row length of the chunk
+ * \param x The vector to multiply
+ * \param[out] prod The C entries of the product, in sorted row order of the chunk
+ */
+template <typename scalar, typename index, int C> inline
+void sell_chunk_product(const scalar *const __restrict vals, const index *const __restrict colind,
+                        const index len, const scalar *const x, scalar prod[C])
+{
+#pragma omp simd
+	for(int i = 0; i < C; i++)
+		prod[i] = 0;
+
+	for(index j = 0; j < len; j++)
+	{
+#pragma omp simd
+		for(int i = 0; i < C; i++)
+			prod[i] += vals[j*C+i]*x[colind[j*C+i]];
+	}
+}
+
+/// Forward Gauss-Seidel update of the rows of one chunk of the strictly lower triangular part
+/** Rows within the chunk are updated simultaneously (Jacobi-wise), while they see the latest values
+ * of all other rows.
+ * \param L The strict lower triangular part of the matrix in SELL-C-sigma storage
+ * \param ichunk The chunk to process
+ * \param diaginv Inverse of the diagonal entries of the matrix, in the original ordering
+ * \param r The RHS vector
+ * \param y The solution vector
+ */
+template <typename scalar, typename index, int C> inline
+void sell_chunk_fgs(const CRawSELLMatrix<scalar,index>& L, const index ichunk,
+                    const scalar *const diaginv, const scalar *const r, scalar *const y)
+{
+	alignas(CACHE_LINE_LEN) scalar inter[C];
+	sell_chunk_product<scalar,index,C>(L.vals + L.chunkptr[ichunk], L.colind + L.chunkptr[ichunk],
+	                                   L.chunklen[ichunk], y, inter);
+
+	const index *const rows = L.rowperm + ichunk*C;
+	const int nr = L.chunk_rows(ichunk);
+	for(int i = 0; i < nr; i++)
+		y[rows[i]] = diaginv[rows[i]] * (r[rows[i]] - inter[i]);
+}
+
+/// Backward Gauss-Seidel update of the rows of one chunk of the strictly upper triangular part
+/** \param U The strict upper triangular part of the matrix in SELL-C-sigma storage
+ * \param ichunk The chunk to process
+ * \param diaginv Inverse of the diagonal entries of the matrix, in the original ordering
+ * \param y The RHS vector, the result of the forward sweep
+ * \param z The solution vector
+ */
+template <typename scalar, typename index, int C> inline
+void sell_chunk_bgs(const CRawSELLMatrix<scalar,index>& U, const index ichunk,
+                    const scalar *const diaginv, const scalar *const y, scalar *const z)
+{
+	alignas(CACHE_LINE_LEN) scalar inter[C];
+	sell_chunk_product<scalar,index,C>(U.vals + U.chunkptr[ichunk], U.colind + U.chunkptr[ichunk],
+	                                   U.chunklen[ichunk], z, inter);
+
+	const index *const rows = U.rowperm + ichunk*C;
+	const int nr = U.chunk_rows(ichunk);
+	for(int i = 0; i < nr; i++)
+		z[rows[i]] = y[rows[i]] - diaginv[rows[i]]*inter[i];
+}
+
+/// Relaxes the rows of one chunk of the full matrix, in place
+/** Computes x := x + D^(-1) (b - A x) for the rows of the chunk.
+ * \param A The full matrix in SELL-C-sigma storage
+ * \param ichunk The chunk to process
+ * \param diaginv Inverse of the diagonal entries of the matrix, in the original ordering
+ * \param b The RHS vector
+ * \param xold The vector used to compute the residual
+ * \param xnew The vector to which the updated rows are written (may alias xold)
+ */
+template <typename scalar, typename index, int C> inline
+void sell_chunk_relax(const CRawSELLMatrix<scalar,index>& A, const index ichunk,
+                      const scalar *const diaginv, const scalar *const b,
+                      const scalar *const xold, scalar *const xnew)
+{
+	alignas(CACHE_LINE_LEN) scalar inter[C];
+	sell_chunk_product<scalar,index,C>(A.vals + A.chunkptr[ichunk], A.colind + A.chunkptr[ichunk],
+	                                   A.chunklen[ichunk], xold, inter);
+
+	const index *const rows = A.rowperm + ichunk*C;
+	const int nr = A.chunk_rows(ichunk);
+	for(int i = 0; i < nr; i++)
+		xnew[rows[i]] = xold[rows[i]] + diaginv[rows[i]]*(b[rows[i]] - inter[i]);
+}
+
+} // end kernels
+
+}
+
+#endif
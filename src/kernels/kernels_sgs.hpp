@@ -8,6 +8,9 @@
 #define BLASTED_KERNELS_SGS_H
 
 #include "srmatrixdefs.hpp"
+#include "kernels_blockops.hpp"
+#include "kernels_multivec.hpp"
+#include "kernels_compressed.hpp"
 
 namespace blasted {
 
@@ -50,12 +53,13 @@ void block_fgs(const Block_t<scalar,bs,stor> *const vals, const index *const bco
 		const Block_t<scalar,bs,stor>& diaginv, const Segment_t<scalar,bs>& rhs,
 		Segment_t<scalar,bs> *const x)
 {
-	Matrix<scalar,bs,1> inter = Matrix<scalar,bs,1>::Zero();
+	Segment_t<scalar,bs> inter = Segment_t<scalar,bs>::Zero();
 
 	for(index jj = browstart; jj < bdiagind; jj++)
-		inter += vals[jj]*x[bcolind[jj]];
+		block_gemv_add<scalar,bs,stor>(vals[jj], x[bcolind[jj]], inter);
 
-	x[irow] = diaginv * (rhs - inter);
+	const Segment_t<scalar,bs> res = rhs - inter;
+	block_gemv<scalar,bs,stor>(diaginv, res, x[irow]);
 }
 
 /// Backward block Gauss-Seidel kernel (for one block-component of the solution vector)
@@ -65,98 +69,110 @@ void block_bgs(const Block_t<scalar,bs,stor> *const vals, const index *const bco
 		const Block_t<scalar,bs,stor>& diaginv, const Segment_t<scalar,bs>& rhs,
 		Segment_t<scalar,bs> *const x)
 {
-	Matrix<scalar,bs,1> inter = Matrix<scalar,bs,1>::Zero();
+	Segment_t<scalar,bs> inter = Segment_t<scalar,bs>::Zero();
 	
 	// compute U z
 	for(index jj = bdiagind+1; jj < nextbrowstart; jj++)
-		inter += vals[jj] * x[bcolind[jj]];
+		block_gemv_add<scalar,bs,stor>(vals[jj], x[bcolind[jj]], inter);
 
 	// compute z =  (y - D^(-1)*U z) for the irow-th block-segment of z
-	x[irow] = rhs - diaginv*inter;
+	Segment_t<scalar,bs> dinter;
+	block_gemv<scalar,bs,stor>(diaginv, inter, dinter);
+	x[irow] = rhs - dinter;
 }
 
-} // end kernels
-
-/// Forward Gauss-Seidel solve - to be called from within a parallel region
-template <typename scalar, typename index>
-void perform_scalar_fgs(const CRawBSRMatrix<scalar,index>& mat, const scalar *const diaginv,
-                        const int thread_chunk_size,
-                        const scalar *const rr, scalar *const __restrict ytemp)
+/// Forward Gauss-Seidel kernel for one row of k row-interleaved vectors
+template <typename scalar, typename index> inline
+void scalar_fgs_multi(const scalar *const __restrict vals, const index *const __restrict colind,
+                      const index irow, const index rowstart, const index diagind,
+                      const scalar diag_entry_inv, const int k, const scalar *const __restrict rhs,
+                      scalar *const x)
 {
-	// forward sweep ytemp := D^(-1) (r - L ytemp)
-#pragma omp for schedule(dynamic, thread_chunk_size) nowait
-	for(index irow = 0; irow < mat.nbrows; irow++)
+	for(int v0 = 0; v0 < k; v0 += MULTIVEC_GROUP)
 	{
-		ytemp[irow] = kernels::scalar_fgs(mat.vals, mat.bcolind, mat.browptr[irow], mat.diagind[irow],
-		                                  diaginv[irow], rr[irow], ytemp);
+		const int nv = std::min(MULTIVEC_GROUP, k-v0);
+		scalar inter[MULTIVEC_GROUP] = {};
+		scalar_row_product_multi(vals, colind, rowstart, diagind, k, nv, x+v0, inter);
+
+#pragma omp simd
+		for(int v = 0; v < nv; v++)
+			x[irow*k+v0+v] = diag_entry_inv * (rhs[irow*k+v0+v] - inter[v]);
 	}
 }
 
-/// Forward Gauss-Seidel solve - to be called from within a parallel region
-template <typename scalar, typename index>
-void perform_scalar_bgs(const CRawBSRMatrix<scalar,index>& mat, const scalar *const diaginv,
-                        const int thread_chunk_size,
-                        const scalar *const ytemp, scalar *const __restrict zz)
+/// Backward Gauss-Seidel kernel for one row of k row-interleaved vectors
+template <typename scalar, typename index> inline
+void scalar_bgs_multi(const scalar *const __restrict vals, const index *const __restrict colind,
+                      const index irow, const index diagind, const index nextrowstart,
+                      const scalar diag_entry_inv, const int k, const scalar *const __restrict rhs,
+                      scalar *const x)
 {
-	// backward sweep z := D^(-1) (D y - U z)
-#pragma omp for schedule(dynamic, thread_chunk_size) nowait
-	for(index irow = mat.nbrows-1; irow >= 0; irow--)
+	for(int v0 = 0; v0 < k; v0 += MULTIVEC_GROUP)
 	{
-		zz[irow] = kernels::scalar_bgs(mat.vals, mat.bcolind, mat.diagind[irow], mat.browptr[irow+1],
-		                               mat.vals[mat.diagind[irow]], diaginv[irow], ytemp[irow], zz);
+		const int nv = std::min(MULTIVEC_GROUP, k-v0);
+		scalar inter[MULTIVEC_GROUP] = {};
+		scalar_row_product_multi(vals, colind, diagind+1, nextrowstart, k, nv, x+v0, inter);
+
+#pragma omp simd
+		for(int v = 0; v < nv; v++)
+			x[irow*k+v0+v] = rhs[irow*k+v0+v] - diag_entry_inv*inter[v];
 	}
 }
 
-/// Forward Gauss-Seidel solve (to be called from within a parallel region)
-/** \param mat The original matrix
- * \param diagblks Inverses of all diagonal blocks of the original matrix
- * \param thread_chunk_size Number of work-items in each 'chunk' of work-items
- * \param r RHS vector
- * \param y Solution vector
- */
-template <typename scalar, typename index, int bs, StorageOptions stor>
-void perform_block_fgs(const CRawBSRMatrix<scalar,index>& mat,
-                       const Block_t<scalar,bs,stor> *const diagblks,
-                       const int thread_chunk_size,
-                       const Segment_t<scalar,bs> *const r, Segment_t<scalar,bs> *const y)
+/// Forward block Gauss-Seidel kernel for one block-row of k row-interleaved vectors
+template <typename scalar, typename index, int bs, StorageOptions stor> inline
+void block_fgs_multi(const Block_t<scalar,bs,stor> *const vals, const index *const bcolind,
+                     const index irow, const index browstart, const index bdiagind,
+                     const Block_t<scalar,bs,stor>& diaginv, const int k,
+                     const scalar *const __restrict rhs, scalar *const x)
 {
-	const Block_t<scalar,bs,stor> *const mvals
-		= reinterpret_cast<const Block_t<scalar,bs,stor>*>(mat.vals);
-
-	// forward sweep ytemp := D^(-1) (r - L ytemp)
-#pragma omp for schedule(dynamic, thread_chunk_size) nowait
-	for(index irow = 0; irow < mat.nbrows; irow++)
+	for(int v0 = 0; v0 < k; v0 += MULTIVEC_GROUP)
 	{
-		kernels::block_fgs<scalar,index,bs,stor>(mvals, mat.bcolind, irow, mat.browptr[irow], 
-		                                         mat.diagind[irow], diagblks[irow], r[irow], y);
+		const int nv = std::min(MULTIVEC_GROUP, k-v0);
+		scalar inter[bs*MULTIVEC_GROUP] = {};
+		scalar res[bs*MULTIVEC_GROUP] = {};
+		block_row_product_multi<scalar,index,bs,stor>(vals, bcolind, browstart, bdiagind, k, nv,
+		                                              x+v0, inter);
+
+		for(int i = 0; i < bs; i++)
+#pragma omp simd
+			for(int v = 0; v < nv; v++)
+				inter[i*nv+v] = rhs[(irow*bs+i)*k+v0+v] - inter[i*nv+v];
+		block_panel_gemm_add<scalar,bs,stor>(diaginv, inter, nv, nv, res, nv);
+
+		for(int i = 0; i < bs; i++)
+			for(int v = 0; v < nv; v++)
+				x[(irow*bs+i)*k+v0+v] = res[i*nv+v];
 	}
 }
 
-/// Backward Gauss-Seidel solve (to be called from within a parallel region)
-/** \param mat The original matrix
- * \param diagblks Inverses of all diagonal blocks of the original matrix
- * \param thread_chunk_size Number of work-items in each 'chunk' of work-items
- * \param y RHS vector
- * \param z Solution vector
- */
-template <typename scalar, typename index, int bs, StorageOptions stor>
-void perform_block_bgs(const CRawBSRMatrix<scalar,index>& mat,
-                       const Block_t<scalar,bs,stor> *const diagblks,
-                       const int thread_chunk_size,
-                       const Segment_t<scalar,bs> *const y, Segment_t<scalar,bs> *const z)
+/// Backward block Gauss-Seidel kernel for one block-row of k row-interleaved vectors
+template <typename scalar, typename index, int bs, StorageOptions stor> inline
+void block_bgs_multi(const Block_t<scalar,bs,stor> *const vals, const index *const bcolind,
+                     const index irow, const index bdiagind, const index nextbrowstart,
+                     const Block_t<scalar,bs,stor>& diaginv, const int k,
+                     const scalar *const __restrict rhs, scalar *const x)
 {
-	const Block_t<scalar,bs,stor> *const mvals
-		= reinterpret_cast<const Block_t<scalar,bs,stor>*>(mat.vals);
-
-	// backward sweep z := D^(-1) (D y - U z)
-#pragma omp for schedule(dynamic, thread_chunk_size) nowait
-	for(index irow = mat.nbrows-1; irow >= 0; irow--)
+	for(int v0 = 0; v0 < k; v0 += MULTIVEC_GROUP)
 	{
-		kernels::block_bgs<scalar, index, bs, stor>(mvals, mat.bcolind, irow, mat.diagind[irow],
-		                                            mat.browptr[irow+1], diagblks[irow], y[irow], z);
+		const int nv = std::min(MULTIVEC_GROUP, k-v0);
+		scalar inter[bs*MULTIVEC_GROUP] = {};
+		scalar res[bs*MULTIVEC_GROUP];
+		for(int i = 0; i < bs; i++)
+			for(int v = 0; v < nv; v++)
+				res[i*nv+v] = rhs[(irow*bs+i)*k+v0+v];
+		block_row_product_multi<scalar,index,bs,stor>(vals, bcolind, bdiagind+1, nextbrowstart, k, nv,
+		                                              x+v0, inter);
+		block_panel_gemm_sub<scalar,bs,stor>(diaginv, inter, nv, nv, res, nv);
+
+		for(int i = 0; i < bs; i++)
+			for(int v = 0; v < nv; v++)
+				x[(irow*bs+i)*k+v0+v] = res[i*nv+v];
 	}
 }
 
+} // end kernels
+
 }
 
 #endif
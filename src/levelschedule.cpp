@@ -3,73 +3,137 @@
  * \author Aditya Kashi
  */
 
-#include <list>
+#include <algorithm>
+#include <stdexcept>
+#include <cstdio>
 #include "levelschedule.hpp"
 
 namespace blasted {
 
+/// Computes level sets for one sweep direction
+/** The dependency graph is built as a CSR list of dependents of each row, along with the number of
+ * rows each row depends on. Levels are then peeled off one by one as in Kahn's topological sort;
+ * the rows of a level are processed in parallel, and a row is appended to the next level when its
+ * last dependency is resolved.
+ * \param forward Whether row i depends on earlier rows (true) or later rows (false)
+ * \param symmetrize Whether non-zeros (j,i) also create a dependency of row i on row j
+ */
 template <typename scalar, typename index>
-std::vector<index> computeLevels(const CRawBSRMatrix<scalar,index> *const mat)
+static LevelSets<index> compute_level_sets(const CRawBSRMatrix<scalar,index> *const mat,
+                                           const bool forward, const bool symmetrize)
 {
-	std::vector<index> levels;
+	const index n = mat->nbrows;
+	std::vector<index> ndeps(n, 0), depptr(n+1, 0);
 
-	// Build dependency lists
-	std::vector<std::list<index>> depends(mat->nbrows);
-	for(index irow = 0; irow < mat->nbrows; irow++)
-	{
+	// 'before' is the order in which rows are swept
+	const auto before = [forward](const index a, const index b) { return forward ? a < b : a > b; };
+
+	// count dependencies and dependents
+#pragma omp parallel for default(shared)
+	for(index irow = 0; irow < n; irow++)
 		for(index jj = mat->browptr[irow]; jj < mat->browptr[irow+1]; jj++)
-			depends[irow].push_back(mat->bcolind[jj]);
-	}
+		{
+			const index jcol = mat->bcolind[jj];
+			if(before(jcol,irow)) {
+				// irow depends on jcol
+#pragma omp atomic update
+				ndeps[irow]++;
+#pragma omp atomic update
+				depptr[jcol+1]++;
+			}
+			else if(symmetrize && before(irow,jcol)) {
+				// jcol depends on irow
+#pragma omp atomic update
+				ndeps[jcol]++;
+#pragma omp atomic update
+				depptr[irow+1]++;
+			}
+		}
 
-	index inode = 0;
-	levels.push_back(0);
-	index nlevels = 0;
+	for(index i = 0; i < n; i++)
+		depptr[i+1] += depptr[i];
 
-	while(inode < mat->nbrows)
-	{
-		// 1. Find consecutive independent nodes
+	std::vector<index> dependents(depptr[n]);
+	std::vector<index> fillpos(depptr.begin(), depptr.end()-1);
 
-		while (inode < mat->nbrows && depends[inode].front() >= inode) {
-			inode++;
+#pragma omp parallel for default(shared)
+	for(index irow = 0; irow < n; irow++)
+		for(index jj = mat->browptr[irow]; jj < mat->browptr[irow+1]; jj++)
+		{
+			const index jcol = mat->bcolind[jj];
+			index pos;
+			if(before(jcol,irow)) {
+#pragma omp atomic capture
+				pos = fillpos[jcol]++;
+				dependents[pos] = irow;
+			}
+			else if(symmetrize && before(irow,jcol)) {
+#pragma omp atomic capture
+				pos = fillpos[irow]++;
+				dependents[pos] = jcol;
+			}
 		}
 
-		// and add those nodes (ie., add the end of the consecutive set of nodes) to this level.
-		levels.push_back(inode);
-		nlevels++;
+	LevelSets<index> lsets;
+	lsets.rows.resize(n);
+	lsets.levelptr.reserve(64);
+	lsets.levelptr.push_back(0);
 
-		// 2. Remove dependency of remaining nodes on each node in this level
+	index tail = 0;
+	for(index i = 0; i < n; i++)
+		if(ndeps[i] == 0)
+			lsets.rows[tail++] = i;
+	lsets.levelptr.push_back(tail);
 
-		// for each node in the new level..
-		for(index jnode = levels[levels.size()-2]; jnode < inode; jnode++)
+	while(tail < n)
+	{
+		const index start = lsets.levelptr[lsets.levelptr.size()-2];
+		const index end = tail;
+
+#pragma omp parallel for default(shared)
+		for(index k = start; k < end; k++)
 		{
-			// go over the neighbors of the node (because the sparsity structure is assumed symmetric)
-			for(auto jnbr = depends[jnode].begin(); jnbr != depends[jnode].end(); jnbr++)
+			const index irow = lsets.rows[k];
+			for(index jj = depptr[irow]; jj < depptr[irow+1]; jj++)
 			{
-				// Every node is its own dependency - skip that
-				if(*jnbr == jnode)
-					continue;
-
-				// find jnode in the list of dependencies of the neighbor..
-				auto it = std::find(depends[*jnbr].begin(), depends[*jnbr].end(), jnode);
-
-				// (jnode must be found because the sparsity structure is symmetric)
-				if(it == depends[*jnbr].end())
-					throw std::runtime_error("Faulty dependency list!");
-
-				// .. and remove it.
-				depends[*jnbr].erase(it);
+				const index jrow = dependents[jj];
+				index remaining;
+#pragma omp atomic capture
+				remaining = --ndeps[jrow];
+				if(remaining == 0) {
+					index pos;
+#pragma omp atomic capture
+					pos = tail++;
+					lsets.rows[pos] = jrow;
+				}
 			}
 		}
+
+		if(tail == end)
+			throw std::runtime_error("computeLevels: Cyclic dependencies!");
+
+		// the order within a level is arbitrary at this point; sort for locality
+		std::sort(lsets.rows.begin()+end, lsets.rows.begin()+tail);
+		lsets.levelptr.push_back(tail);
 	}
 
-	assert(inode == mat->nbrows);
-	assert(mat->nbrows == levels.back());
-	assert(nlevels+1 == static_cast<index>(levels.size()));
-	printf(" LevelSchedule: Found %d levels.\n", nlevels);
+	return lsets;
+}
+
+template <typename scalar, typename index>
+LevelSchedule<index> computeLevels(const CRawBSRMatrix<scalar,index> *const mat, const bool inplace)
+{
+	LevelSchedule<index> lsched;
+	lsched.forward = compute_level_sets(mat, true, inplace);
+	lsched.backward = compute_level_sets(mat, false, inplace);
+
+	printf(" LevelSchedule: Found %d forward and %d backward levels.\n",
+	       static_cast<int>(lsched.forward.numLevels()), static_cast<int>(lsched.backward.numLevels()));
 
-	return levels;
+	return lsched;
 }
 
-template std::vector<int> computeLevels(const CRawBSRMatrix<double,int> *const mat);
+template LevelSchedule<int> computeLevels(const CRawBSRMatrix<double,int> *const mat,
+                                          const bool inplace);
 
 }
@@ -5,6 +5,7 @@
  */
 
 #include "relaxation_chaotic.hpp"
+#include "async_sweeps.hpp"
 #include "kernels/kernels_relaxation.hpp"
 #include <iostream>
 
@@ -29,19 +30,14 @@ void ChaoticBlockRelaxation<scalar,index,bs,stor>::apply(const scalar *const bb,
 	const Seg *x = reinterpret_cast<const Seg*>(xx);
 	Seg *xmut = reinterpret_cast<Seg*>(xx);
 
-#pragma omp parallel default(shared)
-	{
-		for(int step = 0; step < napplysweeps; step++)
-		{
-#pragma omp for schedule(dynamic, thread_chunk_size) nowait
-			for(index irow = 0; irow < mat.nbrows; irow++)
-			{
-				block_relax_kernel<scalar,index,bs,stor>
-					(mvals, mat.bcolind, irow, mat.browptr[irow], mat.diagind[irow], mat.browptr[irow+1],
-					 dblks[irow], b[irow], x, x, xmut[irow]);
-			}
-		}
-	}
+	const AsyncSweepEngine<index> eng(mat.nbrows, thread_chunk_size);
+	eng.run(true, [&]() {
+		eng.forward(napplysweeps, [&](const index irow) {
+			block_relax_kernel<scalar,index,bs,stor>
+				(mvals, mat.bcolind, irow, mat.browptr[irow], mat.diagind[irow], mat.browptr[irow+1],
+				 dblks[irow], b[irow], x, x, xmut[irow]);
+		});
+	});
 }
 
 template<typename scalar, typename index, int bs, StorageOptions stor>
@@ -55,19 +51,14 @@ void ChaoticBlockRelaxation<scalar,index,bs,stor>::apply_relax(const scalar *con
 	const Seg *x = reinterpret_cast<const Seg*>(xx);
 	Seg *xmut = reinterpret_cast<Seg*>(xx);
 
-#pragma omp parallel default(shared)
-	{
-		for(int step = 0; step < solveparams.maxits; step++)
-		{
-#pragma omp for schedule(dynamic, thread_chunk_size) nowait
-			for(index irow = 0; irow < mat.nbrows; irow++)
-			{
-				block_relax_kernel<scalar,index,bs,stor>
-					(mvals, mat.bcolind, irow, mat.browptr[irow], mat.diagind[irow], mat.browptr[irow+1],
-					 dblks[irow], b[irow], x, x, xmut[irow]);
-			}
-		}
-	}
+	const AsyncSweepEngine<index> eng(mat.nbrows, thread_chunk_size);
+	eng.run(true, [&]() {
+		eng.forward(solveparams.maxits, [&](const index irow) {
+			block_relax_kernel<scalar,index,bs,stor>
+				(mvals, mat.bcolind, irow, mat.browptr[irow], mat.diagind[irow], mat.browptr[irow+1],
+				 dblks[irow], b[irow], x, x, xmut[irow]);
+		});
+	});
 }
 
 template class ChaoticBlockRelaxation<double,int,4,RowMajor>;
@@ -92,34 +83,28 @@ template<typename scalar, typename index>
 void ChaoticRelaxation<scalar,index>::apply(const scalar *const bb,
 		scalar *const __restrict xx) const
 {
-#pragma omp parallel default(shared)
-	for(int step = 0; step < napplysweeps; step++)
-	{
-#pragma omp for schedule(dynamic, thread_chunk_size) nowait
-		for(index irow = 0; irow < mat.nbrows; irow++)
-		{
+	const AsyncSweepEngine<index> eng(mat.nbrows, thread_chunk_size);
+	eng.run(true, [&]() {
+		eng.forward(napplysweeps, [&](const index irow) {
 			xx[irow] = scalar_relax<scalar,index>(mat.vals, mat.bcolind, mat.browptr[irow],
 			                                      mat.diagind[irow], mat.browptr[irow+1],
 			                                      dblocks[irow], bb[irow], xx, xx);
-		}
-	}
+		});
+	});
 }
 
 template<typename scalar, typename index>
 void ChaoticRelaxation<scalar,index>::apply_relax(const scalar *const bb,
                                                   scalar *const __restrict xx) const
 {
-#pragma omp parallel default(shared)
-	for(int step = 0; step < solveparams.maxits; step++)
-	{
-#pragma omp for schedule(dynamic, thread_chunk_size) nowait
-		for(index irow = 0; irow < mat.nbrows; irow++)
-		{
+	const AsyncSweepEngine<index> eng(mat.nbrows, thread_chunk_size);
+	eng.run(true, [&]() {
+		eng.forward(solveparams.maxits, [&](const index irow) {
 			xx[irow] = scalar_relax<scalar,index>(mat.vals, mat.bcolind, mat.browptr[irow],
 			                                      mat.diagind[irow], mat.browptr[irow+1],
 			                                      dblocks[irow], bb[irow], xx, xx);
-		}
-	}
+		});
+	});
 }
 
 template class ChaoticRelaxation<double,int>;
@@ -19,6 +19,7 @@
 
 #include <algorithm>
 #include <utility>
+#include <stdexcept>
 #include "helper_algorithms.hpp"
 #include "reorderingscaling.hpp"
 #include "scmatrixdefs.hpp"
@@ -38,6 +39,8 @@ std::vector<index> invertPermutationVector(const std::vector<index> p)
 	return invp;
 }
 
+template std::vector<int> invertPermutationVector(const std::vector<int> p);
+
 template <typename scalar, typename index, int bs>
 Reordering<scalar,index,bs>::Reordering()
 { }
@@ -255,6 +258,446 @@ template class Reordering<double,int,1>;
 template class Reordering<double,int,4>;
 template class Reordering<double,int,7>;
 
+/// Computes the lists of rows coupled to each (block-)row through the matrix or its transpose
+/** The lists are sorted and do not contain the row itself.
+ */
+template <typename scalar, typename index>
+static void symmetric_adjacency(const CRawBSRMatrix<scalar,index>& mat,
+                                std::vector<index>& adjptr, std::vector<index>& adj)
+{
+	const index n = mat.nbrows;
+	std::vector<std::vector<index>> lists(n);
+	for(index irow = 0; irow < n; irow++)
+		for(index jj = mat.browptr[irow]; jj < mat.browptr[irow+1]; jj++)
+		{
+			const index jcol = mat.bcolind[jj];
+			if(jcol == irow)
+				continue;
+			lists[irow].push_back(jcol);
+			lists[jcol].push_back(irow);
+		}
+
+	adjptr.resize(n+1);
+	adjptr[0] = 0;
+	for(index irow = 0; irow < n; irow++) {
+		std::sort(lists[irow].begin(), lists[irow].end());
+		lists[irow].erase(std::unique(lists[irow].begin(), lists[irow].end()), lists[irow].end());
+		adjptr[irow+1] = adjptr[irow] + static_cast<index>(lists[irow].size());
+	}
+
+	adj.resize(adjptr[n]);
+	for(index irow = 0; irow < n; irow++)
+		std::copy(lists[irow].begin(), lists[irow].end(), adj.begin()+adjptr[irow]);
+}
+
+/** The coloring is sequential. Each row marks the colors it may not use with its own index, so
+ * that the marks need not be cleared between rows.
+ */
+template <typename scalar, typename index>
+LevelSets<index> computeColoring(const CRawBSRMatrix<scalar,index>& mat, const int distance,
+                                 const bool balanced)
+{
+	if(distance != 1 && distance != 2)
+		throw std::invalid_argument("Coloring distance must be 1 or 2!");
+
+	const index n = mat.nbrows;
+	std::vector<index> adjptr, adj;
+	symmetric_adjacency(mat, adjptr, adj);
+
+	std::vector<index> color(n, -1);
+	// for each color, the last row for which it was inadmissible
+	std::vector<index> mark;
+	std::vector<index> colorsize;
+
+	for(index irow = 0; irow < n; irow++)
+	{
+		for(index jj = adjptr[irow]; jj < adjptr[irow+1]; jj++)
+		{
+			const index jrow = adj[jj];
+			if(color[jrow] >= 0)
+				mark[color[jrow]] = irow;
+			if(distance == 2)
+				for(index kk = adjptr[jrow]; kk < adjptr[jrow+1]; kk++)
+					if(color[adj[kk]] >= 0)
+						mark[color[adj[kk]]] = irow;
+		}
+
+		index icolor = -1;
+		for(index c = 0; c < static_cast<index>(mark.size()); c++)
+			if(mark[c] != irow) {
+				if(!balanced) {
+					icolor = c;
+					break;
+				}
+				if(icolor < 0 || colorsize[c] < colorsize[icolor])
+					icolor = c;
+			}
+
+		if(icolor < 0) {
+			icolor = static_cast<index>(mark.size());
+			mark.push_back(-1);
+			colorsize.push_back(0);
+		}
+		color[irow] = icolor;
+		colorsize[icolor]++;
+	}
+
+	// list the rows color by color, in increasing order within each color
+	LevelSets<index> colors;
+	colors.levelptr.assign(colorsize.size()+1, 0);
+	for(size_t c = 0; c < colorsize.size(); c++)
+		colors.levelptr[c+1] = colors.levelptr[c] + colorsize[c];
+
+	colors.rows.resize(n);
+	std::vector<index> pos(colors.levelptr.begin(), colors.levelptr.end()-1);
+	for(index irow = 0; irow < n; irow++)
+		colors.rows[pos[color[irow]]++] = irow;
+
+	return colors;
+}
+
+template LevelSets<int> computeColoring(const CRawBSRMatrix<double,int>& mat, const int distance,
+                                        const bool balanced);
+
+template <typename scalar, typename index, int bs>
+MulticolorReordering<scalar,index,bs>::MulticolorReordering(const int distance,
+                                                            const bool balanced)
+	: Reordering<scalar,index,bs>(), dist{distance}, balance{balanced}
+{ }
+
+template <typename scalar, typename index, int bs>
+void MulticolorReordering<scalar,index,bs>::compute(const CRawBSRMatrix<scalar,index>& mat)
+{
+	setColoring(computeColoring(mat, dist, balance));
+}
+
+template <typename scalar, typename index, int bs>
+void MulticolorReordering<scalar,index,bs>::setColoring(const LevelSets<index>& colors)
+{
+	const index n = static_cast<index>(colors.rows.size());
+	this->setOrdering(colors.rows.data(), colors.rows.data(), n);
+	colorptr = colors.levelptr;
+}
+
+template class MulticolorReordering<double,int,1>;
+template class MulticolorReordering<double,int,4>;
+template class MulticolorReordering<double,int,7>;
+
+/// Computes the breadth-first level structure rooted at a row, within the rows of a region
+/** Only rows having the region's label are visited.
+ * \param[out] nodes The rows reached, level by level
+ * \param[out] levelptr Start of each level in nodes, and the number of rows reached
+ * \param degree If not null, the rows reached from a given row are listed in increasing order of
+ *   their degrees, as needed for Cuthill-McKee orderings
+ * \param visited Work array, all false on entry and on exit
+ */
+template <typename index>
+static void level_structure(const std::vector<index>& adjptr, const std::vector<index>& adj,
+                            const std::vector<index>& region, const index label, const index root,
+                            const index *const degree, std::vector<index>& nodes,
+                            std::vector<index>& levelptr, std::vector<char>& visited)
+{
+	nodes.assign(1, root);
+	levelptr.assign(1, 0);
+	visited[root] = 1;
+
+	size_t levelstart = 0;
+	while(levelstart < nodes.size())
+	{
+		const size_t levelend = nodes.size();
+		levelptr.push_back(static_cast<index>(levelend));
+		for(size_t i = levelstart; i < levelend; i++)
+		{
+			const size_t nstart = nodes.size();
+			const index irow = nodes[i];
+			for(index jj = adjptr[irow]; jj < adjptr[irow+1]; jj++) {
+				const index jrow = adj[jj];
+				if(region[jrow] == label && !visited[jrow]) {
+					visited[jrow] = 1;
+					nodes.push_back(jrow);
+				}
+			}
+			if(degree)
+				std::sort(nodes.begin()+nstart, nodes.end(), [degree](const index a, const index b) {
+					return degree[a] < degree[b] || (degree[a] == degree[b] && a < b); });
+		}
+		levelstart = levelend;
+	}
+
+	for(size_t i = 0; i < nodes.size(); i++)
+		visited[nodes[i]] = 0;
+}
+
+/// Finds a pseudo-peripheral row in the connected part of a region containing a given row
+/** This is the algorithm of Gibbs, Poole and Stockmeyer as modified by George and Liu: starting
+ * from the given row, the root moves to a row of minimum degree in the last level of the current
+ * root's level structure as long as that increases the number of levels.
+ * \param[out] nodes The level structure of the returned row \sa level_structure
+ * \param[out] levelptr Start of each level of the returned row's level structure
+ */
+template <typename index>
+static index pseudo_peripheral_row(const std::vector<index>& adjptr, const std::vector<index>& adj,
+                                   const std::vector<index>& region, const index label,
+                                   const index start, std::vector<index>& nodes,
+                                   std::vector<index>& levelptr, std::vector<char>& visited)
+{
+	index root = start;
+	level_structure(adjptr, adj, region, label, root, (const index*)nullptr, nodes, levelptr,
+	                visited);
+
+	std::vector<index> cnodes, clevelptr;
+	while(true)
+	{
+		const index nlevels = static_cast<index>(levelptr.size())-1;
+		index cand = nodes[levelptr[nlevels-1]];
+		for(index i = levelptr[nlevels-1]; i < levelptr[nlevels]; i++)
+			if(adjptr[nodes[i]+1]-adjptr[nodes[i]] < adjptr[cand+1]-adjptr[cand])
+				cand = nodes[i];
+
+		level_structure(adjptr, adj, region, label, cand, (const index*)nullptr, cnodes, clevelptr,
+		                visited);
+		if(clevelptr.size() <= levelptr.size())
+			break;
+		root = cand;
+		nodes.swap(cnodes);
+		levelptr.swap(clevelptr);
+	}
+
+	return root;
+}
+
+template <typename scalar, typename index>
+std::vector<index> computeRCMOrdering(const CRawBSRMatrix<scalar,index>& mat)
+{
+	const index n = mat.nbrows;
+	std::vector<index> adjptr, adj;
+	symmetric_adjacency(mat, adjptr, adj);
+
+	std::vector<index> degree(n);
+	for(index irow = 0; irow < n; irow++)
+		degree[irow] = adjptr[irow+1]-adjptr[irow];
+
+	// rows already numbered are moved out of the region of unnumbered rows, labelled 0
+	std::vector<index> region(n, 0);
+	std::vector<char> visited(n, 0);
+	std::vector<index> ord, nodes, levelptr;
+	ord.reserve(n);
+
+	for(index start = 0; start < n; start++)
+	{
+		if(region[start] != 0)
+			continue;
+		const index root = pseudo_peripheral_row(adjptr, adj, region, (index)0, start, nodes,
+		                                         levelptr, visited);
+		level_structure(adjptr, adj, region, (index)0, root, &degree[0], nodes, levelptr, visited);
+		for(size_t i = 0; i < nodes.size(); i++) {
+			region[nodes[i]] = 1;
+			ord.push_back(nodes[i]);
+		}
+	}
+
+	std::reverse(ord.begin(), ord.end());
+	return ord;
+}
+
+template std::vector<int> computeRCMOrdering(const CRawBSRMatrix<double,int>& mat);
+
+/// Recursively dissects a set of rows and writes its ordering
+/** The rows of the set must carry a label in region that no other row carries. The rows of the
+ * halves are relabelled, so that the separator is excluded from the dissection of the halves.
+ * \param rows The set of rows to order
+ * \param label Label of the set in region
+ * \param nextlabel Label to give to the next subset
+ * \param ord The set is ordered into the positions starting at offset
+ */
+template <typename index>
+static void dissect(const std::vector<index>& adjptr, const std::vector<index>& adj,
+                    const index leafsize, std::vector<index>& rows, const index label,
+                    index& nextlabel, std::vector<index>& region, std::vector<char>& visited,
+                    const index offset, std::vector<index>& ord)
+{
+	const index nrows = static_cast<index>(rows.size());
+	if(nrows <= leafsize) {
+		std::sort(rows.begin(), rows.end());
+		std::copy(rows.begin(), rows.end(), ord.begin()+offset);
+		return;
+	}
+
+	std::vector<index> nodes, levelptr;
+	pseudo_peripheral_row(adjptr, adj, region, label, rows[0], nodes, levelptr, visited);
+	const index nlevels = static_cast<index>(levelptr.size())-1;
+
+	std::vector<index> part1, part2, separator;
+	if(static_cast<index>(nodes.size()) < nrows)
+	{
+		// disconnected: the component found and the rest are ordered independently
+		part1 = nodes;
+		for(index i = 0; i < static_cast<index>(part1.size()); i++)
+			region[part1[i]] = -1;
+		for(index i = 0; i < nrows; i++)
+			if(region[rows[i]] == label)
+				part2.push_back(rows[i]);
+	}
+	else if(nlevels < 3)
+	{
+		// too compact to separate
+		std::sort(rows.begin(), rows.end());
+		std::copy(rows.begin(), rows.end(), ord.begin()+offset);
+		return;
+	}
+	else
+	{
+		// the middle level, but neither the first nor the last, is the separator
+		index lsep = 1;
+		while(lsep < nlevels-2 && levelptr[lsep+1] < nrows/2)
+			lsep++;
+
+		part1.assign(nodes.begin(), nodes.begin()+levelptr[lsep]);
+		part2.assign(nodes.begin()+levelptr[lsep+1], nodes.end());
+
+		// separator rows not coupled to the next level go with the first part
+		for(index i = 0; i < static_cast<index>(part2.size()); i++)
+			region[part2[i]] = -1;
+		for(index i = levelptr[lsep]; i < levelptr[lsep+1]; i++)
+		{
+			const index irow = nodes[i];
+			bool coupled = false;
+			for(index jj = adjptr[irow]; jj < adjptr[irow+1]; jj++)
+				if(region[adj[jj]] == -1) {
+					coupled = true;
+					break;
+				}
+			if(coupled)
+				separator.push_back(irow);
+			else
+				part1.push_back(irow);
+		}
+	}
+
+	const index label1 = nextlabel++;
+	for(index i = 0; i < static_cast<index>(part1.size()); i++)
+		region[part1[i]] = label1;
+	const index label2 = nextlabel++;
+	for(index i = 0; i < static_cast<index>(part2.size()); i++)
+		region[part2[i]] = label2;
+
+	rows.clear();
+	rows.shrink_to_fit();
+
+	const index size1 = static_cast<index>(part1.size()), size2 = static_cast<index>(part2.size());
+	dissect(adjptr, adj, leafsize, part1, label1, nextlabel, region, visited, offset, ord);
+	dissect(adjptr, adj, leafsize, part2, label2, nextlabel, region, visited, offset+size1, ord);
+
+	std::sort(separator.begin(), separator.end());
+	std::copy(separator.begin(), separator.end(), ord.begin()+offset+size1+size2);
+}
+
+template <typename scalar, typename index>
+std::vector<index> computeNestedDissectionOrdering(const CRawBSRMatrix<scalar,index>& mat,
+                                                   const index leaf_size)
+{
+	const index n = mat.nbrows;
+	std::vector<index> adjptr, adj;
+	symmetric_adjacency(mat, adjptr, adj);
+
+	std::vector<index> region(n, 0);
+	std::vector<char> visited(n, 0);
+	std::vector<index> rows(n);
+	for(index i = 0; i < n; i++)
+		rows[i] = i;
+
+	std::vector<index> ord(n);
+	index nextlabel = 1;
+	dissect(adjptr, adj, std::max(leaf_size, (index)1), rows, (index)0, nextlabel, region,
+	        visited, (index)0, ord);
+	return ord;
+}
+
+template std::vector<int> computeNestedDissectionOrdering(const CRawBSRMatrix<double,int>& mat,
+                                                          const int leaf_size);
+
+/** The rows are filled in parallel once the row pointers are known.
+ */
+template <typename scalar, typename index>
+void getReorderedPattern(const CRawBSRMatrix<scalar,index>& mat, const int bs,
+                         const std::vector<index>& ord, SRMatrixStorage<scalar,index>& rmat,
+                         std::vector<index>& origloc)
+{
+	const index n = mat.nbrows;
+	const index nnz = mat.browptr[n];
+	const std::vector<index> newindex = invertPermutationVector(ord);
+
+	rmat.browptr.resize(n+1);
+	rmat.bcolind.resize(nnz);
+	rmat.vals.resize(nnz*bs*bs);
+	rmat.diagind.resize(n);
+	origloc.resize(nnz);
+
+	rmat.browptr[0] = 0;
+	for(index i = 0; i < n; i++) {
+		const index orow = ord[i];
+		rmat.browptr[i+1] = rmat.browptr[i] + mat.browptr[orow+1] - mat.browptr[orow];
+	}
+
+#pragma omp parallel for default(shared)
+	for(index i = 0; i < n; i++)
+	{
+		const index orow = ord[i];
+		std::vector<std::pair<index,index>> entries;
+		for(index jj = mat.browptr[orow]; jj < mat.browptr[orow+1]; jj++)
+			entries.push_back(std::make_pair(newindex[mat.bcolind[jj]], jj));
+		std::sort(entries.begin(), entries.end());
+
+		for(size_t k = 0; k < entries.size(); k++) {
+			const index pos = rmat.browptr[i] + static_cast<index>(k);
+			rmat.bcolind[pos] = entries[k].first;
+			origloc[pos] = entries[k].second;
+			if(entries[k].first == i)
+				rmat.diagind[i] = pos;
+		}
+	}
+
+	rmat.browendptr.wrap(&rmat.browptr[1], n);
+	rmat.nbrows = n;
+	rmat.nnzb = rmat.nbstored = nnz;
+}
+
+template void getReorderedPattern(const CRawBSRMatrix<double,int>& mat, const int bs,
+                                  const std::vector<int>& ord, SRMatrixStorage<double,int>& rmat,
+                                  std::vector<int>& origloc);
+
+template <typename scalar, typename index, int bs>
+RCMReordering<scalar,index,bs>::RCMReordering()
+	: Reordering<scalar,index,bs>()
+{ }
+
+template <typename scalar, typename index, int bs>
+void RCMReordering<scalar,index,bs>::compute(const CRawBSRMatrix<scalar,index>& mat)
+{
+	const std::vector<index> ord = computeRCMOrdering(mat);
+	this->setOrdering(ord.data(), ord.data(), mat.nbrows);
+}
+
+template class RCMReordering<double,int,1>;
+template class RCMReordering<double,int,4>;
+template class RCMReordering<double,int,7>;
+
+template <typename scalar, typename index, int bs>
+NestedDissectionReordering<scalar,index,bs>::NestedDissectionReordering(const index leaf_size)
+	: Reordering<scalar,index,bs>(), leafsize{leaf_size}
+{ }
+
+template <typename scalar, typename index, int bs>
+void NestedDissectionReordering<scalar,index,bs>::compute(const CRawBSRMatrix<scalar,index>& mat)
+{
+	const std::vector<index> ord = computeNestedDissectionOrdering(mat, leafsize);
+	this->setOrdering(ord.data(), ord.data(), mat.nbrows);
+}
+
+template class NestedDissectionReordering<double,int,1>;
+template class NestedDissectionReordering<double,int,4>;
+template class NestedDissectionReordering<double,int,7>;
+
 template <typename scalar, typename index, int bs>
 ReorderingScaling<scalar,index,bs>::ReorderingScaling()
 	: Reordering<scalar,index,bs>()
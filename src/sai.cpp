@@ -2,170 +2,142 @@
  * \brief Implementation of some functionality useful for building SAI-type preconditioners
  */
 
-#include <set>
-#include <Eigen/Dense>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <new>
+#include <memory>
+#include <boost/align/aligned_alloc.hpp>
+#include "structural_cache.hpp"
 #include "sai.hpp"
 #include "helper_algorithms.hpp"
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 namespace blasted {
 
+using boost::alignment::aligned_alloc;
+using boost::alignment::aligned_free;
+
+/** Every block-row of A corresponds to a block-row of the approximate inverse M and to a
+ * least-squares problem. The columns of the LHS matrix of row i are the rows of A indexed by the
+ * columns of row i, and its rows (the constraints) are the union of the columns of those rows.
+ *
+ * The pattern is built in parallel passes over the block-rows: the sizes of all problems are
+ * counted, the pointers are obtained by prefix sums, and the positions are then filled in.
+ * Each thread keeps, for every column of A, the last row whose constraints included it and its
+ * local index there, so that the constraints are found without searching.
+ */
 template <typename scalar, typename index>
 LeftSAIPattern<index> left_SAI_pattern(const SRMatrixStorage<const scalar,const index>&& mat)
 {
 	LeftSAIPattern<index> tsp;
+	const index n = mat.nbrows;
 
-	/* Note that every block-row of A corresponds to a block-row of the approx inverse M and to a
-	 * least-squares problem.
-	 */
-
-	tsp.sairowptr.assign(mat.nbrows+1,0);
-	tsp.nVars.assign(mat.nbrows,0);
-	tsp.nEqns.assign(mat.nbrows,0);
-	tsp.localCentralRow.assign(mat.nbrows, -1);
+	tsp.sairowptr.resize(n+1);
+	tsp.nVars.resize(n);
+	tsp.nEqns.resize(n);
+	tsp.localCentralRow.resize(n);
+	tsp.sairowptr[0] = 0;
 
 	// Step 1: Compute number of variables and constraints for each least-squares problem
 
-	index totalcoeffs = 0;     // number of least-square LHS coeffs over all block-rows
-	//#pragma omp parallel for default(shared) reduction(+:totalcoeffs)
-	for(index irow = 0; irow < mat.nbrows; irow++)
+#pragma omp parallel default(shared)
 	{
-		tsp.nVars[irow] = mat.browendptr[irow] - mat.browptr[irow];
+		std::vector<index> mark(n, -1);
 
-		std::set<index> constraints;
-		for(index jj = mat.browptr[irow]; jj < mat.browendptr[irow]; jj++)
+#pragma omp for schedule(dynamic, 256)
+		for(index irow = 0; irow < n; irow++)
 		{
-			const index col = mat.bcolind[jj];      // column of A^T, row of A
-
-			for(index kk = mat.browptr[col]; kk < mat.browendptr[col]; kk++) {
-				constraints.insert(mat.bcolind[kk]);
-				totalcoeffs++;
+			int neqns = 0;
+			for(index jj = mat.browptr[irow]; jj < mat.browendptr[irow]; jj++)
+			{
+				const index col = mat.bcolind[jj];      // column of A^T, row of A
+				for(index kk = mat.browptr[col]; kk < mat.browendptr[col]; kk++)
+					if(mark[mat.bcolind[kk]] != irow) {
+						mark[mat.bcolind[kk]] = irow;
+						neqns++;
+					}
 			}
-		}
 
-		tsp.nEqns[irow] = static_cast<int>(constraints.size());
-		tsp.sairowptr[irow+1] = tsp.nVars[irow];
+			tsp.nVars[irow] = mat.browendptr[irow] - mat.browptr[irow];
+			tsp.nEqns[irow] = neqns;
+			tsp.sairowptr[irow+1] = tsp.nVars[irow];
+		}
 	}
 
 	// get the starting of each least-squares problem in bcolptr
 	internal::inclusive_scan(tsp.sairowptr);
 
-	const index totalvars = tsp.sairowptr[mat.nbrows];
-#ifdef DEBUG
-	for(index irow = 0; irow < mat.nbrows; irow++)
-		assert(tsp.sairowptr[irow] < totalvars);
-#endif
-	tsp.bcolptr.assign(totalvars+1,0);
-	tsp.bpos.assign(totalcoeffs,0);
-	tsp.browind.assign(totalcoeffs,0);
-
 	// Step 2: Get pointers into bpos and browind corresponding to the beginning of
 	//  each column in each least-squares matrix over all rows of the orig matrix
 
-	for(index irow = 0; irow < mat.nbrows; irow++)
-	{
+	const index totalvars = tsp.sairowptr[n];
+	tsp.bcolptr.resize(totalvars+1);
+	tsp.bcolptr[0] = 0;
+
+#pragma omp parallel for default(shared) schedule(dynamic, 256)
+	for(index irow = 0; irow < n; irow++)
 		for(index jj = mat.browptr[irow]; jj < mat.browendptr[irow]; jj++)
 		{
-			const index col = mat.bcolind[jj];      // column of A^T, row of A
-			const index localcolidx = jj - mat.browptr[irow];
-
-			for(index kk = mat.browptr[col]; kk < mat.browendptr[col]; kk++)
-			{
-				assert(tsp.sairowptr[irow]+localcolidx < tsp.sairowptr[irow+1]);
-				tsp.bcolptr[tsp.sairowptr[irow] + localcolidx + 1]++;
-			}
+			const index col = mat.bcolind[jj];
+			tsp.bcolptr[tsp.sairowptr[irow] + jj-mat.browptr[irow] + 1]
+				= mat.browendptr[col] - mat.browptr[col];
 		}
-	}
 
 	internal::inclusive_scan(tsp.bcolptr);
-	assert(tsp.bcolptr[tsp.sairowptr[mat.nbrows]] == totalcoeffs);
+
+	const index totalcoeffs = tsp.bcolptr[totalvars];
+	tsp.bpos.resize(totalcoeffs);
+	tsp.browind.resize(totalcoeffs);
 
 	// Step 3: For the least-squares problem of each row of A, compute the sparsity pattern
 
-	// #pragma omp parallel for default(shared)
-	for(index irow = 0; irow < mat.nbrows; irow++)
+#pragma omp parallel default(shared)
 	{
-		// Get local row indices (in LHS matrix, which is a block of A^T)
+		std::vector<index> mark(n, -1);
+		std::vector<int> localrow(n);
+		std::vector<index> constraints;
 
-		std::set<index> constraints;
-		for(index jj = mat.browptr[irow]; jj < mat.browendptr[irow]; jj++)
+#pragma omp for schedule(dynamic, 256)
+		for(index irow = 0; irow < n; irow++)
 		{
-			const index col = mat.bcolind[jj];      // column of A^T, row of A
-
-			for(index kk = mat.browptr[col]; kk < mat.browendptr[col]; kk++)
-				constraints.insert(mat.bcolind[kk]);
-		}
-
-		const std::vector<index> constrvec(constraints.begin(), constraints.end());
-		assert(static_cast<int>(constrvec.size())==tsp.nEqns[irow]);
-
-		// find constraint corresponding to the diagonal entry irow
-		for(int icons = 0; icons < tsp.nEqns[irow]; icons++)
-			if(irow == constrvec[icons])
-				tsp.localCentralRow[irow] = icons;
-
-		assert(tsp.localCentralRow[irow] != -1);
-
-		std::vector<std::vector<int>> localrowinds(tsp.nVars[irow]);
-
-		for(index jj = mat.browptr[irow]; jj < mat.browendptr[irow]; jj++)
-		{
-			const index col = mat.bcolind[jj];
-			const int localcolidx = jj - mat.browptr[irow];
-			localrowinds[localcolidx].assign(mat.browendptr[col]-mat.browptr[col], -1);
-
-			for(size_t i = 0; i < constrvec.size(); i++)
+			// Get local row indices (in LHS matrix, which is a block of A^T), ordered by column of A
+			constraints.clear();
+			for(index jj = mat.browptr[irow]; jj < mat.browendptr[irow]; jj++)
 			{
+				const index col = mat.bcolind[jj];
 				for(index kk = mat.browptr[col]; kk < mat.browendptr[col]; kk++)
-					if(constrvec[i] == mat.bcolind[kk])
-					{
-						localrowinds[localcolidx][kk-mat.browptr[col]] = i;
+					if(mark[mat.bcolind[kk]] != irow) {
+						mark[mat.bcolind[kk]] = irow;
+						constraints.push_back(mat.bcolind[kk]);
 					}
 			}
-		}
-
-#ifdef DEBUG
-		for(index jj = mat.browptr[irow]; jj < mat.browendptr[irow]; jj++)
-		{
-			const int localcolidx = jj - mat.browptr[irow];
-			for(size_t i = 0; i < localrowinds[localcolidx].size(); i++) {
-				assert(localrowinds[localcolidx][i] >= 0);
-				assert(localrowinds[localcolidx][i] < tsp.nEqns[irow]);
-			}
-		}
-#endif
+			std::sort(constraints.begin(), constraints.end());
+			assert(static_cast<int>(constraints.size()) == tsp.nEqns[irow]);
 
-		/* Note that because sets are always ordered, the set 'constraints' is ordered by column index.
-		 * This means that localrowinds is ordered by column index of the constraints.
-		 */
+			for(int icons = 0; icons < tsp.nEqns[irow]; icons++)
+				localrow[constraints[icons]] = icons;
 
-		// Then, store positions and local row indices
+			// the constraint corresponding to the diagonal entry irow
+			assert(mark[irow] == irow);
+			tsp.localCentralRow[irow] = localrow[irow];
 
-		for(index jj = mat.browptr[irow]; jj < mat.browendptr[irow]; jj++)
-		{
-			const index col = mat.bcolind[jj];      // column of A^T, row of A
-			const int localcolidx = jj - mat.browptr[irow];
-
-			for(index kk = mat.browptr[col]; kk < mat.browendptr[col]; kk++)
+			// Then, store positions and local row indices
+			for(index jj = mat.browptr[irow]; jj < mat.browendptr[irow]; jj++)
 			{
-				const int locpos = kk - mat.browptr[col];
-				tsp.bpos[tsp.bcolptr[tsp.sairowptr[irow]+localcolidx] + locpos] = kk;
-				tsp.browind[tsp.bcolptr[tsp.sairowptr[irow]+localcolidx] + locpos]
-					= localrowinds[localcolidx][locpos];
-			}
-		}
+				const index col = mat.bcolind[jj];      // column of A^T, row of A
+				const index colstart = tsp.bcolptr[tsp.sairowptr[irow] + jj-mat.browptr[irow]];
 
-		// sanity check
-#ifdef DEBUG
-		for(index icol = tsp.sairowptr[irow]; icol < tsp.sairowptr[irow+1]; icol++)
-		{
-			for(index j = tsp.bcolptr[icol]; j < tsp.bcolptr[icol+1]; j++)
-			{
-				assert(tsp.bpos[j] < mat.nbstored);
-				assert(tsp.browind[j] >= 0);
-				assert(tsp.browind[j] < tsp.nEqns[irow]);
+				for(index kk = mat.browptr[col]; kk < mat.browendptr[col]; kk++)
+				{
+					tsp.bpos[colstart + kk-mat.browptr[col]] = kk;
+					tsp.browind[colstart + kk-mat.browptr[col]] = localrow[mat.bcolind[kk]];
+				}
 			}
 		}
-#endif
 	}
 
 	return tsp;
@@ -173,106 +145,103 @@ LeftSAIPattern<index> left_SAI_pattern(const SRMatrixStorage<const scalar,const
 
 template LeftSAIPattern<int> left_SAI_pattern(const SRMatrixStorage<const double,const int>&& mat);
 
+/** Here the constraints of row i are the columns of row i itself, so that the LHS matrices are
+ * square. The entries of LHS column j are those of row j of A whose columns are in the pattern of
+ * row i. As for \ref left_SAI_pattern, the pattern is built by parallel count, scan and fill
+ * passes, each thread marking the columns of the current row along with their local indices.
+ */
 template <typename scalar, typename index>
 LeftSAIPattern<index> left_incomplete_SAI_pattern(const SRMatrixStorage<const scalar,const index>&& mat)
 {
 	LeftSAIPattern<index> tsp;
+	const index n = mat.nbrows;
 
-	/* Note that every block-row of A corresponds to a block-row of the approx inverse M and to a
-	 * least-squares problem.
-	 */
-
-	tsp.sairowptr.assign(mat.nbrows+1,0);
-	tsp.nVars.resize(mat.nbrows);
-	tsp.nEqns.resize(mat.nbrows);
-	tsp.localCentralRow.assign(mat.nbrows, -1);
+	tsp.sairowptr.resize(n+1);
+	tsp.nVars.resize(n);
+	tsp.nEqns.resize(n);
+	tsp.localCentralRow.assign(n, -1);
+	tsp.sairowptr[0] = 0;
 
-	// Compute sizes
-
-	index totalcoeffs = 0;
-
-	for(index irow = 0; irow < mat.nbrows; irow++)
+#pragma omp parallel for default(shared) schedule(dynamic, 256)
+	for(index irow = 0; irow < n; irow++)
 	{
 		tsp.nVars[irow] = mat.browendptr[irow] - mat.browptr[irow];
 		tsp.nEqns[irow] = tsp.nVars[irow];
 		tsp.sairowptr[irow+1] = tsp.nVars[irow];
-
-		for(index jj = mat.browptr[irow]; jj < mat.browendptr[irow]; jj++)
-		{
-			const index colind = mat.bcolind[jj];
-			for(index kk = mat.browptr[colind]; kk < mat.browendptr[colind]; kk++)
-			{
-				for(index ll = mat.browptr[irow]; ll < mat.browendptr[irow]; ll++) {
-					if(mat.bcolind[ll] == mat.bcolind[kk]) {
-						totalcoeffs++;
-					}
-				}
-			}
-		}
 	}
 
 	internal::inclusive_scan(tsp.sairowptr);
 
-	const index totalvars = tsp.sairowptr[mat.nbrows];
+	const index totalvars = tsp.sairowptr[n];
 	tsp.bcolptr.resize(totalvars+1);
-	tsp.browind.resize(totalcoeffs);
-	tsp.bpos.resize(totalcoeffs);
+	tsp.bcolptr[0] = 0;
+
+	// Count the entries of every column of the LHS matrix for every row of the SAI
 
-	// Compute pointers to the beginning of every column in the LHS matrix for every row of the SAI
-	for(index irow = 0; irow < mat.nbrows; irow++)
+#pragma omp parallel default(shared)
 	{
-		const index startcol = tsp.sairowptr[irow];
+		std::vector<index> mark(n, -1);
 
-		for(index jj = mat.browptr[irow]; jj < mat.browendptr[irow]; jj++)
+#pragma omp for schedule(dynamic, 256)
+		for(index irow = 0; irow < n; irow++)
 		{
-			const index loccol = jj - mat.browptr[irow];
-			const index colind = mat.bcolind[jj];
-			for(index kk = mat.browptr[colind]; kk < mat.browendptr[colind]; kk++)
+			for(index ll = mat.browptr[irow]; ll < mat.browendptr[irow]; ll++)
+				mark[mat.bcolind[ll]] = irow;
+
+			const index startcol = tsp.sairowptr[irow];
+			for(index jj = mat.browptr[irow]; jj < mat.browendptr[irow]; jj++)
 			{
-				for(index ll = mat.browptr[irow]; ll < mat.browendptr[irow]; ll++) {
-					if(mat.bcolind[ll] == mat.bcolind[kk])
-					{
-						assert(startcol+loccol < tsp.sairowptr[irow+1]);
-						tsp.bcolptr[startcol+loccol+1]++;
-					}
-				}
+				const index colind = mat.bcolind[jj];
+				index count = 0;
+				for(index kk = mat.browptr[colind]; kk < mat.browendptr[colind]; kk++)
+					if(mark[mat.bcolind[kk]] == irow)
+						count++;
+				tsp.bcolptr[startcol + jj-mat.browptr[irow] + 1] = count;
+
+				if(colind == irow)
+					tsp.localCentralRow[irow] = jj - mat.browptr[irow];
 			}
 
-			if(colind == irow)
-				tsp.localCentralRow[irow] = loccol;
+			assert(tsp.localCentralRow[irow] >= 0);
+			assert(tsp.localCentralRow[irow] < tsp.nVars[irow]);
 		}
-
-		assert(tsp.localCentralRow[irow] >= 0);
-		assert(tsp.localCentralRow[irow] < tsp.nVars[irow]);
 	}
 
 	internal::inclusive_scan(tsp.bcolptr);
-	assert(tsp.bcolptr[totalvars]==totalcoeffs);
+
+	const index totalcoeffs = tsp.bcolptr[totalvars];
+	tsp.browind.resize(totalcoeffs);
+	tsp.bpos.resize(totalcoeffs);
 
 	// Compute the pattern
 
-	for(index irow = 0; irow < mat.nbrows; irow++)
+#pragma omp parallel default(shared)
 	{
-		const index startcol = tsp.sairowptr[irow];
+		std::vector<index> mark(n, -1);
+		std::vector<int> localrow(n);
 
-		for(index jj = mat.browptr[irow]; jj < mat.browendptr[irow]; jj++)
+#pragma omp for schedule(dynamic, 256)
+		for(index irow = 0; irow < n; irow++)
 		{
-			const index colind = mat.bcolind[jj];
-			const index loccol = jj - mat.browptr[irow];
-			const index saicolpos = tsp.bcolptr[startcol+loccol];
-
-			int numentries = 0;
+			for(index ll = mat.browptr[irow]; ll < mat.browendptr[irow]; ll++) {
+				mark[mat.bcolind[ll]] = irow;
+				localrow[mat.bcolind[ll]] = ll - mat.browptr[irow];
+			}
 
-			for(index kk = mat.browptr[colind]; kk < mat.browendptr[colind]; kk++)
+			const index startcol = tsp.sairowptr[irow];
+			for(index jj = mat.browptr[irow]; jj < mat.browendptr[irow]; jj++)
 			{
-				for(index ll = mat.browptr[irow]; ll < mat.browendptr[irow]; ll++) {
-					if(mat.bcolind[ll] == mat.bcolind[kk])
+				const index colind = mat.bcolind[jj];
+				const index saicolpos = tsp.bcolptr[startcol + jj-mat.browptr[irow]];
+
+				int numentries = 0;
+				for(index kk = mat.browptr[colind]; kk < mat.browendptr[colind]; kk++)
+					if(mark[mat.bcolind[kk]] == irow)
 					{
 						tsp.bpos[saicolpos+numentries] = kk;
-						tsp.browind[saicolpos+numentries] = ll-mat.browptr[irow];
+						tsp.browind[saicolpos+numentries] = localrow[mat.bcolind[kk]];
 						numentries++;
 					}
-				}
 			}
 		}
 	}
@@ -283,93 +252,310 @@ LeftSAIPattern<index> left_incomplete_SAI_pattern(const SRMatrixStorage<const sc
 template LeftSAIPattern<int>
 left_incomplete_SAI_pattern(const SRMatrixStorage<const double,const int>&& mat);
 
-/// Storage type for the left-hand side matrix for computing the left SAI/ISAI corresponding to one row
-template <typename scalar>
-using LMatrix = Matrix<scalar,Dynamic,Dynamic,ColMajor>;
+template <typename scalar, typename index>
+std::shared_ptr<const TriangularSAIPattern<index>>
+triangular_SAI_patterns(const CRawBSRMatrix<scalar,index>& mat, const int bs, const bool fullsai)
+{
+	return structural_cache().structure<TriangularSAIPattern<index>>
+		(fullsai ? "triangular SAI patterns" : "triangular ISAI patterns",
+		 pattern_fingerprint(mat, bs), [&mat,bs,fullsai]() {
+			 SRMatrixStorage<const scalar,const index> lmat(mat.browptr, mat.bcolind, mat.vals,
+			                                                mat.diagind, mat.browendptr, mat.nbrows,
+			                                                mat.nnzb, mat.nbstored, bs);
+			 SRMatrixStorage<const scalar,const index> umat(mat.browptr, mat.bcolind, mat.vals,
+			                                                mat.diagind, mat.browendptr, mat.nbrows,
+			                                                mat.nnzb, mat.nbstored, bs);
+			 if(fullsai)
+				 return TriangularSAIPattern<index> {
+					 left_SAI_pattern(getLowerTriangularView(std::move(lmat))),
+					 left_SAI_pattern(getUpperTriangularView(std::move(umat))) };
+			 else
+				 return TriangularSAIPattern<index> {
+					 left_incomplete_SAI_pattern(getLowerTriangularView(std::move(lmat))),
+					 left_incomplete_SAI_pattern(getUpperTriangularView(std::move(umat))) };
+		 });
+}
 
-/// Gather the SAI/ISAI LHS operator for one (block-)row of the matrix, given the SAI/ISAI pattern
-template <typename scalar, typename index, int bs, StorageOptions stor>
-LMatrix<scalar> gather_lhs_matrix(const SRMatrixStorage<const scalar,const index>& mat,
-                                  const LeftSAIPattern<index>& sp,
-                                  const index row);
+template std::shared_ptr<const TriangularSAIPattern<int>>
+triangular_SAI_patterns(const CRawBSRMatrix<double,int>& mat, const int bs, const bool fullsai);
 
-/// Scatter the SAI/ISAI solution for one (block-)row of the approx inverse, given the pattern
-template <typename scalar, typename index, int bs, StorageOptions stor>
-void scatter_solution(const LMatrix<scalar>& sol, const LeftSAIPattern<index>& sp,
-                      const index row, SRMatrixStorage<scalar,index>& mat);
+template <typename scalar, typename index>
+void triangular_part_pattern(const CRawBSRMatrix<scalar,index>& mat, const int bs, const bool lower,
+                             SRMatrixStorage<scalar,index>& tmat)
+{
+	const index n = mat.nbrows;
+	tmat.browptr.resize(n+1);
+	tmat.diagind.resize(n);
+	tmat.browptr[0] = 0;
+	for(index irow = 0; irow < n; irow++)
+		tmat.browptr[irow+1] = tmat.browptr[irow] + (lower ? mat.diagind[irow]-mat.browptr[irow]+1
+		                                             : mat.browendptr[irow]-mat.diagind[irow]);
+
+	const index nnz = tmat.browptr[n];
+	tmat.bcolind.resize(nnz);
+	tmat.vals.resize(nnz*bs*bs);
+	tmat.browendptr.wrap(&tmat.browptr[1], n);
+	tmat.nbrows = n;
+	tmat.nnzb = tmat.nbstored = nnz;
+
+#pragma omp parallel for default(shared)
+	for(index irow = 0; irow < n; irow++)
+	{
+		const index start = lower ? mat.browptr[irow] : mat.diagind[irow];
+		for(index jj = tmat.browptr[irow]; jj < tmat.browptr[irow+1]; jj++)
+			tmat.bcolind[jj] = mat.bcolind[start + jj-tmat.browptr[irow]];
+		tmat.diagind[irow] = lower ? tmat.browptr[irow+1]-1 : tmat.browptr[irow];
+	}
+}
 
-template <typename scalar, typename index, int bs, StorageOptions stor>
-void compute_SAI(const SRMatrixStorage<const scalar,const index>& mat, const LeftSAIPattern<index>& sp,
-                 const int thread_chunk_size, const bool fullsai,
-                 SRMatrixStorage<scalar,index>& sai)
+template void triangular_part_pattern(const CRawBSRMatrix<double,int>& mat, const int bs,
+                                      const bool lower, SRMatrixStorage<double,int>& tmat);
+
+/// Workspace of one thread for the SAI/ISAI least-squares problems
+/** It is allocated once per thread, with room for the largest problem, so that solving for the
+ * rows does not touch the memory allocator. The workspaces are allocated before the parallel
+ * region that uses them, since an exception must not escape an OpenMP region.
+ */
+template <typename scalar>
+struct SAIWorkspace
 {
-	assert(mat.nbrows == sai.nbrows);
-	assert(mat.nnzb == sai.nnzb);
+	/** \param max_rows Maximum number of rows of a (scalar) LHS matrix
+	 * \param max_cols Maximum number of columns of a (scalar) LHS matrix
+	 * \param nrhs Number of right-hand sides, which is the block size
+	 */
+	SAIWorkspace(const int max_rows, const int max_cols, const int nrhs)
+	{
+		const size_t nlhs = static_cast<size_t>(max_rows)*max_cols;
+		const size_t nrhsv = static_cast<size_t>(max_rows)*nrhs;
+		arena = (scalar*)aligned_alloc(CACHE_LINE_LEN, (nlhs+nrhsv+2*max_cols)*sizeof(scalar));
+		perm = (int*)aligned_alloc(CACHE_LINE_LEN, std::max(max_cols,1)*sizeof(int));
+		if(!arena || !perm) {
+			aligned_free(arena);
+			aligned_free(perm);
+			throw std::bad_alloc();
+		}
+		lhs = arena;
+		rhs = lhs + nlhs;
+		tau = rhs + nrhsv;
+		work = tau + max_cols;
+	}
 
-	// Solve least-squares problem for each row
-#pragma omp parallel for default(shared) schedule(dynamic,thread_chunk_size)
-	for(index irow = 0; irow < mat.nbrows; irow++)
+	~SAIWorkspace()
 	{
-		const LMatrix<scalar> lhs = gather_lhs_matrix<scalar,index,bs,stor>(mat, sp, irow);
-		LMatrix<scalar> rhs = LMatrix<scalar>::Zero(lhs.rows(), bs);
-		for(int i = 0; i < bs; i++)
-			rhs(sp.localCentralRow[irow]*bs + i, i) = 1.0;
+		aligned_free(arena);
+		aligned_free(perm);
+	}
 
-		LMatrix<scalar> ans;
-		if (fullsai)
-			ans = lhs.colPivHouseholderQr().solve(rhs);
-		else
-			ans = lhs.partialPivLu().solve(rhs);
+	SAIWorkspace(const SAIWorkspace&) = delete;
+	SAIWorkspace& operator=(const SAIWorkspace&) = delete;
+
+	scalar *lhs;            ///< Column-major LHS matrix of a least-squares problem
+	scalar *rhs;            ///< Column-major RHS, overwritten by the solution
+	scalar *tau;            ///< Householder scalars
+	scalar *work;           ///< Scratch vector of the length of a row of the solution
+	int *perm;              ///< Column permutation
+
+private:
+	scalar *arena;          ///< The storage for all the scalar arrays above
+};
+
+/// Solves the least-squares problem min ||A X - B|| in place by Householder QR with column pivoting
+/** At each step the remaining column of largest norm is brought forward. Once that norm is
+ * negligible relative to the first pivot, the remaining columns are treated as dependent and their
+ * solution components are set to zero, as Eigen's ColPivHouseholderQR does.
+ * \param m Number of rows of A, at least n
+ * \param n Number of columns of A
+ * \param A Column-major m x n matrix; destroyed
+ * \param nrhs Number of right-hand sides
+ * \param B Column-major m x nrhs right-hand side; on exit, its first n rows contain the solution
+ * \param tau Work array of length n
+ * \param work Work array of length n
+ * \param perm Work array of length n
+ */
+template <typename scalar>
+static void colpiv_qr_solve(const int m, const int n, scalar *const A, const int nrhs,
+                            scalar *const B, scalar *const tau, scalar *const work, int *const perm)
+{
+	const scalar tol = std::numeric_limits<scalar>::epsilon()*std::max(m,n);
+	scalar maxpivot = 0;
+	int rank = n;
+
+	for(int j = 0; j < n; j++)
+		perm[j] = j;
 
-		scatter_solution<scalar,index,bs,stor>(ans, sp, irow, sai);
+	for(int k = 0; k < n; k++)
+	{
+		// pivot: remaining column with largest remaining norm
+		int p = k;
+		scalar pnorm2 = -1;
+		for(int j = k; j < n; j++) {
+			scalar norm2 = 0;
+			for(int i = k; i < m; i++)
+				norm2 += A[j*m+i]*A[j*m+i];
+			if(norm2 > pnorm2) {
+				pnorm2 = norm2;
+				p = j;
+			}
+		}
+
+		const scalar pnorm = std::sqrt(pnorm2);
+		if(k == 0)
+			maxpivot = pnorm;
+		if(pnorm <= tol*maxpivot) {
+			rank = k;
+			break;
+		}
+
+		if(p != k) {
+			for(int i = 0; i < m; i++)
+				std::swap(A[k*m+i], A[p*m+i]);
+			std::swap(perm[k], perm[p]);
+		}
+
+		// Householder reflector H = I - tau v v^T, with v(k) = 1, mapping column k to beta e_k
+		scalar *const colk = &A[k*m];
+		const scalar alpha = colk[k];
+		const scalar beta = alpha >= 0 ? -pnorm : pnorm;
+		tau[k] = (beta-alpha)/beta;
+		const scalar vscale = 1/(alpha-beta);
+		for(int i = k+1; i < m; i++)
+			colk[i] *= vscale;
+		colk[k] = beta;
+
+		for(int j = k+1; j < n; j++) {
+			scalar *const colj = &A[j*m];
+			scalar dot = colj[k];
+			for(int i = k+1; i < m; i++)
+				dot += colk[i]*colj[i];
+			dot *= tau[k];
+			colj[k] -= dot;
+			for(int i = k+1; i < m; i++)
+				colj[i] -= dot*colk[i];
+		}
+		for(int j = 0; j < nrhs; j++) {
+			scalar *const bj = &B[j*m];
+			scalar dot = bj[k];
+			for(int i = k+1; i < m; i++)
+				dot += colk[i]*bj[i];
+			dot *= tau[k];
+			bj[k] -= dot;
+			for(int i = k+1; i < m; i++)
+				bj[i] -= dot*colk[i];
+		}
+	}
+
+	// solve R z = Q^T b for the independent columns, and undo the column permutation
+	for(int j = 0; j < nrhs; j++)
+	{
+		scalar *const bj = &B[j*m];
+		for(int k = rank-1; k >= 0; k--) {
+			scalar sum = bj[k];
+			for(int l = k+1; l < rank; l++)
+				sum -= A[l*m+k]*bj[l];
+			bj[k] = sum/A[k*m+k];
+		}
+		for(int k = rank; k < n; k++)
+			bj[k] = 0;
+
+		for(int k = 0; k < n; k++)
+			work[perm[k]] = bj[k];
+		for(int k = 0; k < n; k++)
+			bj[k] = work[k];
 	}
 }
 
-template void compute_SAI<double,int,1,ColMajor>(const SRMatrixStorage<const double,const int>& mat,
-                                                 const LeftSAIPattern<int>& sp,
-                                                 const int thread_chunk_size, const bool fullsai,
-                                                 SRMatrixStorage<double,int>& sai);
-template void compute_SAI<double,int,4,ColMajor>(const SRMatrixStorage<const double,const int>& mat,
-                                                 const LeftSAIPattern<int>& sp,
-                                                 const int thread_chunk_size, const bool fullsai,
-                                                 SRMatrixStorage<double,int>& sai);
+/// Solves the square system A X = B in place by LU factorization with partial pivoting
+/** \param n Size of A
+ * \param A Column-major n x n matrix; destroyed
+ * \param nrhs Number of right-hand sides
+ * \param B Column-major n x nrhs right-hand side, overwritten by the solution
+ */
+template <typename scalar>
+static void partialpiv_lu_solve(const int n, scalar *const A, const int nrhs, scalar *const B)
+{
+	for(int k = 0; k < n; k++)
+	{
+		int p = k;
+		for(int i = k+1; i < n; i++)
+			if(std::abs(A[k*n+i]) > std::abs(A[k*n+p]))
+				p = i;
+		if(p != k) {
+			for(int j = 0; j < n; j++)
+				std::swap(A[j*n+k], A[j*n+p]);
+			for(int j = 0; j < nrhs; j++)
+				std::swap(B[j*n+k], B[j*n+p]);
+		}
+
+		scalar *const colk = &A[k*n];
+		const scalar invpivot = 1/colk[k];
+		for(int i = k+1; i < n; i++)
+			colk[i] *= invpivot;
+
+		for(int j = k+1; j < n; j++) {
+			scalar *const colj = &A[j*n];
+			for(int i = k+1; i < n; i++)
+				colj[i] -= colk[i]*colj[k];
+		}
+		for(int j = 0; j < nrhs; j++) {
+			scalar *const bj = &B[j*n];
+			for(int i = k+1; i < n; i++)
+				bj[i] -= colk[i]*bj[k];
+		}
+	}
 
+	for(int j = 0; j < nrhs; j++) {
+		scalar *const bj = &B[j*n];
+		for(int k = n-1; k >= 0; k--) {
+			bj[k] /= A[k*n+k];
+			for(int i = 0; i < k; i++)
+				bj[i] -= A[k*n+i]*bj[k];
+		}
+	}
+}
+
+/// Gather the SAI/ISAI LHS operator for one (block-)row of the matrix, given the SAI/ISAI pattern
+/** \param[out] lhs Column-major storage for the LHS matrix, whose leading dimension is its number
+ *   of rows
+ */
 template <typename scalar, typename index, int bs, StorageOptions stor>
-LMatrix<scalar> gather_lhs_matrix(const SRMatrixStorage<const scalar,const index>& mat,
-                                  const LeftSAIPattern<index>& sp,
-                                  const index row)
+static void gather_lhs_matrix(const SRMatrixStorage<const scalar,const index>& mat,
+                              const LeftSAIPattern<index>& sp, const index row,
+                              scalar *const __restrict lhs)
 {
 	using Blk = Block_t<scalar,bs,stor>;
 	const Blk *const valb = reinterpret_cast<const Blk*>(&mat.vals[0]);
+	const int nrows = sp.nEqns[row]*bs, ncols = sp.nVars[row]*bs;
 
-	LMatrix<scalar> lhs = LMatrix<scalar>::Zero(sp.nEqns[row]*bs, sp.nVars[row]*bs);
+	for(int i = 0; i < nrows*ncols; i++)
+		lhs[i] = 0;
 
 	for(int jcol = 0; jcol < sp.nVars[row]; jcol++)
 	{
 		const index start = sp.bcolptr[sp.sairowptr[row]+jcol],
 			end = sp.bcolptr[sp.sairowptr[row]+jcol+1];
 
-		assert(end-start == sp.nEqns[row]);
+		assert(end-start <= sp.nEqns[row]);
 
-#pragma omp simd
 		for(index ii = start; ii < end; ii++)
 		{
 			const int lhsrow = sp.browind[ii];
 			const index lhspos = sp.bpos[ii];
 
 			// Note the transpose
-			for(int ib = 0; ib < bs; ib++)
-				for(int jb = 0; jb < bs; jb++)
-					lhs(lhsrow*bs+ib, jcol*bs+jb) = valb[lhspos](jb,ib);
+			for(int jb = 0; jb < bs; jb++)
+				for(int ib = 0; ib < bs; ib++)
+					lhs[(jcol*bs+jb)*nrows + lhsrow*bs+ib] = valb[lhspos](jb,ib);
 		}
 	}
-
-	return lhs;
 }
 
+/// Scatter the SAI/ISAI solution for one (block-)row of the approx inverse, given the pattern
+/** \param sol Column-major solution whose leading dimension is ldsol
+ */
 template <typename scalar, typename index, int bs, StorageOptions stor>
-void scatter_solution(const LMatrix<scalar>& sol, const LeftSAIPattern<index>& sp,
-                      const index row, SRMatrixStorage<scalar,index>& saimat)
+static void scatter_solution(const scalar *const sol, const int ldsol,
+                             const LeftSAIPattern<index>& sp, const index row,
+                             SRMatrixStorage<scalar,index>& saimat)
 {
 	using Blk = Block_t<scalar,bs,stor>;
 	Blk *const saivalb = reinterpret_cast<Blk*>(&saimat.vals[0]);
@@ -382,8 +568,110 @@ void scatter_solution(const LMatrix<scalar>& sol, const LeftSAIPattern<index>& s
 
 		for(int i = 0; i < bs; i++)
 			for(int j = 0; j < bs; j++)
-				saivalb[jj](i,j) = sol(locloc*bs+j, i);
+				saivalb[jj](i,j) = sol[i*ldsol + locloc*bs+j];
+	}
+}
+
+/// Computes the SAI/ISAI rows of a contiguous range of (block-)rows using one workspace
+template <typename scalar, typename index, int bs, StorageOptions stor>
+static void compute_SAI_rows(const SRMatrixStorage<const scalar,const index>& mat,
+                             const LeftSAIPattern<index>& sp, const bool fullsai,
+                             const index start, const index end, SAIWorkspace<scalar>& ws,
+                             SRMatrixStorage<scalar,index>& sai)
+{
+	for(index irow = start; irow < end; irow++)
+	{
+		const int m = sp.nEqns[irow]*bs, n = sp.nVars[irow]*bs;
+		gather_lhs_matrix<scalar,index,bs,stor>(mat, sp, irow, ws.lhs);
+
+		for(int i = 0; i < m*bs; i++)
+			ws.rhs[i] = 0;
+		for(int i = 0; i < bs; i++)
+			ws.rhs[i*m + sp.localCentralRow[irow]*bs + i] = 1.0;
+
+		if(fullsai)
+			colpiv_qr_solve(m, n, ws.lhs, bs, ws.rhs, ws.tau, ws.work, ws.perm);
+		else
+			partialpiv_lu_solve(n, ws.lhs, bs, ws.rhs);
+
+		scatter_solution<scalar,index,bs,stor>(ws.rhs, m, sp, irow, sai);
 	}
 }
 
+/** The rows are processed in chunks of thread_chunk_size. One workspace for the largest
+ * least-squares problem is allocated for each thread beforehand, and each thread solves all
+ * problems of its chunks in its own workspace.
+ */
+template <typename scalar, typename index, int bs, StorageOptions stor>
+void compute_SAI(const SRMatrixStorage<const scalar,const index>& mat, const LeftSAIPattern<index>& sp,
+                 const int thread_chunk_size, const bool fullsai,
+                 SRMatrixStorage<scalar,index>& sai)
+{
+	assert(mat.nbrows == sai.nbrows);
+	assert(mat.nnzb == sai.nnzb);
+
+	int maxeqns = 0, maxvars = 0;
+#pragma omp parallel for default(shared) reduction(max:maxeqns,maxvars)
+	for(index irow = 0; irow < mat.nbrows; irow++) {
+		maxeqns = std::max(maxeqns, sp.nEqns[irow]);
+		maxvars = std::max(maxvars, sp.nVars[irow]);
+	}
+
+	const index chunksize = std::max(thread_chunk_size, 1);
+	const index nchunks = (mat.nbrows + chunksize - 1)/chunksize;
+
+#ifdef _OPENMP
+	const int nthreads = omp_get_max_threads();
+#else
+	const int nthreads = 1;
+#endif
+	std::vector<std::unique_ptr<SAIWorkspace<scalar>>> wspaces(nthreads);
+	for(int i = 0; i < nthreads; i++)
+		wspaces[i].reset(new SAIWorkspace<scalar>(maxeqns*bs, maxvars*bs, bs));
+
+#pragma omp parallel default(shared) num_threads(nthreads)
+	{
+		int tid = 0;
+#ifdef _OPENMP
+		tid = omp_get_thread_num();
+#endif
+		SAIWorkspace<scalar>& ws = *wspaces[tid];
+
+		// Solve least-squares problem for each row
+#pragma omp for schedule(dynamic,1)
+		for(index ichunk = 0; ichunk < nchunks; ichunk++)
+		{
+			const index start = ichunk*chunksize;
+			const index end = std::min(start+chunksize, mat.nbrows);
+			compute_SAI_rows<scalar,index,bs,stor>(mat, sp, fullsai, start, end, ws, sai);
+		}
+	}
+}
+
+template void compute_SAI<double,int,1,ColMajor>(const SRMatrixStorage<const double,const int>& mat,
+                                                 const LeftSAIPattern<int>& sp,
+                                                 const int thread_chunk_size, const bool fullsai,
+                                                 SRMatrixStorage<double,int>& sai);
+template void compute_SAI<double,int,4,ColMajor>(const SRMatrixStorage<const double,const int>& mat,
+                                                 const LeftSAIPattern<int>& sp,
+                                                 const int thread_chunk_size, const bool fullsai,
+                                                 SRMatrixStorage<double,int>& sai);
+template void compute_SAI<double,int,5,ColMajor>(const SRMatrixStorage<const double,const int>& mat,
+                                                 const LeftSAIPattern<int>& sp,
+                                                 const int thread_chunk_size, const bool fullsai,
+                                                 SRMatrixStorage<double,int>& sai);
+template void compute_SAI<double,int,4,RowMajor>(const SRMatrixStorage<const double,const int>& mat,
+                                                 const LeftSAIPattern<int>& sp,
+                                                 const int thread_chunk_size, const bool fullsai,
+                                                 SRMatrixStorage<double,int>& sai);
+
+#ifdef BUILD_BLOCK_SIZE
+template void compute_SAI<double,int,BUILD_BLOCK_SIZE,ColMajor>
+(const SRMatrixStorage<const double,const int>& mat, const LeftSAIPattern<int>& sp,
+ const int thread_chunk_size, const bool fullsai, SRMatrixStorage<double,int>& sai);
+template void compute_SAI<double,int,BUILD_BLOCK_SIZE,RowMajor>
+(const SRMatrixStorage<const double,const int>& mat, const LeftSAIPattern<int>& sp,
+ const int thread_chunk_size, const bool fullsai, SRMatrixStorage<double,int>& sai);
+#endif
+
 }
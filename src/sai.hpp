@@ -5,6 +5,7 @@
 #ifndef BLASTED_SAI_H
 #define BLASTED_SAI_H
 
+#include <memory>
 #include "device_container.hpp"
 #include "srmatrixdefs.hpp"
 
@@ -37,6 +38,16 @@ struct LeftSAIPattern
 	//device_vector<int> localCentralCol;
 };
 
+/// Assembly patterns of the (incomplete) SAIs of the lower and upper triangular parts of a matrix
+/** Both parts include the diagonal.
+ */
+template <typename index>
+struct TriangularSAIPattern
+{
+	LeftSAIPattern<index> lower;         ///< Pattern for the approximate inverse of the lower part
+	LeftSAIPattern<index> upper;         ///< Pattern for the approximate inverse of the upper part
+};
+
 /// Compute the assembly pattern for a left sparse approximate inverse of the given matrix
 /** Currently, assumes CPU as the device, but it changing it for any other device should not be too
  * difficult (the computation in the function would still be done on the host; the result would
@@ -54,15 +65,35 @@ template <typename scalar, typename index>
 LeftSAIPattern<index> left_incomplete_SAI_pattern(const SRMatrixStorage<const scalar,const index>&& mat);
 
 /// Compute the approximate inverse matrix using a given SAI pattern
-/** \param mat The original matrix
+/** The least-squares problems are solved by Householder QR with column pivoting for a SAI and by
+ * LU with partial pivoting for an incomplete SAI, whose problems are square. No memory is allocated
+ * per row: each thread solves its problems in one workspace sized for the largest problem.
+ * \param mat The original matrix
  * \param sp The SAI/ISAI pattern \ref LeftSAIPattern
- * \param thread_chunk_size Number of work-items per chunk given to a thread at a time
+ * \param thread_chunk_size Number of (block-)rows given to a thread at a time
  * \param fullsai Set to true for computing a SAI, false for computing an incomplete SAI
- * \param[out] sai The approximate inverse matrix preallocated to the same size as the original matrix
+ * \param[out] sai The approximate inverse matrix preallocated with the pattern of the original matrix
  */
 template <typename scalar, typename index, int bs, StorageOptions stor>
-void compute_SAI(const CRawBSRMatrix<scalar,index>& mat, const LeftSAIPattern<index>& sp,
-                 const int thread_chunk_size, const bool fullsai, RawBSRMatrix<scalar,index>& sai);
+void compute_SAI(const SRMatrixStorage<const scalar,const index>& mat, const LeftSAIPattern<index>& sp,
+                 const int thread_chunk_size, const bool fullsai,
+                 SRMatrixStorage<scalar,index>& sai);
+
+/// Returns the assembly patterns for (incomplete) SAIs of the triangular parts of a matrix
+/** The patterns are shared among all callers passing matrices of the same pattern \sa StructuralCache
+ * \param fullsai Set to true for the patterns of SAIs, false for those of incomplete SAIs
+ */
+template <typename scalar, typename index>
+std::shared_ptr<const TriangularSAIPattern<index>>
+triangular_SAI_patterns(const CRawBSRMatrix<scalar,index>& mat, const int bs, const bool fullsai);
+
+/// Sets a compact sparse-row matrix to the pattern of one triangular part of a matrix
+/** The values are allocated but not initialized.
+ * \param lower Whether to take the lower or the upper triangular part, the diagonal included
+ */
+template <typename scalar, typename index>
+void triangular_part_pattern(const CRawBSRMatrix<scalar,index>& mat, const int bs, const bool lower,
+                             SRMatrixStorage<scalar,index>& tmat);
 
 }
 
@@ -0,0 +1,184 @@
+/** \file
+ * \brief Conversion of sparse-row matrices to sliced ELLPACK (SELL-C-sigma) storage
+ * \author Aditya Kashi
+ *
+ * This file is part of BLASTed.
+ *   BLASTed is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   BLASTed is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with BLASTed.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include "sellmatrixdefs.hpp"
+
+namespace blasted {
+
+/// Start of the requested part of a row of a CSR matrix
+template <typename scalar, typename index>
+static inline index part_start(const CRawBSRMatrix<scalar,index>& mat, const SELLPart part,
+                               const index irow)
+{
+	return part == SELL_STRICT_UPPER ? mat.diagind[irow]+1 : mat.browptr[irow];
+}
+
+/// One-past-the-end of the requested part of a row of a CSR matrix
+template <typename scalar, typename index>
+static inline index part_end(const CRawBSRMatrix<scalar,index>& mat, const SELLPart part,
+                             const index irow)
+{
+	return part == SELL_STRICT_LOWER ? mat.diagind[irow] : mat.browptr[irow+1];
+}
+
+template <typename scalar, typename index>
+void convert_SR_to_SELL(const CRawBSRMatrix<scalar,index>& mat, const int C, const int sigma,
+                        const SELLPart part, SELLMatrixStorage<scalar,index>& smat)
+{
+	if(C < 1)
+		throw std::invalid_argument("SELL: Chunk height must be positive!");
+	if(sigma > 1 && sigma % C != 0)
+		throw std::invalid_argument("SELL: Sorting scope " + std::to_string(sigma)
+		                            + " is not a multiple of the chunk height!");
+
+	const index N = mat.nbrows;
+	smat.nrows = N;
+	smat.C = C;
+	smat.sigma = sigma;
+	smat.part = part;
+	smat.nchunks = (N + C - 1)/C;
+
+	// sort rows within each sigma-window by decreasing length of the requested part
+
+	smat.rowperm.resize(smat.nchunks*C);
+	for(index i = 0; i < N; i++)
+		smat.rowperm[i] = i;
+	for(index i = N; i < smat.nchunks*C; i++)
+		smat.rowperm[i] = -1;
+
+	if(sigma > 1)
+	{
+#pragma omp parallel for default(shared) schedule(dynamic, 1)
+		for(index wstart = 0; wstart < N; wstart += sigma)
+		{
+			const index wend = std::min(wstart+sigma, N);
+			std::stable_sort(&smat.rowperm[0] + wstart, &smat.rowperm[0] + wend,
+			                 [&mat,part](const index a, const index b) {
+				                 return part_end(mat,part,a)-part_start(mat,part,a)
+					                 > part_end(mat,part,b)-part_start(mat,part,b);
+			                 });
+		}
+	}
+
+	// compute chunk widths and the locations of chunks in the value array
+
+	smat.chunklen.resize(smat.nchunks);
+	smat.chunkptr.resize(smat.nchunks+1);
+
+#pragma omp parallel for default(shared)
+	for(index ic = 0; ic < smat.nchunks; ic++)
+	{
+		index len = 0;
+		for(int i = 0; i < smat.chunk_rows(ic); i++) {
+			const index irow = smat.rowperm[ic*C+i];
+			len = std::max(len, part_end(mat,part,irow)-part_start(mat,part,irow));
+		}
+		smat.chunklen[ic] = len;
+	}
+
+	smat.chunkptr[0] = 0;
+	for(index ic = 0; ic < smat.nchunks; ic++)
+		smat.chunkptr[ic+1] = smat.chunkptr[ic] + smat.chunklen[ic]*C;
+
+	const index nstored = smat.chunkptr[smat.nchunks];
+	smat.colind.resize(nstored);
+	smat.vals.resize(nstored);
+	smat.srcpos.resize(nstored);
+
+	// fill, column-wise within each chunk
+
+#pragma omp parallel for default(shared)
+	for(index ic = 0; ic < smat.nchunks; ic++)
+	{
+		const index cstart = smat.chunkptr[ic];
+		for(int i = 0; i < C; i++)
+		{
+			const index irow = smat.rowperm[ic*C+i];
+
+			if(irow < 0) {
+				for(index j = 0; j < smat.chunklen[ic]; j++) {
+					smat.colind[cstart + j*C+i] = 0;
+					smat.vals[cstart + j*C+i] = 0;
+					smat.srcpos[cstart + j*C+i] = -1;
+				}
+				continue;
+			}
+
+			const index start = part_start(mat,part,irow);
+			const index rowlen = part_end(mat,part,irow) - start;
+			for(index j = 0; j < rowlen; j++) {
+				smat.colind[cstart + j*C+i] = mat.bcolind[start+j];
+				smat.vals[cstart + j*C+i] = mat.vals[start+j];
+				smat.srcpos[cstart + j*C+i] = start+j;
+			}
+			for(index j = rowlen; j < smat.chunklen[ic]; j++) {
+				smat.colind[cstart + j*C+i] = irow;
+				smat.vals[cstart + j*C+i] = 0;
+				smat.srcpos[cstart + j*C+i] = -1;
+			}
+		}
+	}
+}
+
+template void convert_SR_to_SELL(const CRawBSRMatrix<double,int>& mat, const int C, const int sigma,
+                                 const SELLPart part, SELLMatrixStorage<double,int>& smat);
+
+/// Address of the first entry of an array, or null if it is empty
+template <typename T>
+static inline const T *first_or_null(const ArrayView<T>& arr)
+{
+	return arr.size() > 0 ? &arr[0] : nullptr;
+}
+
+template <typename scalar, typename index>
+CRawSELLMatrix<scalar,index> createRawView(const SELLMatrixStorage<scalar,index>& smat)
+{
+	CRawSELLMatrix<scalar,index> rmat;
+	rmat.chunkptr = first_or_null(smat.chunkptr);
+	rmat.chunklen = first_or_null(smat.chunklen);
+	rmat.colind = first_or_null(smat.colind);
+	rmat.vals = first_or_null(smat.vals);
+	rmat.rowperm = first_or_null(smat.rowperm);
+	rmat.nrows = smat.nrows;
+	rmat.nchunks = smat.nchunks;
+	rmat.C = smat.C;
+	return rmat;
+}
+
+template CRawSELLMatrix<double,int> createRawView(const SELLMatrixStorage<double,int>& smat);
+
+template <typename scalar, typename index>
+void update_SELL_values(const CRawBSRMatrix<scalar,index>& mat, SELLMatrixStorage<scalar,index>& smat)
+{
+	assert(mat.nbrows == smat.nrows);
+	const index nstored = smat.chunkptr[smat.nchunks];
+
+#pragma omp parallel for simd default(shared)
+	for(index jj = 0; jj < nstored; jj++)
+		smat.vals[jj] = smat.srcpos[jj] >= 0 ? mat.vals[smat.srcpos[jj]] : 0;
+}
+
+template void update_SELL_values(const CRawBSRMatrix<double,int>& mat,
+                                 SELLMatrixStorage<double,int>& smat);
+
+}
@@ -9,10 +9,18 @@
 #include "solverfactory.hpp"
 #include "solverops_jacobi.hpp"
 #include "solverops_sgs.hpp"
+#include "solverops_sell.hpp"
 #include "solverops_ilu0.hpp"
+#include "solverops_mixedprec.hpp"
 #include "relaxation_chaotic.hpp"
 #include "solverops_levels_sgs.hpp"
 #include "solverops_levels_ilu0.hpp"
+#include "solverops_iluk.hpp"
+#include "solverops_multicolor.hpp"
+#include "solverops_sai.hpp"
+#include "solverops_sgs_sai.hpp"
+#include "solverops_chebyshev.hpp"
+#include "solverops_reordered.hpp"
 
 namespace blasted {
 
@@ -51,6 +59,22 @@ BlastedSolverType SRFactory<scalar,index>::solverTypeFromString(const std::strin
 		ptype = BLASTED_LEVEL_SGS;
 	else if(precstr2 == asynclevelilustr)
 		ptype = BLASTED_ASYNC_LEVEL_ILU0;
+	else if(precstr2 == ilukstr)
+		ptype = BLASTED_ILUK;
+	else if(precstr2 == asynclevelilukstr)
+		ptype = BLASTED_ASYNC_LEVEL_ILUK;
+	else if(precstr2 == parilutstr)
+		ptype = BLASTED_PARILUT;
+	else if(precstr2 == mcsgsstr)
+		ptype = BLASTED_MC_SGS;
+	else if(precstr2 == mcilu0str)
+		ptype = BLASTED_MC_ILU0;
+	else if(precstr2 == saistr)
+		ptype = BLASTED_SAI;
+	else if(precstr2 == sgssaistr)
+		ptype = BLASTED_SGS_SAI;
+	else if(precstr2 == chebyshevstr)
+		ptype = BLASTED_CHEBYSHEV;
 	else if(precstr2 == noprecstr)
 		ptype = BLASTED_NO_PREC;
 	else {
@@ -59,6 +83,46 @@ BlastedSolverType SRFactory<scalar,index>::solverTypeFromString(const std::strin
 	return ptype;
 }
 
+/// Throws if options not implemented by the mixed-precision preconditioners are requested
+/** The single-precision factor variants only implement plain asynchronous sweeps, so any other
+ * requested algorithm is rejected rather than silently replaced.
+ */
+static void check_float_factor_options(const AsyncSolverSettings& opts)
+{
+	const bool isilu = opts.prectype == BLASTED_ILU0 || opts.prectype == BLASTED_SAPILU0;
+	if(opts.prectype != BLASTED_SGS && !isilu)
+		return;
+
+	if(opts.compressed_colind)
+		throw std::invalid_argument("Compressed column indices are not available with single-precision factors!");
+	if(opts.tile_cache_bytes > 0)
+		throw std::invalid_argument("Sweep tiling is not available with single-precision factors!");
+
+	if(isilu) {
+		if(opts.build_tol > 0)
+			throw std::invalid_argument("Adaptive build sweeps are not available with single-precision factors!");
+		if(opts.syncfree_factor)
+			throw std::invalid_argument("Sync-free factorization is not available with single-precision factors!");
+		if(opts.apply_type != APPLY_ASYNC)
+			throw std::invalid_argument("Only asynchronous application is available with single-precision factors!");
+		if(opts.refactor_row_tol >= 0)
+			throw std::invalid_argument("Incremental refactorization is not available with single-precision factors!");
+	}
+}
+
+/// Throws if an option that the SELL-C-sigma operators do not support is requested along with them
+static void check_sell_options(const AsyncSolverSettings& opts)
+{
+	if(opts.float_factors)
+		throw std::invalid_argument("Single-precision factors are not available with SELL storage!");
+	if(opts.compressed_colind)
+		throw std::invalid_argument("Compressed column indices are not available with SELL storage!");
+	if(opts.tile_cache_bytes > 0)
+		throw std::invalid_argument("Sweep tiling is not available with SELL storage!");
+	if(opts.numa_domains > 1)
+		throw std::invalid_argument("NUMA-aware placement is not available with SELL storage!");
+}
+
 /// Creates the correct preconditioner or relaxation from the arguments for the template
 /** Note that if a relaxation is requested for an algorithm got which relaxation is not implemented,
  * the corresponding preconditioner is returned instead after printing a warning.
@@ -70,6 +134,22 @@ SRFactory<scalar,index>
 ::create_srpreconditioner_of_type(SRMatrixStorage<const scalar,const index>&& mat,
                                   const AsyncSolverSettings& opts) const
 {
+	if(opts.float_factors && !opts.relax)
+	{
+		check_float_factor_options(opts);
+		if(opts.prectype == BLASTED_JACOBI)
+			return new MixedPrecBJacobiPreconditioner<scalar,float,index,bs,stor>(std::move(mat));
+		else if(opts.prectype == BLASTED_SGS)
+			return new MixedPrecAsyncBlockSGSPreconditioner<scalar,float,index,bs,stor>
+				(std::move(mat), opts.napplysweeps, opts.apply_inittype, opts.thread_chunk_size,
+				 opts.float_matrix);
+		else if(opts.prectype == BLASTED_ILU0 || opts.prectype == BLASTED_SAPILU0)
+			return new MixedPrecAsyncBlockILU0Preconditioner<scalar,float,index,bs,stor>
+				(std::move(mat), opts.nbuildsweeps, opts.napplysweeps, opts.scale,
+				 opts.thread_chunk_size, opts.fact_inittype, opts.apply_inittype, true,
+				 opts.prectype == BLASTED_ILU0, opts.compute_precinfo);
+	}
+
 	if(opts.prectype == BLASTED_JACOBI) {
 		return new BJacobiSRPreconditioner<scalar,index,bs,stor>(std::move(mat));
 	}
@@ -78,28 +158,83 @@ SRFactory<scalar,index>
 		                                                        opts.thread_chunk_size);
 	}
 	else if(opts.prectype == BLASTED_SGS) {
-		return new AsyncBlockSGS_SRPreconditioner<scalar,index,bs,stor>
-			(std::move(mat), opts.napplysweeps, opts.apply_inittype, opts.thread_chunk_size);
-	}
-	else if(opts.prectype == BLASTED_ILU0) {
-		return new AsyncBlockILU0_SRPreconditioner<scalar,index,bs,stor>
-			(std::move(mat), opts.nbuildsweeps, opts.napplysweeps, opts.scale, opts.thread_chunk_size,
-			 opts.fact_inittype, opts.apply_inittype, true, true, opts.compute_precinfo);
+		AsyncBlockSGS_SRPreconditioner<scalar,index,bs,stor> *const p
+			= new AsyncBlockSGS_SRPreconditioner<scalar,index,bs,stor>
+			(std::move(mat), opts.napplysweeps, opts.apply_inittype, opts.thread_chunk_size,
+			 opts.compressed_colind);
+		p->setSweepTiling(opts.tile_cache_bytes, opts.tile_inner_sweeps);
+		return p;
 	}
-	else if(opts.prectype == BLASTED_SAPILU0) {
-		return new AsyncBlockILU0_SRPreconditioner<scalar,index,bs,stor>
+	else if(opts.prectype == BLASTED_ILU0 || opts.prectype == BLASTED_SAPILU0) {
+		AsyncBlockILU0_SRPreconditioner<scalar,index,bs,stor> *const p
+			= new AsyncBlockILU0_SRPreconditioner<scalar,index,bs,stor>
 			(std::move(mat), opts.nbuildsweeps, opts.napplysweeps, opts.scale, opts.thread_chunk_size,
-			 opts.fact_inittype, opts.apply_inittype, true, false, opts.compute_precinfo);
+			 opts.fact_inittype, opts.apply_inittype, true, opts.prectype == BLASTED_ILU0,
+			 opts.compute_precinfo, opts.compressed_colind);
+		p->setBuildTolerance(opts.build_tol);
+		p->setIncrementalRefactorization(opts.refactor_row_tol, opts.refactor_dep_levels);
+		p->setSyncFreeFactorization(opts.syncfree_factor);
+		p->setApplyType(opts.apply_type);
+		p->setSweepTiling(opts.tile_cache_bytes, opts.tile_inner_sweeps);
+		return p;
 	}
 	else if(opts.prectype == BLASTED_LEVEL_SGS) {
 		return new Level_BSGS<scalar,index,bs,stor>(std::move(mat));
 	}
+	else if(opts.prectype == BLASTED_MC_SGS) {
+		return new Multicolor_BSGS<scalar,index,bs,stor>(std::move(mat), opts.color_distance,
+		                                                 opts.balanced_colors);
+	}
+	else if(opts.prectype == BLASTED_MC_ILU0) {
+		return new Multicolor_BILU0<scalar,index,bs,stor>(std::move(mat), opts.color_distance,
+		                                                  opts.balanced_colors);
+	}
+	else if(opts.prectype == BLASTED_SAI) {
+		return new LeftSAIPreconditioner<scalar,index,bs,stor>(std::move(mat), !opts.incomplete_sai,
+		                                                       opts.thread_chunk_size);
+	}
+	else if(opts.prectype == BLASTED_SGS_SAI) {
+		return new BSGS_SAI<scalar,index,bs,stor>(std::move(mat), !opts.incomplete_sai,
+		                                          opts.thread_chunk_size);
+	}
+	else if(opts.prectype == BLASTED_CHEBYSHEV) {
+		return new ChebyshevSRPreconditioner<scalar,index,bs,stor>(std::move(mat), opts.napplysweeps,
+		                                                           opts.cheb_eig_iters,
+		                                                           opts.cheb_eig_ratio);
+	}
 	else if(opts.prectype == BLASTED_ASYNC_LEVEL_ILU0) {
-		return new Async_Level_BlockILU0<scalar,index,bs,stor>(std::move(mat),opts.nbuildsweeps,
-		                                                       opts.scale,
-		                                                       opts.thread_chunk_size,
-		                                                       opts.fact_inittype, true,
-		                                                       opts.compute_precinfo);
+		Async_Level_BlockILU0<scalar,index,bs,stor> *const p
+			= new Async_Level_BlockILU0<scalar,index,bs,stor>(std::move(mat),opts.nbuildsweeps,
+			                                                  opts.scale,
+			                                                  opts.thread_chunk_size,
+			                                                  opts.fact_inittype, true,
+			                                                  opts.compute_precinfo);
+		p->setBuildTolerance(opts.build_tol);
+		return p;
+	}
+	else if(opts.prectype == BLASTED_ILUK) {
+		LevelOfFillILU<scalar,index,bs,AsyncBlockILU0_SRPreconditioner<scalar,index,bs,stor>> *const p
+			= new LevelOfFillILU<scalar,index,bs,AsyncBlockILU0_SRPreconditioner<scalar,index,bs,stor>>
+			(std::move(mat), opts.fill_level, opts.nbuildsweeps, opts.napplysweeps, opts.scale,
+			 opts.thread_chunk_size, opts.fact_inittype, opts.apply_inittype, true, true,
+			 opts.compute_precinfo, opts.compressed_colind);
+		p->setBuildTolerance(opts.build_tol);
+		p->setIncrementalRefactorization(opts.refactor_row_tol, opts.refactor_dep_levels);
+		p->setSyncFreeFactorization(opts.syncfree_factor);
+		p->setApplyType(opts.apply_type);
+		p->setSweepTiling(opts.tile_cache_bytes, opts.tile_inner_sweeps);
+		return p;
+	}
+	else if(opts.prectype == BLASTED_ASYNC_LEVEL_ILUK) {
+		LevelOfFillILU<scalar,index,bs,Async_Level_BlockILU0<scalar,index,bs,stor>> *const p
+			= new LevelOfFillILU<scalar,index,bs,Async_Level_BlockILU0<scalar,index,bs,stor>>
+			(std::move(mat), opts.fill_level, opts.nbuildsweeps, opts.scale, opts.thread_chunk_size,
+			 opts.fact_inittype, true, opts.compute_precinfo);
+		p->setBuildTolerance(opts.build_tol);
+		return p;
+	}
+	else if(opts.prectype == BLASTED_PARILUT) {
+		throw std::invalid_argument("ParILUT is only available for scalar matrices!");
 	}
 	else if(opts.prectype == BLASTED_NO_PREC) {
 		return new NoPreconditioner<scalar,index>(std::move(mat), bs);
@@ -108,6 +243,26 @@ SRFactory<scalar,index>
 		throw std::invalid_argument("Invalid preconditioner!");
 }
 
+template <typename scalar, typename index>
+template <int C>
+SRPreconditioner<scalar,index>*
+SRFactory<scalar,index>
+::create_sell_preconditioner(SRMatrixStorage<const scalar,const index>&& mat,
+                             const AsyncSolverSettings& opts) const
+{
+	check_sell_options(opts);
+	if(opts.prectype == BLASTED_JACOBI) {
+		return new SELLJacobiPreconditioner<scalar,index,C>(std::move(mat), opts.sell_sort_scope);
+	}
+	else if(opts.prectype == BLASTED_SGS) {
+		return new AsyncSGS_SELLPreconditioner<scalar,index,C>
+			(std::move(mat), opts.napplysweeps, opts.apply_inittype, opts.thread_chunk_size,
+			 opts.sell_sort_scope, opts.relax);
+	}
+	else
+		throw std::invalid_argument("SELL storage is not available for this preconditioner!");
+}
+
 /** Right now, this factory fails if mat actually owns its storage because it gets destroyed at the
  * end of this function. But, eventually it'll be moved to the preconditioners' SRMatrixStorages and
  * it should be fine.
@@ -121,7 +276,46 @@ SRFactory<scalar,index>::create_preconditioner(SRMatrixStorage<const scalar, con
 
 	const AsyncSolverSettings& opts = dynamic_cast<const AsyncSolverSettings&>(set);
 
-	if(opts.bs == 1) {
+	if(opts.reordering != NATURAL_ORDERING) {
+		// the wrapped operator is created, with all other settings, for the reordered matrix
+		AsyncSolverSettings inneropts = opts;
+		inneropts.reordering = NATURAL_ORDERING;
+		return new ReorderedPreconditioner<scalar,index>
+			(std::move(mat), opts.bs, opts.reordering,
+			 [this,&inneropts](SRMatrixStorage<const scalar,const index>&& rmat) {
+				 return create_preconditioner(std::move(rmat), inneropts); });
+	}
+
+	if(opts.bs == 1 && (opts.sell_chunk_height == 4 || opts.sell_chunk_height == 8)
+	   && (opts.prectype == BLASTED_JACOBI || opts.prectype == BLASTED_SGS))
+	{
+		if(opts.sell_chunk_height == 4)
+			p = create_sell_preconditioner<4>(std::move(mat), opts);
+		else
+			p = create_sell_preconditioner<8>(std::move(mat), opts);
+	}
+	else if(opts.bs == 1 && opts.float_factors && !opts.relax
+	        && (opts.prectype == BLASTED_JACOBI || opts.prectype == BLASTED_SGS
+	            || opts.prectype == BLASTED_ILU0 || opts.prectype == BLASTED_SAPILU0))
+	{
+		check_float_factor_options(opts);
+		if(opts.prectype == BLASTED_JACOBI)
+			p = new MixedPrecJacobiPreconditioner<scalar,float,index>(std::move(mat));
+		else if(opts.prectype == BLASTED_SGS)
+			p = new MixedPrecAsyncSGSPreconditioner<scalar,float,index>
+				(std::move(mat), opts.napplysweeps, opts.apply_inittype, opts.thread_chunk_size,
+				 opts.float_matrix);
+		else
+			p = new MixedPrecAsyncILU0Preconditioner<scalar,float,index>
+				(std::move(mat), opts.nbuildsweeps, opts.napplysweeps,
+				 opts.scale, opts.thread_chunk_size,
+				 opts.fact_inittype, opts.apply_inittype, opts.compute_precinfo, true,
+				 opts.prectype == BLASTED_ILU0);
+	}
+	else if(opts.bs == 1) {
+		if(opts.refactor_row_tol >= 0)
+			throw std::invalid_argument("Incremental refactorization is only available for block ILU(0)!");
+
 		if(opts.prectype == BLASTED_JACOBI) {
 			p = new JacobiSRPreconditioner<scalar,index>(std::move(mat));
 		}
@@ -134,28 +328,87 @@ SRFactory<scalar,index>::create_preconditioner(SRMatrixStorage<const scalar, con
 			                                             opts.thread_chunk_size);
 		}
 		else if(opts.prectype == BLASTED_SGS) {
-			p = new AsyncSGS_SRPreconditioner<scalar,index>
-				(std::move(mat), opts.napplysweeps, opts.apply_inittype, opts.thread_chunk_size);
+			AsyncSGS_SRPreconditioner<scalar,index> *const sgs
+				= new AsyncSGS_SRPreconditioner<scalar,index>
+				(std::move(mat), opts.napplysweeps, opts.apply_inittype, opts.thread_chunk_size,
+				 opts.compressed_colind);
+			sgs->setSweepTiling(opts.tile_cache_bytes, opts.tile_inner_sweeps);
+			p = sgs;
 		}
 		else if(opts.prectype == BLASTED_LEVEL_SGS) {
 			p = new Level_SGS<scalar,index>(std::move(mat));
 		}
-		else if(opts.prectype == BLASTED_ILU0) {
-			p = new AsyncILU0_SRPreconditioner<scalar,index>
-				(std::move(mat), opts.nbuildsweeps, opts.napplysweeps,
-				 opts.scale, opts.thread_chunk_size,
-				 opts.fact_inittype, opts.apply_inittype, opts.compute_precinfo, true,true);
+		else if(opts.prectype == BLASTED_MC_SGS) {
+			p = new Multicolor_SGS<scalar,index>(std::move(mat), opts.color_distance,
+			                                     opts.balanced_colors);
+		}
+		else if(opts.prectype == BLASTED_MC_ILU0) {
+			p = new Multicolor_ILU0<scalar,index>(std::move(mat), opts.color_distance,
+			                                      opts.balanced_colors);
+		}
+		else if(opts.prectype == BLASTED_SAI) {
+			p = new LeftSAIPreconditioner<scalar,index,1,ColMajor>(std::move(mat), !opts.incomplete_sai,
+			                                                       opts.thread_chunk_size);
 		}
-		else if(opts.prectype == BLASTED_SAPILU0) {
-			p = new AsyncILU0_SRPreconditioner<scalar,index>
+		else if(opts.prectype == BLASTED_SGS_SAI) {
+			p = new BSGS_SAI<scalar,index,1,ColMajor>(std::move(mat), !opts.incomplete_sai,
+			                                          opts.thread_chunk_size);
+		}
+		else if(opts.prectype == BLASTED_CHEBYSHEV) {
+			p = new ChebyshevSRPreconditioner<scalar,index,1,ColMajor>(std::move(mat), opts.napplysweeps,
+			                                                           opts.cheb_eig_iters,
+			                                                           opts.cheb_eig_ratio);
+		}
+		else if(opts.prectype == BLASTED_ILU0 || opts.prectype == BLASTED_SAPILU0) {
+			AsyncILU0_SRPreconditioner<scalar,index> *const ilu
+				= new AsyncILU0_SRPreconditioner<scalar,index>
 				(std::move(mat), opts.nbuildsweeps, opts.napplysweeps,
 				 opts.scale, opts.thread_chunk_size,
-				 opts.fact_inittype, opts.apply_inittype, opts.compute_precinfo, true,false);
+				 opts.fact_inittype, opts.apply_inittype, opts.compute_precinfo, true,
+				 opts.prectype == BLASTED_ILU0, opts.compressed_colind);
+			ilu->setBuildTolerance(opts.build_tol);
+			ilu->setSyncFreeFactorization(opts.syncfree_factor);
+			ilu->setApplyType(opts.apply_type);
+			ilu->setSweepTiling(opts.tile_cache_bytes, opts.tile_inner_sweeps);
+			p = ilu;
 		}
 		else if(opts.prectype == BLASTED_ASYNC_LEVEL_ILU0) {
-			p = new Async_Level_ILU0<scalar,index>(std::move(mat), opts.nbuildsweeps, opts.scale,
-			                                       opts.thread_chunk_size, opts.fact_inittype, true,
-			                                       opts.compute_precinfo);
+			Async_Level_ILU0<scalar,index> *const ilu
+				= new Async_Level_ILU0<scalar,index>(std::move(mat), opts.nbuildsweeps, opts.scale,
+				                                     opts.thread_chunk_size, opts.fact_inittype, true,
+				                                     opts.compute_precinfo);
+			ilu->setBuildTolerance(opts.build_tol);
+			p = ilu;
+		}
+		else if(opts.prectype == BLASTED_ILUK) {
+			LevelOfFillILU<scalar,index,1,AsyncILU0_SRPreconditioner<scalar,index>> *const ilu
+				= new LevelOfFillILU<scalar,index,1,AsyncILU0_SRPreconditioner<scalar,index>>
+				(std::move(mat), opts.fill_level, opts.nbuildsweeps, opts.napplysweeps,
+				 opts.scale, opts.thread_chunk_size,
+				 opts.fact_inittype, opts.apply_inittype, opts.compute_precinfo, true, true,
+				 opts.compressed_colind);
+			ilu->setBuildTolerance(opts.build_tol);
+			ilu->setSyncFreeFactorization(opts.syncfree_factor);
+			ilu->setApplyType(opts.apply_type);
+			ilu->setSweepTiling(opts.tile_cache_bytes, opts.tile_inner_sweeps);
+			p = ilu;
+		}
+		else if(opts.prectype == BLASTED_ASYNC_LEVEL_ILUK) {
+			LevelOfFillILU<scalar,index,1,Async_Level_ILU0<scalar,index>> *const ilu
+				= new LevelOfFillILU<scalar,index,1,Async_Level_ILU0<scalar,index>>
+				(std::move(mat), opts.fill_level, opts.nbuildsweeps, opts.scale,
+				 opts.thread_chunk_size, opts.fact_inittype, true, opts.compute_precinfo);
+			ilu->setBuildTolerance(opts.build_tol);
+			p = ilu;
+		}
+		else if(opts.prectype == BLASTED_PARILUT) {
+			AsyncILUT_SRPreconditioner<scalar,index> *const ilu
+				= new AsyncILUT_SRPreconditioner<scalar,index>
+				(std::move(mat), opts.nbuildsweeps, opts.napplysweeps, opts.scale,
+				 opts.thread_chunk_size, opts.fact_inittype, opts.apply_inittype,
+				 opts.ilut_fill_factor, opts.compute_precinfo);
+			ilu->setApplyType(opts.apply_type);
+			p = ilu;
 		}
 		else if(opts.prectype == BLASTED_NO_PREC) {
 			p = new NoPreconditioner<scalar,index>(std::move(mat), 1);
@@ -200,6 +453,9 @@ SRFactory<scalar,index>::create_preconditioner(SRMatrixStorage<const scalar, con
 		throw std::invalid_argument("Block ordering must be either rowmajor or colmajor!");
 	}
 
+	if(opts.numa_domains > 1)
+		p->setNUMADomains(opts.numa_domains, opts.thread_chunk_size);
+
 	return p;
 }
 
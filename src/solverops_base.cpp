@@ -3,10 +3,15 @@
  * \author Aditya Kashi
  */
 
+#include <new>
+#include <boost/align/aligned_alloc.hpp>
 #include "solverops_base.hpp"
 
 namespace blasted {
 
+using boost::alignment::aligned_alloc;
+using boost::alignment::aligned_free;
+
 template <typename scalar, typename index>
 Preconditioner<scalar,index>::Preconditioner(const StorageType stype)
 	: AbstractLinearOperator<scalar,index>(stype)
@@ -16,6 +21,39 @@ template <typename scalar, typename index>
 Preconditioner<scalar,index>::~Preconditioner()
 { }
 
+template <typename scalar, typename index>
+void Preconditioner<scalar,index>::apply_multi(const int nvecs, const scalar *const x,
+                                               scalar *const __restrict y) const
+{
+	const index n = dim();
+	scalar *const xcol = (scalar*)aligned_alloc(CACHE_LINE_LEN, n*sizeof(scalar));
+	scalar *const ycol = (scalar*)aligned_alloc(CACHE_LINE_LEN, n*sizeof(scalar));
+	if(!xcol || !ycol) {
+		aligned_free(xcol);
+		aligned_free(ycol);
+		throw std::bad_alloc();
+	}
+
+	for(int v = 0; v < nvecs; v++)
+	{
+		// the output is copied in too, as some operators use it as the initial guess
+#pragma omp parallel for simd default(shared)
+		for(index i = 0; i < n; i++) {
+			xcol[i] = x[i*nvecs+v];
+			ycol[i] = y[i*nvecs+v];
+		}
+
+		apply(xcol, ycol);
+
+#pragma omp parallel for simd default(shared)
+		for(index i = 0; i < n; i++)
+			y[i*nvecs+v] = ycol[i];
+	}
+
+	aligned_free(xcol);
+	aligned_free(ycol);
+}
+
 template <typename scalar, typename index>
 SRPreconditioner<scalar,index>::SRPreconditioner(SRMatrixStorage<const scalar, const index>&& matrix)
 	: Preconditioner<scalar,index>(SPARSEROW), pmat(std::move(matrix)),
@@ -37,6 +75,15 @@ void NoPreconditioner<scalar,index>::apply(const scalar *const x, scalar *const
 		y[i] = x[i];
 }
 
+template <typename scalar, typename index>
+void NoPreconditioner<scalar,index>::apply_multi(const int nvecs, const scalar *const x,
+                                                 scalar *const __restrict y) const
+{
+#pragma omp parallel for simd default(shared)
+	for(index i = 0; i < ndim*nvecs; i++)
+		y[i] = x[i];
+}
+
 template <typename scalar, typename index>
 void NoPreconditioner<scalar,index>::apply_relax(const scalar *const x, scalar *const __restrict y) const
 {
@@ -0,0 +1,203 @@
+/** \file
+ * \brief Implementation of Chebyshev polynomial preconditioning and relaxation
+ * \author Aditya Kashi
+ *
+ * This file is part of BLASTed.
+ *   BLASTed is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   BLASTed is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with BLASTed.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cmath>
+#include <new>
+#include <stdexcept>
+#include <boost/align/aligned_alloc.hpp>
+#include "blas/matvecs.hpp"
+#include "solverops_chebyshev.hpp"
+
+namespace blasted {
+
+using boost::alignment::aligned_alloc;
+using boost::alignment::aligned_free;
+
+/// Returns the 2-norm of a vector
+template <typename scalar, typename index>
+static scalar vector_norm(const index n, const scalar *const v)
+{
+	scalar norm = 0;
+#pragma omp parallel for simd default(shared) reduction(+:norm)
+	for(index i = 0; i < n; i++)
+		norm += v[i]*v[i];
+	return std::sqrt(norm);
+}
+
+/// Returns a sparse-row view of a matrix, for the BLAS-2 operations
+template <typename scalar, typename index>
+static SRMatrixStorage<const scalar,const index> matrix_view(const CRawBSRMatrix<scalar,index>& mat,
+                                                             const int bs)
+{
+	return SRMatrixStorage<const scalar,const index>(mat.browptr, mat.bcolind, mat.vals, mat.diagind,
+	                                                 mat.browendptr, mat.nbrows, mat.nnzb,
+	                                                 mat.nbstored, bs);
+}
+
+template <typename scalar, typename index, int bs, StorageOptions stor>
+ChebyshevSRPreconditioner<scalar,index,bs,stor>
+::ChebyshevSRPreconditioner(SRMatrixStorage<const scalar, const index>&& matrix, const int degree,
+                            const int eig_iters, const scalar eig_ratio)
+	: Jacobi(std::move(matrix)), chebdegree{degree}, eigiters{eig_iters}, eigratio{eig_ratio},
+	  lmin{0}, lmax{0}, work{nullptr}
+{
+	if(degree < 1 || eig_iters < 1)
+		throw std::invalid_argument("Chebyshev: degree and eigenvalue iterations must be positive!");
+	if(!(eig_ratio > 0 && eig_ratio < 1))
+		throw std::invalid_argument("Chebyshev: eigenvalue ratio must be between 0 and 1!");
+}
+
+template <typename scalar, typename index, int bs, StorageOptions stor>
+ChebyshevSRPreconditioner<scalar,index,bs,stor>::~ChebyshevSRPreconditioner()
+{
+	aligned_free(work);
+}
+
+/** The power iterations start from a fixed vector, so that the estimate is repeatable. The largest
+ * eigenvalue of D^{-1} A is usually estimated from below by them, so the upper bound of the
+ * interval is the estimate increased by 10%.
+ */
+template <typename scalar, typename index, int bs, StorageOptions stor>
+PrecInfo ChebyshevSRPreconditioner<scalar,index,bs,stor>::compute()
+{
+	using SpMV = typename BLAS_SR<const scalar,const index,bs,stor>::type;
+
+	const PrecInfo pinfo = Jacobi::compute();
+
+	const index n = mat.nbrows*bs;
+	if(!work) {
+		work = (scalar*)aligned_alloc(CACHE_LINE_LEN, 3*n*sizeof(scalar));
+		if(!work)
+			throw std::bad_alloc();
+	}
+
+	scalar *const v = work, *const av = work + n, *const dav = work + 2*n;
+
+#pragma omp parallel for simd default(shared)
+	for(index i = 0; i < n; i++)
+		v[i] = 1 + (i % 7);
+
+	scalar vnorm = vector_norm(n, v);
+	scalar lambda = 0;
+	for(int it = 0; it < eigiters; it++)
+	{
+		SpMV::matrix_apply(matrix_view(mat, bs), v, av);
+		Jacobi::apply(av, dav);
+
+		const scalar norm = vector_norm(n, dav);
+		lambda = norm/vnorm;
+
+#pragma omp parallel for simd default(shared)
+		for(index i = 0; i < n; i++)
+			v[i] = dav[i]/norm;
+		vnorm = 1;
+	}
+
+	lmax = 1.1*lambda;
+	lmin = eigratio*lmax;
+	return pinfo;
+}
+
+/** This is the preconditioned Chebyshev iteration of Saad, "Iterative methods for sparse linear
+ * systems", 2nd ed., algorithm 12.1, with D as the preconditioner. The residual is recomputed from
+ * the current iterate at every step by a fused matrix-vector product.
+ */
+template <typename scalar, typename index, int bs, StorageOptions stor>
+void ChebyshevSRPreconditioner<scalar,index,bs,stor>::iterate(const scalar *const b,
+                                                             scalar *const __restrict x,
+                                                             const int nsteps, const bool zeroguess,
+                                                             const bool ctol) const
+{
+	using SpMV = typename BLAS_SR<const scalar,const index,bs,stor>::type;
+
+	const index n = mat.nbrows*bs;
+	scalar *const res = work, *const sres = work + n, *const d = work + 2*n;
+
+	const scalar theta = (lmax + lmin)/2, delta = (lmax - lmin)/2;
+	const scalar sigma = theta/delta;
+	scalar rho = 1/sigma;
+	scalar refdiffnorm = 1;
+
+	for(int step = 0; step < nsteps; step++)
+	{
+		if(step == 0 && zeroguess)
+			Jacobi::apply(b, sres);
+		else {
+			SpMV::gemv3(matrix_view(mat, bs), scalar(-1), x, scalar(1), b, res);
+			Jacobi::apply(res, sres);
+		}
+
+		if(step == 0)
+		{
+#pragma omp parallel for simd default(shared)
+			for(index i = 0; i < n; i++) {
+				d[i] = sres[i]/theta;
+				x[i] = zeroguess ? d[i] : x[i] + d[i];
+			}
+		}
+		else
+		{
+			const scalar rhonew = 1/(2*sigma - rho);
+			const scalar dcoeff = rhonew*rho, rcoeff = 2*rhonew/delta;
+#pragma omp parallel for simd default(shared)
+			for(index i = 0; i < n; i++) {
+				d[i] = dcoeff*d[i] + rcoeff*sres[i];
+				x[i] += d[i];
+			}
+			rho = rhonew;
+		}
+
+		if(ctol)
+		{
+			const scalar diffnorm = vector_norm(n, d);
+			if(step == 0)
+				refdiffnorm = diffnorm;
+
+			if(diffnorm < solveparams.atol || diffnorm/refdiffnorm < solveparams.rtol ||
+			   diffnorm/refdiffnorm > solveparams.dtol)
+				break;
+		}
+	}
+}
+
+template <typename scalar, typename index, int bs, StorageOptions stor>
+void ChebyshevSRPreconditioner<scalar,index,bs,stor>::apply(const scalar *const r,
+                                                           scalar *const __restrict z) const
+{
+	iterate(r, z, chebdegree, true, false);
+}
+
+template <typename scalar, typename index, int bs, StorageOptions stor>
+void ChebyshevSRPreconditioner<scalar,index,bs,stor>::apply_relax(const scalar *const b,
+                                                                 scalar *const __restrict x) const
+{
+	iterate(b, x, solveparams.maxits, false, solveparams.ctol);
+}
+
+template class ChebyshevSRPreconditioner<double,int,1,ColMajor>;
+template class ChebyshevSRPreconditioner<double,int,4,ColMajor>;
+template class ChebyshevSRPreconditioner<double,int,5,ColMajor>;
+template class ChebyshevSRPreconditioner<double,int,4,RowMajor>;
+
+#ifdef BUILD_BLOCK_SIZE
+template class ChebyshevSRPreconditioner<double,int,BUILD_BLOCK_SIZE,ColMajor>;
+template class ChebyshevSRPreconditioner<double,int,BUILD_BLOCK_SIZE,RowMajor>;
+#endif
+
+}
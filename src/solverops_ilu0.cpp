@@ -5,11 +5,15 @@
 
 #include <type_traits>
 #include <iostream>
+#include <chrono>
 #include <boost/align/aligned_alloc.hpp>
 #include "solverops_ilu0.hpp"
+#include "async_sweeps.hpp"
 #include "kernels/kernels_ilu_apply.hpp"
 #include "async_ilu_factor.hpp"
+#include "async_ilut_factor.hpp"
 #include "async_blockilu_factor.hpp"
+#include "ilu_isai.hpp"
 
 namespace blasted {
 
@@ -21,11 +25,13 @@ AsyncBlockILU0_SRPreconditioner<scalar,index,bs,stor>
 ::AsyncBlockILU0_SRPreconditioner(SRMatrixStorage<const scalar, const index>&& matrix,
                                   const int nbuildswp, const int napplyswp, const bool uscl,
                                   const int tcs, const FactInit finit, const ApplyInit ainit,
-                                  const bool tf, const bool ta, const bool comp_rem)
+                                  const bool tf, const bool ta, const bool comp_rem,
+                                  const bool compressed_colind)
 	: SRPreconditioner<scalar,index>(std::move(matrix)), iluvals{nullptr}, scale{nullptr}, ytemp{nullptr},
 	  usescaling{uscl}, threadedfactor{tf}, threadedapply{ta},
 	  nbuildsweeps{nbuildswp}, napplysweeps{napplyswp}, thread_chunk_size{tcs},
-	  factinittype{finit}, applyinittype{ainit}, compute_remainder{comp_rem}
+	  factinittype{finit}, applyinittype{ainit}, compute_remainder{comp_rem},
+	  usecompressedind{compressed_colind}
 {
 }
 
@@ -34,13 +40,73 @@ AsyncBlockILU0_SRPreconditioner<scalar,index,bs,stor>::~AsyncBlockILU0_SRPrecond
 {
 	aligned_free(iluvals);
 	aligned_free(ytemp);
+	aligned_free(ymulti);
 	aligned_free(scale);
+	aligned_free(snapshot);
+	aligned_free(pivinvs);
+}
+
+/// Applies the block-ILU0 factorization by exact synchronization-free triangular solves
+/** Each block-row of the forward (backward) substitution is carried out as soon as the rows in the
+ * columns of its lower (upper) triangular part are done. The only barrier is between the two
+ * solves. The arguments are as for \ref block_ilu0_apply.
+ */
+template <typename scalar, typename index, int bs, StorageOptions stor>
+static void block_ilu0_apply_syncfree(const CRawBSRMatrix<scalar,index> *const mat,
+                                      const CRawCompressedColumnIndex<index> *const cind,
+                                      const SyncFreeSchedule<index>& sched,
+                                      const Block_t<scalar,bs,stor> *const ilu,
+                                      const scalar *const scale,
+                                      Segment_t<scalar,bs> *const __restrict y,
+                                      const bool usethreads,
+                                      const scalar *const rr, scalar *const __restrict zz)
+{
+	using Seg = Segment_t<scalar,bs>;
+	Seg *z = reinterpret_cast<Seg*>(zz);
+
+#pragma omp parallel default(shared) if(usethreads)
+	{
+		// z := Sr
+#pragma omp for simd schedule(static)
+		for(index i = 0; i < mat->nbrows*bs; i++)
+			zz[i] = scale ? scale[i]*rr[i] : rr[i];
+
+		if(cind)
+			sched.forward(*mat, [&](const index i) {
+				block_unit_lower_triangular_ci<scalar,index,bs,stor>
+					(ilu, *cind, mat->browptr[i], mat->diagind[i], z[i], i, y);
+			});
+		else
+			sched.forward(*mat, [&](const index i) {
+				block_unit_lower_triangular<scalar,index,bs,stor>
+					(ilu, mat->bcolind, mat->browptr[i], mat->diagind[i], z[i], i, y);
+			});
+
+		if(cind)
+			sched.backward(*mat, [&](const index i) {
+				block_upper_triangular_ci<scalar,index,bs,stor>
+					(ilu, *cind, mat->diagind[i], mat->browptr[i+1], y[i], i, z);
+			});
+		else
+			sched.backward(*mat, [&](const index i) {
+				block_upper_triangular<scalar,index,bs,stor>
+					(ilu, mat->bcolind, mat->diagind[i], mat->browptr[i+1], y[i], i, z);
+			});
+
+		if(scale)
+#pragma omp for simd schedule(static)
+			for(index i = 0; i < mat->nbrows*bs; i++)
+				zz[i] = zz[i]*scale[i];
+	}
 }
 
 /// Applies the block-ILU0 factorization using a block variant of the asynch triangular solve in
 /// \cite async:anzt_triangular
 /**
  * \param[in] mat The BSR matrix
+ * \param[in] cind Compressed column indices of mat to use instead of its block-column indices;
+ *   may be null
+ * \param[in] sched Schedule of the sweeps by NUMA domain, or null for the usual dynamic schedule
  * \param[in] iluvals The ILU factorization non-zeros, accessed using the block-row pointers, 
  *   block-column indices and diagonal pointers of the original BSR matrix
  * \param ytemp A pre-allocated temporary vector, needed for applying the ILU0 factors
@@ -51,14 +117,19 @@ AsyncBlockILU0_SRPreconditioner<scalar,index,bs,stor>::~AsyncBlockILU0_SRPrecond
  * \param[in] init_type Type of initialization
  * \param[in] r The RHS vector of the preconditioning problem Mz = r
  * \param[in,out] z The solution vector of the preconditioning problem Mz = r
+ * \param[in] syncfree If not null, exact synchronization-free triangular solves are carried out
+ *   instead of the asynchronous sweeps \sa block_ilu0_apply_syncfree
  */
 template <typename scalar, typename index, int bs, StorageOptions stor>
 void block_ilu0_apply(const CRawBSRMatrix<scalar,index> *const mat,
+                      const CRawCompressedColumnIndex<index> *const cind,
+                      const DomainSchedule<index> *const sched,
                       const scalar *const iluvals, const scalar *const scale,
                       scalar *const __restrict y_temp,
                       const int napplysweeps, const int thread_chunk_size, const bool usethreads,
                       const ApplyInit init_type,
-                      const scalar *const rr, scalar *const __restrict zz)
+                      const scalar *const rr, scalar *const __restrict zz,
+                      const SyncFreeSchedule<index> *const syncfree = nullptr)
 {
 	using Blk = Block_t<scalar,bs,stor>;
 	using Seg = Segment_t<scalar,bs>;
@@ -68,83 +139,161 @@ void block_ilu0_apply(const CRawBSRMatrix<scalar,index> *const mat,
 	Seg *z = reinterpret_cast<Seg*>(zz);
 	Seg *y = reinterpret_cast<Seg*>(y_temp);
 
-	if(scale)
+	if(syncfree) {
+		block_ilu0_apply_syncfree<scalar,index,bs,stor>(mat, cind, *syncfree, ilu, scale, y,
+		                                                usethreads, rr, zz);
+		return;
+	}
+
+	if(init_type != INIT_A_JACOBI && init_type != INIT_A_ZERO)
+		throw std::runtime_error(" block_ilu0_apply: Invalid init type!");
+
+	const AsyncSweepEngine<index> eng(mat->nbrows, thread_chunk_size, sched);
+	eng.run(usethreads, [&]() {
 		// initially, z := Sr
-#pragma omp parallel for simd default(shared)
-		for(index i = 0; i < mat->nbrows*bs; i++) {
-			zz[i] = scale[i]*rr[i];
-		}
-	else
-#pragma omp parallel for simd default(shared)
-		for(index i = 0; i < mat->nbrows*bs; i++) {
-			zz[i] = rr[i];
-		}
+		eng.rows([&](const index start, const index end) {
+			if(scale)
+#pragma omp simd
+				for(index i = start*bs; i < end*bs; i++)
+					zz[i] = scale[i]*rr[i];
+			else
+#pragma omp simd
+				for(index i = start*bs; i < end*bs; i++)
+					zz[i] = rr[i];
+
+#pragma omp simd
+			for(index i = start*bs; i < end*bs; i++)
+				y_temp[i] = 0;
+		});
+
+		/** solves Ly = Sr by asynchronous Jacobi iterations.
+		 * Note that if done serially, this is a forward-substitution.
+		 */
+		eng.sync();
+		if(cind)
+			eng.forward(napplysweeps, [&](const index i) {
+				block_unit_lower_triangular_ci<scalar,index,bs,stor>
+					(ilu, *cind, mat->browptr[i], mat->diagind[i], z[i], i, y);
+			});
+		else
+			eng.forward(napplysweeps, [&](const index i) {
+				block_unit_lower_triangular<scalar,index,bs,stor>
+					(ilu, mat->bcolind, mat->browptr[i], mat->diagind[i], z[i], i, y);
+			});
+
+		eng.sync();
+		eng.rows([&](const index start, const index end) {
+			if(init_type == INIT_A_JACOBI)
+#pragma omp simd
+				for(index i = start*bs; i < end*bs; i++)
+					zz[i] = y_temp[i];
+			else
+#pragma omp simd
+				for(index i = start*bs; i < end*bs; i++)
+					zz[i] = 0;
+		});
+
+		/* Solves Uz = y by asynchronous Jacobi iteration.
+		 * If done serially, this is a back-substitution.
+		 */
+		eng.sync();
+		if(cind)
+			eng.backward(napplysweeps, [&](const index i) {
+				block_upper_triangular_ci<scalar,index,bs,stor>
+					(ilu, *cind, mat->diagind[i], mat->browptr[i+1], y[i], i, z);
+			});
+		else
+			eng.backward(napplysweeps, [&](const index i) {
+				block_upper_triangular<scalar,index,bs,stor>
+					(ilu, mat->bcolind, mat->diagind[i], mat->browptr[i+1], y[i], i, z);
+			});
 
-	switch(init_type) {
-	case INIT_A_JACOBI:
-	case INIT_A_ZERO:
-#pragma omp parallel for simd default(shared)
-		for(index i = 0; i < mat->nbrows*bs; i++)
-		{
-			y_temp[i] = 0;
+		// scale z
+		if(scale) {
+			eng.sync();
+			eng.rows([&](const index start, const index end) {
+#pragma omp simd
+				for(index i = start*bs; i < end*bs; i++)
+					zz[i] = zz[i]*scale[i];
+			});
 		}
-		break;
-	default:
-		;
-	}
+	});
+}
 
-	/** solves Ly = Sr by asynchronous Jacobi iterations.
-	 * Note that if done serially, this is a forward-substitution.
-	 */
-#pragma omp parallel default(shared) if(usethreads)
-	for(int isweep = 0; isweep < napplysweeps; isweep++)
-	{
-#pragma omp for schedule(dynamic, thread_chunk_size) nowait
-		for(index i = 0; i < mat->nbrows; i++)
-		{
-			block_unit_lower_triangular<scalar,index,bs,stor>
-				(ilu, mat->bcolind, mat->browptr[i], mat->diagind[i], z[i], i, y);
-		}
-	}
+/// Applies the block-ILU0 factorization to several row-interleaved vectors at once
+/** The work-flow is the same as that of \ref block_ilu0_apply, except that every block of the
+ * factors that is read is applied to all the vectors.
+ * \param y_temp A pre-allocated temporary multivector
+ * \param nvecs Number of vectors
+ */
+template <typename scalar, typename index, int bs, StorageOptions stor>
+void block_ilu0_apply_multi(const CRawBSRMatrix<scalar,index> *const mat,
+                            const scalar *const iluvals, const scalar *const scale,
+                            scalar *const __restrict y_temp,
+                            const int napplysweeps, const int thread_chunk_size, const bool usethreads,
+                            const ApplyInit init_type, const int nvecs,
+                            const scalar *const rr, scalar *const __restrict zz)
+{
+	using Blk = Block_t<scalar,bs,stor>;
+	const Blk *ilu = reinterpret_cast<const Blk*>(iluvals);
 
-	switch(init_type) {
-	case INIT_A_JACOBI:
-#pragma omp parallel for simd default(shared)
-		for(index i = 0; i < mat->nbrows*bs; i++)
-		{
-			zz[i] = y_temp[i];
-		}
-		break;
-	case INIT_A_ZERO:
-#pragma omp parallel for simd default(shared)
-		for(index i = 0; i < mat->nbrows*bs; i++)
-		{
-			zz[i] = 0;
-		}
-		break;
-	default:
-		throw std::runtime_error(" scalar_ilu0_apply: Invalid init type!");
-	}
+	if(init_type != INIT_A_JACOBI && init_type != INIT_A_ZERO)
+		throw std::runtime_error(" block_ilu0_apply_multi: Invalid init type!");
 
-	/* Solves Uz = y by asynchronous Jacobi iteration.
-	 * If done serially, this is a back-substitution.
-	 */
-#pragma omp parallel default(shared) if(usethreads)
-	for(int isweep = 0; isweep < napplysweeps; isweep++)
-	{
-#pragma omp for schedule(dynamic, thread_chunk_size) nowait
-		for(index i = mat->nbrows-1; i >= 0; i--)
-		{
-			block_upper_triangular<scalar,index,bs,stor>
-				(ilu, mat->bcolind, mat->diagind[i], mat->browptr[i+1], y[i], i, z);
-		}
-	}
+	const AsyncSweepEngine<index> eng(mat->nbrows, thread_chunk_size);
+	eng.run(usethreads, [&]() {
+		// initially, z := Sr
+		eng.rows([&](const index start, const index end) {
+			for(index i = start*bs; i < end*bs; i++)
+			{
+				const scalar sc = scale ? scale[i] : 1;
+#pragma omp simd
+				for(int v = 0; v < nvecs; v++) {
+					zz[i*nvecs+v] = sc*rr[i*nvecs+v];
+					y_temp[i*nvecs+v] = 0;
+				}
+			}
+		});
+
+		// solves Ly = Sr by asynchronous Jacobi iterations
+		eng.sync();
+		eng.forward(napplysweeps, [&](const index i) {
+			block_unit_lower_triangular_multi<scalar,index,bs,stor>
+				(ilu, mat->bcolind, mat->browptr[i], mat->diagind[i], nvecs, zz, i, y_temp);
+		});
+
+		eng.sync();
+		eng.rows([&](const index start, const index end) {
+			if(init_type == INIT_A_JACOBI)
+#pragma omp simd
+				for(index i = start*bs*nvecs; i < end*bs*nvecs; i++)
+					zz[i] = y_temp[i];
+			else
+#pragma omp simd
+				for(index i = start*bs*nvecs; i < end*bs*nvecs; i++)
+					zz[i] = 0;
+		});
+
+		// solves Uz = y by asynchronous Jacobi iteration
+		eng.sync();
+		eng.backward(napplysweeps, [&](const index i) {
+			block_upper_triangular_multi<scalar,index,bs,stor>
+				(ilu, mat->bcolind, mat->diagind[i], mat->browptr[i+1], nvecs, y_temp, i, zz);
+		});
 
-	// scale z
-	if(scale)
-#pragma omp parallel for simd default(shared)
-		for(int i = 0; i < mat->nbrows*bs; i++)
-			zz[i] = zz[i]*scale[i];
+		// scale z
+		if(scale) {
+			eng.sync();
+			eng.rows([&](const index start, const index end) {
+				for(index i = start*bs; i < end*bs; i++)
+				{
+#pragma omp simd
+					for(int v = 0; v < nvecs; v++)
+						zz[i*nvecs+v] *= scale[i];
+				}
+			});
+		}
+	});
 }
 
 template <typename scalar, typename index, int bs, StorageOptions stor>
@@ -157,26 +306,36 @@ void AsyncBlockILU0_SRPreconditioner<scalar,index,bs,stor>::setup_storage()
 	// Allocate lu
 	iluvals = (scalar*)aligned_alloc(CACHE_LINE_LEN, mat.browptr[mat.nbrows]*bs*bs*sizeof(scalar));
 
+	if(numasched.active())
+		numasched.first_touch_entries(mat.browptr, bs*bs, mat.vals, iluvals);
+	else
 #pragma omp parallel for simd default(shared)
-	for(index j = 0; j < mat.browptr[mat.nbrows]*bs*bs; j++) {
-		iluvals[j] = mat.vals[j];
-	}
+		for(index j = 0; j < mat.browptr[mat.nbrows]*bs*bs; j++) {
+			iluvals[j] = mat.vals[j];
+		}
 
 	// intermediate array for the solve part
 	if(!ytemp) {
 		ytemp = (scalar*)aligned_alloc(CACHE_LINE_LEN, mat.nbrows*bs*sizeof(scalar));
+		if(numasched.active())
+			numasched.first_touch(ytemp, bs, scalar(0));
+		else
 #pragma omp parallel for simd default(shared)
-		for(index i = 0; i < mat.nbrows*bs; i++)
-		{
-			ytemp[i] = 0;
-		}
+			for(index i = 0; i < mat.nbrows*bs; i++)
+			{
+				ytemp[i] = 0;
+			}
 	}
 	else
 		std::cout << "! AsyncBlockILU0_SRPreconditioner: Temp vector is already allocated!\n";
 
 	if(usescaling) {
 		if(!scale)
+		{
 			scale = (scalar*)aligned_alloc(CACHE_LINE_LEN, mat.nbrows*bs*sizeof(scalar));
+			if(numasched.active())
+				numasched.first_touch(scale, bs, scalar(1));
+		}
 		else
 			std::cout << "! AsyncBlockILU0_SRPreconditioner: scale was already allocated!\n";
 	}
@@ -189,23 +348,166 @@ void AsyncBlockILU0_SRPreconditioner<scalar,index,bs,stor>::setup_storage()
 template <typename scalar, typename index, int bs, StorageOptions stor>
 PrecInfo AsyncBlockILU0_SRPreconditioner<scalar,index,bs,stor>::compute()
 {
+	double structtime = 0;
+
+	if(refactortol >= 0 && snapshot)
+	{
+		if(scale)
+			getScalingVector<scalar,index,bs>(&mat, scale);
+
+		PrecInfo pinfo;
+		if(compute_remainder)
+			pinfo.prec_rem_initial_norm() = block_ilu0_inverted_remainder<scalar,index,bs,stor>
+				(&mat, *plist, scale, iluvals, thread_chunk_size, nullptr);
+
+		std::vector<char> active;
+		const std::vector<index> rows = block_ilu0_changed_rows<scalar,index,bs,stor>
+			(&mat, scale, refactortol, refactorlevels, snapshot, active);
+		if(!rows.empty())
+			block_ilu0_refactorize<scalar,index,bs,stor>(&mat, *plist, rows, active, nbuildsweeps,
+			                                             thread_chunk_size, threadedfactor, scale,
+			                                             iluvals, pivinvs,
+			                                             syncfreefactor ? sfsched.get() : nullptr);
+		if(!rows.empty() && applytype == APPLY_ISAI)
+			isai->compute(mat, iluvals, scale, thread_chunk_size);
+
+		if(compute_remainder)
+			pinfo.prec_remainder_norm() = block_ilu0_inverted_remainder<scalar,index,bs,stor>
+				(&mat, *plist, scale, iluvals, thread_chunk_size, &pinfo);
+		pinfo.build_sweeps = rows.empty() ? 0 : (syncfreefactor ? 1 : nbuildsweeps);
+		pinfo.refactored_rows = static_cast<int>(rows.size());
+		return pinfo;
+	}
+
 	// first-time setup
 	if(!iluvals) {
 		setup_storage();
-		plist = compute_ILU_positions_CSR_CSR(&mat);
+		const auto tstart = std::chrono::steady_clock::now();
+		plist = structural_cache().structure<ILUPositions<index>>("ILU0 positions",
+			pattern_fingerprint(mat, bs), [this]() { return compute_ILU_positions_CSR_CSR(&mat); });
+		structtime = std::chrono::duration<double>(std::chrono::steady_clock::now()-tstart).count();
+		if(usecompressedind) {
+			compress_column_indices(mat, cind);
+			rcind = createRawView(cind);
+		}
 	}
 
-	return block_ilu0_factorize<scalar,index,bs,stor>
-		(&mat, plist, nbuildsweeps, thread_chunk_size, threadedfactor, factinittype,
-		 compute_remainder, iluvals, scale);
+	if((syncfreefactor || applytype == APPLY_SYNCFREE) && !sfsched)
+		sfsched.reset(new SyncFreeSchedule<index>(mat.nbrows, thread_chunk_size));
+	if(tilecachebytes > 0)
+		tiling.tilerows = cache_tile_rows(mat, bs, 2, tilecachebytes);
+
+	PrecInfo pinfo = block_ilu0_factorize<scalar,index,bs,stor>
+		(&mat, *plist, nbuildsweeps, buildtol, thread_chunk_size, threadedfactor, factinittype,
+		 compute_remainder, iluvals, scale, syncfreefactor ? sfsched.get() : nullptr, tiling);
+	pinfo.structure_walltime = structtime;
+	pinfo.refactored_rows = mat.nbrows;
+
+	if(applytype == APPLY_ISAI) {
+		if(!isai)
+			isai.reset(new ILUISAI<scalar,index,bs,stor>(true));
+		isai->compute(mat, iluvals, scale, thread_chunk_size);
+	}
+
+	if(refactortol >= 0) {
+		snapshot = (scalar*)aligned_alloc(CACHE_LINE_LEN, mat.browptr[mat.nbrows]*bs*bs*sizeof(scalar));
+		pivinvs = (scalar*)aligned_alloc(CACHE_LINE_LEN, mat.nbrows*bs*bs*sizeof(scalar));
+		if(!snapshot || !pivinvs)
+			throw std::bad_alloc();
+		block_ilu0_save_state<scalar,index,bs,stor>(&mat, scale, iluvals, snapshot, pivinvs);
+	}
+	return pinfo;
 }
 
 template <typename scalar, typename index, int bs, StorageOptions stor>
 void AsyncBlockILU0_SRPreconditioner<scalar,index,bs,stor>::apply(const scalar *const r, 
                                                                   scalar *const __restrict z) const
 {
+	if(applytype == APPLY_ISAI) {
+		isai->apply(r, z);
+		return;
+	}
+
 	block_ilu0_apply<scalar,index,bs,stor>
-		(&mat, iluvals, scale, ytemp, napplysweeps, thread_chunk_size, threadedapply, applyinittype, r, z);
+		(&mat, usecompressedind ? &rcind : nullptr, &numasched,
+		 iluvals, scale, ytemp, napplysweeps, thread_chunk_size, threadedapply, applyinittype, r, z,
+		 applytype == APPLY_SYNCFREE ? sfsched.get() : nullptr);
+}
+
+/// Applies the block-ILU0 factorization to several vectors by exact sync-free triangular solves
+/** \sa block_ilu0_apply_syncfree block_ilu0_apply_multi
+ */
+template <typename scalar, typename index, int bs, StorageOptions stor>
+static void block_ilu0_apply_multi_syncfree(const CRawBSRMatrix<scalar,index> *const mat,
+                                            const SyncFreeSchedule<index>& sched,
+                                            const scalar *const iluvals, const scalar *const scale,
+                                            scalar *const __restrict y_temp, const bool usethreads,
+                                            const int nvecs,
+                                            const scalar *const rr, scalar *const __restrict zz)
+{
+	using Blk = Block_t<scalar,bs,stor>;
+	const Blk *ilu = reinterpret_cast<const Blk*>(iluvals);
+
+#pragma omp parallel default(shared) if(usethreads)
+	{
+		// z := Sr
+#pragma omp for schedule(static)
+		for(index i = 0; i < mat->nbrows*bs; i++)
+		{
+			const scalar sc = scale ? scale[i] : 1;
+#pragma omp simd
+			for(int v = 0; v < nvecs; v++)
+				zz[i*nvecs+v] = sc*rr[i*nvecs+v];
+		}
+
+		sched.forward(*mat, [&](const index i) {
+			block_unit_lower_triangular_multi<scalar,index,bs,stor>
+				(ilu, mat->bcolind, mat->browptr[i], mat->diagind[i], nvecs, zz, i, y_temp);
+		});
+
+		sched.backward(*mat, [&](const index i) {
+			block_upper_triangular_multi<scalar,index,bs,stor>
+				(ilu, mat->bcolind, mat->diagind[i], mat->browptr[i+1], nvecs, y_temp, i, zz);
+		});
+
+		if(scale)
+#pragma omp for schedule(static)
+			for(index i = 0; i < mat->nbrows*bs; i++)
+			{
+#pragma omp simd
+				for(int v = 0; v < nvecs; v++)
+					zz[i*nvecs+v] *= scale[i];
+			}
+	}
+}
+
+template <typename scalar, typename index, int bs, StorageOptions stor>
+void AsyncBlockILU0_SRPreconditioner<scalar,index,bs,stor>::apply_multi(const int nvecs,
+                                                                        const scalar *const r,
+                                                                        scalar *const __restrict z)
+	const
+{
+	if(applytype == APPLY_ISAI) {
+		isai->apply_multi(nvecs, r, z);
+		return;
+	}
+
+	if(nvecs > nymultivecs) {
+		aligned_free(ymulti);
+		nymultivecs = 0;
+		ymulti = (scalar*)aligned_alloc(CACHE_LINE_LEN, mat.nbrows*bs*nvecs*sizeof(scalar));
+		if(!ymulti)
+			throw std::bad_alloc();
+		nymultivecs = nvecs;
+	}
+
+	if(applytype == APPLY_SYNCFREE)
+		block_ilu0_apply_multi_syncfree<scalar,index,bs,stor>
+			(&mat, *sfsched, iluvals, scale, ymulti, threadedapply, nvecs, r, z);
+	else
+		block_ilu0_apply_multi<scalar,index,bs,stor>
+			(&mat, iluvals, scale, ymulti, napplysweeps, thread_chunk_size, threadedapply,
+			 applyinittype, nvecs, r, z);
 }
 
 template <typename scalar, typename index, int bs, StorageOptions stor>
@@ -220,12 +522,13 @@ AsyncILU0_SRPreconditioner<scalar,index>::
 AsyncILU0_SRPreconditioner(SRMatrixStorage<const scalar, const index>&& matrix,
                            const int nbuildswp, const int napplyswp, const bool uscal, const int tcs,
                            const FactInit fi, const ApplyInit ai, const bool compute_preconditioner_info,
-                           const bool tf, const bool ta)
+                           const bool tf, const bool ta, const bool compressed_colind)
 	: SRPreconditioner<scalar,index>(std::move(matrix)),
 	  iluvals{nullptr}, scale{nullptr}, ytemp{nullptr}, usescaling{uscal},
 	  threadedfactor{tf}, threadedapply{ta},
 	  nbuildsweeps{nbuildswp}, napplysweeps{napplyswp}, thread_chunk_size{tcs},
-	  factinittype{fi}, applyinittype{ai}, compute_precinfo{compute_preconditioner_info}
+	  factinittype{fi}, applyinittype{ai}, compute_precinfo{compute_preconditioner_info},
+	  usecompressedind{compressed_colind}
 { }
 
 template <typename scalar, typename index>
@@ -233,91 +536,220 @@ AsyncILU0_SRPreconditioner<scalar,index>::~AsyncILU0_SRPreconditioner()
 {
 	aligned_free(iluvals);
 	aligned_free(ytemp);
+	aligned_free(ymulti);
 	aligned_free(scale);
 }
 
+/// Applies the scalar ILU0 factorization by exact synchronization-free triangular solves
+/** \sa block_ilu0_apply_syncfree
+ */
+template <typename scalar, typename index>
+static void scalar_ilu0_apply_syncfree(const CRawBSRMatrix<scalar,index> *const mat,
+                                       const CRawCompressedColumnIndex<index> *const cind,
+                                       const SyncFreeSchedule<index>& sched,
+                                       const scalar *const iluvals, const scalar *const scale,
+                                       scalar *const __restrict ytemp, const bool usethreads,
+                                       const scalar *const ra, scalar *const __restrict za)
+{
+#pragma omp parallel default(shared) if(usethreads)
+	{
+		// z := Sr
+#pragma omp for simd schedule(static)
+		for(index i = 0; i < mat->nbrows; i++)
+			za[i] = scale ? scale[i]*ra[i] : ra[i];
+
+		if(cind)
+			sched.forward(*mat, [&](const index i) {
+				ytemp[i] = scalar_unit_lower_triangular_ci(iluvals, *cind, i, mat->browptr[i],
+				                                           mat->diagind[i], za[i], ytemp);
+			});
+		else
+			sched.forward(*mat, [&](const index i) {
+				ytemp[i] = scalar_unit_lower_triangular(iluvals, mat->bcolind, mat->browptr[i],
+				                                        mat->diagind[i], za[i], ytemp);
+			});
+
+		if(cind)
+			sched.backward(*mat, [&](const index i) {
+				za[i] = scalar_upper_triangular_ci<scalar,index>(iluvals, *cind, i, mat->diagind[i],
+						mat->browptr[i+1], 1.0/iluvals[mat->diagind[i]], ytemp[i], za);
+			});
+		else
+			sched.backward(*mat, [&](const index i) {
+				za[i] = scalar_upper_triangular<scalar,index>(iluvals, mat->bcolind, mat->diagind[i],
+						mat->browptr[i+1], 1.0/iluvals[mat->diagind[i]], ytemp[i], za);
+			});
+
+		if(scale)
+#pragma omp for simd schedule(static)
+			for(index i = 0; i < mat->nbrows; i++)
+				za[i] = za[i]*scale[i];
+	}
+}
+
 template <typename scalar, typename index>
 void scalar_ilu0_apply(const CRawBSRMatrix<scalar,index> *const mat,
+                       const CRawCompressedColumnIndex<index> *const cind,
+                       const DomainSchedule<index> *const sched,
                        const scalar *const iluvals, const scalar *const scale,
                        scalar *const __restrict ytemp,
                        const int napplysweeps, const int thread_chunk_size, const bool usethreads,
                        const ApplyInit init_type,
-                       const scalar *const ra, scalar *const __restrict za) 
+                       const scalar *const ra, scalar *const __restrict za,
+                       const SyncFreeSchedule<index> *const syncfree = nullptr)
 {
-	// initially, z := Sr
-	if(scale)
-#pragma omp parallel for simd default(shared)
-		for(index i = 0; i < mat->nbrows; i++) {
-			za[i] = scale[i]*ra[i];
-		}
-	else
-#pragma omp parallel for simd default(shared)
-		for(index i = 0; i < mat->nbrows; i++) {
-			za[i] = ra[i];
-		}
-
-	switch(init_type) {
-	case INIT_A_JACOBI:
-	case INIT_A_ZERO:
-#pragma omp parallel for simd default(shared)
-		for(index i = 0; i < mat->nbrows; i++) {
-			ytemp[i] = 0;
-		}
-	break;
-	default:
-		;
+	if(syncfree) {
+		scalar_ilu0_apply_syncfree(mat, cind, *syncfree, iluvals, scale, ytemp, usethreads, ra, za);
+		return;
 	}
 
-	/** solves Ly = Sr by asynchronous Jacobi iterations.
-	 * Note that if done serially, this is a forward-substitution.
-	 */
-#pragma omp parallel default(shared) if(usethreads)
-	for(int isweep = 0; isweep < napplysweeps; isweep++)
-	{
-#pragma omp for schedule(dynamic, thread_chunk_size) nowait
-		for(index i = 0; i < mat->nbrows; i++)
-		{
-			ytemp[i] = scalar_unit_lower_triangular(iluvals, mat->bcolind, mat->browptr[i],
-					mat->diagind[i], za[i], ytemp);
-		}
-	}
-
-	switch(init_type) {
-	case INIT_A_JACOBI:
-#pragma omp parallel for simd default(shared)
-		for(index i = 0; i < mat->nbrows; i++) {
-			za[i] = ytemp[i];
-		}
-		break;
-	case INIT_A_ZERO:
-#pragma omp parallel for simd default(shared)
-		for(index i = 0; i < mat->nbrows; i++) {
-			za[i] = 0;
-		}
-		break;
-	default:
+	if(init_type != INIT_A_JACOBI && init_type != INIT_A_ZERO)
 		throw std::runtime_error(" scalar_ilu0_apply: Invalid init type!");
-	}
 
-	/* Solves Uz = y by asynchronous Jacobi iteration.
-	 * If done serially, this is a back-substitution.
-	 */
-#pragma omp parallel default(shared) if(usethreads)
-	for(int isweep = 0; isweep < napplysweeps; isweep++)
-	{
-#pragma omp for schedule(dynamic, thread_chunk_size) nowait
-		for(index i = mat->nbrows-1; i >= 0; i--)
-		{
-			za[i] = scalar_upper_triangular<scalar,index>(iluvals, mat->bcolind, mat->diagind[i],
-					mat->browptr[i+1], 1.0/iluvals[mat->diagind[i]], ytemp[i], za);
+	const AsyncSweepEngine<index> eng(mat->nbrows, thread_chunk_size, sched);
+	eng.run(usethreads, [&]() {
+		// initially, z := Sr
+		eng.rows([&](const index start, const index end) {
+			if(scale)
+#pragma omp simd
+				for(index i = start; i < end; i++)
+					za[i] = scale[i]*ra[i];
+			else
+#pragma omp simd
+				for(index i = start; i < end; i++)
+					za[i] = ra[i];
+
+#pragma omp simd
+			for(index i = start; i < end; i++)
+				ytemp[i] = 0;
+		});
+
+		/** solves Ly = Sr by asynchronous Jacobi iterations.
+		 * Note that if done serially, this is a forward-substitution.
+		 */
+		eng.sync();
+		if(cind)
+			eng.forward(napplysweeps, [&](const index i) {
+				ytemp[i] = scalar_unit_lower_triangular_ci(iluvals, *cind, i, mat->browptr[i],
+				                                           mat->diagind[i], za[i], ytemp);
+			});
+		else
+			eng.forward(napplysweeps, [&](const index i) {
+				ytemp[i] = scalar_unit_lower_triangular(iluvals, mat->bcolind, mat->browptr[i],
+						mat->diagind[i], za[i], ytemp);
+			});
+
+		eng.sync();
+		eng.rows([&](const index start, const index end) {
+			if(init_type == INIT_A_JACOBI)
+#pragma omp simd
+				for(index i = start; i < end; i++)
+					za[i] = ytemp[i];
+			else
+#pragma omp simd
+				for(index i = start; i < end; i++)
+					za[i] = 0;
+		});
+
+		/* Solves Uz = y by asynchronous Jacobi iteration.
+		 * If done serially, this is a back-substitution.
+		 */
+		eng.sync();
+		if(cind)
+			eng.backward(napplysweeps, [&](const index i) {
+				za[i] = scalar_upper_triangular_ci<scalar,index>(iluvals, *cind, i, mat->diagind[i],
+						mat->browptr[i+1], 1.0/iluvals[mat->diagind[i]], ytemp[i], za);
+			});
+		else
+			eng.backward(napplysweeps, [&](const index i) {
+				za[i] = scalar_upper_triangular<scalar,index>(iluvals, mat->bcolind, mat->diagind[i],
+						mat->browptr[i+1], 1.0/iluvals[mat->diagind[i]], ytemp[i], za);
+			});
+
+		// scale z
+		if(scale) {
+			eng.sync();
+			eng.rows([&](const index start, const index end) {
+#pragma omp simd
+				for(index i = start; i < end; i++)
+					za[i] = za[i]*scale[i];
+			});
 		}
-	}
+	});
+}
+
+/// Applies the scalar ILU0 factorization to several row-interleaved vectors at once
+/** The work-flow is the same as that of \ref scalar_ilu0_apply, except that every entry of the
+ * factors that is read is applied to all the vectors.
+ * \param ytemp A pre-allocated temporary multivector
+ * \param nvecs Number of vectors
+ */
+template <typename scalar, typename index>
+void scalar_ilu0_apply_multi(const CRawBSRMatrix<scalar,index> *const mat,
+                             const scalar *const iluvals, const scalar *const scale,
+                             scalar *const __restrict ytemp,
+                             const int napplysweeps, const int thread_chunk_size, const bool usethreads,
+                             const ApplyInit init_type, const int nvecs,
+                             const scalar *const ra, scalar *const __restrict za)
+{
+	if(init_type != INIT_A_JACOBI && init_type != INIT_A_ZERO)
+		throw std::runtime_error(" scalar_ilu0_apply_multi: Invalid init type!");
+
+	const AsyncSweepEngine<index> eng(mat->nbrows, thread_chunk_size);
+	eng.run(usethreads, [&]() {
+		// initially, z := Sr
+		eng.rows([&](const index start, const index end) {
+			for(index i = start; i < end; i++)
+			{
+				const scalar sc = scale ? scale[i] : 1;
+#pragma omp simd
+				for(int v = 0; v < nvecs; v++) {
+					za[i*nvecs+v] = sc*ra[i*nvecs+v];
+					ytemp[i*nvecs+v] = 0;
+				}
+			}
+		});
+
+		// solves Ly = Sr by asynchronous Jacobi iterations
+		eng.sync();
+		eng.forward(napplysweeps, [&](const index i) {
+			scalar_unit_lower_triangular_multi(iluvals, mat->bcolind, i, mat->browptr[i],
+			                                   mat->diagind[i], nvecs, za, ytemp);
+		});
+
+		eng.sync();
+		eng.rows([&](const index start, const index end) {
+			if(init_type == INIT_A_JACOBI)
+#pragma omp simd
+				for(index i = start*nvecs; i < end*nvecs; i++)
+					za[i] = ytemp[i];
+			else
+#pragma omp simd
+				for(index i = start*nvecs; i < end*nvecs; i++)
+					za[i] = 0;
+		});
+
+		// solves Uz = y by asynchronous Jacobi iteration
+		eng.sync();
+		eng.backward(napplysweeps, [&](const index i) {
+			scalar_upper_triangular_multi(iluvals, mat->bcolind, i, mat->diagind[i],
+			                              mat->browptr[i+1], 1.0/iluvals[mat->diagind[i]], nvecs,
+			                              ytemp, za);
+		});
 
-	if(scale)
 		// scale z
-#pragma omp parallel for simd default(shared)
-		for(int i = 0; i < mat->nbrows; i++)
-			za[i] = za[i]*scale[i];
+		if(scale) {
+			eng.sync();
+			eng.rows([&](const index start, const index end) {
+				for(index i = start; i < end; i++)
+				{
+#pragma omp simd
+					for(int v = 0; v < nvecs; v++)
+						za[i*nvecs+v] *= scale[i];
+				}
+			});
+		}
+	});
 }
 
 template <typename scalar, typename index>
@@ -329,26 +761,36 @@ void AsyncILU0_SRPreconditioner<scalar,index>::setup_storage()
 
 	// Allocate lu
 	iluvals = (scalar*)aligned_alloc(CACHE_LINE_LEN, mat.browptr[mat.nbrows]*sizeof(scalar));
+	if(numasched.active())
+		numasched.first_touch_entries(mat.browptr, 1, mat.vals, iluvals);
+	else
 #pragma omp parallel for simd default(shared)
-	for(int j = 0; j < mat.browptr[mat.nbrows]; j++) {
-		iluvals[j] = mat.vals[j];
-	}
+		for(int j = 0; j < mat.browptr[mat.nbrows]; j++) {
+			iluvals[j] = mat.vals[j];
+		}
 
 	// intermediate array for the solve part
 	if(!ytemp) {
 		ytemp = (scalar*)aligned_alloc(CACHE_LINE_LEN, mat.nbrows*sizeof(scalar));
+		if(numasched.active())
+			numasched.first_touch(ytemp, 1, scalar(0));
+		else
 #pragma omp parallel for simd default(shared)
-		for(index i = 0; i < mat.nbrows; i++)
-		{
-			ytemp[i] = 0;
-		}
+			for(index i = 0; i < mat.nbrows; i++)
+			{
+				ytemp[i] = 0;
+			}
 	}
 	else
 		std::cout << "! AsyncILU0: setup_storage(): Temp vector is already allocated!\n";
 
 	if(usescaling) {
 		if(!scale)
+		{
 			scale = (scalar*)aligned_alloc(CACHE_LINE_LEN, mat.nbrows*sizeof(scalar));
+			if(numasched.active())
+				numasched.first_touch(scale, 1, scalar(1));
+		}
 		else
 			std::cout << "! AsyncILU0: setup_storage(): Scale vector is already allocated!\n";
 	}
@@ -357,13 +799,37 @@ void AsyncILU0_SRPreconditioner<scalar,index>::setup_storage()
 template <typename scalar, typename index>
 PrecInfo AsyncILU0_SRPreconditioner<scalar,index>::compute()
 {
+	double structtime = 0;
+
 	if(!iluvals) {
 		setup_storage();
-		plist = compute_ILU_positions_CSR_CSR(&mat);
+		const auto tstart = std::chrono::steady_clock::now();
+		plist = structural_cache().structure<ILUPositions<index>>("ILU0 positions",
+			pattern_fingerprint(mat, 1), [this]() { return compute_ILU_positions_CSR_CSR(&mat); });
+		structtime = std::chrono::duration<double>(std::chrono::steady_clock::now()-tstart).count();
+		if(usecompressedind) {
+			compress_column_indices(mat, cind);
+			rcind = createRawView(cind);
+		}
 	}
 
-	return scalar_ilu0_factorize(&mat, plist, nbuildsweeps, thread_chunk_size, threadedfactor,
-	                             factinittype, compute_precinfo, iluvals, scale);
+	if((syncfreefactor || applytype == APPLY_SYNCFREE) && !sfsched)
+		sfsched.reset(new SyncFreeSchedule<index>(mat.nbrows, thread_chunk_size));
+	if(tilecachebytes > 0)
+		tiling.tilerows = cache_tile_rows(mat, 1, 2, tilecachebytes);
+
+	PrecInfo pinfo = scalar_ilu0_factorize(&mat, *plist, nbuildsweeps, buildtol, thread_chunk_size,
+	                                       threadedfactor, factinittype, compute_precinfo,
+	                                       iluvals, scale, syncfreefactor ? sfsched.get() : nullptr,
+	                                       tiling);
+	pinfo.structure_walltime = structtime;
+
+	if(applytype == APPLY_ISAI) {
+		if(!isai)
+			isai.reset(new ILUISAI<scalar,index,1,ColMajor>(false));
+		isai->compute(mat, iluvals, scale, thread_chunk_size);
+	}
+	return pinfo;
 
 }
 
@@ -371,8 +837,86 @@ template <typename scalar, typename index>
 void AsyncILU0_SRPreconditioner<scalar,index>::apply(const scalar *const __restrict ra, 
                                                      scalar *const __restrict za) const
 {
-	scalar_ilu0_apply(&mat, iluvals, scale, ytemp, napplysweeps, thread_chunk_size, threadedapply,
-	                  applyinittype, ra, za);
+	if(applytype == APPLY_ISAI) {
+		isai->apply(ra, za);
+		return;
+	}
+
+	scalar_ilu0_apply(&mat, usecompressedind ? &rcind : nullptr,
+	                  &numasched,
+	                  iluvals, scale, ytemp, napplysweeps, thread_chunk_size, threadedapply,
+	                  applyinittype, ra, za, applytype == APPLY_SYNCFREE ? sfsched.get() : nullptr);
+}
+
+/// Applies the scalar ILU0 factorization to several vectors by exact sync-free triangular solves
+/** \sa scalar_ilu0_apply_syncfree scalar_ilu0_apply_multi
+ */
+template <typename scalar, typename index>
+static void scalar_ilu0_apply_multi_syncfree(const CRawBSRMatrix<scalar,index> *const mat,
+                                             const SyncFreeSchedule<index>& sched,
+                                             const scalar *const iluvals, const scalar *const scale,
+                                             scalar *const __restrict ytemp, const bool usethreads,
+                                             const int nvecs,
+                                             const scalar *const ra, scalar *const __restrict za)
+{
+#pragma omp parallel default(shared) if(usethreads)
+	{
+		// z := Sr
+#pragma omp for schedule(static)
+		for(index i = 0; i < mat->nbrows; i++)
+		{
+			const scalar sc = scale ? scale[i] : 1;
+#pragma omp simd
+			for(int v = 0; v < nvecs; v++)
+				za[i*nvecs+v] = sc*ra[i*nvecs+v];
+		}
+
+		sched.forward(*mat, [&](const index i) {
+			scalar_unit_lower_triangular_multi(iluvals, mat->bcolind, i, mat->browptr[i],
+			                                   mat->diagind[i], nvecs, za, ytemp);
+		});
+
+		sched.backward(*mat, [&](const index i) {
+			scalar_upper_triangular_multi(iluvals, mat->bcolind, i, mat->diagind[i],
+			                              mat->browptr[i+1], 1.0/iluvals[mat->diagind[i]], nvecs,
+			                              ytemp, za);
+		});
+
+		if(scale)
+#pragma omp for schedule(static)
+			for(index i = 0; i < mat->nbrows; i++)
+			{
+#pragma omp simd
+				for(int v = 0; v < nvecs; v++)
+					za[i*nvecs+v] *= scale[i];
+			}
+	}
+}
+
+template <typename scalar, typename index>
+void AsyncILU0_SRPreconditioner<scalar,index>::apply_multi(const int nvecs, const scalar *const ra,
+                                                           scalar *const __restrict za) const
+{
+	if(applytype == APPLY_ISAI) {
+		isai->apply_multi(nvecs, ra, za);
+		return;
+	}
+
+	if(nvecs > nymultivecs) {
+		aligned_free(ymulti);
+		nymultivecs = 0;
+		ymulti = (scalar*)aligned_alloc(CACHE_LINE_LEN, mat.nbrows*nvecs*sizeof(scalar));
+		if(!ymulti)
+			throw std::bad_alloc();
+		nymultivecs = nvecs;
+	}
+
+	if(applytype == APPLY_SYNCFREE)
+		scalar_ilu0_apply_multi_syncfree(&mat, *sfsched, iluvals, scale, ymulti, threadedapply, nvecs,
+		                                 ra, za);
+	else
+		scalar_ilu0_apply_multi(&mat, iluvals, scale, ymulti, napplysweeps, thread_chunk_size,
+		                        threadedapply, applyinittype, nvecs, ra, za);
 }
 
 template <typename scalar, typename index>
@@ -426,11 +970,18 @@ PrecInfo ReorderedAsyncILU0_SRPreconditioner<scalar,index>::compute()
 	reord->compute(mat);
 	reord->applyOrdering(rsmat, FORWARD);
 
-	plist = compute_ILU_positions_CSR_CSR(reinterpret_cast<CRawBSRMatrix<scalar,index>*>(&rsmat));
-
-	return scalar_ilu0_factorize(reinterpret_cast<CRawBSRMatrix<scalar,index>*>(&rsmat),
-	                             plist, nbuildsweeps, thread_chunk_size, threadedfactor,
-	                             factinittype, false, iluvals, scale);
+	const CRawBSRMatrix<scalar,index> *const rmat
+		= reinterpret_cast<CRawBSRMatrix<scalar,index>*>(&rsmat);
+	const auto tstart = std::chrono::steady_clock::now();
+	plist = structural_cache().structure<ILUPositions<index>>("ILU0 positions",
+		pattern_fingerprint(*rmat, 1), [rmat]() { return compute_ILU_positions_CSR_CSR(rmat); });
+	const double structtime
+		= std::chrono::duration<double>(std::chrono::steady_clock::now()-tstart).count();
+
+	PrecInfo pinfo = scalar_ilu0_factorize(rmat, *plist, nbuildsweeps, buildtol, thread_chunk_size,
+	                                       threadedfactor, factinittype, false, iluvals, scale);
+	pinfo.structure_walltime = structtime;
+	return pinfo;
 }
 
 template <typename scalar, typename index>
@@ -450,6 +1001,8 @@ void ReorderedAsyncILU0_SRPreconditioner<scalar,index>::apply(const scalar *cons
 
 		// solve triangular system
 		scalar_ilu0_apply(reinterpret_cast<const CRawBSRMatrix<scalar,index>*>(&rsmat),
+		                  (const CRawCompressedColumnIndex<index>*)nullptr,
+		                  (const DomainSchedule<index>*)nullptr,
 		                  iluvals, scale, ytemp, napplysweeps, thread_chunk_size, threadedapply,
 		                  applyinittype, rb, za);
 
@@ -458,6 +1011,8 @@ void ReorderedAsyncILU0_SRPreconditioner<scalar,index>::apply(const scalar *cons
 	else {
 		// solve triangular system
 		scalar_ilu0_apply(reinterpret_cast<const CRawBSRMatrix<scalar,index>*>(&rsmat),
+		                  (const CRawCompressedColumnIndex<index>*)nullptr,
+		                  (const DomainSchedule<index>*)nullptr,
 		                  iluvals, scale, ytemp, napplysweeps, thread_chunk_size, threadedapply,
 		                  applyinittype, ra, za);
 	}
@@ -475,6 +1030,56 @@ void ReorderedAsyncILU0_SRPreconditioner<scalar,index>::apply_relax(const scalar
 
 template class ReorderedAsyncILU0_SRPreconditioner<double,int>;
 
+template <typename scalar, typename index>
+AsyncILUT_SRPreconditioner<scalar,index>::
+AsyncILUT_SRPreconditioner(SRMatrixStorage<const scalar, const index>&& matrix,
+                           const int nsteps, const int napplysweeps, const bool use_scaling,
+                           const int tcs, const FactInit finit, const ApplyInit ainit,
+                           const scalar fill_factor, const bool compute_preconditioner_info,
+                           const bool threadedfactor, const bool threadedapply)
+	: AsyncILU0_SRPreconditioner<scalar,index>(std::move(matrix), nsteps, napplysweeps, use_scaling,
+	                                           tcs, finit, ainit, compute_preconditioner_info,
+	                                           threadedfactor, threadedapply),
+	  fillfactor{fill_factor}
+{ }
+
+template <typename scalar, typename index>
+PrecInfo AsyncILUT_SRPreconditioner<scalar,index>::compute()
+{
+	if(!iluvals) {
+		setup_storage();
+		iluvalscapacity = pmat.nnzb;
+	}
+
+	// the pattern of the factors starts from that of the matrix every time
+	const CRawBSRMatrix<scalar,index> origmat(&pmat.browptr[0], &pmat.bcolind[0], &pmat.vals[0],
+	                                          &pmat.diagind[0], &pmat.browendptr[0], pmat.nbrows,
+	                                          pmat.nnzb, pmat.nbstored);
+
+	const PrecInfo pinfo = scalar_parilut_factorize(&origmat, nbuildsweeps, fillfactor,
+	                                                thread_chunk_size, threadedfactor, factinittype,
+	                                                compute_precinfo, ilutmat, iluvals,
+	                                                iluvalscapacity, scale);
+
+	mat = CRawBSRMatrix<scalar,index>(&ilutmat.browptr[0], &ilutmat.bcolind[0], &ilutmat.vals[0],
+	                                  &ilutmat.diagind[0], &ilutmat.browendptr[0], ilutmat.nbrows,
+	                                  ilutmat.nnzb, ilutmat.nbstored);
+	if(applytype == APPLY_SYNCFREE && !sfsched)
+		sfsched.reset(new SyncFreeSchedule<index>(mat.nbrows, thread_chunk_size));
+
+	// the pattern of the factors changes every time
+	if(applytype == APPLY_ISAI) {
+		if(!isai)
+			isai.reset(new ILUISAI<scalar,index,1,ColMajor>(false));
+		else
+			isai->reset();
+		isai->compute(mat, iluvals, scale, thread_chunk_size);
+	}
+	return pinfo;
+}
+
+template class AsyncILUT_SRPreconditioner<double,int>;
+
 #ifdef HAVE_MC64
 
 template <typename scalar, typename index>
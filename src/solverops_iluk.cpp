@@ -0,0 +1,84 @@
+/** \file
+ * \brief Implementation of ILU(k) preconditioners
+ * \author Aditya Kashi
+ */
+
+#include <string>
+#include <chrono>
+#include <boost/align/aligned_alloc.hpp>
+#include "structural_cache.hpp"
+#include "solverops_iluk.hpp"
+
+namespace blasted {
+
+using boost::alignment::aligned_alloc;
+using boost::alignment::aligned_free;
+
+template <typename scalar, typename index, int bs, typename ILU0>
+LevelOfFillILU<scalar,index,bs,ILU0>::~LevelOfFillILU()
+{
+	aligned_free(extvals);
+}
+
+template <typename scalar, typename index, int bs, typename ILU0>
+PrecInfo LevelOfFillILU<scalar,index,bs,ILU0>::compute()
+{
+	double structtime = 0;
+
+	if(!pattern) {
+		const auto tstart = std::chrono::steady_clock::now();
+		pattern = structural_cache().structure<ILUkPattern<index>>
+			("ILU(" + std::to_string(filllevel) + ") pattern", pattern_fingerprint(mat, bs),
+			 [this]() { return compute_ILUk_pattern(&mat, filllevel); });
+		structtime = std::chrono::duration<double>(std::chrono::steady_clock::now()-tstart).count();
+
+		const index nnzext = pattern->browptr[mat.nbrows];
+		extvals = (scalar*)aligned_alloc(CACHE_LINE_LEN, nnzext*bs*bs*sizeof(scalar));
+		if(!extvals)
+			throw std::bad_alloc();
+
+		// from now on, ILU0 operates on the extended matrix
+		mat = CRawBSRMatrix<scalar,index>(&pattern->browptr[0], &pattern->bcolind[0], extvals,
+		                                  &pattern->diagind[0], &pattern->browptr[1],
+		                                  mat.nbrows, nnzext, nnzext);
+	}
+
+	const ILUkPattern<index>& pat = *pattern;
+
+#pragma omp parallel for default(shared)
+	for(index irow = 0; irow < pmat.nbrows; irow++)
+	{
+		for(index j = pat.browptr[irow]*bs*bs; j < pat.browptr[irow+1]*bs*bs; j++)
+			extvals[j] = 0;
+		for(index j = pmat.browptr[irow]; j < pmat.browendptr[irow]; j++)
+			for(int l = 0; l < bs*bs; l++)
+				extvals[pat.origpos[j]*bs*bs + l] = pmat.vals[j*bs*bs + l];
+	}
+
+	PrecInfo pinfo = ILU0::compute();
+	pinfo.structure_walltime += structtime;
+	return pinfo;
+}
+
+template class LevelOfFillILU<double,int,1,AsyncILU0_SRPreconditioner<double,int>>;
+template class LevelOfFillILU<double,int,1,Async_Level_ILU0<double,int>>;
+
+template class LevelOfFillILU<double,int,4,AsyncBlockILU0_SRPreconditioner<double,int,4,ColMajor>>;
+template class LevelOfFillILU<double,int,4,Async_Level_BlockILU0<double,int,4,ColMajor>>;
+template class LevelOfFillILU<double,int,5,AsyncBlockILU0_SRPreconditioner<double,int,5,ColMajor>>;
+template class LevelOfFillILU<double,int,5,Async_Level_BlockILU0<double,int,5,ColMajor>>;
+template class LevelOfFillILU<double,int,4,AsyncBlockILU0_SRPreconditioner<double,int,4,RowMajor>>;
+template class LevelOfFillILU<double,int,4,Async_Level_BlockILU0<double,int,4,RowMajor>>;
+
+#ifdef BUILD_BLOCK_SIZE
+template class LevelOfFillILU<double,int,BUILD_BLOCK_SIZE,
+                              AsyncBlockILU0_SRPreconditioner<double,int,BUILD_BLOCK_SIZE,ColMajor>>;
+template class LevelOfFillILU<double,int,BUILD_BLOCK_SIZE,
+                              Async_Level_BlockILU0<double,int,BUILD_BLOCK_SIZE,ColMajor>>;
+template class LevelOfFillILU<double,int,BUILD_BLOCK_SIZE,
+                              AsyncBlockILU0_SRPreconditioner<double,int,BUILD_BLOCK_SIZE,RowMajor>>;
+template class LevelOfFillILU<double,int,BUILD_BLOCK_SIZE,
+                              Async_Level_BlockILU0<double,int,BUILD_BLOCK_SIZE,RowMajor>>;
+#endif
+
+}
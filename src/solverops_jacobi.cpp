@@ -8,7 +8,9 @@
 #include <boost/align/aligned_alloc.hpp>
 #include <Eigen/LU>
 #include "solverops_jacobi.hpp"
+#include "structural_cache.hpp"
 #include "kernels/kernels_relaxation.hpp"
+#include "kernels/kernels_multivec.hpp"
 
 namespace blasted {
 
@@ -24,14 +26,19 @@ BJacobiSRPreconditioner<scalar,index,bs,stor>
 template <typename scalar, typename index, int bs, StorageOptions stor>
 BJacobiSRPreconditioner<scalar,index,bs,stor>::~BJacobiSRPreconditioner()
 {
-	boost::alignment::aligned_free(dblocks);
 }
 
 template <typename scalar, typename index, int bs, StorageOptions stor>
 PrecInfo BJacobiSRPreconditioner<scalar,index,bs,stor>::compute()
 {
 	if(!dblocks) {
-		dblocks = (scalar*)aligned_alloc(CACHE_LINE_LEN, mat.nbrows*bs*bs*sizeof(scalar));
+		// instances wrapping the same matrix compute the same inverses, so they share the storage
+		bool created = false;
+		dblockstore = structural_cache().operator_buffer<Blk,scalar>("inverted diagonal blocks",
+			pattern_fingerprint(mat, bs), mat.vals, mat.nbrows*bs*bs, created);
+		dblocks = dblockstore.get();
+		if(created && numasched.active())
+			numasched.first_touch(dblocks, bs*bs, scalar(0));
 #ifdef DEBUG
 		std::cout << " precJacobiSetup(): Allocating.\n";
 #endif
@@ -42,7 +49,7 @@ PrecInfo BJacobiSRPreconditioner<scalar,index,bs,stor>::compute()
 
 #pragma omp parallel for default(shared)
 	for(index irow = 0; irow < mat.nbrows; irow++)
-		dblks[irow] = vals[mat.diagind[irow]].inverse();
+		kernels::block_invert<scalar,bs,stor>(vals[mat.diagind[irow]], dblks[irow]);
 
 	return PrecInfo();
 }
@@ -62,6 +69,23 @@ void BJacobiSRPreconditioner<scalar,index,bs,stor>::apply(const scalar *const rr
 	}
 }
 
+template <typename scalar, typename index, int bs, StorageOptions stor>
+void BJacobiSRPreconditioner<scalar,index,bs,stor>::apply_multi(const int nvecs,
+                                                                const scalar *const rr,
+                                                                scalar *const __restrict zz) const
+{
+	const Blk *dblks = reinterpret_cast<const Blk*>(dblocks);
+
+#pragma omp parallel for default(shared)
+	for(index irow = 0; irow < mat.nbrows; irow++)
+	{
+		scalar *const zblk = zz + irow*bs*nvecs;
+		for(int i = 0; i < bs*nvecs; i++)
+			zblk[i] = 0;
+		kernels::block_panel_gemm_add<scalar,bs,stor>(dblks[irow], rr + irow*bs*nvecs, nvecs, zblk);
+	}
+}
+
 template<typename scalar, typename index, int bs, StorageOptions stor>
 void BJacobiSRPreconditioner<scalar,index,bs,stor>::apply_relax(const scalar *const bb, 
                                                                 scalar *const __restrict xx) const
@@ -129,7 +153,6 @@ JacobiSRPreconditioner<scalar,index>
 template <typename scalar, typename index>
 JacobiSRPreconditioner<scalar,index>::~JacobiSRPreconditioner()
 {
-	boost::alignment::aligned_free(dblocks);
 }
 
 /// Inverts diagonal entries
@@ -150,7 +173,12 @@ template <typename scalar, typename index>
 PrecInfo JacobiSRPreconditioner<scalar,index>::compute()
 {
 	if(!dblocks) {
-		dblocks = (scalar*)boost::alignment::aligned_alloc(CACHE_LINE_LEN,mat.nbrows*sizeof(scalar));
+		bool created = false;
+		dblockstore = structural_cache().operator_buffer<scalar,scalar>("inverted diagonal entries",
+			pattern_fingerprint(mat, 1), mat.vals, mat.nbrows, created);
+		dblocks = dblockstore.get();
+		if(created && numasched.active())
+			numasched.first_touch(dblocks, 1, scalar(0));
 #ifdef DEBUG
 		std::cout << " CSR MatrixView: precJacobiSetup(): Initial setup.\n";
 #endif
@@ -170,6 +198,19 @@ void JacobiSRPreconditioner<scalar,index>::apply(const scalar *const rr,
 		zz[irow] = dblocks[irow] * rr[irow];
 }
 
+template <typename scalar, typename index>
+void JacobiSRPreconditioner<scalar,index>::apply_multi(const int nvecs, const scalar *const rr,
+                                                       scalar *const __restrict zz) const
+{
+#pragma omp parallel for default(shared)
+	for(index irow = 0; irow < mat.nbrows; irow++)
+	{
+#pragma omp simd
+		for(int v = 0; v < nvecs; v++)
+			zz[irow*nvecs+v] = dblocks[irow] * rr[irow*nvecs+v];
+	}
+}
+
 template<typename scalar, typename index>
 void JacobiSRPreconditioner<scalar,index>::apply_relax(const scalar *const bb, 
                                                        scalar *const __restrict xx) const
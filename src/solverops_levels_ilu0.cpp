@@ -18,9 +18,11 @@
  */
 
 #include <iostream>
+#include <chrono>
 #include <boost/align/aligned_alloc.hpp>
 #include "kernels/kernels_ilu_apply.hpp"
 #include "levelschedule.hpp"
+#include "structural_cache.hpp"
 #include "solverops_levels_ilu0.hpp"
 
 namespace blasted {
@@ -48,10 +50,17 @@ Async_Level_BlockILU0<scalar,index,bs,stor>::~Async_Level_BlockILU0()
 template <typename scalar, typename index, int bs, StorageOptions stor>
 PrecInfo Async_Level_BlockILU0<scalar,index,bs,stor>::compute()
 {
-	if(!iluvals)
-		levels = computeLevels(&mat);
+	double structtime = 0;
+	if(!iluvals) {
+		const auto tstart = std::chrono::steady_clock::now();
+		levels = structural_cache().structure<LevelSchedule<index>>("levels",
+			pattern_fingerprint(mat, bs), [this]() { return computeLevels(&mat); });
+		structtime = std::chrono::duration<double>(std::chrono::steady_clock::now()-tstart).count();
+	}
 
-	return AsyncBlockILU0_SRPreconditioner<scalar,index,bs,stor>::compute();
+	PrecInfo pinfo = AsyncBlockILU0_SRPreconditioner<scalar,index,bs,stor>::compute();
+	pinfo.structure_walltime += structtime;
+	return pinfo;
 }
 
 template <typename scalar, typename index, int bs, StorageOptions stor>
@@ -63,7 +72,8 @@ void Async_Level_BlockILU0<scalar,index,bs,stor>::apply(const scalar *const rr,
 	Seg *z = reinterpret_cast<Seg*>(zz);
 	Seg *y = reinterpret_cast<Seg*>(ytemp);
 
-	const index nlevels = static_cast<index>(levels.size())-1;
+	const LevelSets<index>& flvls = levels->forward;
+	const LevelSets<index>& blvls = levels->backward;
 
 	if(usescaling)
 		// initially, z := Sr
@@ -77,21 +87,23 @@ void Async_Level_BlockILU0<scalar,index,bs,stor>::apply(const scalar *const rr,
 			zz[i] = rr[i];
 		}
 
-	for(int ilvl = 0; ilvl < nlevels; ilvl++)
+	for(index ilvl = 0; ilvl < flvls.numLevels(); ilvl++)
 	{
 #pragma omp parallel for default(shared)
-		for(index i = levels[ilvl]; i < levels[ilvl+1]; i++)
+		for(index k = flvls.levelptr[ilvl]; k < flvls.levelptr[ilvl+1]; k++)
 		{
+			const index i = flvls.rows[k];
 			block_unit_lower_triangular<scalar,index,bs,stor>
 				(ilu, mat.bcolind, mat.browptr[i], mat.diagind[i], z[i], i, y);
 		}
 	}
 
-	for(int ilvl = nlevels; ilvl > 0; ilvl--)
+	for(index ilvl = 0; ilvl < blvls.numLevels(); ilvl++)
 	{
 #pragma omp parallel for default(shared)
-		for(index i = levels[ilvl]-1; i >= levels[ilvl-1]; i--)
+		for(index k = blvls.levelptr[ilvl]; k < blvls.levelptr[ilvl+1]; k++)
 		{
+			const index i = blvls.rows[k];
 			block_upper_triangular<scalar,index,bs,stor>
 				(ilu, mat.bcolind, mat.diagind[i], mat.browptr[i+1], y[i], i, z);
 		}
@@ -138,17 +150,25 @@ Async_Level_ILU0<scalar,index>::~Async_Level_ILU0()
 template <typename scalar, typename index>
 PrecInfo Async_Level_ILU0<scalar,index>::compute()
 {
-	if(!iluvals)
-		levels = computeLevels(&mat);
+	double structtime = 0;
+	if(!iluvals) {
+		const auto tstart = std::chrono::steady_clock::now();
+		levels = structural_cache().structure<LevelSchedule<index>>("levels",
+			pattern_fingerprint(mat, 1), [this]() { return computeLevels(&mat); });
+		structtime = std::chrono::duration<double>(std::chrono::steady_clock::now()-tstart).count();
+	}
 
-	return AsyncILU0_SRPreconditioner<scalar,index>::compute();
+	PrecInfo pinfo = AsyncILU0_SRPreconditioner<scalar,index>::compute();
+	pinfo.structure_walltime += structtime;
+	return pinfo;
 }
 
 template <typename scalar, typename index>
 void Async_Level_ILU0<scalar,index>::apply(const scalar *const rr, 
                                            scalar *const __restrict zz) const
 {
-	const index nlevels = static_cast<index>(levels.size())-1;
+	const LevelSets<index>& flvls = levels->forward;
+	const LevelSets<index>& blvls = levels->backward;
 
 	if(usescaling)
 		// initially, z := Sr
@@ -163,21 +183,23 @@ void Async_Level_ILU0<scalar,index>::apply(const scalar *const rr,
 		}
 
 
-	for(int ilvl = 0; ilvl < nlevels; ilvl++)
+	for(index ilvl = 0; ilvl < flvls.numLevels(); ilvl++)
 	{
 #pragma omp parallel for default(shared)
-		for(index i = levels[ilvl]; i < levels[ilvl+1]; i++)
+		for(index k = flvls.levelptr[ilvl]; k < flvls.levelptr[ilvl+1]; k++)
 		{
+			const index i = flvls.rows[k];
 			ytemp[i] = scalar_unit_lower_triangular<scalar,index>(iluvals, mat.bcolind, mat.browptr[i],
 			                                                      mat.diagind[i], zz[i], ytemp);
 		}
 	}
 
-	for(int ilvl = nlevels; ilvl > 0; ilvl--)
+	for(index ilvl = 0; ilvl < blvls.numLevels(); ilvl++)
 	{
 #pragma omp parallel for default(shared)
-		for(index i = levels[ilvl]-1; i >= levels[ilvl-1]; i--)
+		for(index k = blvls.levelptr[ilvl]; k < blvls.levelptr[ilvl+1]; k++)
 		{
+			const index i = blvls.rows[k];
 			zz[i] = scalar_upper_triangular<scalar,index>(iluvals, mat.bcolind, mat.diagind[i],
 			                                              mat.browptr[i+1], 1.0/iluvals[mat.diagind[i]],
 			                                              ytemp[i], zz);
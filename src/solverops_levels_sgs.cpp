@@ -17,10 +17,12 @@
  *   along with BLASTed.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <chrono>
 #include <boost/align/aligned_alloc.hpp>
 #include "kernels/kernels_sgs.hpp"
 #include "kernels/kernels_relaxation.hpp"
 #include "levelschedule.hpp"
+#include "structural_cache.hpp"
 #include "solverops_levels_sgs.hpp"
 
 namespace blasted {
@@ -42,12 +44,21 @@ Level_BSGS<scalar,index,bs,stor>::~Level_BSGS()
 template <typename scalar, typename index, int bs, StorageOptions stor>
 PrecInfo Level_BSGS<scalar,index,bs,stor>::compute()
 {
+	double structtime = 0;
 	if(!ytemp) {
 		ytemp = (scalar*)aligned_alloc(CACHE_LINE_LEN, mat.nbrows*bs*sizeof(scalar));
-		levels = computeLevels(&mat);
+		const auto tstart = std::chrono::steady_clock::now();
+		const PatternFingerprint fp = pattern_fingerprint(mat, bs);
+		levels = structural_cache().structure<LevelSchedule<index>>("levels", fp,
+			[this]() { return computeLevels(&mat); });
+		relaxlevels = structural_cache().structure<LevelSchedule<index>>("in-place levels", fp,
+			[this]() { return computeLevels(&mat, true); });
+		structtime = std::chrono::duration<double>(std::chrono::steady_clock::now()-tstart).count();
 	}
 
-	return BJacobiSRPreconditioner<scalar,index,bs,stor>::compute();
+	PrecInfo pinfo = BJacobiSRPreconditioner<scalar,index,bs,stor>::compute();
+	pinfo.structure_walltime += structtime;
+	return pinfo;
 }
 
 template <typename scalar, typename index, int bs, StorageOptions stor>
@@ -61,25 +72,28 @@ void Level_BSGS<scalar,index,bs,stor>::apply(const scalar *const rr,
 	Seg *z = reinterpret_cast<Seg*>(zz);
 	Seg *y = reinterpret_cast<Seg*>(ytemp);
 
-	const index nlevels = static_cast<index>(levels.size())-1;
+	const LevelSets<index>& flvls = levels->forward;
+	const LevelSets<index>& blvls = levels->backward;
 
 	// forward solve
-	for(index ilvl = 0; ilvl < nlevels; ilvl++)
+	for(index ilvl = 0; ilvl < flvls.numLevels(); ilvl++)
 	{
 #pragma omp parallel for default(shared)
-		for(index irow = levels[ilvl]; irow < levels[ilvl+1]; irow++)
+		for(index k = flvls.levelptr[ilvl]; k < flvls.levelptr[ilvl+1]; k++)
 		{
+			const index irow = flvls.rows[k];
 			kernels::block_fgs<scalar,index,bs,stor>(mvals, mat.bcolind, irow, mat.browptr[irow], 
 			                                         mat.diagind[irow], dblks[irow], r[irow], y);
 		}
 	}
 
 	// backward solve
-	for(index ilvl = nlevels; ilvl >= 1; ilvl--)
+	for(index ilvl = 0; ilvl < blvls.numLevels(); ilvl++)
 	{
 #pragma omp parallel for default(shared)
-		for(index irow = levels[ilvl]-1; irow >= levels[ilvl-1]; irow--)
+		for(index k = blvls.levelptr[ilvl]; k < blvls.levelptr[ilvl+1]; k++)
 		{
+			const index irow = blvls.rows[k];
 			kernels::block_bgs<scalar,index,bs,stor>(mvals, mat.bcolind, irow, mat.diagind[irow],
 			                                         mat.browptr[irow+1], dblks[irow], y[irow], z);
 		}
@@ -97,14 +111,16 @@ void Level_BSGS<scalar,index,bs,stor>::apply_relax(const scalar *const bb,
 	const Seg *x = reinterpret_cast<const Seg*>(xx);
 	Seg *xmut = reinterpret_cast<Seg*>(xx);
 
-	const index nlevels = static_cast<index>(levels.size())-1;
+	const LevelSets<index>& flvls = relaxlevels->forward;
+	const LevelSets<index>& blvls = relaxlevels->backward;
 
 	for(int step = 0; step < solveparams.maxits; step++)
 	{
-		for(index ilvl = 0; ilvl < nlevels; ilvl++) {
+		for(index ilvl = 0; ilvl < flvls.numLevels(); ilvl++) {
 #pragma omp parallel for default(shared)
-			for(index irow = levels[ilvl]; irow < levels[ilvl+1]; irow++)
+			for(index k = flvls.levelptr[ilvl]; k < flvls.levelptr[ilvl+1]; k++)
 			{
+				const index irow = flvls.rows[k];
 				block_relax_kernel<scalar,index,bs,stor>
 					(mvals, mat.bcolind, irow,
 					 mat.browptr[irow], mat.diagind[irow], mat.browptr[irow+1],
@@ -112,10 +128,11 @@ void Level_BSGS<scalar,index,bs,stor>::apply_relax(const scalar *const bb,
 			}
 		}
 
-		for(index ilvl = nlevels; ilvl >= 1; ilvl--) {
+		for(index ilvl = 0; ilvl < blvls.numLevels(); ilvl++) {
 #pragma omp parallel for default(shared)
-			for(index irow = levels[ilvl]-1; irow >= levels[ilvl-1]; irow--)
+			for(index k = blvls.levelptr[ilvl]; k < blvls.levelptr[ilvl+1]; k++)
 			{
+				const index irow = blvls.rows[k];
 				block_relax_kernel<scalar,index,bs,stor>
 					(mvals, mat.bcolind, irow,
 					 mat.browptr[irow], mat.diagind[irow], mat.browptr[irow+1],
@@ -148,26 +165,37 @@ Level_SGS<scalar,index>::~Level_SGS()
 template <typename scalar, typename index>
 PrecInfo Level_SGS<scalar,index>::compute()
 {
+	double structtime = 0;
 	if(!ytemp) {
 		ytemp = (scalar*)aligned_alloc(CACHE_LINE_LEN, mat.nbrows*sizeof(scalar));
-		levels = computeLevels(&mat);
+		const auto tstart = std::chrono::steady_clock::now();
+		const PatternFingerprint fp = pattern_fingerprint(mat, 1);
+		levels = structural_cache().structure<LevelSchedule<index>>("levels", fp,
+			[this]() { return computeLevels(&mat); });
+		relaxlevels = structural_cache().structure<LevelSchedule<index>>("in-place levels", fp,
+			[this]() { return computeLevels(&mat, true); });
+		structtime = std::chrono::duration<double>(std::chrono::steady_clock::now()-tstart).count();
 	}
 
-	return JacobiSRPreconditioner<scalar,index>::compute();
+	PrecInfo pinfo = JacobiSRPreconditioner<scalar,index>::compute();
+	pinfo.structure_walltime += structtime;
+	return pinfo;
 }
 
 template <typename scalar, typename index>
 void Level_SGS<scalar,index>::apply(const scalar *const rr,
                                     scalar *const __restrict zz) const
 {
-	const index nlevels = static_cast<index>(levels.size())-1;
+	const LevelSets<index>& flvls = levels->forward;
+	const LevelSets<index>& blvls = levels->backward;
 
 	// forward solve
-	for(index ilvl = 0; ilvl < nlevels; ilvl++)
+	for(index ilvl = 0; ilvl < flvls.numLevels(); ilvl++)
 	{
 #pragma omp parallel for default(shared)
-		for(index irow = levels[ilvl]; irow < levels[ilvl+1]; irow++)
+		for(index k = flvls.levelptr[ilvl]; k < flvls.levelptr[ilvl+1]; k++)
 		{
+			const index irow = flvls.rows[k];
 			ytemp[irow] = kernels::scalar_fgs(mat.vals, mat.bcolind,
 			                                  mat.browptr[irow], mat.diagind[irow],
 			                                  dblocks[irow], rr[irow], ytemp);
@@ -175,11 +203,12 @@ void Level_SGS<scalar,index>::apply(const scalar *const rr,
 	}
 
 	// backward solve
-	for(index ilvl = nlevels; ilvl >= 1; ilvl--)
+	for(index ilvl = 0; ilvl < blvls.numLevels(); ilvl++)
 	{
 #pragma omp parallel for default(shared)
-		for(index irow = levels[ilvl]-1; irow >= levels[ilvl-1]; irow--)
+		for(index k = blvls.levelptr[ilvl]; k < blvls.levelptr[ilvl+1]; k++)
 		{
+			const index irow = blvls.rows[k];
 			zz[irow] = kernels::scalar_bgs(mat.vals, mat.bcolind,
 			                               mat.diagind[irow], mat.browptr[irow+1],
 			                               mat.vals[mat.diagind[irow]], dblocks[irow],
@@ -192,14 +221,16 @@ template <typename scalar, typename index>
 void Level_SGS<scalar,index>::apply_relax(const scalar *const b,
                                           scalar *const __restrict x) const
 {
-	const index nlevels = static_cast<index>(levels.size())-1;
+	const LevelSets<index>& flvls = relaxlevels->forward;
+	const LevelSets<index>& blvls = relaxlevels->backward;
 
 	for(int step = 0; step < solveparams.maxits; step++)
 	{
-		for(index ilvl = 0; ilvl < nlevels; ilvl++) {
+		for(index ilvl = 0; ilvl < flvls.numLevels(); ilvl++) {
 #pragma omp parallel for default(shared)
-			for(index irow = levels[ilvl]; irow < levels[ilvl+1]; irow++)
+			for(index k = flvls.levelptr[ilvl]; k < flvls.levelptr[ilvl+1]; k++)
 			{
+				const index irow = flvls.rows[k];
 				x[irow] = scalar_relax<scalar,index>
 					(mat.vals, mat.bcolind,
 					 mat.browptr[irow], mat.diagind[irow], mat.browptr[irow+1],
@@ -207,10 +238,11 @@ void Level_SGS<scalar,index>::apply_relax(const scalar *const b,
 			}
 		}
 
-		for(index ilvl = nlevels; ilvl >= 1; ilvl--) {
+		for(index ilvl = 0; ilvl < blvls.numLevels(); ilvl++) {
 #pragma omp parallel for default(shared)
-			for(index irow = levels[ilvl]-1; irow >= levels[ilvl-1]; irow--)
+			for(index k = blvls.levelptr[ilvl]; k < blvls.levelptr[ilvl+1]; k++)
 			{
+				const index irow = blvls.rows[k];
 				x[irow] = scalar_relax<scalar,index>
 					(mat.vals, mat.bcolind, 
 					 mat.browptr[irow], mat.diagind[irow], mat.browptr[irow+1],
@@ -0,0 +1,469 @@
+/** \file solverops_mixedprec.cpp
+ * \brief Implementation of preconditioners that store their factors in a lower precision
+ * \author Aditya Kashi
+ *
+ * This file is part of BLASTed.
+ *   BLASTed is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   BLASTed is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with BLASTed.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <new>
+#include <stdexcept>
+#include <boost/align/aligned_alloc.hpp>
+#include "solverops_mixedprec.hpp"
+#include "async_sweeps.hpp"
+#include "kernels/kernels_mixedprec.hpp"
+
+namespace blasted {
+
+using boost::alignment::aligned_alloc;
+using boost::alignment::aligned_free;
+
+/// Copies an array into lower-precision storage, allocating the latter the first time
+template <typename scalar, typename lscalar, typename index>
+static void copy_to_lowprec(const scalar *const src, const index n, lscalar *& dst)
+{
+	if(!dst)
+		dst = (lscalar*)aligned_alloc(CACHE_LINE_LEN, n*sizeof(lscalar));
+
+#pragma omp parallel for simd default(shared)
+	for(index i = 0; i < n; i++)
+		dst[i] = static_cast<lscalar>(src[i]);
+}
+
+template <typename scalar, typename lscalar, typename index, int bs, StorageOptions stor>
+MixedPrecBJacobiPreconditioner<scalar,lscalar,index,bs,stor>
+::MixedPrecBJacobiPreconditioner(SRMatrixStorage<const scalar, const index>&& matrix)
+	: BJacobiSRPreconditioner<scalar,index,bs,stor>(std::move(matrix)), ldblocks{nullptr}
+{ }
+
+template <typename scalar, typename lscalar, typename index, int bs, StorageOptions stor>
+MixedPrecBJacobiPreconditioner<scalar,lscalar,index,bs,stor>::~MixedPrecBJacobiPreconditioner()
+{
+	aligned_free(ldblocks);
+}
+
+template <typename scalar, typename lscalar, typename index, int bs, StorageOptions stor>
+PrecInfo MixedPrecBJacobiPreconditioner<scalar,lscalar,index,bs,stor>::compute()
+{
+	const PrecInfo pinfo = BJacobiSRPreconditioner<scalar,index,bs,stor>::compute();
+	copy_to_lowprec(dblocks, mat.nbrows*bs*bs, ldblocks);
+	return pinfo;
+}
+
+template <typename scalar, typename lscalar, typename index, int bs, StorageOptions stor>
+void MixedPrecBJacobiPreconditioner<scalar,lscalar,index,bs,stor>
+::apply(const scalar *const rr, scalar *const __restrict zz) const
+{
+	const Block_t<lscalar,bs,stor> *dblks = reinterpret_cast<const Block_t<lscalar,bs,stor>*>(ldblocks);
+	const Segment_t<scalar,bs> *r = reinterpret_cast<const Segment_t<scalar,bs>*>(rr);
+	Segment_t<scalar,bs> *z = reinterpret_cast<Segment_t<scalar,bs>*>(zz);
+
+#pragma omp parallel for default(shared)
+	for(index irow = 0; irow < mat.nbrows; irow++)
+		kernels::block_gemv_lp<scalar,lscalar,bs,stor>(dblks[irow], r[irow], z[irow]);
+}
+
+template <typename scalar, typename lscalar, typename index>
+MixedPrecJacobiPreconditioner<scalar,lscalar,index>
+::MixedPrecJacobiPreconditioner(SRMatrixStorage<const scalar, const index>&& matrix)
+	: JacobiSRPreconditioner<scalar,index>(std::move(matrix)), ldblocks{nullptr}
+{ }
+
+template <typename scalar, typename lscalar, typename index>
+MixedPrecJacobiPreconditioner<scalar,lscalar,index>::~MixedPrecJacobiPreconditioner()
+{
+	aligned_free(ldblocks);
+}
+
+template <typename scalar, typename lscalar, typename index>
+PrecInfo MixedPrecJacobiPreconditioner<scalar,lscalar,index>::compute()
+{
+	const PrecInfo pinfo = JacobiSRPreconditioner<scalar,index>::compute();
+	copy_to_lowprec(dblocks, mat.nbrows, ldblocks);
+	return pinfo;
+}
+
+template <typename scalar, typename lscalar, typename index>
+void MixedPrecJacobiPreconditioner<scalar,lscalar,index>::apply(const scalar *const rr,
+                                                               scalar *const __restrict zz) const
+{
+#pragma omp parallel for simd default(shared)
+	for(index irow = 0; irow < mat.nbrows; irow++)
+		zz[irow] = static_cast<scalar>(ldblocks[irow]) * rr[irow];
+}
+
+template <typename scalar, typename lscalar, typename index, int bs, StorageOptions stor>
+MixedPrecAsyncBlockSGSPreconditioner<scalar,lscalar,index,bs,stor>
+::MixedPrecAsyncBlockSGSPreconditioner(SRMatrixStorage<const scalar, const index>&& matrix,
+                                       const int naswps, const ApplyInit apply_inittype,
+                                       const int threadchunksize, const bool lowprec_matrix)
+	: AsyncBlockSGS_SRPreconditioner<scalar,index,bs,stor>(std::move(matrix), naswps, apply_inittype,
+	                                                       threadchunksize),
+	  lowprecmatrix{lowprec_matrix}, ldblocks{nullptr}, lvals{nullptr}
+{ }
+
+template <typename scalar, typename lscalar, typename index, int bs, StorageOptions stor>
+MixedPrecAsyncBlockSGSPreconditioner<scalar,lscalar,index,bs,stor>
+::~MixedPrecAsyncBlockSGSPreconditioner()
+{
+	aligned_free(ldblocks);
+	aligned_free(lvals);
+}
+
+template <typename scalar, typename lscalar, typename index, int bs, StorageOptions stor>
+PrecInfo MixedPrecAsyncBlockSGSPreconditioner<scalar,lscalar,index,bs,stor>::compute()
+{
+	const PrecInfo pinfo = AsyncBlockSGS_SRPreconditioner<scalar,index,bs,stor>::compute();
+	copy_to_lowprec(dblocks, mat.nbrows*bs*bs, ldblocks);
+	if(lowprecmatrix)
+		copy_to_lowprec(mat.vals, mat.browptr[mat.nbrows]*bs*bs, lvals);
+	return pinfo;
+}
+
+template <typename scalar, typename lscalar, typename index, int bs, StorageOptions stor>
+template <typename vscalar>
+void MixedPrecAsyncBlockSGSPreconditioner<scalar,lscalar,index,bs,stor>
+::apply_sweeps(const vscalar *const vals, const scalar *const rr, scalar *const __restrict zz) const
+{
+	const Block_t<vscalar,bs,stor> *mvals = reinterpret_cast<const Block_t<vscalar,bs,stor>*>(vals);
+	const Block_t<lscalar,bs,stor> *dblks = reinterpret_cast<const Block_t<lscalar,bs,stor>*>(ldblocks);
+	const Segment_t<scalar,bs> *r = reinterpret_cast<const Segment_t<scalar,bs>*>(rr);
+	Segment_t<scalar,bs> *z = reinterpret_cast<Segment_t<scalar,bs>*>(zz);
+	Segment_t<scalar,bs> *y = reinterpret_cast<Segment_t<scalar,bs>*>(ytemp);
+
+	const AsyncSweepEngine<index> eng(mat.nbrows, thread_chunk_size, &numasched);
+	eng.run(true, [&]() {
+		if(ainit == INIT_A_JACOBI || ainit == INIT_A_ZERO)
+			eng.rows([this](const index start, const index end) {
+#pragma omp simd
+				for(index i = start*bs; i < end*bs; i++)
+					ytemp[i] = 0;
+			});
+
+		// forward sweep ytemp := D^(-1) (r - L ytemp)
+		eng.sync();
+		eng.forward(napplysweeps, [&](const index irow) {
+			kernels::block_fgs_lp<scalar,vscalar,lscalar,index,bs,stor>
+				(mvals, mat.bcolind, irow, mat.browptr[irow], mat.diagind[irow], dblks[irow],
+				 r[irow], y);
+		});
+
+		eng.sync();
+		if(ainit == INIT_A_JACOBI || ainit == INIT_A_ZERO)
+			eng.rows([this,zz](const index start, const index end) {
+				for(index i = start*bs; i < end*bs; i++)
+					zz[i] = (ainit == INIT_A_JACOBI) ? ytemp[i] : scalar(0);
+			});
+
+		// backward sweep z := D^(-1) (D y - U z)
+		eng.sync();
+		eng.backward(napplysweeps, [&](const index irow) {
+			kernels::block_bgs_lp<scalar,vscalar,lscalar,index,bs,stor>
+				(mvals, mat.bcolind, irow, mat.diagind[irow], mat.browptr[irow+1], dblks[irow],
+				 y[irow], z);
+		});
+	});
+}
+
+template <typename scalar, typename lscalar, typename index, int bs, StorageOptions stor>
+void MixedPrecAsyncBlockSGSPreconditioner<scalar,lscalar,index,bs,stor>
+::apply(const scalar *const rr, scalar *const __restrict zz) const
+{
+	if(lowprecmatrix)
+		apply_sweeps(lvals, rr, zz);
+	else
+		apply_sweeps(mat.vals, rr, zz);
+}
+
+template <typename scalar, typename lscalar, typename index>
+MixedPrecAsyncSGSPreconditioner<scalar,lscalar,index>
+::MixedPrecAsyncSGSPreconditioner(SRMatrixStorage<const scalar, const index>&& matrix,
+                                  const int naswps, const ApplyInit apply_inittype,
+                                  const int threadchunksize, const bool lowprec_matrix)
+	: AsyncSGS_SRPreconditioner<scalar,index>(std::move(matrix), naswps, apply_inittype,
+	                                          threadchunksize),
+	  lowprecmatrix{lowprec_matrix}, ldblocks{nullptr}, lvals{nullptr}
+{ }
+
+template <typename scalar, typename lscalar, typename index>
+MixedPrecAsyncSGSPreconditioner<scalar,lscalar,index>::~MixedPrecAsyncSGSPreconditioner()
+{
+	aligned_free(ldblocks);
+	aligned_free(lvals);
+}
+
+template <typename scalar, typename lscalar, typename index>
+PrecInfo MixedPrecAsyncSGSPreconditioner<scalar,lscalar,index>::compute()
+{
+	const PrecInfo pinfo = AsyncSGS_SRPreconditioner<scalar,index>::compute();
+	copy_to_lowprec(dblocks, mat.nbrows, ldblocks);
+	if(lowprecmatrix)
+		copy_to_lowprec(mat.vals, mat.browptr[mat.nbrows], lvals);
+	return pinfo;
+}
+
+template <typename scalar, typename lscalar, typename index>
+template <typename vscalar>
+void MixedPrecAsyncSGSPreconditioner<scalar,lscalar,index>
+::apply_sweeps(const vscalar *const vals, const scalar *const rr, scalar *const __restrict zz) const
+{
+	const AsyncSweepEngine<index> eng(mat.nbrows, thread_chunk_size, &numasched);
+	eng.run(true, [&]() {
+		if(ainit == INIT_A_JACOBI || ainit == INIT_A_ZERO)
+			eng.rows([this](const index start, const index end) {
+#pragma omp simd
+				for(index i = start; i < end; i++)
+					ytemp[i] = 0;
+			});
+
+		// forward sweep ytemp := D^(-1) (r - L ytemp)
+		eng.sync();
+		eng.forward(napplysweeps, [&](const index irow) {
+			ytemp[irow] = kernels::scalar_fgs_lp(vals, mat.bcolind, mat.browptr[irow],
+			                                     mat.diagind[irow], ldblocks[irow], rr[irow], ytemp);
+		});
+
+		eng.sync();
+		if(ainit == INIT_A_JACOBI || ainit == INIT_A_ZERO)
+			eng.rows([this,zz](const index start, const index end) {
+				for(index i = start; i < end; i++)
+					zz[i] = (ainit == INIT_A_JACOBI) ? ytemp[i] : scalar(0);
+			});
+
+		// backward sweep z := D^(-1) (D y - U z)
+		eng.sync();
+		eng.backward(napplysweeps, [&](const index irow) {
+			zz[irow] = kernels::scalar_bgs_lp(vals, mat.bcolind, mat.diagind[irow],
+			                                  mat.browptr[irow+1], ldblocks[irow], ytemp[irow], zz);
+		});
+	});
+}
+
+template <typename scalar, typename lscalar, typename index>
+void MixedPrecAsyncSGSPreconditioner<scalar,lscalar,index>::apply(const scalar *const rr,
+                                                                 scalar *const __restrict zz) const
+{
+	if(lowprecmatrix)
+		apply_sweeps(lvals, rr, zz);
+	else
+		apply_sweeps(mat.vals, rr, zz);
+}
+
+template <typename scalar, typename lscalar, typename index, int bs, StorageOptions stor>
+MixedPrecAsyncBlockILU0Preconditioner<scalar,lscalar,index,bs,stor>
+::MixedPrecAsyncBlockILU0Preconditioner(SRMatrixStorage<const scalar, const index>&& matrix,
+                                        const int nbuildswp, const int napplyswp, const bool uscl,
+                                        const int tcs, const FactInit finit, const ApplyInit ainit,
+                                        const bool tf, const bool ta, const bool comp_rem)
+	: AsyncBlockILU0_SRPreconditioner<scalar,index,bs,stor>(std::move(matrix), nbuildswp, napplyswp,
+	                                                        uscl, tcs, finit, ainit, tf, ta, comp_rem),
+	  liluvals{nullptr}
+{ }
+
+template <typename scalar, typename lscalar, typename index, int bs, StorageOptions stor>
+MixedPrecAsyncBlockILU0Preconditioner<scalar,lscalar,index,bs,stor>
+::~MixedPrecAsyncBlockILU0Preconditioner()
+{
+	aligned_free(liluvals);
+}
+
+template <typename scalar, typename lscalar, typename index, int bs, StorageOptions stor>
+PrecInfo MixedPrecAsyncBlockILU0Preconditioner<scalar,lscalar,index,bs,stor>::compute()
+{
+	// without a warm start, the working-precision factors are only needed during the factorization
+	const bool keepfactors = (factinittype == INIT_F_NONE);
+	if(!keepfactors && liluvals) {
+		iluvals = (scalar*)aligned_alloc(CACHE_LINE_LEN, mat.browptr[mat.nbrows]*bs*bs*sizeof(scalar));
+		if(!iluvals)
+			throw std::bad_alloc();
+	}
+
+	const PrecInfo pinfo = AsyncBlockILU0_SRPreconditioner<scalar,index,bs,stor>::compute();
+	copy_to_lowprec(iluvals, mat.browptr[mat.nbrows]*bs*bs, liluvals);
+
+	if(!keepfactors) {
+		aligned_free(iluvals);
+		iluvals = nullptr;
+	}
+	return pinfo;
+}
+
+template <typename scalar, typename lscalar, typename index, int bs, StorageOptions stor>
+void MixedPrecAsyncBlockILU0Preconditioner<scalar,lscalar,index,bs,stor>
+::apply(const scalar *const rr, scalar *const __restrict zz) const
+{
+	const Block_t<lscalar,bs,stor> *ilu = reinterpret_cast<const Block_t<lscalar,bs,stor>*>(liluvals);
+	Segment_t<scalar,bs> *z = reinterpret_cast<Segment_t<scalar,bs>*>(zz);
+	Segment_t<scalar,bs> *y = reinterpret_cast<Segment_t<scalar,bs>*>(ytemp);
+
+	if(applyinittype != INIT_A_JACOBI && applyinittype != INIT_A_ZERO)
+		throw std::runtime_error(" MixedPrecAsyncBlockILU0: Invalid init type!");
+
+	const AsyncSweepEngine<index> eng(mat.nbrows, thread_chunk_size, &numasched);
+	eng.run(threadedapply, [&]() {
+		// initially, z := Sr
+		eng.rows([&](const index start, const index end) {
+#pragma omp simd
+			for(index i = start*bs; i < end*bs; i++) {
+				zz[i] = scale ? scale[i]*rr[i] : rr[i];
+				ytemp[i] = 0;
+			}
+		});
+
+		// solves Ly = Sr by asynchronous Jacobi iterations
+		eng.sync();
+		eng.forward(napplysweeps, [&](const index i) {
+			kernels::block_unit_lower_triangular_lp<scalar,lscalar,index,bs,stor>
+				(ilu, mat.bcolind, mat.browptr[i], mat.diagind[i], z[i], i, y);
+		});
+
+		eng.sync();
+		eng.rows([&](const index start, const index end) {
+			for(index i = start*bs; i < end*bs; i++)
+				zz[i] = (applyinittype == INIT_A_JACOBI) ? ytemp[i] : scalar(0);
+		});
+
+		// solves Uz = y by asynchronous Jacobi iteration
+		eng.sync();
+		eng.backward(napplysweeps, [&](const index i) {
+			kernels::block_upper_triangular_lp<scalar,lscalar,index,bs,stor>
+				(ilu, mat.bcolind, mat.diagind[i], mat.browptr[i+1], y[i], i, z);
+		});
+
+		if(scale) {
+			eng.sync();
+			eng.rows([&](const index start, const index end) {
+#pragma omp simd
+				for(index i = start*bs; i < end*bs; i++)
+					zz[i] = zz[i]*scale[i];
+			});
+		}
+	});
+}
+
+template <typename scalar, typename lscalar, typename index>
+MixedPrecAsyncILU0Preconditioner<scalar,lscalar,index>
+::MixedPrecAsyncILU0Preconditioner(SRMatrixStorage<const scalar, const index>&& matrix,
+                                   const int nbuildswp, const int napplyswp, const bool uscal,
+                                   const int tcs, const FactInit fi, const ApplyInit ai,
+                                   const bool compute_preconditioner_info,
+                                   const bool tf, const bool ta)
+	: AsyncILU0_SRPreconditioner<scalar,index>(std::move(matrix), nbuildswp, napplyswp, uscal, tcs,
+	                                           fi, ai, compute_preconditioner_info, tf, ta),
+	  liluvals{nullptr}
+{ }
+
+template <typename scalar, typename lscalar, typename index>
+MixedPrecAsyncILU0Preconditioner<scalar,lscalar,index>::~MixedPrecAsyncILU0Preconditioner()
+{
+	aligned_free(liluvals);
+}
+
+template <typename scalar, typename lscalar, typename index>
+PrecInfo MixedPrecAsyncILU0Preconditioner<scalar,lscalar,index>::compute()
+{
+	// without a warm start, the working-precision factors are only needed during the factorization
+	const bool keepfactors = (factinittype == INIT_F_NONE);
+	if(!keepfactors && liluvals) {
+		iluvals = (scalar*)aligned_alloc(CACHE_LINE_LEN, mat.browptr[mat.nbrows]*sizeof(scalar));
+		if(!iluvals)
+			throw std::bad_alloc();
+	}
+
+	const PrecInfo pinfo = AsyncILU0_SRPreconditioner<scalar,index>::compute();
+	copy_to_lowprec(iluvals, mat.browptr[mat.nbrows], liluvals);
+
+	if(!keepfactors) {
+		aligned_free(iluvals);
+		iluvals = nullptr;
+	}
+	return pinfo;
+}
+
+template <typename scalar, typename lscalar, typename index>
+void MixedPrecAsyncILU0Preconditioner<scalar,lscalar,index>::apply(const scalar *const ra,
+                                                                  scalar *const __restrict za) const
+{
+	if(applyinittype != INIT_A_JACOBI && applyinittype != INIT_A_ZERO)
+		throw std::runtime_error(" MixedPrecAsyncILU0: Invalid init type!");
+
+	const AsyncSweepEngine<index> eng(mat.nbrows, thread_chunk_size, &numasched);
+	eng.run(threadedapply, [&]() {
+		// initially, z := Sr
+		eng.rows([&](const index start, const index end) {
+#pragma omp simd
+			for(index i = start; i < end; i++) {
+				za[i] = scale ? scale[i]*ra[i] : ra[i];
+				ytemp[i] = 0;
+			}
+		});
+
+		// solves Ly = Sr by asynchronous Jacobi iterations
+		eng.sync();
+		eng.forward(napplysweeps, [&](const index i) {
+			ytemp[i] = kernels::scalar_unit_lower_triangular_lp(liluvals, mat.bcolind, mat.browptr[i],
+			                                                    mat.diagind[i], za[i], ytemp);
+		});
+
+		eng.sync();
+		eng.rows([&](const index start, const index end) {
+			for(index i = start; i < end; i++)
+				za[i] = (applyinittype == INIT_A_JACOBI) ? ytemp[i] : scalar(0);
+		});
+
+		// solves Uz = y by asynchronous Jacobi iteration
+		eng.sync();
+		eng.backward(napplysweeps, [&](const index i) {
+			const scalar dinv = 1/static_cast<scalar>(liluvals[mat.diagind[i]]);
+			za[i] = kernels::scalar_upper_triangular_lp(liluvals, mat.bcolind, mat.diagind[i],
+			                                            mat.browptr[i+1], dinv, ytemp[i], za);
+		});
+
+		if(scale) {
+			eng.sync();
+			eng.rows([&](const index start, const index end) {
+#pragma omp simd
+				for(index i = start; i < end; i++)
+					za[i] = za[i]*scale[i];
+			});
+		}
+	});
+}
+
+// instantiations
+
+template class MixedPrecJacobiPreconditioner<double,float,int>;
+template class MixedPrecAsyncSGSPreconditioner<double,float,int>;
+template class MixedPrecAsyncILU0Preconditioner<double,float,int>;
+
+template class MixedPrecBJacobiPreconditioner<double,float,int,4,ColMajor>;
+template class MixedPrecBJacobiPreconditioner<double,float,int,5,ColMajor>;
+template class MixedPrecBJacobiPreconditioner<double,float,int,4,RowMajor>;
+template class MixedPrecAsyncBlockSGSPreconditioner<double,float,int,4,ColMajor>;
+template class MixedPrecAsyncBlockSGSPreconditioner<double,float,int,5,ColMajor>;
+template class MixedPrecAsyncBlockSGSPreconditioner<double,float,int,4,RowMajor>;
+template class MixedPrecAsyncBlockILU0Preconditioner<double,float,int,4,ColMajor>;
+template class MixedPrecAsyncBlockILU0Preconditioner<double,float,int,5,ColMajor>;
+template class MixedPrecAsyncBlockILU0Preconditioner<double,float,int,4,RowMajor>;
+
+#ifdef BUILD_BLOCK_SIZE
+template class MixedPrecBJacobiPreconditioner<double,float,int,BUILD_BLOCK_SIZE,ColMajor>;
+template class MixedPrecBJacobiPreconditioner<double,float,int,BUILD_BLOCK_SIZE,RowMajor>;
+template class MixedPrecAsyncBlockSGSPreconditioner<double,float,int,BUILD_BLOCK_SIZE,ColMajor>;
+template class MixedPrecAsyncBlockSGSPreconditioner<double,float,int,BUILD_BLOCK_SIZE,RowMajor>;
+template class MixedPrecAsyncBlockILU0Preconditioner<double,float,int,BUILD_BLOCK_SIZE,ColMajor>;
+template class MixedPrecAsyncBlockILU0Preconditioner<double,float,int,BUILD_BLOCK_SIZE,RowMajor>;
+#endif
+
+}
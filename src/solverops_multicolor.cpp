@@ -0,0 +1,455 @@
+/** \file
+ * \brief Implementation of multicolor Gauss-Seidel and ILU(0) iterations
+ * \author Aditya Kashi
+ *
+ * This file is part of BLASTed.
+ *   BLASTed is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   BLASTed is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with BLASTed.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <chrono>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <boost/align/aligned_alloc.hpp>
+#include "kernels/kernels_relaxation.hpp"
+#include "kernels/kernels_ilu0_factorize.hpp"
+#include "kernels/kernels_ilu_apply.hpp"
+#include "reorderingscaling.hpp"
+#include "structural_cache.hpp"
+#include "solverops_multicolor.hpp"
+
+namespace blasted {
+
+using boost::alignment::aligned_alloc;
+using boost::alignment::aligned_free;
+
+/// Returns the coloring of the rows of a matrix, computing it only if no instance having the same
+///  sparsity pattern has done so
+template <typename scalar, typename index>
+static std::shared_ptr<const LevelSets<index>>
+cached_coloring(const CRawBSRMatrix<scalar,index>& mat, const int bs, const int distance,
+                const bool balanced)
+{
+	const std::string kind = std::string(balanced ? "balanced " : "") + "distance-"
+		+ std::to_string(distance) + " coloring";
+	return structural_cache().structure<LevelSets<index>>(kind, pattern_fingerprint(mat, bs),
+		[&mat,distance,balanced]() { return computeColoring(mat, distance, balanced); });
+}
+
+/// Returns an immutable raw view of a matrix
+template <typename scalar, typename index>
+static CRawBSRMatrix<scalar,index> raw_view(const SRMatrixStorage<scalar,index>& smat)
+{
+	return CRawBSRMatrix<scalar,index>(&smat.browptr[0], &smat.bcolind[0], &smat.vals[0],
+	                                   &smat.diagind[0], &smat.browendptr[0], smat.nbrows,
+	                                   smat.nnzb, smat.nbstored);
+}
+
+template <typename scalar, typename index, int bs, StorageOptions stor>
+Multicolor_BSGS<scalar,index,bs,stor>::Multicolor_BSGS(SRMatrixStorage<const scalar,const index>&& matrix,
+                                                       const int color_distance,
+                                                       const bool balanced_colors)
+	: BJacobiSRPreconditioner<scalar,index,bs,stor>(std::move(matrix)),
+	  colordist{color_distance}, balancedcolors{balanced_colors}
+{ }
+
+template <typename scalar, typename index, int bs, StorageOptions stor>
+PrecInfo Multicolor_BSGS<scalar,index,bs,stor>::compute()
+{
+	double structtime = 0;
+	if(!colors) {
+		const auto tstart = std::chrono::steady_clock::now();
+		colors = cached_coloring(mat, bs, colordist, balancedcolors);
+		structtime = std::chrono::duration<double>(std::chrono::steady_clock::now()-tstart).count();
+	}
+
+	PrecInfo pinfo = BJacobiSRPreconditioner<scalar,index,bs,stor>::compute();
+	pinfo.structure_walltime += structtime;
+	return pinfo;
+}
+
+/** All sweeps take place in one parallel region, with a barrier only after each color. The last
+ * color of a forward sweep is not repeated by the following backward sweep, as its neighbors have
+ * not changed in between.
+ */
+template <typename scalar, typename index, int bs, StorageOptions stor>
+void Multicolor_BSGS<scalar,index,bs,stor>::sweeps(const Seg *const b, Seg *const xmut,
+                                                   const int nsweeps) const
+{
+	const Blk *mvals = reinterpret_cast<const Blk*>(mat.vals);
+	const Blk *dblks = reinterpret_cast<const Blk*>(dblocks);
+	const Seg *x = xmut;
+	const LevelSets<index>& clrs = *colors;
+	const index ncolors = clrs.numLevels();
+
+#pragma omp parallel default(shared)
+	for(int step = 0; step < nsweeps; step++)
+	{
+		for(index icolor = 0; icolor < ncolors; icolor++) {
+#pragma omp for
+			for(index k = clrs.levelptr[icolor]; k < clrs.levelptr[icolor+1]; k++)
+			{
+				const index irow = clrs.rows[k];
+				block_relax_kernel<scalar,index,bs,stor>
+					(mvals, mat.bcolind, irow,
+					 mat.browptr[irow], mat.diagind[irow], mat.browptr[irow+1],
+					 dblks[irow], b[irow], x, x, xmut[irow]);
+			}
+		}
+
+		for(index icolor = ncolors-2; icolor >= 0; icolor--) {
+#pragma omp for
+			for(index k = clrs.levelptr[icolor]; k < clrs.levelptr[icolor+1]; k++)
+			{
+				const index irow = clrs.rows[k];
+				block_relax_kernel<scalar,index,bs,stor>
+					(mvals, mat.bcolind, irow,
+					 mat.browptr[irow], mat.diagind[irow], mat.browptr[irow+1],
+					 dblks[irow], b[irow], x, x, xmut[irow]);
+			}
+		}
+	}
+}
+
+/** One symmetric sweep starting from zero gives the SGS preconditioner in the color ordering.
+ */
+template <typename scalar, typename index, int bs, StorageOptions stor>
+void Multicolor_BSGS<scalar,index,bs,stor>::apply(const scalar *const rr,
+                                                  scalar *const __restrict zz) const
+{
+#pragma omp parallel for simd default(shared)
+	for(index i = 0; i < mat.nbrows*bs; i++)
+		zz[i] = 0;
+
+	sweeps(reinterpret_cast<const Seg*>(rr), reinterpret_cast<Seg*>(zz), 1);
+}
+
+template <typename scalar, typename index, int bs, StorageOptions stor>
+void Multicolor_BSGS<scalar,index,bs,stor>::apply_relax(const scalar *const bb,
+                                                        scalar *const __restrict xx) const
+{
+	sweeps(reinterpret_cast<const Seg*>(bb), reinterpret_cast<Seg*>(xx), solveparams.maxits);
+}
+
+template class Multicolor_BSGS<double,int,4,ColMajor>;
+template class Multicolor_BSGS<double,int,5,ColMajor>;
+template class Multicolor_BSGS<double,int,4,RowMajor>;
+
+#ifdef BUILD_BLOCK_SIZE
+template class Multicolor_BSGS<double,int,BUILD_BLOCK_SIZE,ColMajor>;
+template class Multicolor_BSGS<double,int,BUILD_BLOCK_SIZE,RowMajor>;
+#endif
+
+template <typename scalar, typename index>
+Multicolor_SGS<scalar,index>::Multicolor_SGS(SRMatrixStorage<const scalar,const index>&& matrix,
+                                             const int color_distance, const bool balanced_colors)
+	: JacobiSRPreconditioner<scalar,index>(std::move(matrix)),
+	  colordist{color_distance}, balancedcolors{balanced_colors}
+{ }
+
+template <typename scalar, typename index>
+PrecInfo Multicolor_SGS<scalar,index>::compute()
+{
+	double structtime = 0;
+	if(!colors) {
+		const auto tstart = std::chrono::steady_clock::now();
+		colors = cached_coloring(mat, 1, colordist, balancedcolors);
+		structtime = std::chrono::duration<double>(std::chrono::steady_clock::now()-tstart).count();
+	}
+
+	PrecInfo pinfo = JacobiSRPreconditioner<scalar,index>::compute();
+	pinfo.structure_walltime += structtime;
+	return pinfo;
+}
+
+template <typename scalar, typename index>
+void Multicolor_SGS<scalar,index>::sweeps(const scalar *const b, scalar *const x,
+                                          const int nsweeps) const
+{
+	const LevelSets<index>& clrs = *colors;
+	const index ncolors = clrs.numLevels();
+
+#pragma omp parallel default(shared)
+	for(int step = 0; step < nsweeps; step++)
+	{
+		for(index icolor = 0; icolor < ncolors; icolor++) {
+#pragma omp for
+			for(index k = clrs.levelptr[icolor]; k < clrs.levelptr[icolor+1]; k++)
+			{
+				const index irow = clrs.rows[k];
+				x[irow] = scalar_relax<scalar,index>
+					(mat.vals, mat.bcolind,
+					 mat.browptr[irow], mat.diagind[irow], mat.browptr[irow+1],
+					 dblocks[irow], b[irow], x, x);
+			}
+		}
+
+		for(index icolor = ncolors-2; icolor >= 0; icolor--) {
+#pragma omp for
+			for(index k = clrs.levelptr[icolor]; k < clrs.levelptr[icolor+1]; k++)
+			{
+				const index irow = clrs.rows[k];
+				x[irow] = scalar_relax<scalar,index>
+					(mat.vals, mat.bcolind,
+					 mat.browptr[irow], mat.diagind[irow], mat.browptr[irow+1],
+					 dblocks[irow], b[irow], x, x);
+			}
+		}
+	}
+}
+
+template <typename scalar, typename index>
+void Multicolor_SGS<scalar,index>::apply(const scalar *const r, scalar *const __restrict z) const
+{
+#pragma omp parallel for simd default(shared)
+	for(index i = 0; i < mat.nbrows; i++)
+		z[i] = 0;
+
+	sweeps(r, z, 1);
+}
+
+template <typename scalar, typename index>
+void Multicolor_SGS<scalar,index>::apply_relax(const scalar *const b,
+                                               scalar *const __restrict x) const
+{
+	sweeps(b, x, solveparams.maxits);
+}
+
+template class Multicolor_SGS<double,int>;
+
+template <typename scalar, typename index, int bs, StorageOptions stor>
+Multicolor_BILU0<scalar,index,bs,stor>::Multicolor_BILU0(SRMatrixStorage<const scalar,const index>&& matrix,
+                                                         const int color_distance,
+                                                         const bool balanced_colors)
+	: SRPreconditioner<scalar,index>(std::move(matrix)),
+	  colordist{color_distance}, balancedcolors{balanced_colors},
+	  iluvals{nullptr}, pivinv{nullptr}, ytemp{nullptr}, ztemp{nullptr}
+{ }
+
+template <typename scalar, typename index, int bs, StorageOptions stor>
+Multicolor_BILU0<scalar,index,bs,stor>::~Multicolor_BILU0()
+{
+	aligned_free(iluvals);
+	aligned_free(pivinv);
+	aligned_free(ytemp);
+	aligned_free(ztemp);
+}
+
+/** Since the factorization is exact, it does not depend on an initial guess. Nor is scaling
+ * needed, as ILU(0) commutes with symmetric diagonal scaling.
+ */
+template <typename scalar, typename index, int bs, StorageOptions stor>
+PrecInfo Multicolor_BILU0<scalar,index,bs,stor>::compute()
+{
+	double structtime = 0;
+	if(!iluvals) {
+		const auto tstart = std::chrono::steady_clock::now();
+		colors = cached_coloring(mat, bs, colordist, balancedcolors);
+		getReorderedPattern(mat, bs, colors->rows, rmat, origloc);
+		const CRawBSRMatrix<scalar,index> rview = raw_view(rmat);
+		plist = structural_cache().structure<ILUPositions<index>>("ILU0 positions",
+			pattern_fingerprint(rview, bs), [&rview]() { return compute_ILU_positions_CSR_CSR(&rview); });
+		structtime = std::chrono::duration<double>(std::chrono::steady_clock::now()-tstart).count();
+
+		iluvals = (scalar*)aligned_alloc(CACHE_LINE_LEN, rmat.nnzb*bs*bs*sizeof(scalar));
+		pivinv = (Blk*)aligned_alloc(CACHE_LINE_LEN, mat.nbrows*sizeof(Blk));
+		ytemp = (scalar*)aligned_alloc(CACHE_LINE_LEN, mat.nbrows*bs*sizeof(scalar));
+		ztemp = (scalar*)aligned_alloc(CACHE_LINE_LEN, mat.nbrows*bs*sizeof(scalar));
+		if(!iluvals || !pivinv || !ytemp || !ztemp)
+			throw std::bad_alloc();
+	}
+
+	const CRawBSRMatrix<scalar,index> rview = raw_view(rmat);
+	const Blk *const ovals = reinterpret_cast<const Blk*>(mat.vals);
+	Blk *const rvals = reinterpret_cast<Blk*>(&rmat.vals[0]);
+	Blk *const ilu = reinterpret_cast<Blk*>(iluvals);
+	const LevelSets<index>& clrs = *colors;
+
+#pragma omp parallel default(shared)
+	{
+#pragma omp for
+		for(index j = 0; j < rmat.nnzb; j++)
+			rvals[j] = ovals[origloc[j]];
+
+		for(index icolor = 0; icolor < clrs.numLevels(); icolor++) {
+#pragma omp for
+			for(index irow = clrs.levelptr[icolor]; irow < clrs.levelptr[icolor+1]; irow++)
+				async_block_ilu0_factorize<scalar,index,bs,stor,false>(&rview, rvals, *plist, nullptr,
+				                                                       irow, ilu, pivinv);
+		}
+
+		// store the inverted diagonal blocks
+#pragma omp for
+		for(index irow = 0; irow < rmat.nbrows; irow++)
+			ilu[rmat.diagind[irow]] = pivinv[irow];
+	}
+
+	PrecInfo pinfo;
+	pinfo.build_sweeps = 1;
+	pinfo.structure_walltime = structtime;
+	return pinfo;
+}
+
+/** The input is gathered into the reordered space by the forward solve, and the solution is
+ * scattered back at the end.
+ */
+template <typename scalar, typename index, int bs, StorageOptions stor>
+void Multicolor_BILU0<scalar,index,bs,stor>::apply(const scalar *const rr,
+                                                   scalar *const __restrict zz) const
+{
+	const Blk *ilu = reinterpret_cast<const Blk*>(iluvals);
+	const Seg *r = reinterpret_cast<const Seg*>(rr);
+	Seg *z = reinterpret_cast<Seg*>(zz);
+	Seg *y = reinterpret_cast<Seg*>(ytemp);
+	Seg *w = reinterpret_cast<Seg*>(ztemp);
+	const LevelSets<index>& clrs = *colors;
+	const index ncolors = clrs.numLevels();
+
+#pragma omp parallel default(shared)
+	{
+		for(index icolor = 0; icolor < ncolors; icolor++) {
+#pragma omp for
+			for(index i = clrs.levelptr[icolor]; i < clrs.levelptr[icolor+1]; i++)
+				block_unit_lower_triangular<scalar,index,bs,stor>
+					(ilu, &rmat.bcolind[0], rmat.browptr[i], rmat.diagind[i], r[clrs.rows[i]], i, y);
+		}
+
+		for(index icolor = ncolors-1; icolor >= 0; icolor--) {
+#pragma omp for
+			for(index i = clrs.levelptr[icolor]; i < clrs.levelptr[icolor+1]; i++)
+				block_upper_triangular<scalar,index,bs,stor>
+					(ilu, &rmat.bcolind[0], rmat.diagind[i], rmat.browptr[i+1], y[i], i, w);
+		}
+
+#pragma omp for
+		for(index i = 0; i < rmat.nbrows; i++)
+			z[clrs.rows[i]] = w[i];
+	}
+}
+
+template <typename scalar, typename index, int bs, StorageOptions stor>
+void Multicolor_BILU0<scalar,index,bs,stor>::apply_relax(const scalar *const r,
+                                                         scalar *const __restrict z) const
+{
+	throw std::runtime_error("ILU relaxation not implemented!");
+}
+
+template class Multicolor_BILU0<double,int,4,ColMajor>;
+template class Multicolor_BILU0<double,int,5,ColMajor>;
+template class Multicolor_BILU0<double,int,4,RowMajor>;
+
+#ifdef BUILD_BLOCK_SIZE
+template class Multicolor_BILU0<double,int,BUILD_BLOCK_SIZE,ColMajor>;
+template class Multicolor_BILU0<double,int,BUILD_BLOCK_SIZE,RowMajor>;
+#endif
+
+template <typename scalar, typename index>
+Multicolor_ILU0<scalar,index>::Multicolor_ILU0(SRMatrixStorage<const scalar,const index>&& matrix,
+                                               const int color_distance, const bool balanced_colors)
+	: SRPreconditioner<scalar,index>(std::move(matrix)),
+	  colordist{color_distance}, balancedcolors{balanced_colors},
+	  iluvals{nullptr}, ytemp{nullptr}, ztemp{nullptr}
+{ }
+
+template <typename scalar, typename index>
+Multicolor_ILU0<scalar,index>::~Multicolor_ILU0()
+{
+	aligned_free(iluvals);
+	aligned_free(ytemp);
+	aligned_free(ztemp);
+}
+
+template <typename scalar, typename index>
+PrecInfo Multicolor_ILU0<scalar,index>::compute()
+{
+	double structtime = 0;
+	if(!iluvals) {
+		const auto tstart = std::chrono::steady_clock::now();
+		colors = cached_coloring(mat, 1, colordist, balancedcolors);
+		getReorderedPattern(mat, 1, colors->rows, rmat, origloc);
+		const CRawBSRMatrix<scalar,index> rview = raw_view(rmat);
+		plist = structural_cache().structure<ILUPositions<index>>("ILU0 positions",
+			pattern_fingerprint(rview, 1), [&rview]() { return compute_ILU_positions_CSR_CSR(&rview); });
+		structtime = std::chrono::duration<double>(std::chrono::steady_clock::now()-tstart).count();
+
+		iluvals = (scalar*)aligned_alloc(CACHE_LINE_LEN, rmat.nnzb*sizeof(scalar));
+		ytemp = (scalar*)aligned_alloc(CACHE_LINE_LEN, mat.nbrows*sizeof(scalar));
+		ztemp = (scalar*)aligned_alloc(CACHE_LINE_LEN, mat.nbrows*sizeof(scalar));
+		if(!iluvals || !ytemp || !ztemp)
+			throw std::bad_alloc();
+	}
+
+	const CRawBSRMatrix<scalar,index> rview = raw_view(rmat);
+	const LevelSets<index>& clrs = *colors;
+
+#pragma omp parallel default(shared)
+	{
+#pragma omp for simd
+		for(index j = 0; j < rmat.nnzb; j++)
+			rmat.vals[j] = mat.vals[origloc[j]];
+
+		for(index icolor = 0; icolor < clrs.numLevels(); icolor++) {
+#pragma omp for
+			for(index irow = clrs.levelptr[icolor]; irow < clrs.levelptr[icolor+1]; irow++)
+				async_ilu0_factorize_kernel<scalar,index,false,false>(&rview, *plist, irow,
+				                                                      nullptr, nullptr, iluvals);
+		}
+	}
+
+	PrecInfo pinfo;
+	pinfo.build_sweeps = 1;
+	pinfo.structure_walltime = structtime;
+	return pinfo;
+}
+
+template <typename scalar, typename index>
+void Multicolor_ILU0<scalar,index>::apply(const scalar *const r, scalar *const __restrict z) const
+{
+	const LevelSets<index>& clrs = *colors;
+	const index ncolors = clrs.numLevels();
+
+#pragma omp parallel default(shared)
+	{
+		for(index icolor = 0; icolor < ncolors; icolor++) {
+#pragma omp for
+			for(index i = clrs.levelptr[icolor]; i < clrs.levelptr[icolor+1]; i++)
+				ytemp[i] = scalar_unit_lower_triangular<scalar,index>
+					(iluvals, &rmat.bcolind[0], rmat.browptr[i], rmat.diagind[i], r[clrs.rows[i]],
+					 ytemp);
+		}
+
+		for(index icolor = ncolors-1; icolor >= 0; icolor--) {
+#pragma omp for
+			for(index i = clrs.levelptr[icolor]; i < clrs.levelptr[icolor+1]; i++)
+				ztemp[i] = scalar_upper_triangular<scalar,index>
+					(iluvals, &rmat.bcolind[0], rmat.diagind[i], rmat.browptr[i+1],
+					 1.0/iluvals[rmat.diagind[i]], ytemp[i], ztemp);
+		}
+
+#pragma omp for
+		for(index i = 0; i < rmat.nbrows; i++)
+			z[clrs.rows[i]] = ztemp[i];
+	}
+}
+
+template <typename scalar, typename index>
+void Multicolor_ILU0<scalar,index>::apply_relax(const scalar *const r,
+                                                scalar *const __restrict z) const
+{
+	throw std::runtime_error("ILU relaxation not implemented!");
+}
+
+template class Multicolor_ILU0<double,int>;
+
+}
@@ -0,0 +1,170 @@
+/** \file
+ * \brief Implementation of preconditioning in a bandwidth-reducing ordering of the matrix
+ * \author Aditya Kashi
+ *
+ * This file is part of BLASTed.
+ *   BLASTed is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   BLASTed is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with BLASTed.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <chrono>
+#include <new>
+#include <stdexcept>
+#include <boost/align/aligned_alloc.hpp>
+#include "structural_cache.hpp"
+#include "solverops_reordered.hpp"
+
+namespace blasted {
+
+using boost::alignment::aligned_alloc;
+using boost::alignment::aligned_free;
+
+/// Number of block-rows below which nested dissection stops dissecting
+static const int nd_leaf_size = 64;
+
+/// Gathers block-rows of two vectors into the new ordering in one pass
+/** \param width Number of entries in a block-row of the vectors
+ */
+template <typename scalar, typename index>
+static void gather_rows(const index nrows, const int width, const index *const ord,
+                        const scalar *const x1, scalar *const __restrict y1,
+                        const scalar *const x2, scalar *const __restrict y2)
+{
+#pragma omp parallel for default(shared)
+	for(index i = 0; i < nrows; i++)
+	{
+		const index orow = ord[i];
+		for(int k = 0; k < width; k++) {
+			y1[i*width+k] = x1[orow*width+k];
+			y2[i*width+k] = x2[orow*width+k];
+		}
+	}
+}
+
+/// Scatters block-rows of a vector back to the original ordering
+/** \param width Number of entries in a block-row of the vectors
+ */
+template <typename scalar, typename index>
+static void scatter_rows(const index nrows, const int width, const index *const ord,
+                         const scalar *const x, scalar *const __restrict y)
+{
+#pragma omp parallel for default(shared)
+	for(index i = 0; i < nrows; i++)
+	{
+		const index orow = ord[i];
+		for(int k = 0; k < width; k++)
+			y[orow*width+k] = x[i*width+k];
+	}
+}
+
+template <typename scalar, typename index>
+ReorderedPreconditioner<scalar,index>
+::ReorderedPreconditioner(SRMatrixStorage<const scalar,const index>&& matrix, const int block_size,
+                          const GraphOrdering ordering, const InnerCreator& create_inner)
+	: SRPreconditioner<scalar,index>(std::move(matrix)), bs{block_size}
+{
+	const auto tstart = std::chrono::steady_clock::now();
+	const CRawBSRMatrix<scalar,index>& cmat = mat;
+	if(ordering == RCM_ORDERING)
+		ord = structural_cache().structure<std::vector<index>>("RCM ordering",
+			pattern_fingerprint(mat, bs), [&cmat]() { return computeRCMOrdering(cmat); });
+	else if(ordering == ND_ORDERING)
+		ord = structural_cache().structure<std::vector<index>>("nested dissection ordering",
+			pattern_fingerprint(mat, bs),
+			[&cmat]() { return computeNestedDissectionOrdering(cmat, (index)nd_leaf_size); });
+	else
+		throw std::invalid_argument("ReorderedPreconditioner: invalid ordering!");
+
+	getReorderedPattern(mat, bs, *ord, rmat, origloc);
+	structtime = std::chrono::duration<double>(std::chrono::steady_clock::now()-tstart).count();
+
+	inner.reset(create_inner(share_with_const(rmat, bs)));
+
+	rtemp = (scalar*)aligned_alloc(CACHE_LINE_LEN, mat.nbrows*bs*sizeof(scalar));
+	ztemp = (scalar*)aligned_alloc(CACHE_LINE_LEN, mat.nbrows*bs*sizeof(scalar));
+	if(!rtemp || !ztemp)
+		throw std::bad_alloc();
+}
+
+template <typename scalar, typename index>
+ReorderedPreconditioner<scalar,index>::~ReorderedPreconditioner()
+{
+	aligned_free(rtemp);
+	aligned_free(ztemp);
+	aligned_free(rmulti);
+	aligned_free(zmulti);
+}
+
+template <typename scalar, typename index>
+PrecInfo ReorderedPreconditioner<scalar,index>::compute()
+{
+	const int bs2 = bs*bs;
+	scalar *const rvals = &rmat.vals[0];
+#pragma omp parallel for default(shared)
+	for(index j = 0; j < rmat.nnzb; j++)
+		for(int k = 0; k < bs2; k++)
+			rvals[j*bs2+k] = mat.vals[origloc[j]*bs2+k];
+
+	PrecInfo pinfo = inner->compute();
+	pinfo.structure_walltime += structtime;
+	structtime = 0;
+	return pinfo;
+}
+
+template <typename scalar, typename index>
+void ReorderedPreconditioner<scalar,index>::apply(const scalar *const r,
+                                                  scalar *const __restrict z) const
+{
+	// the output is gathered too, as some operators use it as the initial guess
+	gather_rows(mat.nbrows, bs, &(*ord)[0], r, rtemp, z, ztemp);
+	inner->apply(rtemp, ztemp);
+	scatter_rows(mat.nbrows, bs, &(*ord)[0], ztemp, z);
+}
+
+/** The multivectors are row-interleaved, so that a block-row of all the vectors is contiguous and
+ * is permuted as a unit.
+ */
+template <typename scalar, typename index>
+void ReorderedPreconditioner<scalar,index>::apply_multi(const int nvecs, const scalar *const x,
+                                                        scalar *const __restrict y) const
+{
+	if(nvecs > nmultivecs) {
+		aligned_free(rmulti);
+		aligned_free(zmulti);
+		nmultivecs = 0;
+		const size_t n = static_cast<size_t>(mat.nbrows)*bs*nvecs;
+		rmulti = (scalar*)aligned_alloc(CACHE_LINE_LEN, n*sizeof(scalar));
+		zmulti = (scalar*)aligned_alloc(CACHE_LINE_LEN, n*sizeof(scalar));
+		if(!rmulti || !zmulti)
+			throw std::bad_alloc();
+		nmultivecs = nvecs;
+	}
+
+	gather_rows(mat.nbrows, bs*nvecs, &(*ord)[0], x, rmulti, y, zmulti);
+	inner->apply_multi(nvecs, rmulti, zmulti);
+	scatter_rows(mat.nbrows, bs*nvecs, &(*ord)[0], zmulti, y);
+}
+
+template <typename scalar, typename index>
+void ReorderedPreconditioner<scalar,index>::apply_relax(const scalar *const b,
+                                                        scalar *const __restrict x) const
+{
+	inner->setApplyParams(solveparams);
+	gather_rows(mat.nbrows, bs, &(*ord)[0], b, rtemp, x, ztemp);
+	inner->apply_relax(rtemp, ztemp);
+	scatter_rows(mat.nbrows, bs, &(*ord)[0], ztemp, x);
+}
+
+template class ReorderedPreconditioner<double,int>;
+
+}
@@ -1,35 +1,102 @@
 /** \file
  * \brief Sparse approximate preconditioner implementation
+ * \author Aditya Kashi
+ *
+ * This file is part of BLASTed.
+ *   BLASTed is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   BLASTed is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with BLASTed.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <chrono>
+#include "blas/matvecs.hpp"
+#include "structural_cache.hpp"
 #include "sai.hpp"
 #include "solverops_sai.hpp"
 
 namespace blasted {
 
-template <typename scalar, typename index>
-struct LeftSAIImpl
-{
-	LeftSAIPattern<index> sp;             ///< Pattern for gathering the row-wise SAI matrices
-	RawBSRMatrix<scalar,index> saimat;    ///< The sparse approximate inverse
-};
-
 template <typename scalar, typename index, int bs, StorageOptions stor>
 LeftSAIPreconditioner<scalar,index,bs,stor>
-::LeftSAIPreconditioner(SRMatrixStorage<const scalar,const index>&& matrix)
-	: SRPreconditioner<scalar,index>(std::move(matrix))
+::LeftSAIPreconditioner(SRMatrixStorage<const scalar,const index>&& matrix, const bool full_sai,
+                        const int thread_chunk_size)
+	: SRPreconditioner<scalar,index>(std::move(matrix)), fullsai{full_sai},
+	  threadchunksize{thread_chunk_size}
 { }
 
 template <typename scalar, typename index, int bs, StorageOptions stor>
 PrecInfo LeftSAIPreconditioner<scalar,index,bs,stor>::compute()
 {
-	return PrecInfo();
+	PrecInfo pinfo;
+
+	if(!saipatt)
+	{
+		const auto tstart = std::chrono::steady_clock::now();
+		saipatt = structural_cache().structure<LeftSAIPattern<index>>
+			(fullsai ? "left SAI pattern" : "left ISAI pattern", pattern_fingerprint(mat, bs),
+			 [this]() {
+				 SRMatrixStorage<const scalar,const index> smat(mat.browptr, mat.bcolind, mat.vals,
+				                                                mat.diagind, mat.browendptr,
+				                                                mat.nbrows, mat.nnzb, mat.nbstored,
+				                                                bs);
+				 return fullsai ? left_SAI_pattern(std::move(smat))
+					 : left_incomplete_SAI_pattern(std::move(smat));
+			 });
+
+		// compact copy of the pattern of the matrix
+		const index n = mat.nbrows;
+		sai.browptr.resize(n+1);
+		sai.diagind.resize(n);
+		sai.browptr[0] = 0;
+		for(index irow = 0; irow < n; irow++)
+			sai.browptr[irow+1] = sai.browptr[irow] + mat.browendptr[irow]-mat.browptr[irow];
+
+		const index nnz = sai.browptr[n];
+		sai.bcolind.resize(nnz);
+		sai.vals.resize(nnz*bs*bs);
+		sai.browendptr.wrap(&sai.browptr[1], n);
+		sai.nbrows = n;
+		sai.nnzb = sai.nbstored = nnz;
+
+#pragma omp parallel for default(shared)
+		for(index irow = 0; irow < n; irow++)
+		{
+			for(index jj = mat.browptr[irow]; jj < mat.browendptr[irow]; jj++)
+				sai.bcolind[sai.browptr[irow] + jj-mat.browptr[irow]] = mat.bcolind[jj];
+			sai.diagind[irow] = sai.browptr[irow] + mat.diagind[irow]-mat.browptr[irow];
+		}
+
+		pinfo.structure_walltime
+			= std::chrono::duration<double>(std::chrono::steady_clock::now()-tstart).count();
+	}
+
+	compute_SAI<scalar,index,bs,stor>(pmat, *saipatt, threadchunksize, fullsai, sai);
+	return pinfo;
 }
 
 template <typename scalar, typename index, int bs, StorageOptions stor>
 void LeftSAIPreconditioner<scalar,index,bs,stor>::apply(const scalar *const x,
                                                         scalar *const __restrict y) const
 {
+	using SpMV = typename BLAS_SR<const scalar,const index,bs,stor>::type;
+	SpMV::matrix_apply(share_with_const(sai, bs), x, y);
+}
+
+template <typename scalar, typename index, int bs, StorageOptions stor>
+void LeftSAIPreconditioner<scalar,index,bs,stor>::apply_multi(const int nvecs, const scalar *const x,
+                                                              scalar *const __restrict y) const
+{
+	using SpMV = typename BLAS_SR<const scalar,const index,bs,stor>::type;
+	SpMV::matrix_apply_multi(share_with_const(sai, bs), nvecs, x, y);
 }
 
 template <typename scalar, typename index, int bs, StorageOptions stor>
@@ -41,5 +108,12 @@ void LeftSAIPreconditioner<scalar,index,bs,stor>::apply_relax(const scalar *cons
 
 template class LeftSAIPreconditioner<double,int,1,ColMajor>;
 template class LeftSAIPreconditioner<double,int,4,ColMajor>;
+template class LeftSAIPreconditioner<double,int,5,ColMajor>;
+template class LeftSAIPreconditioner<double,int,4,RowMajor>;
+
+#ifdef BUILD_BLOCK_SIZE
+template class LeftSAIPreconditioner<double,int,BUILD_BLOCK_SIZE,ColMajor>;
+template class LeftSAIPreconditioner<double,int,BUILD_BLOCK_SIZE,RowMajor>;
+#endif
 
 }
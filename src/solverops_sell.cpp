@@ -0,0 +1,196 @@
+/** \file solverops_sell.cpp
+ * \brief Implementation of scalar Jacobi and asynchronous SGS operations using SELL-C-sigma storage
+ * \author Aditya Kashi
+ *
+ * This file is part of BLASTed.
+ *   BLASTed is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   BLASTed is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with BLASTed.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cmath>
+#include <stdexcept>
+#include <boost/align/aligned_alloc.hpp>
+#include "solverops_sell.hpp"
+#include "kernels/kernels_sell.hpp"
+
+namespace blasted {
+
+using boost::alignment::aligned_alloc;
+using boost::alignment::aligned_free;
+
+/// Computes a SELL-C-sigma copy of (a part of) the matrix the first time, and updates values later
+template <typename scalar, typename index>
+static void setup_sell_matrix(const CRawBSRMatrix<scalar,index>& mat, const int C, const int sigma,
+                              const SELLPart part, SELLMatrixStorage<scalar,index>& smat,
+                              CRawSELLMatrix<scalar,index>& rsmat)
+{
+	if(smat.nrows != mat.nbrows) {
+		convert_SR_to_SELL(mat, C, sigma, part, smat);
+		rsmat = createRawView(smat);
+	}
+	else
+		update_SELL_values(mat, smat);
+}
+
+template <typename scalar, typename index, int C>
+SELLJacobiPreconditioner<scalar,index,C>
+::SELLJacobiPreconditioner(SRMatrixStorage<const scalar, const index>&& matrix, const int sort_scope)
+	: JacobiSRPreconditioner<scalar,index>(std::move(matrix)), sigma{sort_scope}
+{ }
+
+template <typename scalar, typename index, int C>
+PrecInfo SELLJacobiPreconditioner<scalar,index,C>::compute()
+{
+	const PrecInfo info = JacobiSRPreconditioner<scalar,index>::compute();
+	setup_sell_matrix(mat, C, sigma, SELL_FULL, smat, rsmat);
+	return info;
+}
+
+template <typename scalar, typename index, int C>
+void SELLJacobiPreconditioner<scalar,index,C>::apply_relax(const scalar *const bb,
+                                                           scalar *const __restrict xx) const
+{
+	scalar *xtemp = (scalar*)aligned_alloc(CACHE_LINE_LEN,mat.nbrows*sizeof(scalar));
+	scalar refdiffnorm = 1;
+
+	for(int step = 0; step < solveparams.maxits; step++)
+	{
+#pragma omp parallel for default(shared)
+		for(index ic = 0; ic < rsmat.nchunks; ic++)
+		{
+			kernels::sell_chunk_relax<scalar,index,C>(rsmat, ic, dblocks, bb, xx, xtemp);
+		}
+
+		if(solveparams.ctol)
+		{
+			scalar diffnorm = 0;
+#pragma omp parallel for simd default(shared) reduction(+:diffnorm)
+			for(index i = 0; i < mat.nbrows; i++)
+			{
+				scalar diff = xtemp[i] - xx[i];
+				diffnorm += diff*diff;
+				xx[i] = xtemp[i];
+			}
+			diffnorm = std::sqrt(diffnorm);
+
+			if(step == 0)
+				refdiffnorm = diffnorm;
+
+			if(diffnorm < solveparams.atol || diffnorm/refdiffnorm < solveparams.rtol ||
+			   diffnorm/refdiffnorm > solveparams.dtol)
+				break;
+		}
+		else
+		{
+#pragma omp parallel for simd default(shared)
+			for(index i = 0; i < mat.nbrows; i++) {
+				xx[i] = xtemp[i];
+			}
+		}
+	}
+
+	aligned_free(xtemp);
+}
+
+template <typename scalar, typename index, int C>
+AsyncSGS_SELLPreconditioner<scalar,index,C>
+::AsyncSGS_SELLPreconditioner(SRMatrixStorage<const scalar, const index>&& matrix,
+                              const int naswps, const ApplyInit apply_inittype,
+                              const int threadchunksize, const int sort_scope,
+                              const bool relax)
+	: AsyncSGS_SRPreconditioner<scalar,index>(std::move(matrix), naswps, apply_inittype,
+	                                          threadchunksize),
+	  sigma{sort_scope}, relaxation{relax}
+{ }
+
+template <typename scalar, typename index, int C>
+PrecInfo AsyncSGS_SELLPreconditioner<scalar,index,C>::compute()
+{
+	const PrecInfo info = AsyncSGS_SRPreconditioner<scalar,index>::compute();
+	setup_sell_matrix(mat, C, sigma, SELL_STRICT_LOWER, lmat, rlmat);
+	setup_sell_matrix(mat, C, sigma, SELL_STRICT_UPPER, umat, rumat);
+	if(relaxation)
+		setup_sell_matrix(mat, C, sigma, SELL_FULL, fmat, rfmat);
+	return info;
+}
+
+template <typename scalar, typename index, int C>
+void AsyncSGS_SELLPreconditioner<scalar,index,C>::apply(const scalar *const rr,
+                                                        scalar *const __restrict zz) const
+{
+	const int tcs = chunks_per_task();
+
+#pragma omp parallel default(shared)
+	{
+		if(ainit == INIT_A_JACOBI || ainit == INIT_A_ZERO)
+#pragma omp for simd
+			for(index i = 0; i < mat.nbrows; i++)
+				ytemp[i] = 0;
+
+		for(int isweep = 0; isweep < napplysweeps; isweep++)
+		{
+			// forward sweep ytemp := D^(-1) (r - L ytemp)
+#pragma omp for schedule(dynamic, tcs) nowait
+			for(index ic = 0; ic < rlmat.nchunks; ic++)
+				kernels::sell_chunk_fgs<scalar,index,C>(rlmat, ic, dblocks, rr, ytemp);
+		}
+
+#pragma omp barrier
+
+		if(ainit == INIT_A_JACOBI)
+#pragma omp for simd
+			for(index i = 0; i < mat.nbrows; i++)
+				zz[i] = ytemp[i];
+		else if(ainit == INIT_A_ZERO)
+#pragma omp for simd
+			for(index i = 0; i < mat.nbrows; i++)
+				zz[i] = 0;
+
+		for(int isweep = 0; isweep < napplysweeps; isweep++)
+		{
+			// backward sweep z := D^(-1) (D y - U z)
+#pragma omp for schedule(dynamic, tcs) nowait
+			for(index ic = rumat.nchunks-1; ic >= 0; ic--)
+				kernels::sell_chunk_bgs<scalar,index,C>(rumat, ic, dblocks, ytemp, zz);
+		}
+	}
+}
+
+template <typename scalar, typename index, int C>
+void AsyncSGS_SELLPreconditioner<scalar,index,C>::apply_relax(const scalar *const b,
+                                                              scalar *const __restrict x) const
+{
+	if(!relaxation)
+		throw std::runtime_error("SELL SGS relaxation was not requested on construction!");
+
+	const int tcs = chunks_per_task();
+
+#pragma omp parallel default(shared)
+	for(int step = 0; step < solveparams.maxits; step++)
+	{
+#pragma omp for schedule(dynamic, tcs) nowait
+		for(index ic = 0; ic < rfmat.nchunks; ic++)
+			kernels::sell_chunk_relax<scalar,index,C>(rfmat, ic, dblocks, b, x, x);
+
+#pragma omp for schedule(dynamic, tcs) nowait
+		for(index ic = rfmat.nchunks-1; ic >= 0; ic--)
+			kernels::sell_chunk_relax<scalar,index,C>(rfmat, ic, dblocks, b, x, x);
+	}
+}
+
+template class SELLJacobiPreconditioner<double,int,4>;
+template class SELLJacobiPreconditioner<double,int,8>;
+template class AsyncSGS_SELLPreconditioner<double,int,4>;
+template class AsyncSGS_SELLPreconditioner<double,int,8>;
+
+}
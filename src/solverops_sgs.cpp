@@ -6,6 +6,7 @@
 #include <type_traits>
 #include <boost/align/aligned_alloc.hpp>
 #include "solverops_sgs.hpp"
+#include "async_sweeps.hpp"
 #include "kernels/kernels_sgs.hpp"
 #include "kernels/kernels_relaxation.hpp"
 
@@ -18,15 +19,17 @@ template <typename scalar, typename index, int bs, StorageOptions stor>
 AsyncBlockSGS_SRPreconditioner<scalar,index,bs,stor>::
 AsyncBlockSGS_SRPreconditioner(SRMatrixStorage<const scalar, const index>&& matrix,
                                const int naswps, const ApplyInit apply_inittype,
-                               const int threadchunksize)
+                               const int threadchunksize, const bool compressed_colind)
 	: BJacobiSRPreconditioner<scalar,index,bs,stor>(std::move(matrix)), ytemp{nullptr},
-	  napplysweeps{naswps}, ainit{apply_inittype}, thread_chunk_size{threadchunksize}
+	  napplysweeps{naswps}, ainit{apply_inittype}, thread_chunk_size{threadchunksize},
+	  usecompressedind{compressed_colind}
 { }
 
 template <typename scalar, typename index, int bs, StorageOptions stor>
 AsyncBlockSGS_SRPreconditioner<scalar,index,bs,stor>::~AsyncBlockSGS_SRPreconditioner()
 {
 	aligned_free(ytemp);
+	aligned_free(ymulti);
 }
 
 template <typename scalar, typename index, int bs, StorageOptions stor>
@@ -36,9 +39,21 @@ PrecInfo AsyncBlockSGS_SRPreconditioner<scalar,index,bs,stor>::compute()
 	if(!ytemp) {
 		ytemp = (scalar*)aligned_alloc(CACHE_LINE_LEN,mat.nbrows*bs*sizeof(scalar));
 
+		if(numasched.active())
+			numasched.first_touch(ytemp, bs, scalar(0));
+		else
 #pragma omp parallel for simd default(shared)
-		for(index i = 0; i < mat.nbrows*bs; i++)
-			ytemp[i] = 0;
+			for(index i = 0; i < mat.nbrows*bs; i++)
+				ytemp[i] = 0;
+	}
+
+	if(tilecachebytes > 0)
+		tiling.tilerows = cache_tile_rows(mat, bs, 1, tilecachebytes);
+
+	// the non-zero structure is assumed not to change between calls
+	if(usecompressedind && cind.nbrows != mat.nbrows) {
+		compress_column_indices(mat, cind);
+		rcind = createRawView(cind);
 	}
 
 	return PrecInfo();
@@ -48,38 +63,104 @@ template <typename scalar, typename index, int bs, StorageOptions stor>
 void AsyncBlockSGS_SRPreconditioner<scalar,index,bs,stor>::apply(const scalar *const rr,
                                                                  scalar *const __restrict zz) const
 {
-	//const Blk *mvals = reinterpret_cast<const Blk*>(mat.vals);
+	const Blk *mvals = reinterpret_cast<const Blk*>(mat.vals);
 	const Blk *dblks = reinterpret_cast<const Blk*>(dblocks);
 	const Seg *r = reinterpret_cast<const Seg*>(rr);
 	Seg *z = reinterpret_cast<Seg*>(zz);
 	Seg *y = reinterpret_cast<Seg*>(ytemp);
 
-	if(ainit == INIT_A_JACOBI || ainit == INIT_A_ZERO)
-#pragma omp parallel for simd default(shared)
-		for(index i = 0; i < mat.nbrows*bs; i++)
-			ytemp[i] = 0;
+	const AsyncSweepEngine<index> eng(mat.nbrows, thread_chunk_size, &numasched, tiling);
+	eng.run(true, [&]() {
+		if(ainit == INIT_A_JACOBI || ainit == INIT_A_ZERO)
+			eng.rows([y](const index start, const index end) {
+				for(index i = start; i < end; i++)
+					y[i] = Seg::Zero();
+			});
 
-	for(int isweep = 0; isweep < napplysweeps; isweep++)
-	{
 		// forward sweep ytemp := D^(-1) (r - L ytemp)
-		perform_block_fgs<scalar,index,bs,stor>(mat, dblks, thread_chunk_size, r, y);
+		eng.sync();
+		if(usecompressedind)
+			eng.forward(napplysweeps, [&](const index irow) {
+				kernels::block_fgs_ci<scalar,index,bs,stor>(mvals, rcind, irow, mat.browptr[irow],
+				                                            mat.diagind[irow], dblks[irow], r[irow], y);
+			});
+		else
+			eng.forward(napplysweeps, [&](const index irow) {
+				kernels::block_fgs<scalar,index,bs,stor>(mvals, mat.bcolind, irow, mat.browptr[irow],
+				                                         mat.diagind[irow], dblks[irow], r[irow], y);
+			});
+
+		eng.sync();
+		if(ainit == INIT_A_JACOBI || ainit == INIT_A_ZERO)
+			eng.rows([this,y,z](const index start, const index end) {
+				for(index i = start; i < end; i++)
+					z[i] = (ainit == INIT_A_JACOBI) ? y[i] : Seg::Zero();
+			});
+
+		// backward sweep z := D^(-1) (D y - U z)
+		eng.sync();
+		if(usecompressedind)
+			eng.backward(napplysweeps, [&](const index irow) {
+				kernels::block_bgs_ci<scalar,index,bs,stor>(mvals, rcind, irow, mat.diagind[irow],
+				                                            mat.browptr[irow+1], dblks[irow], y[irow], z);
+			});
+		else
+			eng.backward(napplysweeps, [&](const index irow) {
+				kernels::block_bgs<scalar,index,bs,stor>(mvals, mat.bcolind, irow, mat.diagind[irow],
+				                                         mat.browptr[irow+1], dblks[irow], y[irow], z);
+			});
+	});
+}
+
+template <typename scalar, typename index, int bs, StorageOptions stor>
+void AsyncBlockSGS_SRPreconditioner<scalar,index,bs,stor>::apply_multi(const int nvecs,
+                                                                       const scalar *const rr,
+                                                                       scalar *const __restrict zz)
+	const
+{
+	const Blk *mvals = reinterpret_cast<const Blk*>(mat.vals);
+	const Blk *dblks = reinterpret_cast<const Blk*>(dblocks);
+	const int nv = nvecs;
+	if(nvecs > nymultivecs) {
+		aligned_free(ymulti);
+		nymultivecs = 0;
+		ymulti = (scalar*)aligned_alloc(CACHE_LINE_LEN, mat.nbrows*bs*nvecs*sizeof(scalar));
+		if(!ymulti)
+			throw std::bad_alloc();
+		nymultivecs = nvecs;
 	}
 
-	if(ainit == INIT_A_JACOBI)
-#pragma omp parallel for simd default(shared)
-		for(index i = 0; i < mat.nbrows*bs; i++)
-			zz[i] = ytemp[i];
-	else if(ainit == INIT_A_ZERO)
-#pragma omp parallel for simd default(shared)
-		for(index i = 0; i < mat.nbrows*bs; i++)
-			zz[i] = 0;
+	const AsyncSweepEngine<index> eng(mat.nbrows, thread_chunk_size);
+	eng.run(true, [&]() {
+		eng.rows([&](const index start, const index end) {
+#pragma omp simd
+			for(index i = start*bs*nv; i < end*bs*nv; i++)
+				ymulti[i] = 0;
+		});
+
+		// forward sweep y := D^(-1) (r - L y)
+		eng.sync();
+		eng.forward(napplysweeps, [&](const index irow) {
+			kernels::block_fgs_multi<scalar,index,bs,stor>(mvals, mat.bcolind, irow,
+			                                               mat.browptr[irow], mat.diagind[irow],
+			                                               dblks[irow], nv, rr, ymulti);
+		});
+
+		eng.sync();
+		if(ainit == INIT_A_JACOBI || ainit == INIT_A_ZERO)
+			eng.rows([&](const index start, const index end) {
+				for(index i = start*bs*nv; i < end*bs*nv; i++)
+					zz[i] = (ainit == INIT_A_JACOBI) ? ymulti[i] : scalar(0);
+			});
 
-#pragma omp parallel default(shared)
-	for(int isweep = 0; isweep < napplysweeps; isweep++)
-	{
 		// backward sweep z := D^(-1) (D y - U z)
-		perform_block_bgs<scalar,index,bs,stor>(mat, dblks, thread_chunk_size, y, z);
-	}
+		eng.sync();
+		eng.backward(napplysweeps, [&](const index irow) {
+			kernels::block_bgs_multi<scalar,index,bs,stor>(mvals, mat.bcolind, irow,
+			                                               mat.diagind[irow], mat.browptr[irow+1],
+			                                               dblks[irow], nv, ymulti, zz);
+		});
+	});
 }
 
 template<typename scalar, typename index, int bs, StorageOptions stor>
@@ -93,40 +174,37 @@ void AsyncBlockSGS_SRPreconditioner<scalar,index,bs,stor>::apply_relax(const sca
 	const Seg *x = reinterpret_cast<const Seg*>(xx);
 	Seg *xmut = reinterpret_cast<Seg*>(xx);
 
-#pragma omp parallel default(shared)
-	{
-	for(int step = 0; step < solveparams.maxits; step++)
-	{
-#pragma omp for schedule(dynamic, thread_chunk_size) nowait
-		for(index irow = 0; irow < mat.nbrows; irow++)
-		{
-			block_relax_kernel<scalar,index,bs,stor>
-				(mvals, mat.bcolind, irow, mat.browptr[irow], mat.diagind[irow], mat.browptr[irow+1],
-				 dblks[irow], b[irow], x, x, xmut[irow]);
-		}
-#pragma omp for schedule(dynamic, thread_chunk_size) nowait
-		for(index irow = mat.nbrows-1; irow >= 0; irow--)
+	const auto relax = [&](const index irow) {
+		block_relax_kernel<scalar,index,bs,stor>
+			(mvals, mat.bcolind, irow, mat.browptr[irow], mat.diagind[irow], mat.browptr[irow+1],
+			 dblks[irow], b[irow], x, x, xmut[irow]);
+	};
+
+	const AsyncSweepEngine<index> eng(mat.nbrows, thread_chunk_size, nullptr, tiling);
+	eng.run(true, [&]() {
+		for(int step = 0; step < solveparams.maxits; step++)
 		{
-			block_relax_kernel<scalar,index,bs,stor>
-				(mvals, mat.bcolind, irow, mat.browptr[irow], mat.diagind[irow], mat.browptr[irow+1],
-				 dblks[irow], b[irow], x, x, xmut[irow]);
+			eng.forward(1, relax);
+			eng.backward(1, relax);
 		}
-	}
-	}
+	});
 }
 
 template <typename scalar, typename index>
 AsyncSGS_SRPreconditioner<scalar,index>
 ::AsyncSGS_SRPreconditioner(SRMatrixStorage<const scalar, const index>&& matrix,
-                            const int naswps, const ApplyInit apply_inittype, const int threadchunksize)
+                            const int naswps, const ApplyInit apply_inittype, const int threadchunksize,
+                            const bool compressed_colind)
 	: JacobiSRPreconditioner<scalar,index>(std::move(matrix)), ytemp{nullptr},
-	  napplysweeps{naswps}, ainit{apply_inittype}, thread_chunk_size{threadchunksize}
+	  napplysweeps{naswps}, ainit{apply_inittype}, thread_chunk_size{threadchunksize},
+	  usecompressedind{compressed_colind}
 { }
 
 template <typename scalar, typename index>
 AsyncSGS_SRPreconditioner<scalar,index>::~AsyncSGS_SRPreconditioner()
 {
 	aligned_free(ytemp);
+	aligned_free(ymulti);
 }
 
 template <typename scalar, typename index>
@@ -136,9 +214,21 @@ PrecInfo AsyncSGS_SRPreconditioner<scalar,index>::compute()
 	if(!ytemp) {
 		ytemp = (scalar*)aligned_alloc(CACHE_LINE_LEN,mat.nbrows*sizeof(scalar));
 
+		if(numasched.active())
+			numasched.first_touch(ytemp, 1, scalar(0));
+		else
 #pragma omp parallel for simd default(shared)
-		for(index i = 0; i < mat.nbrows; i++)
-			ytemp[i] = 0;
+			for(index i = 0; i < mat.nbrows; i++)
+				ytemp[i] = 0;
+	}
+
+	if(tilecachebytes > 0)
+		tiling.tilerows = cache_tile_rows(mat, 1, 1, tilecachebytes);
+
+	// the non-zero structure is assumed not to change between calls
+	if(usecompressedind && cind.nbrows != mat.nbrows) {
+		compress_column_indices(mat, cind);
+		rcind = createRawView(cind);
 	}
 
 	return PrecInfo();
@@ -148,58 +238,115 @@ template <typename scalar, typename index>
 void AsyncSGS_SRPreconditioner<scalar,index>::apply(const scalar *const rr,
                                                     scalar *const __restrict zz) const
 {
-	if(ainit == INIT_A_JACOBI || ainit == INIT_A_ZERO)
-#pragma omp parallel for simd default(shared)
-		for(index i = 0; i < mat.nbrows; i++)
-			ytemp[i] = 0;
+	const AsyncSweepEngine<index> eng(mat.nbrows, thread_chunk_size, &numasched, tiling);
+	eng.run(true, [&]() {
+		if(ainit == INIT_A_JACOBI || ainit == INIT_A_ZERO)
+			eng.rows([this](const index start, const index end) {
+#pragma omp simd
+				for(index i = start; i < end; i++)
+					ytemp[i] = 0;
+			});
 
-	for(int isweep = 0; isweep < napplysweeps; isweep++)
-	{
 		// forward sweep ytemp := D^(-1) (r - L ytemp)
-		perform_scalar_fgs(mat, dblocks, thread_chunk_size, rr, ytemp);
+		eng.sync();
+		if(usecompressedind)
+			eng.forward(napplysweeps, [&](const index irow) {
+				ytemp[irow] = kernels::scalar_fgs_ci(mat.vals, rcind, irow, mat.browptr[irow],
+				                                     mat.diagind[irow], dblocks[irow], rr[irow], ytemp);
+			});
+		else
+			eng.forward(napplysweeps, [&](const index irow) {
+				ytemp[irow] = kernels::scalar_fgs(mat.vals, mat.bcolind, mat.browptr[irow],
+				                                  mat.diagind[irow], dblocks[irow], rr[irow], ytemp);
+			});
+
+		eng.sync();
+		if(ainit == INIT_A_JACOBI || ainit == INIT_A_ZERO)
+			eng.rows([this,zz](const index start, const index end) {
+				for(index i = start; i < end; i++)
+					zz[i] = (ainit == INIT_A_JACOBI) ? ytemp[i] : scalar(0);
+			});
+
+		// backward sweep z := D^(-1) (D y - U z)
+		eng.sync();
+		if(usecompressedind)
+			eng.backward(napplysweeps, [&](const index irow) {
+				zz[irow] = kernels::scalar_bgs_ci(mat.vals, rcind, irow, mat.diagind[irow],
+				                                  mat.browptr[irow+1], dblocks[irow], ytemp[irow], zz);
+			});
+		else
+			eng.backward(napplysweeps, [&](const index irow) {
+				zz[irow] = kernels::scalar_bgs(mat.vals, mat.bcolind, mat.diagind[irow],
+				                               mat.browptr[irow+1], mat.vals[mat.diagind[irow]],
+				                               dblocks[irow], ytemp[irow], zz);
+			});
+	});
+}
+
+template <typename scalar, typename index>
+void AsyncSGS_SRPreconditioner<scalar,index>::apply_multi(const int nvecs, const scalar *const rr,
+                                                          scalar *const __restrict zz) const
+{
+	const int nv = nvecs;
+	if(nvecs > nymultivecs) {
+		aligned_free(ymulti);
+		nymultivecs = 0;
+		ymulti = (scalar*)aligned_alloc(CACHE_LINE_LEN, mat.nbrows*nvecs*sizeof(scalar));
+		if(!ymulti)
+			throw std::bad_alloc();
+		nymultivecs = nvecs;
 	}
 
-	if(ainit == INIT_A_JACOBI)
-#pragma omp parallel for simd default(shared)
-		for(index i = 0; i < mat.nbrows; i++)
-			zz[i] = ytemp[i];
-	else if(ainit == INIT_A_ZERO)
-#pragma omp parallel for simd default(shared)
-		for(index i = 0; i < mat.nbrows; i++)
-			zz[i] = 0;
+	const AsyncSweepEngine<index> eng(mat.nbrows, thread_chunk_size);
+	eng.run(true, [&]() {
+		eng.rows([&](const index start, const index end) {
+#pragma omp simd
+			for(index i = start*nv; i < end*nv; i++)
+				ymulti[i] = 0;
+		});
+
+		// forward sweep y := D^(-1) (r - L y)
+		eng.sync();
+		eng.forward(napplysweeps, [&](const index irow) {
+			kernels::scalar_fgs_multi(mat.vals, mat.bcolind, irow, mat.browptr[irow],
+			                          mat.diagind[irow], dblocks[irow], nv, rr, ymulti);
+		});
+
+		eng.sync();
+		if(ainit == INIT_A_JACOBI || ainit == INIT_A_ZERO)
+			eng.rows([&](const index start, const index end) {
+				for(index i = start*nv; i < end*nv; i++)
+					zz[i] = (ainit == INIT_A_JACOBI) ? ymulti[i] : scalar(0);
+			});
 
-#pragma omp parallel default(shared)
-	for(int isweep = 0; isweep < napplysweeps; isweep++)
-	{
 		// backward sweep z := D^(-1) (D y - U z)
-		perform_scalar_bgs(mat, dblocks, thread_chunk_size, ytemp, zz);
-	}
+		eng.sync();
+		eng.backward(napplysweeps, [&](const index irow) {
+			kernels::scalar_bgs_multi(mat.vals, mat.bcolind, irow, mat.diagind[irow],
+			                          mat.browptr[irow+1], dblocks[irow], nv, ymulti, zz);
+		});
+	});
 }
 
 template<typename scalar, typename index>
 void AsyncSGS_SRPreconditioner<scalar,index>::apply_relax(const scalar *const b,
                                                           scalar *const __restrict x) const
 {
-#pragma omp parallel default(shared)
-	for(int step = 0; step < solveparams.maxits; step++)
-	{
-#pragma omp for schedule(dynamic, thread_chunk_size) nowait
-		for(index irow = 0; irow < mat.nbrows; irow++)
-		{
-			x[irow] = scalar_relax<scalar,index>
-				(mat.vals, mat.bcolind,
-				 mat.browptr[irow], mat.diagind[irow], mat.browptr[irow+1],
-				 dblocks[irow], b[irow], x, x);
-		}
-#pragma omp for schedule(dynamic, thread_chunk_size) nowait
-		for(index irow = mat.nbrows-1; irow >= 0; irow--)
+	const auto relax = [&](const index irow) {
+		x[irow] = scalar_relax<scalar,index>
+			(mat.vals, mat.bcolind,
+			 mat.browptr[irow], mat.diagind[irow], mat.browptr[irow+1],
+			 dblocks[irow], b[irow], x, x);
+	};
+
+	const AsyncSweepEngine<index> eng(mat.nbrows, thread_chunk_size, nullptr, tiling);
+	eng.run(true, [&]() {
+		for(int step = 0; step < solveparams.maxits; step++)
 		{
-			x[irow] = scalar_relax<scalar,index>
-				(mat.vals, mat.bcolind,
-				 mat.browptr[irow], mat.diagind[irow], mat.browptr[irow+1],
-				 dblocks[irow], b[irow], x, x);
+			eng.forward(1, relax);
+			eng.backward(1, relax);
 		}
-	}
+	});
 }
 
 template <typename scalar, typename index>
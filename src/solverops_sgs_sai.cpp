@@ -1,9 +1,27 @@
 /** \file
  * \brief Implementation of SGS (I)SAI
+ * \author Aditya Kashi
+ *
+ * This file is part of BLASTed.
+ *   BLASTed is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   BLASTed is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with BLASTed.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <chrono>
+#include <new>
 #include <boost/align/aligned_alloc.hpp>
-#include <Eigen/Dense>
+#include "blas/matvecs.hpp"
+#include "sai.hpp"
 #include "solverops_sgs_sai.hpp"
 
 namespace blasted {
@@ -12,120 +30,116 @@ using boost::alignment::aligned_alloc;
 using boost::alignment::aligned_free;
 
 template <typename scalar, typename index, int bs, StorageOptions stopt>
-BSGS_SAI<scalar,index,bs,stopt>::BSGS_SAI(const bool full_spai)
-	: fullsai{full_spai},
-	  saiL.nbrows{0}, saiL.browptr{nullptr}, saiL.bcolind{nullptr},
-	saiL.diagind{nullptr}, saiL.vals{nullptr},
-	saiU.nbrows{0}, saiU.browptr{nullptr}, saiU.bcolind{nullptr},
-	saiU.diagind{nullptr}, saiU.vals{nullptr}
+BSGS_SAI<scalar,index,bs,stopt>::BSGS_SAI(SRMatrixStorage<const scalar, const index>&& matrix,
+                                          const bool full_sai, const int thread_chunk_size)
+	: SRPreconditioner<scalar,index>(std::move(matrix)), fullsai{full_sai},
+	  threadchunksize{thread_chunk_size}, ytemp{nullptr}
 { }
 
 template <typename scalar, typename index, int bs, StorageOptions stopt>
 BSGS_SAI<scalar,index,bs,stopt>::~BSGS_SAI()
 {
-	aligned_free(saiL.browptr);
-	aligned_free(saiL.bcolind);
-	aligned_free(saiL.vals);
-	aligned_free(saiL.diagind);
-	aligned_free(saiU.browptr);
-	aligned_free(saiU.bcolind);
-	aligned_free(saiU.vals);
-	aligned_free(saiU.diagind);
+	aligned_free(ytemp);
+	aligned_free(ymulti);
 }
 
+/** The approximate inverses of D+L and D+U are computed from the triangular views of the matrix,
+ * so the values are not copied. Block-column j of the approximate inverse of D+U is then
+ * multiplied by the diagonal block D_j.
+ */
 template <typename scalar, typename index, int bs, StorageOptions stopt>
-void BSGS_SAI<scalar,index,bs,stopt>::compute()
+PrecInfo BSGS_SAI<scalar,index,bs,stopt>::compute()
 {
+	using Blk = Block_t<scalar,bs,stopt>;
+
 	if(mat.nbrows == 0 || mat.browptr == nullptr)
 		throw std::runtime_error("BSGS_SAI: Matrix not set!");
 
-	/// Assumes sparsity pattern does not change once set.
-	if(!sai.browptr)
+	PrecInfo pinfo;
+
+	if(!saipatt)
 	{
-		initialize();
+		const auto tstart = std::chrono::steady_clock::now();
+		saipatt = triangular_SAI_patterns(mat, bs, fullsai);
+		triangular_part_pattern(mat, bs, true, saiL);
+		triangular_part_pattern(mat, bs, false, saiU);
+
+		ytemp = (scalar*)aligned_alloc(CACHE_LINE_LEN, mat.nbrows*bs*sizeof(scalar));
+		if(!ytemp)
+			throw std::bad_alloc();
+		pinfo.structure_walltime
+			= std::chrono::duration<double>(std::chrono::steady_clock::now()-tstart).count();
 	}
 
-	// Compute SAI or ISAI
+	{
+		SRMatrixStorage<const scalar,const index> lmat(mat.browptr, mat.bcolind, mat.vals,
+		                                               mat.diagind, mat.browendptr, mat.nbrows,
+		                                               mat.nnzb, mat.nbstored, bs);
+		const SRMatrixStorage<const scalar,const index> lower = getLowerTriangularView(std::move(lmat));
+		compute_SAI<scalar,index,bs,stopt>(lower, saipatt->lower, threadchunksize, fullsai, saiL);
+	}
+	{
+		SRMatrixStorage<const scalar,const index> umat(mat.browptr, mat.bcolind, mat.vals,
+		                                               mat.diagind, mat.browendptr, mat.nbrows,
+		                                               mat.nnzb, mat.nbstored, bs);
+		const SRMatrixStorage<const scalar,const index> upper = getUpperTriangularView(std::move(umat));
+		compute_SAI<scalar,index,bs,stopt>(upper, saipatt->upper, threadchunksize, fullsai, saiU);
+	}
+
+	const Blk *const data = reinterpret_cast<const Blk*>(mat.vals);
+	Blk *const ub = reinterpret_cast<Blk*>(&saiU.vals[0]);
+
 #pragma omp parallel for default(shared)
 	for(index irow = 0; irow < mat.nbrows; irow++)
 	{
-		compute_SAI_lower(irow);
-		compute_SAI_upper(irow);
+		for(index jj = saiU.browptr[irow]; jj < saiU.browptr[irow+1]; jj++) {
+			const Blk m = ub[jj];
+			ub[jj].noalias() = m * data[mat.diagind[saiU.bcolind[jj]]];
+		}
 	}
-}
 
-template <typename scalar, typename index, int bs, StorageOptions stopt>
-void BSGS_ISAI<scalar,index,bs,stopt>::apply(const scalar *const x, scalar *const __restrict y) const
-{
-	//bsr_matrix_apply<scalar,index,bs,stopt>(sai, x, y);
+	return pinfo;
 }
 
 template <typename scalar, typename index, int bs, StorageOptions stopt>
-void BSGS_ISAI<scalar,index,bs,stopt>::apply_relax(const scalar *const x, scalar *const __restrict y) const
+void BSGS_SAI<scalar,index,bs,stopt>::apply(const scalar *const x, scalar *const __restrict y) const
 {
-	throw std::runtime_error("BSGS_SAI does not have relaxation!");
+	using SpMV = typename BLAS_SR<const scalar,const index,bs,stopt>::type;
+	SpMV::matrix_apply(share_with_const(saiL, bs), x, ytemp);
+	SpMV::matrix_apply(share_with_const(saiU, bs), ytemp, y);
 }
 
 template <typename scalar, typename index, int bs, StorageOptions stopt>
-void BSGS_ISAI<scalar,index,bs,stopt>::compute_SAI_lower(const index irow)
+void BSGS_SAI<scalar,index,bs,stopt>::apply_multi(const int nvecs, const scalar *const x,
+                                                  scalar *const __restrict y) const
 {
-	// compute number of columns of A that are needed for this row of M
+	using SpMV = typename BLAS_SR<const scalar,const index,bs,stopt>::type;
+	if(nvecs > nymultivecs) {
+		aligned_free(ymulti);
+		nymultivecs = 0;
+		ymulti = (scalar*)aligned_alloc(CACHE_LINE_LEN, saiL.nbrows*bs*nvecs*sizeof(scalar));
+		if(!ymulti)
+			throw std::bad_alloc();
+		nymultivecs = nvecs;
+	}
+	SpMV::matrix_apply_multi(share_with_const(saiL, bs), nvecs, x, ymulti);
+	SpMV::matrix_apply_multi(share_with_const(saiU, bs), nvecs, ymulti, y);
 }
 
 template <typename scalar, typename index, int bs, StorageOptions stopt>
-void BSGS_SAI<scalar,index,bs,stopt>::initialize()
+void BSGS_SAI<scalar,index,bs,stopt>::apply_relax(const scalar *const x, scalar *const __restrict y) const
 {
-	// allocate memory for storing approximate inverses
-
-	saiL.nbrows = mat.nbrows;
-	saiU.nbrows = mat.nbrows;
-	saiL.browptr = (index*)aligned_alloc(CACHE_LINE_LEN, (mat.nbrows+1)*sizeof(index));
-	saiU.browptr = (index*)aligned_alloc(CACHE_LINE_LEN, (mat.nbrows+1)*sizeof(index));
-
-	index lnnz = 0, unnz = 0;
-	saiL.browptr[0] = 0; saiU.browptr[0] = 0;
-
-	for(index irow = 0; irow < mat.nbrows; irow++)
-	{
-		for(index jj = mat.browptr[irow]; jj <= mat.diagind[irow]; jj++) {
-			lnnz++;
-		}
-		saiL.browptr[irow+1] = lnnz;
-
-		for(index jj = mat.diagind[irow]; jj < mat.browptr[irow+1]; jj++) {
-			unnz++;
-		}
-		saiU.browptr[irow+1] = unnz;
-	}
-
-	if(saiL.browptr[saiL.nbrows] + saiU.browptr[saiU.nbrows] - mat.nbrows != mat.browptr[mat.nbrows])
-		throw std::runtime_error("NNZs of lower and/or upper SAIs are wrong!");
-
-	saiL.bcolind = (index*)aligned_alloc(CACHE_LINE_LEN, saiL.browptr[saiL.nbrows]*sizeof(index));
-	saiL.vals = (scalar*)aligned_alloc(CACHE_LINE_LEN, saiL.browptr[saiL.nbrows]*bs*bs*sizeof(scalar));
-	saiL.diagind = (index*)aligned_alloc(CACHE_LINE_LEN, saiL.nbrows*sizeof(index));
-	saiU.bcolind = (index*)aligned_alloc(CACHE_LINE_LEN, saiU.browptr[saiU.nbrows]*sizeof(index));
-	saiU.vals = (scalar*)aligned_alloc(CACHE_LINE_LEN, saiU.browptr[saiU.nbrows]*bs*bs*sizeof(scalar));
-	saiU.diagind = (index*)aligned_alloc(CACHE_LINE_LEN, saiU.nbrows*sizeof(index));
-
-	lnnz = 0; unnz = 0;
-	for(index irow = 0; irow < mat.nbrows; irow++)
-	{
-		for(index jj = mat.browptr[irow]; jj <= mat.diagind[irow]; jj++) {
-			saiL.bcolind[lnnz] = mat.bcolind[jj];
-			lnnz++;
-		}
-
-		saiL.diagind[irow] = lnnz-1;
-		saiU.diagind[irow] = unnz;
+	throw std::runtime_error("BSGS_SAI does not have relaxation!");
+}
 
-		for(index jj = mat.diagind[irow]; jj < mat.browptr[irow+1]; jj++) {
-			saiU.bcolind[unnz] = mat.bcolind[jj];
-			unnz++;
-		}
-	}
+template class BSGS_SAI<double,int,1,ColMajor>;
+template class BSGS_SAI<double,int,4,ColMajor>;
+template class BSGS_SAI<double,int,5,ColMajor>;
+template class BSGS_SAI<double,int,4,RowMajor>;
 
-	compute_pattern();
-}
+#ifdef BUILD_BLOCK_SIZE
+template class BSGS_SAI<double,int,BUILD_BLOCK_SIZE,ColMajor>;
+template class BSGS_SAI<double,int,BUILD_BLOCK_SIZE,RowMajor>;
+#endif
 
 }
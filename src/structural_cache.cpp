@@ -0,0 +1,52 @@
+/** \file structural_cache.cpp
+ * \brief Implementation of the process-wide structural cache
+ * \author Aditya Kashi
+ */
+
+#include "structural_cache.hpp"
+
+namespace blasted {
+
+StructuralCache& structural_cache()
+{
+	static StructuralCache cache;
+	return cache;
+}
+
+size_t StructuralCache::size() const
+{
+	std::lock_guard<std::mutex> lock(mtx);
+	size_t n = 0;
+	for(const auto& e : entries)
+		if(!e.second.expired())
+			n++;
+	return n;
+}
+
+std::shared_ptr<void> StructuralCache::find(const Key& key)
+{
+	std::lock_guard<std::mutex> lock(mtx);
+	const auto it = entries.find(key);
+	if(it == entries.end())
+		return nullptr;
+	return it->second.lock();
+}
+
+std::shared_ptr<void> StructuralCache::insert(const Key& key, const std::shared_ptr<void>& p)
+{
+	std::lock_guard<std::mutex> lock(mtx);
+
+	for(auto it = entries.begin(); it != entries.end(); )
+		if(it->second.expired())
+			it = entries.erase(it);
+		else
+			++it;
+
+	std::weak_ptr<void>& entry = entries[key];
+	if(std::shared_ptr<void> existing = entry.lock())
+		return existing;
+	entry = p;
+	return p;
+}
+
+}
@@ -0,0 +1,86 @@
+/** \file
+ * \brief Checks the small dense block micro-kernels against Eigen for all supported block sizes
+ */
+
+#undef NDEBUG
+
+#include <cassert>
+#include <cfloat>
+#include <iostream>
+#include "../../src/kernels/kernels_blockops.hpp"
+
+using namespace blasted;
+
+template <int bs, StorageOptions stor>
+int testBlockOps()
+{
+	using Blk = Block_t<double,bs,stor>;
+	using Seg = Segment_t<double,bs>;
+
+	// diagonally dominant, so that the inverse is well-conditioned
+	const Blk a = Blk::Random() + 2.0*bs*Blk::Identity();
+	const Blk b = Blk::Random();
+	const Seg x = Seg::Random();
+	const double tol = 100*DBL_EPSILON;
+
+	Seg y = Seg::Random();
+	const Seg yref = y + a*x;
+	kernels::block_gemv_add<double,bs,stor>(a, x, y);
+	assert((y-yref).norm() < tol*yref.norm());
+
+	kernels::block_gemv<double,bs,stor>(a, x, y);
+	assert((y-a*x).norm() < tol*y.norm());
+
+	Blk c = Blk::Random();
+	const Blk cref = c - a*b;
+	kernels::block_gemm_sub<double,bs,stor>(a, b, c);
+	assert((c-cref).norm() < tol*cref.norm());
+
+	kernels::block_gemm<double,bs,stor>(a, b, c);
+	assert((c-a*b).norm() < tol*c.norm());
+
+	// batched products of blocks picked from arrays, one of which is used twice
+	const Blk blks[3] = {Blk::Random(), Blk::Random(), Blk::Random()};
+	const int ap[3] = {0, 2, 1}, bp[3] = {1, 1, 0};
+	c = Blk::Random();
+	Blk cbref = c;
+	for(int k = 0; k < 3; k++)
+		cbref -= blks[ap[k]]*blks[bp[k]];
+	kernels::block_gemm_sub_batch<double,bs,stor>(blks, ap, blks, bp, 3, c);
+	assert((c-cbref).norm() < tol*cbref.norm());
+
+	Blk ainv;
+	kernels::block_invert<double,bs,stor>(a, ainv);
+	assert((ainv*a - Blk::Identity()).norm() < tol*bs);
+
+	// with the rows reversed, the elimination needs row interchanges
+	const Blk arev = a.colwise().reverse();
+	kernels::block_invert<double,bs,stor>(arev, ainv);
+	assert((ainv*arev - Blk::Identity()).norm() < tol*bs);
+
+	std::cout << " Block size " << bs << (stor == RowMajor ? " row-major" : " column-major")
+	          << " passed.\n";
+	return 0;
+}
+
+int main()
+{
+	int ierr = 0;
+	ierr += testBlockOps<2,ColMajor>();
+	ierr += testBlockOps<3,ColMajor>();
+	ierr += testBlockOps<4,ColMajor>();
+	ierr += testBlockOps<5,ColMajor>();
+	ierr += testBlockOps<6,ColMajor>();
+	ierr += testBlockOps<7,ColMajor>();
+	ierr += testBlockOps<8,ColMajor>();
+	ierr += testBlockOps<9,ColMajor>();
+	ierr += testBlockOps<2,RowMajor>();
+	ierr += testBlockOps<3,RowMajor>();
+	ierr += testBlockOps<4,RowMajor>();
+	ierr += testBlockOps<5,RowMajor>();
+	ierr += testBlockOps<6,RowMajor>();
+	ierr += testBlockOps<7,RowMajor>();
+	ierr += testBlockOps<8,RowMajor>();
+	ierr += testBlockOps<9,RowMajor>();
+	return ierr;
+}
@@ -0,0 +1,138 @@
+#undef NDEBUG
+
+#include <cassert>
+#include <cmath>
+#include <memory>
+#include <vector>
+#include "coomatrix.hpp"
+#include "blockmatrices.hpp"
+#include "solverfactory.hpp"
+#include "solverops_chebyshev.hpp"
+#include "testhelpers.hpp"
+
+using namespace blasted;
+
+/// Returns the 2-norm of b - A x relative to that of b
+template <int bs>
+static double relative_residual(const SRMatrixStorage<double,int>& A, const std::vector<double>& b,
+                                const std::vector<double>& x)
+{
+	std::vector<double> ax(b.size());
+	block_matvec<bs>(A, x, ax);
+	double res = 0, norm = 0;
+	for(size_t i = 0; i < b.size(); i++) {
+		res += (b[i]-ax[i])*(b[i]-ax[i]);
+		norm += b[i]*b[i];
+	}
+	return std::sqrt(res/norm);
+}
+
+/// Checks the Chebyshev operator against Jacobi, and its relaxation against its preconditioning
+/** One Chebyshev step from zero is Jacobi scaled by the inverse of the centre of the interval.
+ * Relaxation from zero with as many steps as the degree must give the preconditioner, and it
+ * should reduce the residual more than as many Jacobi sweeps.
+ */
+template <int bs>
+int test_chebyshev(const std::string matfile)
+{
+	COOMatrix<double,int> coo;
+	coo.readMatrixMarket(matfile);
+	SRMatrixStorage<double,int> smat = getSRMatrixFromCOO<double,int,bs>(coo, "colmajor");
+	const int n = smat.nbrows*bs;
+
+	const SRFactory<double,int> factory;
+	AsyncSolverSettings settings;
+	settings.prectype = factory.solverTypeFromString("chebyshev");
+	assert(settings.prectype == BLASTED_CHEBYSHEV);
+	settings.bs = bs;
+	settings.blockstorage = ColMajor;
+	settings.relax = false;
+	settings.thread_chunk_size = 64;
+	settings.napplysweeps = 1;
+	settings.cheb_eig_iters = 20;
+	settings.cheb_eig_ratio = 0.3;
+
+	std::unique_ptr<SRPreconditioner<double,int>> cheb1
+		(factory.create_preconditioner(share_with_const(smat, bs), settings));
+	settings.prectype = BLASTED_JACOBI;
+	std::unique_ptr<SRPreconditioner<double,int>> jac
+		(factory.create_preconditioner(share_with_const(smat, bs), settings));
+	assert(cheb1->dim() == n);
+	assert(cheb1->relaxationAvailable());
+	cheb1->compute();
+	jac->compute();
+
+	const ChebyshevSRPreconditioner<double,int,bs,ColMajor> *const cp
+		= dynamic_cast<const ChebyshevSRPreconditioner<double,int,bs,ColMajor>*>(cheb1.get());
+	assert(cp);
+	const double lmax = cp->maxEigenvalueBound(), lmin = cp->minEigenvalueBound();
+	std::cout << " Eigenvalue bounds " << lmin << ", " << lmax << std::endl;
+	assert(lmax > 0);
+	assert(std::abs(lmin - 0.3*lmax) < 1e-14*lmax);
+
+	std::vector<double> x(n), r(n), z(n), zref(n);
+	for(int i = 0; i < n; i++)
+		x[i] = 1.0 + (i % 7);
+	block_matvec<bs>(smat, x, r);
+
+	cheb1->apply(&r[0], &z[0]);
+	jac->apply(&r[0], &zref[0]);
+	for(int i = 0; i < n; i++)
+		zref[i] *= 2/(lmax+lmin);
+	double diff = relative_difference(z, zref);
+	std::cout << " One step: relative difference from scaled Jacobi " << diff << std::endl;
+	assert(diff < 1e-14);
+
+	const int degree = 4;
+	settings.prectype = BLASTED_CHEBYSHEV;
+	settings.napplysweeps = degree;
+	std::unique_ptr<SRPreconditioner<double,int>> cheb
+		(factory.create_preconditioner(share_with_const(smat, bs), settings));
+	cheb->compute();
+	cheb->apply(&r[0], &zref[0]);
+
+	const SolveParams<double> sparams {1e-30, 1e-30, 1e10, false, degree};
+	cheb->setApplyParams(sparams);
+	std::fill(z.begin(), z.end(), 0.0);
+	cheb->apply_relax(&r[0], &z[0]);
+	diff = relative_difference(z, zref);
+	std::cout << " Relaxation from zero: relative difference from preconditioner " << diff
+	          << std::endl;
+	assert(diff < 1e-12);
+
+	std::vector<double> zjac(n, 0.0);
+	jac->setApplyParams(sparams);
+	jac->apply_relax(&r[0], &zjac[0]);
+	const double rescheb = relative_residual<bs>(smat, r, zref);
+	const double resjac = relative_residual<bs>(smat, r, zjac);
+	std::cout << " Relative residual after " << degree << " steps: Chebyshev " << rescheb
+	          << ", Jacobi " << resjac << std::endl;
+	assert(rescheb < resjac);
+
+	return 0;
+}
+
+int main(int argc, char *argv[])
+{
+	if(argc < 3) {
+		std::cout << "Need mtx file name and block size\n";
+		std::exit(-1);
+	}
+
+	const std::string matfile = argv[1];
+	const int blocksize = std::stoi(argv[2]);
+
+	int res = -1;
+	switch(blocksize) {
+	case 1:
+		res = test_chebyshev<1>(matfile);
+		break;
+	case 4:
+		res = test_chebyshev<4>(matfile);
+		break;
+	default:
+		printf("Block size not available!");
+	}
+
+	return res;
+}
@@ -0,0 +1,132 @@
+/** \file
+ * \brief Checks products and sweeps that use 16-bit compressed column indices against the
+ *   corresponding ones that use the full column indices
+ */
+#undef NDEBUG
+
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <cfloat>
+#include <stdexcept>
+#include "cimatrixdefs.hpp"
+#include "../../src/blas/matvecs.hpp"
+#include "../../src/kernels/kernels_sgs.hpp"
+
+using namespace blasted;
+
+/// A block-sparse-row matrix with entries near the diagonal and a few columns far away from it
+/** The far columns are more than 2^15 block-rows away for most rows, so they need escapes.
+ */
+struct TestPattern
+{
+	std::vector<int> browptr, bcolind, diagind;
+	int nbrows;
+
+	TestPattern(const int n) : nbrows{n}
+	{
+		browptr.push_back(0);
+		for(int i = 0; i < n; i++)
+		{
+			std::vector<int> cols = {i, std::max(i-1,0), std::min(i+1,n-1), (i+40000) % n,
+			                         static_cast<int>((static_cast<long>(i)*7919) % n)};
+			std::sort(cols.begin(), cols.end());
+			cols.erase(std::unique(cols.begin(), cols.end()), cols.end());
+			for(int c : cols) {
+				if(c == i)
+					diagind.push_back(static_cast<int>(bcolind.size()));
+				bcolind.push_back(c);
+			}
+			browptr.push_back(static_cast<int>(bcolind.size()));
+		}
+	}
+};
+
+template <int bs>
+void testCompressedProduct(const TestPattern& p)
+{
+	const int nnzb = p.browptr[p.nbrows];
+	std::vector<double> vals(nnzb*bs*bs), x(p.nbrows*bs), y(p.nbrows*bs), yc(p.nbrows*bs);
+	for(size_t i = 0; i < vals.size(); i++)
+		vals[i] = 1.0/(1.0 + static_cast<double>(i % 97));
+	for(size_t i = 0; i < x.size(); i++)
+		x[i] = std::sin(static_cast<double>(i));
+
+	SRMatrixStorage<double,int> smat(const_cast<int*>(&p.browptr[0]), const_cast<int*>(&p.bcolind[0]),
+	                                 &vals[0], const_cast<int*>(&p.diagind[0]),
+	                                 const_cast<int*>(&p.browptr[1]), p.nbrows, nnzb, nnzb, bs);
+	const CRawBSRMatrix<double,int> rmat(&p.browptr[0], &p.bcolind[0], &vals[0], &p.diagind[0],
+	                                     &p.browptr[1], p.nbrows, nnzb, nnzb);
+
+	CompressedColumnIndex<int> cind;
+	compress_column_indices(rmat, cind);
+	assert(cind.nbrows == p.nbrows);
+	assert(cind.escapes.size() > 0);
+	const CRawCompressedColumnIndex<int> rcind = createRawView(cind);
+
+	// every column must decode back to the original
+	for(int irow = 0; irow < p.nbrows; irow++)
+	{
+		int esc = rcind.escptr[irow];
+		for(int jj = p.browptr[irow]; jj < p.browptr[irow+1]; jj++) {
+			if(jj == p.diagind[irow]+1)
+				assert(esc == rcind.escdiagptr[irow]);
+			assert(kernels::ci_column(rcind, irow, jj, esc) == p.bcolind[jj]);
+		}
+		assert(esc == rcind.escptr[irow+1]);
+	}
+
+	if(bs == 1) {
+		BLAS_CSR<double,int>::matrix_apply(std::move(smat), &x[0], &y[0]);
+		BLAS_CSR<double,int>::matrix_apply_ci(std::move(smat), rcind, &x[0], &yc[0]);
+	}
+	else {
+		BLAS_BSR<double,int,bs,RowMajor>::matrix_apply(std::move(smat), &x[0], &y[0]);
+		BLAS_BSR<double,int,bs,RowMajor>::matrix_apply_ci(std::move(smat), rcind, &x[0], &yc[0]);
+	}
+
+	for(int i = 0; i < p.nbrows*bs; i++)
+		assert(std::fabs(y[i]-yc[i]) <= 10*DBL_EPSILON*(1.0+std::fabs(y[i])));
+
+	// a forward and a backward scalar sweep
+	if(bs == 1)
+	{
+		std::vector<double> dinv(p.nbrows);
+		for(int i = 0; i < p.nbrows; i++)
+			dinv[i] = 1.0/(vals[p.diagind[i]] + 10.0);
+
+		for(int irow = 0; irow < p.nbrows; irow++)
+		{
+			const double f = kernels::scalar_fgs(&vals[0], &p.bcolind[0], p.browptr[irow],
+			                                     p.diagind[irow], dinv[irow], x[irow], &y[0]);
+			const double fc = kernels::scalar_fgs_ci(&vals[0], rcind, irow, p.browptr[irow],
+			                                         p.diagind[irow], dinv[irow], x[irow], &y[0]);
+			assert(std::fabs(f-fc) <= 10*DBL_EPSILON*(1.0+std::fabs(f)));
+
+			const double b = kernels::scalar_bgs(&vals[0], &p.bcolind[0], p.diagind[irow],
+			                                     p.browptr[irow+1], vals[p.diagind[irow]], dinv[irow],
+			                                     x[irow], &y[0]);
+			const double bc = kernels::scalar_bgs_ci(&vals[0], rcind, irow, p.diagind[irow],
+			                                         p.browptr[irow+1], dinv[irow], x[irow], &y[0]);
+			assert(std::fabs(b-bc) <= 10*DBL_EPSILON*(1.0+std::fabs(b)));
+		}
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	if(argc < 2)
+		throw std::runtime_error("Need block size!");
+
+	const TestPattern p(70000);
+
+	const int bs = std::stoi(argv[1]);
+	if(bs == 1)
+		testCompressedProduct<1>(p);
+	else if(bs == 3)
+		testCompressedProduct<3>(p);
+	else
+		throw std::runtime_error("Block size not available!");
+
+	return 0;
+}
@@ -0,0 +1,62 @@
+/** \file testhelpers.hpp
+ * \brief Small reference computations shared by the tests of preconditioners
+ * \author Aditya Kashi
+ */
+
+#ifndef BLASTED_TESTHELPERS_H
+#define BLASTED_TESTHELPERS_H
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include "srmatrixdefs.hpp"
+
+/// Returns the max-norm of the difference of two vectors relative to that of the second
+inline double relative_difference(const std::vector<double>& x, const std::vector<double>& ref)
+{
+	double diff = 0, norm = 0;
+	for(size_t i = 0; i < ref.size(); i++) {
+		diff = std::max(diff, std::abs(x[i]-ref[i]));
+		norm = std::max(norm, std::abs(ref[i]));
+	}
+	return diff/norm;
+}
+
+/// Computes y = A x for a block sparse-row matrix with column-major blocks
+template <int bs>
+void block_matvec(const blasted::SRMatrixStorage<double,int>& A, const std::vector<double>& x,
+                  std::vector<double>& y)
+{
+	for(int i = 0; i < A.nbrows; i++)
+		for(int k = 0; k < bs; k++) {
+			y[i*bs+k] = 0;
+			for(int jj = A.browptr[i]; jj < A.browptr[i+1]; jj++)
+				for(int l = 0; l < bs; l++)
+					y[i*bs+k] += A.vals[jj*bs*bs + l*bs+k] * x[A.bcolind[jj]*bs+l];
+		}
+}
+
+/// Returns a matrix with the pattern of the given one and zero values
+inline blasted::SRMatrixStorage<double,int> zero_copy(const blasted::SRMatrixStorage<double,int>& smat,
+                                                      const int bs)
+{
+	blasted::SRMatrixStorage<double,int> zmat;
+	zmat.browptr.resize(smat.nbrows+1);
+	zmat.bcolind.resize(smat.nnzb);
+	zmat.diagind.resize(smat.nbrows);
+	zmat.vals.resize(smat.nnzb*bs*bs);
+	for(int i = 0; i < smat.nbrows+1; i++)
+		zmat.browptr[i] = smat.browptr[i];
+	for(int i = 0; i < smat.nbrows; i++)
+		zmat.diagind[i] = smat.diagind[i];
+	for(int j = 0; j < smat.nnzb; j++)
+		zmat.bcolind[j] = smat.bcolind[j];
+	for(int j = 0; j < smat.nnzb*bs*bs; j++)
+		zmat.vals[j] = 0;
+	zmat.browendptr.wrap(&zmat.browptr[1], smat.nbrows);
+	zmat.nbrows = smat.nbrows;
+	zmat.nnzb = zmat.nbstored = smat.nnzb;
+	return zmat;
+}
+
+#endif
@@ -0,0 +1,200 @@
+#undef NDEBUG
+
+#include <cassert>
+#include <cmath>
+#include <map>
+#include <vector>
+#include <Eigen/LU>
+#include "coomatrix.hpp"
+#include "blockmatrices.hpp"
+#include "solverops_ilu0.hpp"
+#include "../../src/ilu_isai.hpp"
+#include "testhelpers.hpp"
+
+using namespace blasted;
+
+/// Gives access to the factors of an ILU preconditioner
+template <typename Prec>
+struct ILUProbe : public Prec
+{
+	using Prec::Prec;
+	const CRawBSRMatrix<double,int>& matrix() const { return this->mat; }
+	const double *factors() const { return this->iluvals; }
+	const double *scaling() const { return this->scale; }
+};
+
+/// Gives access to the approximate inverses of the factors
+template <int bs>
+struct ISAIProbe : public ILUISAI<double,int,bs,ColMajor>
+{
+	ISAIProbe(const bool invdiag) : ILUISAI<double,int,bs,ColMajor>(invdiag) { }
+	using ILUISAI<double,int,bs,ColMajor>::linv;
+	using ILUISAI<double,int,bs,ColMajor>::uinv;
+};
+
+/// Checks the conditions (M T)(i,j) = delta_ij for j in the pattern of row i of a factor T
+/** The scaling folded into the approximate inverse M is removed first.
+ * \param lower Whether T is the unit lower factor or the upper factor
+ */
+template <int bs>
+static double check_isai(const CRawBSRMatrix<double,int>& mat, const double *const iluvals,
+                         const double *const scale, const bool invdiag, const bool lower,
+                         const SRMatrixStorage<double,int>& minv)
+{
+	using Blk = Block_t<double,bs,ColMajor>;
+	const Blk *const ilu = reinterpret_cast<const Blk*>(iluvals);
+	const Blk *const mv = reinterpret_cast<const Blk*>(&minv.vals[0]);
+
+	const auto factor = [&](const int c, const int jj) -> Blk {
+		if(jj != mat.diagind[c])
+			return ilu[jj];
+		if(lower)
+			return Blk::Identity();
+		return invdiag ? Blk(ilu[jj].inverse()) : ilu[jj];
+	};
+
+	double maxres = 0;
+	for(int i = 0; i < mat.nbrows; i++)
+	{
+		std::map<int,Blk> res;
+		for(int cc = minv.browptr[i]; cc < minv.browptr[i+1]; cc++)
+		{
+			const int c = minv.bcolind[cc];
+			Blk m = mv[cc];
+			if(scale)
+				for(int k = 0; k < bs; k++) {
+					if(lower)
+						m.col(k) /= scale[c*bs+k];
+					else
+						m.row(k) /= scale[i*bs+k];
+				}
+
+			const int start = lower ? mat.browptr[c] : mat.diagind[c];
+			const int end = lower ? mat.diagind[c]+1 : mat.browendptr[c];
+			for(int jj = start; jj < end; jj++) {
+				if(res.find(mat.bcolind[jj]) == res.end())
+					res[mat.bcolind[jj]] = Blk::Zero();
+				res[mat.bcolind[jj]] += m*factor(c,jj);
+			}
+		}
+
+		for(int cc = minv.browptr[i]; cc < minv.browptr[i+1]; cc++) {
+			const int j = minv.bcolind[cc];
+			Blk r = res[j];
+			if(j == i)
+				r -= Blk::Identity();
+			maxres = std::max(maxres, r.cwiseAbs().maxCoeff());
+		}
+	}
+	return maxres;
+}
+
+/// Checks the approximate inverses of the factors and the application of the preconditioner
+template <int bs, typename Prec>
+int test_isai(Prec& prec, Prec& exact, const int n)
+{
+	prec.setSyncFreeFactorization(true);
+	prec.setApplyType(APPLY_ISAI);
+	prec.compute();
+	exact.setSyncFreeFactorization(true);
+	exact.setApplyType(APPLY_SYNCFREE);
+	exact.compute();
+
+	ISAIProbe<bs> isai(bs > 1);
+	isai.compute(prec.matrix(), prec.factors(), prec.scaling(), 64);
+	const double lres = check_isai<bs>(prec.matrix(), prec.factors(), prec.scaling(), bs > 1, true,
+	                                   isai.linv);
+	const double ures = check_isai<bs>(prec.matrix(), prec.factors(), prec.scaling(), bs > 1, false,
+	                                   isai.uinv);
+	std::cout << " ISAI residuals: lower " << lres << ", upper " << ures << std::endl;
+	assert(lres < 1e-10);
+	assert(ures < 1e-10);
+
+	std::vector<double> r(n), z(n), zref(n);
+	for(int i = 0; i < n; i++)
+		r[i] = 1.0 + (i % 7);
+
+	prec.apply(&r[0], &z[0]);
+	isai.apply(&r[0], &zref[0]);
+	assert(relative_difference(z, zref) == 0);
+
+	// recomputation reuses the patterns
+	prec.compute();
+	prec.apply(&r[0], &z[0]);
+	assert(relative_difference(z, zref) == 0);
+
+	exact.apply(&r[0], &zref[0]);
+	const double diff = relative_difference(z, zref);
+	std::cout << " Relative difference from exact ILU application " << diff << std::endl;
+	assert(diff < 1.0);
+
+	// the temporary storage for several vectors is reused, then grown
+	prec.apply(&r[0], &zref[0]);
+	for(const int nvecs : {3, 2, 5})
+	{
+		std::vector<double> rmulti(n*nvecs), zmulti(n*nvecs);
+		for(int i = 0; i < n; i++)
+			for(int v = 0; v < nvecs; v++)
+				rmulti[i*nvecs+v] = (v+1)*r[i];
+		prec.apply_multi(nvecs, &rmulti[0], &zmulti[0]);
+		for(int v = 0; v < nvecs; v++) {
+			for(int i = 0; i < n; i++)
+				z[i] = zmulti[i*nvecs+v]/(v+1);
+			assert(relative_difference(z, zref) < 1e-14);
+		}
+	}
+	return 0;
+}
+
+template <int bs>
+int test_ilu_isai(const std::string matfile, const bool usescaling)
+{
+	COOMatrix<double,int> coo;
+	coo.readMatrixMarket(matfile);
+
+	if(bs == 1) {
+		using Prec = ILUProbe<AsyncILU0_SRPreconditioner<double,int>>;
+		SRMatrixStorage<double,int> smat = getSRMatrixFromCOO<double,int,1>(coo, "rowmajor");
+		Prec prec(share_with_const(smat, 1), 1, 1, usescaling, 64, INIT_F_ORIGINAL,
+		          INIT_A_ZERO, false);
+		Prec exact(share_with_const(smat, 1), 1, 1, usescaling, 64, INIT_F_ORIGINAL,
+		           INIT_A_ZERO, false);
+		return test_isai<1>(prec, exact, smat.nbrows);
+	}
+	else {
+		using Prec = ILUProbe<AsyncBlockILU0_SRPreconditioner<double,int,bs,ColMajor>>;
+		SRMatrixStorage<double,int> smat = getSRMatrixFromCOO<double,int,bs>(coo, "colmajor");
+		Prec prec(share_with_const(smat, bs), 1, 1, usescaling, 64, INIT_F_ORIGINAL,
+		          INIT_A_ZERO);
+		Prec exact(share_with_const(smat, bs), 1, 1, usescaling, 64, INIT_F_ORIGINAL,
+		           INIT_A_ZERO);
+		return test_isai<bs>(prec, exact, smat.nbrows*bs);
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	if(argc < 3) {
+		std::cout << "Need mtx file name and block size\n";
+		std::exit(-1);
+	}
+
+	const std::string matfile = argv[1];
+	const int blocksize = std::stoi(argv[2]);
+
+	int res = -1;
+	switch(blocksize) {
+	case 1:
+		res = test_ilu_isai<1>(matfile, false);
+		res = res || test_ilu_isai<1>(matfile, true);
+		break;
+	case 4:
+		res = test_ilu_isai<4>(matfile, false);
+		res = res || test_ilu_isai<4>(matfile, true);
+		break;
+	default:
+		printf("Block size not available!");
+	}
+
+	return res;
+}
@@ -0,0 +1,98 @@
+#undef NDEBUG
+
+#include <cassert>
+#include <set>
+#include "coomatrix.hpp"
+#include "blockmatrices.hpp"
+#include "ilu_pattern.hpp"
+
+using namespace blasted;
+
+/// Checks the structure of the pattern and the positions of the original entries in it
+template <typename index>
+static void check_pattern(const CRawBSRMatrix<double,index>& mat, const ILUkPattern<index>& pat)
+{
+	assert(static_cast<index>(pat.browptr.size()) == mat.nbrows+1);
+	assert(pat.browptr[mat.nbrows] == static_cast<index>(pat.bcolind.size()));
+	for(index irow = 0; irow < mat.nbrows; irow++)
+	{
+		for(index j = pat.browptr[irow]; j < pat.browptr[irow+1]-1; j++)
+			assert(pat.bcolind[j] < pat.bcolind[j+1]);
+		assert(pat.bcolind[pat.diagind[irow]] == irow);
+		for(index j = mat.browptr[irow]; j < mat.browendptr[irow]; j++) {
+			assert(pat.origpos[j] >= pat.browptr[irow] && pat.origpos[j] < pat.browptr[irow+1]);
+			assert(pat.bcolind[pat.origpos[j]] == mat.bcolind[j]);
+		}
+	}
+}
+
+/// Checks that level 0 gives the original pattern and that level 1 adds the pattern of the product
+///  of the strictly lower and strictly upper parts of the matrix
+template <int bs>
+int test_iluk_pattern(const std::string matfile)
+{
+	COOMatrix<double,int> coo;
+	coo.readMatrixMarket(matfile);
+
+	SRMatrixStorage<const double,const int> smat =
+		move_to_const<double,int>(getSRMatrixFromCOO<double,int,bs>(coo, "colmajor"));
+	const CRawBSRMatrix<double,int> mat(&smat.browptr[0], &smat.bcolind[0], &smat.vals[0],
+	                                    &smat.diagind[0], &smat.browendptr[0], smat.nbrows,
+	                                    smat.nnzb, smat.nbstored);
+
+	const ILUkPattern<int> pat0 = compute_ILUk_pattern(&mat, 0);
+	check_pattern(mat, pat0);
+	for(int i = 0; i <= mat.nbrows; i++)
+		assert(pat0.browptr[i] == mat.browptr[i]);
+	for(int j = 0; j < mat.nnzb; j++)
+		assert(pat0.bcolind[j] == mat.bcolind[j]);
+
+	const ILUkPattern<int> pat1 = compute_ILUk_pattern(&mat, 1);
+	check_pattern(mat, pat1);
+	for(int irow = 0; irow < mat.nbrows; irow++)
+	{
+		std::set<int> cols(mat.bcolind+mat.browptr[irow], mat.bcolind+mat.browendptr[irow]);
+		for(int k = mat.browptr[irow]; k < mat.diagind[irow]; k++) {
+			const int krow = mat.bcolind[k];
+			cols.insert(mat.bcolind+mat.diagind[krow]+1, mat.bcolind+mat.browendptr[krow]);
+		}
+
+		assert(static_cast<int>(cols.size()) == pat1.browptr[irow+1]-pat1.browptr[irow]);
+		int j = pat1.browptr[irow];
+		for(const int col : cols)
+			assert(pat1.bcolind[j++] == col);
+	}
+
+	const ILUkPattern<int> pat2 = compute_ILUk_pattern(&mat, 2);
+	check_pattern(mat, pat2);
+	assert(pat2.browptr[mat.nbrows] >= pat1.browptr[mat.nbrows]);
+
+	std::cout << " Non-zeros: ILU(0) " << pat0.browptr[mat.nbrows] << ", ILU(1) "
+	          << pat1.browptr[mat.nbrows] << ", ILU(2) " << pat2.browptr[mat.nbrows] << std::endl;
+	return 0;
+}
+
+int main(int argc, char *argv[])
+{
+	if(argc < 3) {
+		std::cout << "Need mtx file name and block size\n";
+		std::exit(-1);
+	}
+
+	const std::string matfile = argv[1];
+	const int blocksize = std::stoi(argv[2]);
+
+	int res = -1;
+	switch(blocksize) {
+	case 1:
+		res = test_iluk_pattern<1>(matfile);
+		break;
+	case 4:
+		res = test_iluk_pattern<4>(matfile);
+		break;
+	default:
+		printf("Block size not available!");
+	}
+
+	return res;
+}
@@ -0,0 +1,107 @@
+#undef NDEBUG
+
+#include <cassert>
+#include <cmath>
+#include <vector>
+#include "coomatrix.hpp"
+#include "blockmatrices.hpp"
+#include "solverops_ilu0.hpp"
+
+using namespace blasted;
+
+/// Checks that incremental refactorization after a local change of values gives the same factors
+///  as a full factorization
+/** With one serial sweep, asynchronous ILU(0) is exact, as is threaded sync-free factorization.
+ * So when all rows depending on the changed rows are refactorized, the result must match a new
+ * factorization to round-off. So must the remainder and diagonal dominance reported.
+ */
+template <int bs>
+int test_incremental_ilu(const std::string matfile, const bool usescaling, const bool syncfree)
+{
+	using Prec = AsyncBlockILU0_SRPreconditioner<double,int,bs,ColMajor>;
+
+	COOMatrix<double,int> coo;
+	coo.readMatrixMarket(matfile);
+	SRMatrixStorage<double,int> smat = getSRMatrixFromCOO<double,int,bs>(coo, "colmajor");
+	const int nbrows = smat.nbrows;
+
+	Prec inc(share_with_const(smat, bs), 1, 1, usescaling, 64, INIT_F_ORIGINAL, INIT_A_ZERO,
+	         syncfree, false, true);
+	inc.setIncrementalRefactorization(0, -1);
+	inc.setSyncFreeFactorization(syncfree);
+
+	PrecInfo pinfo = inc.compute();
+	assert(pinfo.refactored_rows == nbrows);
+
+	pinfo = inc.compute();
+	assert(pinfo.refactored_rows == 0);
+	assert(pinfo.build_sweeps == 0);
+
+	// change some rows in the middle, and then some others, so that refactorization is repeated
+	//  starting from incrementally computed factors
+	for(const int firstrow : {nbrows/2, nbrows/3})
+	{
+		const int nchanged = 5;
+		for(int irow = firstrow; irow < firstrow+nchanged; irow++)
+			for(int j = smat.browptr[irow]*bs*bs; j < smat.browptr[irow+1]*bs*bs; j++)
+				smat.vals[j] *= 1.1;
+
+		pinfo = inc.compute();
+		assert(pinfo.refactored_rows >= nchanged);
+		assert(pinfo.refactored_rows <= nbrows-firstrow);
+
+		Prec full(share_with_const(smat, bs), 1, 1, usescaling, 64, INIT_F_ORIGINAL, INIT_A_ZERO,
+		          false, false, true);
+		const PrecInfo fullinfo = full.compute();
+
+		// the old factors do not fit the new values, while the new ones are exact on the pattern
+		assert(pinfo.prec_rem_initial_norm() > 1e3*pinfo.prec_remainder_norm());
+		assert(pinfo.prec_remainder_norm() <= 10*fullinfo.prec_remainder_norm());
+		assert(std::abs(pinfo.upper_min_diag_dom() - fullinfo.upper_min_diag_dom())
+		       <= 1e-10*std::abs(fullinfo.upper_min_diag_dom()));
+		assert(std::abs(pinfo.lower_avg_diag_dom() - fullinfo.lower_avg_diag_dom())
+		       <= 1e-10*std::abs(fullinfo.lower_avg_diag_dom()));
+
+		const std::vector<double> r(nbrows*bs, 1.0);
+		std::vector<double> zinc(nbrows*bs), zfull(nbrows*bs);
+		inc.apply(&r[0], &zinc[0]);
+		full.apply(&r[0], &zfull[0]);
+
+		double diff = 0, norm = 0;
+		for(int i = 0; i < nbrows*bs; i++) {
+			diff = std::max(diff, std::abs(zinc[i]-zfull[i]));
+			norm = std::max(norm, std::abs(zfull[i]));
+		}
+		std::cout << " Refactorized " << pinfo.refactored_rows << " of " << nbrows
+		          << " rows; relative difference " << diff/norm << "; remainder "
+		          << pinfo.prec_rem_initial_norm() << " -> " << pinfo.prec_remainder_norm()
+		          << " (full " << fullinfo.prec_remainder_norm() << ")" << std::endl;
+		assert(diff <= 1e-10*norm);
+	}
+
+	return 0;
+}
+
+int main(int argc, char *argv[])
+{
+	if(argc < 3) {
+		std::cout << "Need mtx file name and block size\n";
+		std::exit(-1);
+	}
+
+	const std::string matfile = argv[1];
+	const int blocksize = std::stoi(argv[2]);
+
+	int res = -1;
+	switch(blocksize) {
+	case 4:
+		res = test_incremental_ilu<4>(matfile, false, false);
+		res = res || test_incremental_ilu<4>(matfile, true, false);
+		res = res || test_incremental_ilu<4>(matfile, true, true);
+		break;
+	default:
+		printf("Block size not available!");
+	}
+
+	return res;
+}
@@ -6,6 +6,42 @@
 
 using namespace blasted;
 
+/// Checks that every row is in exactly one level, and that rows depend only on earlier levels
+/** \param forward Whether rows depend on earlier rows or on later rows
+ * \param inplace Whether a non-zero (j,i) also makes row i depend on row j
+ */
+static void check_level_sets(const CRawBSRMatrix<double,int>& omat, const LevelSets<int>& lsets,
+                             const bool forward, const bool inplace)
+{
+	if(lsets.levelptr[0] != 0 || lsets.levelptr.back() != omat.nbrows)
+		throw "Level pointers do not cover all rows!";
+
+	std::vector<int> levelof(omat.nbrows, -1);
+	for(int lvl = 0; lvl < lsets.numLevels(); lvl++)
+	{
+		if(lsets.levelptr[lvl+1] <= lsets.levelptr[lvl])
+			throw "Empty level!";
+		for(int k = lsets.levelptr[lvl]; k < lsets.levelptr[lvl+1]; k++)
+		{
+			if(levelof[lsets.rows[k]] != -1)
+				throw "Row in more than one level!";
+			levelof[lsets.rows[k]] = lvl;
+		}
+	}
+
+	const auto before = [forward](const int a, const int b) { return forward ? a < b : a > b; };
+
+	for(int irow = 0; irow < omat.nbrows; irow++)
+		for(int jj = omat.browptr[irow]; jj < omat.browptr[irow+1]; jj++)
+		{
+			const int jcol = omat.bcolind[jj];
+			if(before(jcol,irow) && levelof[jcol] >= levelof[irow])
+				throw "Dependence in level!";
+			if(inplace && before(irow,jcol) && levelof[irow] >= levelof[jcol])
+				throw "Dependence of in-place sweep in level!";
+		}
+}
+
 template <int bs>
 int test_levelschedule(const std::string matfile)
 {
@@ -20,20 +56,11 @@ int test_levelschedule(const std::string matfile)
 
 	std::cout << "Number of block rows = " << omat.nbrows << std::endl;
 
-	const std::vector<int> levels = computeLevels(&omat);
-
-	for(size_t lvl = 0; lvl < levels.size()-1; lvl++)
+	for(const bool inplace : {false, true})
 	{
-		for(int inode = levels[lvl]; inode < levels[lvl+1]; inode++)
-		{
-			for(int jj = omat.browptr[inode]; jj < omat.browptr[inode+1]; jj++)
-			{
-				const int colind = omat.bcolind[jj];
-				for(int jnode = inode+1; jnode < levels[lvl+1]; jnode++)
-					if(colind == jnode)
-						throw "Dependence in level!";
-			}
-		}
+		const LevelSchedule<int> levels = computeLevels(&omat, inplace);
+		check_level_sets(omat, levels.forward, true, inplace);
+		check_level_sets(omat, levels.backward, false, inplace);
 	}
 
 	return 0;
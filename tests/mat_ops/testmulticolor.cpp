@@ -0,0 +1,206 @@
+#undef NDEBUG
+
+#include <cassert>
+#include <cmath>
+#include <set>
+#include <vector>
+#include "coomatrix.hpp"
+#include "blockmatrices.hpp"
+#include "reorderingscaling.hpp"
+#include "solverops_levels_sgs.hpp"
+#include "solverops_ilu0.hpp"
+#include "solverops_multicolor.hpp"
+#include "testhelpers.hpp"
+
+using namespace blasted;
+
+/// Checks that every row has exactly one color and that coupled rows have different colors
+/** For distance 2, the columns in every row must also have different colors.
+ */
+static void check_coloring(const CRawBSRMatrix<double,int>& mat, const LevelSets<int>& colors,
+                           const int distance)
+{
+	const int n = mat.nbrows;
+	assert(colors.levelptr[0] == 0);
+	assert(colors.levelptr[colors.numLevels()] == n);
+	std::vector<int> color(n, -1);
+	for(int c = 0; c < colors.numLevels(); c++) {
+		assert(colors.levelptr[c+1] > colors.levelptr[c]);
+		for(int k = colors.levelptr[c]; k < colors.levelptr[c+1]; k++) {
+			assert(color[colors.rows[k]] == -1);
+			color[colors.rows[k]] = c;
+		}
+	}
+
+	for(int irow = 0; irow < n; irow++) {
+		std::set<int> rowcolors;
+		for(int jj = mat.browptr[irow]; jj < mat.browptr[irow+1]; jj++) {
+			if(mat.bcolind[jj] != irow)
+				assert(color[mat.bcolind[jj]] != color[irow]);
+			if(distance == 2)
+				assert(rowcolors.insert(color[mat.bcolind[jj]]).second);
+		}
+	}
+}
+
+/// Symmetrically reorders a block matrix such that block-row colors.rows[i] becomes block-row i
+template <int bs>
+static SRMatrixStorage<double,int> reorder(const SRMatrixStorage<double,int>& mat,
+                                           const LevelSets<int>& colors)
+{
+	const int n = mat.nbrows;
+	const int nnz = mat.browptr[n];
+	std::vector<int> newindex(n);
+	for(int i = 0; i < n; i++)
+		newindex[colors.rows[i]] = i;
+
+	SRMatrixStorage<double,int> rmat;
+	rmat.browptr.resize(n+1);
+	rmat.bcolind.resize(nnz);
+	rmat.vals.resize(nnz*bs*bs);
+	rmat.diagind.resize(n);
+	rmat.browptr[0] = 0;
+	for(int i = 0; i < n; i++)
+	{
+		const int orow = colors.rows[i];
+		std::vector<std::pair<int,int>> entries;
+		for(int jj = mat.browptr[orow]; jj < mat.browptr[orow+1]; jj++)
+			entries.push_back(std::make_pair(newindex[mat.bcolind[jj]], jj));
+		std::sort(entries.begin(), entries.end());
+
+		rmat.browptr[i+1] = rmat.browptr[i] + static_cast<int>(entries.size());
+		for(size_t k = 0; k < entries.size(); k++) {
+			const int pos = rmat.browptr[i] + static_cast<int>(k);
+			rmat.bcolind[pos] = entries[k].first;
+			if(entries[k].first == i)
+				rmat.diagind[i] = pos;
+			for(int l = 0; l < bs*bs; l++)
+				rmat.vals[pos*bs*bs+l] = mat.vals[entries[k].second*bs*bs+l];
+		}
+	}
+	rmat.browendptr.wrap(&rmat.browptr[1], n);
+	rmat.nbrows = n;
+	rmat.nnzb = rmat.nbstored = nnz;
+	return rmat;
+}
+
+/// Scalar ILU(0) with the constructor arguments of the block version
+class ScalarILU0 : public AsyncILU0_SRPreconditioner<double,int>
+{
+public:
+	ScalarILU0(SRMatrixStorage<const double,const int>&& matrix, const int nbuildsweeps,
+	           const int napplysweeps, const bool use_scaling, const int tcs,
+	           const FactInit finit, const ApplyInit ainit, const bool threadedfactor,
+	           const bool threadedapply)
+		: AsyncILU0_SRPreconditioner<double,int>(std::move(matrix), nbuildsweeps, napplysweeps,
+		                                         use_scaling, tcs, finit, ainit, false,
+		                                         threadedfactor, threadedapply)
+	{ }
+};
+
+/// Checks the coloring, and compares the multicolor operators with the sequential ones applied to
+///  the reordered matrix
+/** The references are level-scheduled SGS and the serially computed and applied ILU(0) of the
+ * reordered matrix, both of which are exact.
+ */
+template <int bs, typename MCSGS, typename LevelSGS, typename MCILU, typename ILU>
+int test_multicolor(const std::string matfile, const int distance, const bool balanced)
+{
+	COOMatrix<double,int> coo;
+	coo.readMatrixMarket(matfile);
+	SRMatrixStorage<double,int> smat
+		= getSRMatrixFromCOO<double,int,bs>(coo, bs == 1 ? "rowmajor" : "colmajor");
+	const int n = smat.nbrows*bs;
+	const CRawBSRMatrix<double,int> cmat(&smat.browptr[0], &smat.bcolind[0], &smat.vals[0],
+	                                     &smat.diagind[0], &smat.browendptr[0], smat.nbrows,
+	                                     smat.nnzb, smat.nbstored);
+
+	const LevelSets<int> colors = computeColoring(cmat, distance, balanced);
+	check_coloring(cmat, colors, distance);
+	std::cout << " Distance-" << distance << (balanced ? " balanced" : "") << " coloring: "
+	          << colors.numLevels() << " colors\n";
+
+	MulticolorReordering<double,int,bs> reord(distance, balanced);
+	reord.compute(cmat);
+	assert(reord.colorPointers() == colors.levelptr);
+
+	std::vector<double> r(n), rperm(n);
+	for(int i = 0; i < n; i++)
+		r[i] = 1.0 + (i % 7);
+	for(int i = 0; i < smat.nbrows; i++)
+		for(int k = 0; k < bs; k++)
+			rperm[i*bs+k] = r[colors.rows[i]*bs+k];
+
+	SRMatrixStorage<double,int> pmat = reorder<bs>(smat, colors);
+	std::vector<double> z(n), zperm(n), zref(n);
+
+	MCSGS mcsgs(share_with_const(smat, bs), distance, balanced);
+	mcsgs.compute();
+	LevelSGS lsgs(share_with_const(pmat, bs));
+	lsgs.compute();
+	mcsgs.apply(&r[0], &z[0]);
+	lsgs.apply(&rperm[0], &zperm[0]);
+	for(int i = 0; i < smat.nbrows; i++)
+		for(int k = 0; k < bs; k++)
+			zref[colors.rows[i]*bs+k] = zperm[i*bs+k];
+	const double sgsdiff = relative_difference(z, zref);
+	std::cout << "  SGS: relative difference " << sgsdiff << std::endl;
+	assert(sgsdiff < 1e-10);
+
+	MCILU mcilu(share_with_const(smat, bs), distance, balanced);
+	ILU iluref(share_with_const(pmat, bs), 1, 1, false, 32, INIT_F_ORIGINAL, INIT_A_ZERO,
+	           false, false);
+	iluref.compute();
+	iluref.apply(&rperm[0], &zperm[0]);
+	for(int i = 0; i < smat.nbrows; i++)
+		for(int k = 0; k < bs; k++)
+			zref[colors.rows[i]*bs+k] = zperm[i*bs+k];
+
+	// recomputation must give the same factors
+	for(int i = 0; i < 2; i++) {
+		const PrecInfo pinfo = mcilu.compute();
+		assert(pinfo.build_sweeps == 1);
+		mcilu.apply(&r[0], &z[0]);
+		const double iludiff = relative_difference(z, zref);
+		std::cout << "  ILU0: relative difference " << iludiff << std::endl;
+		assert(iludiff < 1e-10);
+	}
+
+	return 0;
+}
+
+int main(int argc, char *argv[])
+{
+	if(argc < 3) {
+		std::cout << "Need mtx file name and block size\n";
+		std::exit(-1);
+	}
+
+	const std::string matfile = argv[1];
+	const int blocksize = std::stoi(argv[2]);
+
+	int res = -1;
+	switch(blocksize) {
+	case 1:
+		res = test_multicolor<1, Multicolor_SGS<double,int>, Level_SGS<double,int>,
+		                      Multicolor_ILU0<double,int>, ScalarILU0>(matfile, 1, false);
+		res = res || test_multicolor<1, Multicolor_SGS<double,int>, Level_SGS<double,int>,
+		                             Multicolor_ILU0<double,int>, ScalarILU0>(matfile, 2, true);
+		break;
+	case 4:
+		res = test_multicolor<4, Multicolor_BSGS<double,int,4,ColMajor>,
+		                      Level_BSGS<double,int,4,ColMajor>,
+		                      Multicolor_BILU0<double,int,4,ColMajor>,
+		                      AsyncBlockILU0_SRPreconditioner<double,int,4,ColMajor>>(matfile, 1, false);
+		res = res || test_multicolor<4, Multicolor_BSGS<double,int,4,ColMajor>,
+		                             Level_BSGS<double,int,4,ColMajor>,
+		                             Multicolor_BILU0<double,int,4,ColMajor>,
+		                             AsyncBlockILU0_SRPreconditioner<double,int,4,ColMajor>>
+			(matfile, 2, true);
+		break;
+	default:
+		printf("Block size not available!");
+	}
+
+	return res;
+}
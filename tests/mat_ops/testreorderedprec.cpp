@@ -0,0 +1,204 @@
+#undef NDEBUG
+
+#include <cassert>
+#include <cmath>
+#include <memory>
+#include <vector>
+#include "coomatrix.hpp"
+#include "blockmatrices.hpp"
+#include "reorderingscaling.hpp"
+#include "solverfactory.hpp"
+#include "solverops_levels_sgs.hpp"
+#include "solverops_reordered.hpp"
+#include "testhelpers.hpp"
+
+using namespace blasted;
+
+/// Checks that an ordering is a permutation
+static void check_permutation(const std::vector<int>& ord, const int n)
+{
+	assert(static_cast<int>(ord.size()) == n);
+	std::vector<int> count(n, 0);
+	for(int i = 0; i < n; i++)
+		count[ord[i]]++;
+	for(int i = 0; i < n; i++)
+		assert(count[i] == 1);
+}
+
+/// Returns the block bandwidth of a matrix after symmetric reordering by ord
+static int bandwidth(const CRawBSRMatrix<double,int>& mat, const std::vector<int>& ord)
+{
+	const std::vector<int> newindex = invertPermutationVector(ord);
+	int bw = 0;
+	for(int irow = 0; irow < mat.nbrows; irow++)
+		for(int jj = mat.browptr[irow]; jj < mat.browptr[irow+1]; jj++)
+			bw = std::max(bw, std::abs(newindex[irow]-newindex[mat.bcolind[jj]]));
+	return bw;
+}
+
+/// Checks the reordered pattern against the original matrix
+static void check_reordered_pattern(const CRawBSRMatrix<double,int>& mat, const std::vector<int>& ord)
+{
+	SRMatrixStorage<double,int> rmat;
+	std::vector<int> origloc;
+	getReorderedPattern(mat, 1, ord, rmat, origloc);
+	for(int i = 0; i < mat.nbrows; i++) {
+		assert(rmat.browptr[i+1]-rmat.browptr[i] == mat.browptr[ord[i]+1]-mat.browptr[ord[i]]);
+		assert(rmat.bcolind[rmat.diagind[i]] == i);
+		for(int jj = rmat.browptr[i]; jj < rmat.browptr[i+1]; jj++) {
+			if(jj > rmat.browptr[i])
+				assert(rmat.bcolind[jj] > rmat.bcolind[jj-1]);
+			assert(ord[rmat.bcolind[jj]] == mat.bcolind[origloc[jj]]);
+			assert(origloc[jj] >= mat.browptr[ord[i]] && origloc[jj] < mat.browptr[ord[i]+1]);
+		}
+	}
+}
+
+/// Checks the orderings, and compares reordered operators with ones computed independently
+/** Block-Jacobi is invariant under symmetric reordering, so the reordered operator must give the
+ * results of the original one, both as preconditioner and as relaxation. Level-scheduled SGS is
+ * exact, so the wrapper must give its result for the matrix reordered here.
+ */
+template <int bs, typename LevelSGS>
+int test_reordered(const std::string matfile, const GraphOrdering ordering)
+{
+	COOMatrix<double,int> coo;
+	coo.readMatrixMarket(matfile);
+	const StorageOptions stor = bs == 1 ? RowMajor : ColMajor;
+	SRMatrixStorage<double,int> smat
+		= getSRMatrixFromCOO<double,int,bs>(coo, bs == 1 ? "rowmajor" : "colmajor");
+	const int n = smat.nbrows*bs;
+	const CRawBSRMatrix<double,int> cmat(&smat.browptr[0], &smat.bcolind[0], &smat.vals[0],
+	                                     &smat.diagind[0], &smat.browendptr[0], smat.nbrows,
+	                                     smat.nnzb, smat.nbstored);
+
+	std::vector<int> natural(smat.nbrows);
+	for(int i = 0; i < smat.nbrows; i++)
+		natural[i] = i;
+	const std::vector<int> ord = ordering == RCM_ORDERING ? computeRCMOrdering(cmat)
+		: computeNestedDissectionOrdering(cmat, 64);
+	check_permutation(ord, smat.nbrows);
+	check_reordered_pattern(cmat, ord);
+	std::cout << " Bandwidth: natural " << bandwidth(cmat, natural) << ", reordered "
+	          << bandwidth(cmat, ord) << std::endl;
+	if(ordering == RCM_ORDERING)
+		assert(bandwidth(cmat, ord) <= bandwidth(cmat, natural));
+
+	AsyncSolverSettings settings;
+	settings.prectype = BLASTED_JACOBI;
+	settings.bs = bs;
+	settings.blockstorage = stor;
+	settings.relax = false;
+	settings.thread_chunk_size = 64;
+	settings.scale = false;
+	settings.nbuildsweeps = settings.napplysweeps = 1;
+	settings.fact_inittype = INIT_F_ORIGINAL;
+	settings.apply_inittype = INIT_A_ZERO;
+	settings.compute_precinfo = false;
+
+	const SRFactory<double,int> factory;
+	std::unique_ptr<SRPreconditioner<double,int>> jac
+		(factory.create_preconditioner(share_with_const(smat, bs), settings));
+	settings.reordering = ordering;
+	std::unique_ptr<SRPreconditioner<double,int>> rjac
+		(factory.create_preconditioner(share_with_const(smat, bs), settings));
+	const ReorderedPreconditioner<double,int> *const rp
+		= dynamic_cast<const ReorderedPreconditioner<double,int>*>(rjac.get());
+	assert(rp);
+	assert(rp->ordering() == ord);
+	assert(rjac->dim() == n);
+	jac->compute();
+	rjac->compute();
+
+	std::vector<double> r(n), z(n), zref(n);
+	for(int i = 0; i < n; i++)
+		r[i] = 1.0 + (i % 7);
+
+	jac->apply(&r[0], &zref[0]);
+	rjac->apply(&r[0], &z[0]);
+	double diff = relative_difference(z, zref);
+	std::cout << "  Jacobi: relative difference " << diff << std::endl;
+	assert(diff == 0);
+
+	const SolveParams<double> sparams {1e-30, 1e-30, 1e10, false, 5};
+	jac->setApplyParams(sparams);
+	rjac->setApplyParams(sparams);
+	std::fill(z.begin(), z.end(), 0.0);
+	std::fill(zref.begin(), zref.end(), 0.0);
+	jac->apply_relax(&r[0], &zref[0]);
+	rjac->apply_relax(&r[0], &z[0]);
+	diff = relative_difference(z, zref);
+	std::cout << "  Jacobi relaxation: relative difference " << diff << std::endl;
+	assert(diff < 1e-14);
+
+	// reference: level SGS of the matrix reordered here
+	SRMatrixStorage<double,int> pmat;
+	std::vector<int> origloc;
+	getReorderedPattern(cmat, bs, ord, pmat, origloc);
+	for(int j = 0; j < pmat.nnzb; j++)
+		for(int k = 0; k < bs*bs; k++)
+			pmat.vals[j*bs*bs+k] = smat.vals[origloc[j]*bs*bs+k];
+	LevelSGS lsgs(share_with_const(pmat, bs));
+	lsgs.compute();
+	std::vector<double> rperm(n), zperm(n);
+	for(int i = 0; i < smat.nbrows; i++)
+		for(int k = 0; k < bs; k++)
+			rperm[i*bs+k] = r[ord[i]*bs+k];
+	lsgs.apply(&rperm[0], &zperm[0]);
+	for(int i = 0; i < smat.nbrows; i++)
+		for(int k = 0; k < bs; k++)
+			zref[ord[i]*bs+k] = zperm[i*bs+k];
+
+	ReorderedPreconditioner<double,int> rsgs(share_with_const(smat, bs), bs, ordering,
+		[](SRMatrixStorage<const double,const int>&& m) { return new LevelSGS(std::move(m)); });
+	rsgs.compute();
+	rsgs.apply(&r[0], &z[0]);
+	diff = relative_difference(z, zref);
+	std::cout << "  SGS: relative difference " << diff << std::endl;
+	assert(diff < 1e-14);
+
+	// several vectors at once; the temporary storage is reused, then grown
+	for(const int nvecs : {3, 2, 5})
+	{
+		std::vector<double> rmulti(n*nvecs), zmulti(n*nvecs);
+		for(int i = 0; i < n; i++)
+			for(int v = 0; v < nvecs; v++)
+				rmulti[i*nvecs+v] = (v+1)*r[i];
+		rsgs.apply_multi(nvecs, &rmulti[0], &zmulti[0]);
+		for(int v = 0; v < nvecs; v++) {
+			for(int i = 0; i < n; i++)
+				z[i] = zmulti[i*nvecs+v]/(v+1);
+			diff = relative_difference(z, zref);
+			assert(diff < 1e-14);
+		}
+	}
+
+	return 0;
+}
+
+int main(int argc, char *argv[])
+{
+	if(argc < 3) {
+		std::cout << "Need mtx file name and block size\n";
+		std::exit(-1);
+	}
+
+	const std::string matfile = argv[1];
+	const int blocksize = std::stoi(argv[2]);
+
+	int res = -1;
+	switch(blocksize) {
+	case 1:
+		res = test_reordered<1, Level_SGS<double,int>>(matfile, RCM_ORDERING);
+		res = res || test_reordered<1, Level_SGS<double,int>>(matfile, ND_ORDERING);
+		break;
+	case 4:
+		res = test_reordered<4, Level_BSGS<double,int,4,ColMajor>>(matfile, RCM_ORDERING);
+		res = res || test_reordered<4, Level_BSGS<double,int,4,ColMajor>>(matfile, ND_ORDERING);
+		break;
+	default:
+		printf("Block size not available!");
+	}
+
+	return res;
+}
@@ -0,0 +1,103 @@
+#undef NDEBUG
+
+#include <cassert>
+#include <cmath>
+#include <map>
+#include <vector>
+#include "coomatrix.hpp"
+#include "blockmatrices.hpp"
+#include "../../src/sai.hpp"
+#include "testhelpers.hpp"
+
+using namespace blasted;
+
+/// Checks the optimality of the rows of a left SAI or ISAI M of A
+/** With the residual R = M A - I, the rows of an ISAI satisfy R(k,j) = 0 for all j in the pattern
+ * of row k. Those of a SAI, being least-squares solutions, satisfy sum_j R(k,j) A(c,j)^T = 0 for
+ * every c in the pattern of row k.
+ */
+template <int bs>
+static double check_sai(const SRMatrixStorage<double,int>& A, const SRMatrixStorage<double,int>& M,
+                        const bool fullsai)
+{
+	using Blk = Block_t<double,bs,ColMajor>;
+	const Blk *const av = reinterpret_cast<const Blk*>(&A.vals[0]);
+	const Blk *const mv = reinterpret_cast<const Blk*>(&M.vals[0]);
+
+	double maxres = 0, maxval = 0;
+	for(int j = 0; j < A.nnzb; j++)
+		maxval = std::max(maxval, av[j].cwiseAbs().maxCoeff());
+
+	for(int k = 0; k < A.nbrows; k++)
+	{
+		std::map<int,Blk> resrow;
+		for(int cc = M.browptr[k]; cc < M.browptr[k+1]; cc++) {
+			const int c = M.bcolind[cc];
+			for(int jj = A.browptr[c]; jj < A.browptr[c+1]; jj++) {
+				if(resrow.find(A.bcolind[jj]) == resrow.end())
+					resrow[A.bcolind[jj]] = Blk::Zero();
+				resrow[A.bcolind[jj]] += mv[cc]*av[jj];
+			}
+		}
+		resrow[k] -= Blk::Identity();
+
+		for(int cc = M.browptr[k]; cc < M.browptr[k+1]; cc++)
+		{
+			const int c = M.bcolind[cc];
+			if(fullsai) {
+				Blk grad = Blk::Zero();
+				for(int jj = A.browptr[c]; jj < A.browptr[c+1]; jj++)
+					grad += resrow[A.bcolind[jj]]*av[jj].transpose();
+				maxres = std::max(maxres, grad.cwiseAbs().maxCoeff()/maxval);
+			}
+			else
+				maxres = std::max(maxres, resrow[c].cwiseAbs().maxCoeff());
+		}
+	}
+	return maxres;
+}
+
+template <int bs>
+int test_sai(const std::string matfile, const bool fullsai)
+{
+	COOMatrix<double,int> coo;
+	coo.readMatrixMarket(matfile);
+	SRMatrixStorage<double,int> smat = getSRMatrixFromCOO<double,int,bs>(coo, "colmajor");
+
+	const LeftSAIPattern<int> sp = fullsai ? left_SAI_pattern(share_with_const(smat, bs))
+		: left_incomplete_SAI_pattern(share_with_const(smat, bs));
+	SRMatrixStorage<double,int> sai = zero_copy(smat, bs);
+	compute_SAI<double,int,bs,ColMajor>(share_with_const(smat, bs), sp, 16, fullsai, sai);
+
+	const double res = check_sai<bs>(smat, sai, fullsai);
+	std::cout << (fullsai ? " SAI" : " ISAI") << ": max optimality residual " << res << std::endl;
+	assert(res < 1e-10);
+	return 0;
+}
+
+int main(int argc, char *argv[])
+{
+	if(argc < 3) {
+		std::cout << "Need mtx file name and block size\n";
+		std::exit(-1);
+	}
+
+	const std::string matfile = argv[1];
+	const int blocksize = std::stoi(argv[2]);
+
+	int res = -1;
+	switch(blocksize) {
+	case 1:
+		res = test_sai<1>(matfile, true);
+		res = res || test_sai<1>(matfile, false);
+		break;
+	case 4:
+		res = test_sai<4>(matfile, true);
+		res = res || test_sai<4>(matfile, false);
+		break;
+	default:
+		printf("Block size not available!");
+	}
+
+	return res;
+}
@@ -0,0 +1,134 @@
+#undef NDEBUG
+
+#include <cassert>
+#include <cmath>
+#include <memory>
+#include <vector>
+#include "coomatrix.hpp"
+#include "blockmatrices.hpp"
+#include "solverfactory.hpp"
+#include "solverops_levels_sgs.hpp"
+#include "../../src/sai.hpp"
+#include "testhelpers.hpp"
+
+using namespace blasted;
+
+/// Checks that applying the preconditioner to several vectors at once matches applying it to each
+/** The numbers of vectors are such that the temporary storage is both reused and grown.
+ */
+static void check_apply_multi(const SRPreconditioner<double,int>& prec, const std::vector<double>& r)
+{
+	const int n = static_cast<int>(r.size());
+	std::vector<double> z(n), zref(n);
+	prec.apply(&r[0], &zref[0]);
+	for(const int nvecs : {3, 2, 5})
+	{
+		std::vector<double> rmulti(n*nvecs), zmulti(n*nvecs);
+		for(int i = 0; i < n; i++)
+			for(int v = 0; v < nvecs; v++)
+				rmulti[i*nvecs+v] = (v+1)*r[i];
+		prec.apply_multi(nvecs, &rmulti[0], &zmulti[0]);
+		for(int v = 0; v < nvecs; v++) {
+			for(int i = 0; i < n; i++)
+				z[i] = zmulti[i*nvecs+v]/(v+1);
+			assert(relative_difference(z, zref) < 1e-14);
+		}
+	}
+}
+
+/// Checks SAI and SGS-SAI preconditioners created by the factory
+/** The SAI preconditioner must apply the approximate inverse computed directly from the matrix,
+ * and SGS-SAI should approximate the application of exact (level-scheduled) SGS.
+ */
+template <int bs, typename LevelSGS>
+int test_saiprec(const std::string matfile, const bool incomplete)
+{
+	COOMatrix<double,int> coo;
+	coo.readMatrixMarket(matfile);
+	SRMatrixStorage<double,int> smat = getSRMatrixFromCOO<double,int,bs>(coo, "colmajor");
+	const int n = smat.nbrows*bs;
+
+	std::vector<double> x(n), r(n), z(n), zref(n);
+	for(int i = 0; i < n; i++)
+		x[i] = 1.0 + (i % 7);
+	block_matvec<bs>(smat, x, r);
+
+	const SRFactory<double,int> factory;
+	AsyncSolverSettings settings;
+	settings.prectype = factory.solverTypeFromString("sai");
+	assert(settings.prectype == BLASTED_SAI);
+	settings.bs = bs;
+	settings.blockstorage = ColMajor;
+	settings.relax = false;
+	settings.thread_chunk_size = 16;
+	settings.incomplete_sai = incomplete;
+
+	std::unique_ptr<SRPreconditioner<double,int>> sai
+		(factory.create_preconditioner(share_with_const(smat, bs), settings));
+	assert(sai->dim() == n);
+	assert(!sai->relaxationAvailable());
+	sai->compute();
+	sai->apply(&r[0], &z[0]);
+
+	const LeftSAIPattern<int> sp = incomplete ? left_incomplete_SAI_pattern(share_with_const(smat, bs))
+		: left_SAI_pattern(share_with_const(smat, bs));
+	SRMatrixStorage<double,int> saimat = zero_copy(smat, bs);
+	compute_SAI<double,int,bs,ColMajor>(share_with_const(smat, bs), sp, 16, !incomplete, saimat);
+	block_matvec<bs>(saimat, r, zref);
+	double diff = relative_difference(z, zref);
+	std::cout << (incomplete ? " ISAI" : " SAI") << ": relative difference " << diff
+	          << ", relative error of M A x " << relative_difference(z, x) << std::endl;
+	assert(diff < 1e-14);
+
+	// recomputation reuses the pattern
+	sai->compute();
+	sai->apply(&r[0], &zref[0]);
+	assert(relative_difference(z, zref) == 0);
+	check_apply_multi(*sai, r);
+
+	settings.prectype = factory.solverTypeFromString("sgs_sai");
+	assert(settings.prectype == BLASTED_SGS_SAI);
+	std::unique_ptr<SRPreconditioner<double,int>> sgssai
+		(factory.create_preconditioner(share_with_const(smat, bs), settings));
+	assert(sgssai->dim() == n);
+	sgssai->compute();
+	sgssai->apply(&r[0], &z[0]);
+
+	LevelSGS sgs(share_with_const(smat, bs));
+	sgs.compute();
+	sgs.apply(&r[0], &zref[0]);
+	diff = relative_difference(z, zref);
+	std::cout << (incomplete ? " SGS-ISAI" : " SGS-SAI") << ": relative difference from SGS "
+	          << diff << std::endl;
+	assert(diff < 1.0);
+	check_apply_multi(*sgssai, r);
+
+	return 0;
+}
+
+int main(int argc, char *argv[])
+{
+	if(argc < 3) {
+		std::cout << "Need mtx file name and block size\n";
+		std::exit(-1);
+	}
+
+	const std::string matfile = argv[1];
+	const int blocksize = std::stoi(argv[2]);
+
+	int res = -1;
+	switch(blocksize) {
+	case 1:
+		res = test_saiprec<1, Level_SGS<double,int>>(matfile, false);
+		res = res || test_saiprec<1, Level_SGS<double,int>>(matfile, true);
+		break;
+	case 4:
+		res = test_saiprec<4, Level_BSGS<double,int,4,ColMajor>>(matfile, false);
+		res = res || test_saiprec<4, Level_BSGS<double,int,4,ColMajor>>(matfile, true);
+		break;
+	default:
+		printf("Block size not available!");
+	}
+
+	return res;
+}
@@ -0,0 +1,78 @@
+/** \file
+ * \brief Checks conversion from CSR to SELL-C-sigma and the SELL-C-sigma matrix-vector product
+ */
+#undef NDEBUG
+
+#include <cfloat>
+#include <stdexcept>
+#include "coomatrix.hpp"
+#include "sellmatrixdefs.hpp"
+#include "../../src/blas/matvecs.hpp"
+
+using namespace blasted;
+
+template <int C>
+int testSELLMatMult(const std::string matfile, const std::string xvec, const std::string prodvec,
+                    const int sigma)
+{
+	COOMatrix<double,int> coom;
+	coom.readMatrixMarket(matfile);
+
+	const device_vector<double> x = readDenseMatrixMarket<double>(xvec);
+	const device_vector<double> ans = readDenseMatrixMarket<double>(prodvec);
+
+	const SRMatrixStorage<const double,const int> smat
+		= move_to_const<double,int>(getSRMatrixFromCOO<double,int,1>(coom, ""));
+	const CRawBSRMatrix<double,int> rmat(&smat.browptr[0], &smat.bcolind[0], &smat.vals[0],
+	                                     &smat.diagind[0], &smat.browendptr[0], smat.nbrows,
+	                                     smat.nnzb, smat.nbstored);
+
+	// full matrix product
+	SELLMatrixStorage<double,int> fmat;
+	convert_SR_to_SELL(rmat, C, sigma, SELL_FULL, fmat);
+	assert(fmat.nchunks*C >= rmat.nbrows);
+
+	device_vector<double> y(rmat.nbrows);
+	BLAS_SELL<double,int,C>::matrix_apply(createRawView(fmat), x.data(), y.data());
+
+	for(int i = 0; i < rmat.nbrows; i++)
+		assert(std::fabs(y[i]-ans[i]) < 10*DBL_EPSILON);
+
+	// lower + diagonal + upper should give the same product
+	SELLMatrixStorage<double,int> lmat, umat;
+	convert_SR_to_SELL(rmat, C, sigma, SELL_STRICT_LOWER, lmat);
+	convert_SR_to_SELL(rmat, C, sigma, SELL_STRICT_UPPER, umat);
+
+	device_vector<double> yl(rmat.nbrows), yu(rmat.nbrows);
+	BLAS_SELL<double,int,C>::matrix_apply(createRawView(lmat), x.data(), yl.data());
+	BLAS_SELL<double,int,C>::gemv3(createRawView(umat), 1.0, x.data(), 1.0, yl.data(), yu.data());
+
+	for(int i = 0; i < rmat.nbrows; i++) {
+		const double d = rmat.vals[rmat.diagind[i]]*x[i];
+		assert(std::fabs(yu[i]+d-ans[i]) < 100*DBL_EPSILON*(1.0+std::fabs(ans[i])));
+	}
+
+	// re-gathering values must not change anything
+	update_SELL_values(rmat, fmat);
+	BLAS_SELL<double,int,C>::matrix_apply(createRawView(fmat), x.data(), y.data());
+	for(int i = 0; i < rmat.nbrows; i++)
+		assert(std::fabs(y[i]-ans[i]) < 10*DBL_EPSILON);
+
+	return 0;
+}
+
+int main(int argc, char *argv[])
+{
+	if(argc < 6)
+		throw std::runtime_error("Need matrix file, x file, b file, chunk height and sorting scope!");
+
+	const int C = std::stoi(argv[4]);
+	const int sigma = std::stoi(argv[5]);
+
+	if(C == 4)
+		return testSELLMatMult<4>(argv[1], argv[2], argv[3], sigma);
+	else if(C == 8)
+		return testSELLMatMult<8>(argv[1], argv[2], argv[3], sigma);
+	else
+		throw std::runtime_error("Chunk height not available!");
+}
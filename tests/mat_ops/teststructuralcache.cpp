@@ -0,0 +1,100 @@
+#undef NDEBUG
+
+#include <cassert>
+#include "coomatrix.hpp"
+#include "blockmatrices.hpp"
+#include "ilu_pattern.hpp"
+#include "structural_cache.hpp"
+
+using namespace blasted;
+
+template <int bs>
+int test_structuralcache(const std::string matfile)
+{
+	COOMatrix<double,int> coo;
+	coo.readMatrixMarket(matfile);
+
+	SRMatrixStorage<const double,const int> smat =
+		move_to_const<double,int>(getSRMatrixFromCOO<double,int,bs>(coo, "colmajor"));
+	CRawBSRMatrix<double,int> omat(&smat.browptr[0], &smat.bcolind[0], &smat.vals[0],
+	                               &smat.diagind[0], &smat.browendptr[0], smat.nbrows,
+	                               smat.nnzb, smat.nbstored);
+
+	// a copy of the pattern with one column index changed
+	std::vector<int> bcolind(omat.bcolind, omat.bcolind+omat.nnzb);
+	std::swap(bcolind[0], bcolind[1]);
+	CRawBSRMatrix<double,int> pmat = omat;
+	pmat.bcolind = &bcolind[0];
+
+	const PatternFingerprint fp = pattern_fingerprint(omat, bs);
+	assert(fp == pattern_fingerprint(omat, bs));
+	assert(!(fp == pattern_fingerprint(pmat, bs)));
+	assert(!(fp == pattern_fingerprint(omat, bs+1)));
+
+	StructuralCache& cache = structural_cache();
+	const size_t nentries = cache.size();
+	int nbuilds = 0;
+	const auto build = [&omat,&nbuilds]() {
+		nbuilds++;
+		return compute_ILU_positions_CSR_CSR(&omat);
+	};
+
+	{
+		const std::shared_ptr<const ILUPositions<int>> p1
+			= cache.structure<ILUPositions<int>>("ILU0 positions", fp, build);
+		const std::shared_ptr<const ILUPositions<int>> p2
+			= cache.structure<ILUPositions<int>>("ILU0 positions", fp, build);
+		assert(p1 == p2);
+		assert(nbuilds == 1);
+		assert(cache.size() == nentries+1);
+
+		const std::shared_ptr<const ILUPositions<int>> p3
+			= cache.structure<ILUPositions<int>>("ILU0 positions", pattern_fingerprint(pmat, bs),
+			                                     build);
+		assert(p3 != p1);
+		assert(nbuilds == 2);
+
+		bool created = false;
+		const std::shared_ptr<double> b1 = cache.operator_buffer<Block_t<double,bs,ColMajor>,double>
+			("inverted diagonal blocks", fp, omat.vals, omat.nbrows*bs*bs, created);
+		assert(created);
+		const std::shared_ptr<double> b2 = cache.operator_buffer<Block_t<double,bs,ColMajor>,double>
+			("inverted diagonal blocks", fp, omat.vals, omat.nbrows*bs*bs, created);
+		assert(!created);
+		assert(b1 == b2);
+		const std::shared_ptr<double> b3 = cache.operator_buffer<Block_t<double,bs,ColMajor>,double>
+			("inverted diagonal blocks", fp, &bcolind[0], omat.nbrows*bs*bs, created);
+		assert(created);
+		assert(b3 != b1);
+	}
+
+	// nothing is retained once the users are gone
+	assert(cache.size() == nentries);
+
+	return 0;
+}
+
+int main(int argc, char *argv[])
+{
+	if(argc < 3) {
+		std::cout << "Need mtx file name and block size\n";
+		std::exit(-1);
+	}
+
+	const std::string matfile = argv[1];
+	const int blocksize = std::stoi(argv[2]);
+
+	int res = -1;
+	switch(blocksize) {
+	case 1:
+		res = test_structuralcache<1>(matfile);
+		break;
+	case 4:
+		res = test_structuralcache<4>(matfile);
+		break;
+	default:
+		printf("Block size not available!");
+	}
+
+	return res;
+}
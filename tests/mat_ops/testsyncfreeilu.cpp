@@ -0,0 +1,107 @@
+#undef NDEBUG
+
+#include <cassert>
+#include <cmath>
+#include <vector>
+#include "coomatrix.hpp"
+#include "blockmatrices.hpp"
+#include "solverops_ilu0.hpp"
+#include "testhelpers.hpp"
+
+using namespace blasted;
+
+/// Checks that the synchronization-free factorization and triangular solves are exact
+/** The reference is one serial asynchronous sweep each for factorization and application, which
+ * is exact.
+ */
+template <typename Prec>
+int compare_syncfree(Prec& syncfree, Prec& serial, const int n)
+{
+	syncfree.setSyncFreeFactorization(true);
+	syncfree.setApplyType(APPLY_SYNCFREE);
+	PrecInfo pinfo = syncfree.compute();
+	assert(pinfo.build_sweeps == 1);
+	serial.compute();
+
+	const std::vector<double> r(n, 1.0);
+	std::vector<double> zsf(n), zser(n);
+	serial.apply(&r[0], &zser[0]);
+
+	// a second computation or application must not depend on the completion flags of the first
+	for(int i = 0; i < 2; i++) {
+		syncfree.compute();
+		syncfree.apply(&r[0], &zsf[0]);
+		const double diff = relative_difference(zsf, zser);
+		std::cout << " Relative difference " << diff << std::endl;
+		assert(diff <= 1e-12);
+	}
+
+	// application to several vectors must be the same operator
+	const int nvecs = 3;
+	std::vector<double> rmulti(n*nvecs), zmulti(n*nvecs), zcol(n);
+	for(int i = 0; i < n; i++)
+		for(int v = 0; v < nvecs; v++)
+			rmulti[i*nvecs+v] = v+1;
+	syncfree.apply_multi(nvecs, &rmulti[0], &zmulti[0]);
+	for(int v = 0; v < nvecs; v++) {
+		for(int i = 0; i < n; i++)
+			zcol[i] = zmulti[i*nvecs+v]/(v+1);
+		const double diff = relative_difference(zcol, zser);
+		std::cout << " Multiple vectors: relative difference " << diff << std::endl;
+		assert(diff <= 1e-12);
+	}
+	return 0;
+}
+
+template <int bs>
+int test_syncfree_ilu(const std::string matfile, const bool usescaling)
+{
+	COOMatrix<double,int> coo;
+	coo.readMatrixMarket(matfile);
+
+	if(bs == 1) {
+		using Prec = AsyncILU0_SRPreconditioner<double,int>;
+		SRMatrixStorage<double,int> smat = getSRMatrixFromCOO<double,int,1>(coo, "rowmajor");
+		Prec syncfree(share_with_const(smat, 1), 1, 1, usescaling, 64, INIT_F_ORIGINAL,
+		              INIT_A_ZERO, false, true, true);
+		Prec serial(share_with_const(smat, 1), 1, 1, usescaling, 64, INIT_F_ORIGINAL,
+		            INIT_A_ZERO, false, false, false);
+		return compare_syncfree(syncfree, serial, smat.nbrows);
+	}
+	else {
+		using Prec = AsyncBlockILU0_SRPreconditioner<double,int,bs,ColMajor>;
+		SRMatrixStorage<double,int> smat = getSRMatrixFromCOO<double,int,bs>(coo, "colmajor");
+		Prec syncfree(share_with_const(smat, bs), 1, 1, usescaling, 64, INIT_F_ORIGINAL,
+		              INIT_A_ZERO, true, true);
+		Prec serial(share_with_const(smat, bs), 1, 1, usescaling, 64, INIT_F_ORIGINAL,
+		            INIT_A_ZERO, false, false);
+		return compare_syncfree(syncfree, serial, smat.nbrows*bs);
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	if(argc < 3) {
+		std::cout << "Need mtx file name and block size\n";
+		std::exit(-1);
+	}
+
+	const std::string matfile = argv[1];
+	const int blocksize = std::stoi(argv[2]);
+
+	int res = -1;
+	switch(blocksize) {
+	case 1:
+		res = test_syncfree_ilu<1>(matfile, false);
+		res = res || test_syncfree_ilu<1>(matfile, true);
+		break;
+	case 4:
+		res = test_syncfree_ilu<4>(matfile, false);
+		res = res || test_syncfree_ilu<4>(matfile, true);
+		break;
+	default:
+		printf("Block size not available!");
+	}
+
+	return res;
+}
@@ -0,0 +1,102 @@
+#undef NDEBUG
+
+#include <cassert>
+#include <cmath>
+#include <vector>
+#include "coomatrix.hpp"
+#include "blockmatrices.hpp"
+#include "solverops_sgs.hpp"
+#include "solverops_levels_sgs.hpp"
+#include "solverops_ilu0.hpp"
+#include "testhelpers.hpp"
+
+using namespace blasted;
+
+/// Checks that block-asynchronous tiled sweeps converge to the exact SGS and ILU(0) operators
+/** The tiles are made small so that there are many of them. The references are level-scheduled
+ * SGS and the serially computed and applied ILU(0).
+ */
+template <int bs, typename SGS, typename LevelSGS, typename ILU>
+int test_tiled_sweeps(const std::string matfile)
+{
+	const int nsweeps = 20, ninner = 2;
+	const size_t tilebytes = 16*1024;
+
+	COOMatrix<double,int> coo;
+	coo.readMatrixMarket(matfile);
+	SRMatrixStorage<double,int> smat = getSRMatrixFromCOO<double,int,bs>(coo, "colmajor");
+	const int n = smat.nbrows*bs;
+	const std::vector<double> r(n, 1.0);
+
+	SGS sgs(share_with_const(smat, bs), nsweeps, INIT_A_ZERO, 32);
+	sgs.setSweepTiling(tilebytes, ninner);
+	sgs.compute();
+	LevelSGS lsgs(share_with_const(smat, bs));
+	lsgs.compute();
+
+	std::vector<double> z(n), zref(n);
+	sgs.apply(&r[0], &z[0]);
+	lsgs.apply(&r[0], &zref[0]);
+	const double sgsdiff = relative_difference(z, zref);
+	std::cout << " SGS: relative difference " << sgsdiff << std::endl;
+	assert(sgsdiff < 1e-10);
+
+	ILU ilu(share_with_const(smat, bs), nsweeps, 1, false, 32, INIT_F_ORIGINAL, INIT_A_ZERO,
+	        true, false);
+	ilu.setSweepTiling(tilebytes, ninner);
+	const PrecInfo pinfo = ilu.compute();
+	assert(pinfo.build_sweeps == nsweeps);
+	ILU iluref(share_with_const(smat, bs), 1, 1, false, 32, INIT_F_ORIGINAL, INIT_A_ZERO,
+	           false, false);
+	iluref.compute();
+
+	ilu.apply(&r[0], &z[0]);
+	iluref.apply(&r[0], &zref[0]);
+	const double iludiff = relative_difference(z, zref);
+	std::cout << " ILU0: relative difference " << iludiff << std::endl;
+	assert(iludiff < 1e-10);
+
+	return 0;
+}
+
+/// Scalar ILU(0) with the constructor arguments of the block version
+class ScalarILU0 : public AsyncILU0_SRPreconditioner<double,int>
+{
+public:
+	ScalarILU0(SRMatrixStorage<const double,const int>&& matrix, const int nbuildsweeps,
+	           const int napplysweeps, const bool use_scaling, const int tcs,
+	           const FactInit finit, const ApplyInit ainit, const bool threadedfactor,
+	           const bool threadedapply)
+		: AsyncILU0_SRPreconditioner<double,int>(std::move(matrix), nbuildsweeps, napplysweeps,
+		                                         use_scaling, tcs, finit, ainit, false,
+		                                         threadedfactor, threadedapply)
+	{ }
+};
+
+int main(int argc, char *argv[])
+{
+	if(argc < 3) {
+		std::cout << "Need mtx file name and block size\n";
+		std::exit(-1);
+	}
+
+	const std::string matfile = argv[1];
+	const int blocksize = std::stoi(argv[2]);
+
+	int res = -1;
+	switch(blocksize) {
+	case 1:
+		res = test_tiled_sweeps<1, AsyncSGS_SRPreconditioner<double,int>, Level_SGS<double,int>,
+		                        ScalarILU0>(matfile);
+		break;
+	case 4:
+		res = test_tiled_sweeps<4, AsyncBlockSGS_SRPreconditioner<double,int,4,ColMajor>,
+		                        Level_BSGS<double,int,4,ColMajor>,
+		                        AsyncBlockILU0_SRPreconditioner<double,int,4,ColMajor>>(matfile);
+		break;
+	default:
+		printf("Block size not available!");
+	}
+
+	return res;
+}
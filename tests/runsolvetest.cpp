@@ -29,7 +29,8 @@ int main(const int argc, const char *const argv[])
 		std::cout << " the preconditioner (options: jacobi, sgs, ilu0), \n";
 		std::cout << " the factor initialization type (options: init_zero, init_sgs, init_original)\n";
 		std::cout << " the apply initialization type (options: init_zero, init_jacobi)\n";
-		std::cout << " the matrix type to use (options: csr, bsr),\n";
+		std::cout << " the matrix type to use (options: csr, bsr, sell, csrci, bsrci,\n";
+		std::cout << "  csrsp, bsrsp, csrnuma, bsrnuma, csradapt, bsradapt),\n";
 		std::cout << "whether the entries within blocks should be rowmajor or colmajor\n";
 		std::cout << "(this option does not matter for CSR, but it's needed anyway),\n";
 		std::cout << "the three file names of (in order) the matrix,\n"
@@ -56,7 +57,8 @@ int main(const int argc, const char *const argv[])
 	const std::string bfile = argv[9];
 
 	int err = 0;
-	if(mattype == "bsr")
+	if(mattype == "bsr" || mattype == "bsrci" || mattype == "bsrsp" || mattype == "bsrnuma"
+	   || mattype == "bsradapt")
 		err = testSolve<4>(solvertype, precontype, factinittype, applyinittype, mattype, storageorder, 
 		                   testtol, matfile, xfile, bfile, reltol, maxiter, 1, 1, threadchunksize);
 	else
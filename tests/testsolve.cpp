@@ -7,6 +7,7 @@
 #undef NDEBUG
 
 #include <iostream>
+#include <cmath>
 
 #include <blockmatrices.hpp>
 #include <coomatrix.hpp>
@@ -17,9 +18,66 @@
 
 #include "testsolve.hpp"
 #include "solvers.hpp"
+#include "../src/blas/matvecs.hpp"
 
 using namespace blasted;
 
+/// Product of the test matrix with several row-interleaved vectors
+template <int bs>
+static void multiProduct(const SRMatrixStorage<const double,const int>& smat,
+                         const std::string storageorder, const int nv,
+                         const double *const x, double *const y)
+{
+	if(storageorder == "rowmajor")
+		BLAS_BSR<const double,const int,bs,RowMajor>::matrix_apply_multi(std::move(smat), nv, x, y);
+	else
+		BLAS_BSR<const double,const int,bs,ColMajor>::matrix_apply_multi(std::move(smat), nv, x, y);
+}
+
+template <>
+void multiProduct<1>(const SRMatrixStorage<const double,const int>& smat, const std::string,
+                     const int nv, const double *const x, double *const y)
+{
+	BLAS_CSR<const double,const int>::matrix_apply_multi(std::move(smat), nv, x, y);
+}
+
+/// Checks that the multi-vector product and preconditioner agree with their single-vector versions
+/** The three vectors are repeated with power-of-two scalings so that the multivector spans more
+ * than one group of vectors in the kernels that work on groups.
+ */
+template <int bs>
+static void testMultiVector(const SRMatrixView<double,int> *const mat, const std::string storageorder,
+                            const SRPreconditioner<double,int> *const prec,
+                            const device_vector<double>& v0, const device_vector<double>& v1,
+                            const device_vector<double>& v2)
+{
+	constexpr int nv = 11;
+	const int n = mat->dim();
+	const device_vector<double> *const vs[3] = {&v0, &v1, &v2};
+
+	device_vector<double> xm(n*nv), ym(n*nv), zm(n*nv,0.0);
+	for(int i = 0; i < n; i++)
+		for(int v = 0; v < nv; v++)
+			xm[i*nv+v] = std::ldexp((*vs[v%3])[i], v/3);
+
+	multiProduct<bs>(mat->getSRStorage(), storageorder, nv, xm.data(), ym.data());
+	prec->apply_multi(nv, xm.data(), zm.data());
+
+	device_vector<double> y(n), z(n);
+	for(int v = 0; v < nv; v++)
+	{
+		mat->apply(vs[v%3]->data(), y.data());
+		std::fill(z.begin(), z.end(), 0.0);
+		prec->apply(vs[v%3]->data(), z.data());
+
+		for(int i = 0; i < n; i++) {
+			const double ys = std::ldexp(y[i], v/3), zs = std::ldexp(z[i], v/3);
+			assert(std::fabs(ym[i*nv+v]-ys) <= 1e-12*(1.0+std::fabs(ys)));
+			assert(std::fabs(zm[i*nv+v]-zs) <= 1e-12*(1.0+std::fabs(zs)));
+		}
+	}
+}
+
 template<int bs>
 int testSolve(const std::string solvertype, const std::string precontype,
               const std::string factinittype, const std::string applyinittype,
@@ -76,6 +134,19 @@ int testSolve(const std::string solvertype, const std::string precontype,
 	else
 		params.blockstorage = ColMajor;
 	params.relax = false;
+	if(mattype == "sell") {
+		params.sell_chunk_height = 8;
+		params.sell_sort_scope = 32;
+	}
+	params.compressed_colind = (mattype == "csrci" || mattype == "bsrci");
+	params.float_factors = params.float_matrix = (mattype == "csrsp" || mattype == "bsrsp");
+	if(mattype == "csrnuma" || mattype == "bsrnuma")
+		params.numa_domains = 2;
+	const bool adaptivebuild = (mattype == "csradapt" || mattype == "bsradapt");
+	if(adaptivebuild) {
+		params.nbuildsweeps = 25;
+		params.build_tol = 1e-6;
+	}
 
 	// prec = fctry.create_preconditioner(move_to_const<double,int>
 	//                                    (getSRMatrixFromCOO<double,int,bs>(coom, storageorder)),
@@ -84,7 +155,11 @@ int testSolve(const std::string solvertype, const std::string precontype,
 
 	// prec->wrap(mat->getSRStorage().nbrows, &mat->getSRStorage().browptr[0], &mat->getSRStorage().bcolind[0],
 	//            &mat->getSRStorage().vals[0], &mat->getSRStorage().diagind[0]);
-	prec->compute();
+	const PrecInfo pinfo = prec->compute();
+	if(adaptivebuild) {
+		std::cout << " Build sweeps used = " << pinfo.build_sweeps << std::endl;
+		assert(pinfo.build_sweeps > 0 && pinfo.build_sweeps < params.nbuildsweeps);
+	}
 
 	IterativeSolver* solver = nullptr;
 	if(solvertype == "richardson")
@@ -109,6 +184,8 @@ int testSolve(const std::string solvertype, const std::string precontype,
 	std::cout << " L2 norm of error = " << l2norm << '\n';
 	assert(l2norm < testtol);
 
+	testMultiVector<bs>(mat, storageorder, prec, b, x, ans);
+
 	delete solver;
 	delete prec;
 	delete mat;
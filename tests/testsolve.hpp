@@ -13,7 +13,11 @@
  * \param precontype The preconditioner to test: "jacobi", "sgs", "ilu0" or "none"
  * \param factinittype Initial guess method for asynchronous factorizations
  * \param applyinittype Initial guess method for asynchronous preconditioner applications
- * \param mattype The type of matrix to test the preconditioner with: "csr" or "bsr"
+ * \param mattype The type of matrix to test the preconditioner with: "csr", "bsr", "sell", "csrci",
+ *   "bsrci", "csrsp", "bsrsp", "csrnuma" or "bsrnuma" - "sell" means that the preconditioner works
+ *   on a SELL-8-32 copy of the CSR matrix, the "ci" variants mean that it uses compressed column
+ *   indices, the "sp" variants mean that it stores its factors and a copy of the matrix in single
+ *   precision and the "numa" variants mean that its data and sweeps are split over two NUMA domains
  * \param storageorder Matters only for BSR matrices - whether the entries within blocks
  *   are stored "rowmajor" or "colmajor"
  * \param matfile The mtx file containing the matrix